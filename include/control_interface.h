@@ -21,8 +21,10 @@
 #ifndef SUSHI_CONTROL_INTERFACE_H
 #define SUSHI_CONTROL_INTERFACE_H
 
+#include <chrono>
 #include <utility>
 #include <optional>
+#include <variant>
 #include <vector>
 
 namespace sushi {
@@ -114,6 +116,204 @@ struct TrackInfo
     int         processor_count;
 };
 
+struct ParameterValue
+{
+    int     processor_id;
+    int     parameter_id;
+    float   value;
+};
+
+struct ParameterState
+{
+    ParameterInfo   info;
+    float           value;
+};
+
+struct ProcessorState
+{
+    ProcessorInfo               info;
+    std::vector<ParameterState> parameters;
+};
+
+struct TrackState
+{
+    TrackInfo                   info;
+    std::vector<ParameterState> parameters;
+    std::vector<ProcessorState> processors;
+};
+
+/* The full state of the engine, for clients that need to mirror it */
+struct EngineSnapshot
+{
+    float                   samplerate;
+    PlayingMode             playing_mode;
+    SyncMode                sync_mode;
+    float                   tempo;
+    TimeSignature           time_signature;
+    std::vector<TrackState> tracks;
+};
+
+enum class NotificationType
+{
+    PARAMETER_CHANGE,
+    PROCESSOR_UPDATE,
+    TRACK_UPDATE,
+    TRANSPORT_UPDATE,
+    CLIPPING
+};
+
+enum class ProcessorAction
+{
+    ADDED,
+    DELETED
+};
+
+enum class TrackAction
+{
+    ADDED,
+    DELETED
+};
+
+enum class TransportAction
+{
+    TEMPO_CHANGED,
+    TIME_SIGNATURE_CHANGED,
+    PLAYING_MODE_CHANGED,
+    SYNC_MODE_CHANGED
+};
+
+enum class ClippingChannelType
+{
+    INPUT,
+    OUTPUT
+};
+
+class ControlNotification
+{
+public:
+    virtual ~ControlNotification() = default;
+
+    NotificationType            type() const {return _type;}
+    std::chrono::microseconds   timestamp() const {return _timestamp;}
+
+protected:
+    ControlNotification(NotificationType type, std::chrono::microseconds timestamp) : _type(type),
+                                                                                      _timestamp(timestamp) {}
+
+private:
+    NotificationType            _type;
+    std::chrono::microseconds   _timestamp;
+};
+
+class ParameterChangeNotification : public ControlNotification
+{
+public:
+    ParameterChangeNotification(int processor_id,
+                                int parameter_id,
+                                float value,
+                                std::chrono::microseconds timestamp) : ControlNotification(NotificationType::PARAMETER_CHANGE, timestamp),
+                                                                       _processor_id(processor_id),
+                                                                       _parameter_id(parameter_id),
+                                                                       _value(value) {}
+
+    int     processor_id() const {return _processor_id;}
+    int     parameter_id() const {return _parameter_id;}
+    float   value() const {return _value;}
+
+private:
+    int     _processor_id;
+    int     _parameter_id;
+    float   _value;
+};
+
+class ProcessorNotification : public ControlNotification
+{
+public:
+    ProcessorNotification(ProcessorAction action,
+                          int processor_id,
+                          int parent_track_id,
+                          std::chrono::microseconds timestamp) : ControlNotification(NotificationType::PROCESSOR_UPDATE, timestamp),
+                                                                 _action(action),
+                                                                 _processor_id(processor_id),
+                                                                 _parent_track_id(parent_track_id) {}
+
+    ProcessorAction action() const {return _action;}
+    int             processor_id() const {return _processor_id;}
+    int             parent_track_id() const {return _parent_track_id;}
+
+private:
+    ProcessorAction _action;
+    int             _processor_id;
+    int             _parent_track_id;
+};
+
+class TrackNotification : public ControlNotification
+{
+public:
+    TrackNotification(TrackAction action,
+                      int track_id,
+                      std::chrono::microseconds timestamp) : ControlNotification(NotificationType::TRACK_UPDATE, timestamp),
+                                                             _action(action),
+                                                             _track_id(track_id) {}
+
+    TrackAction action() const {return _action;}
+    int         track_id() const {return _track_id;}
+
+private:
+    TrackAction _action;
+    int         _track_id;
+};
+
+class TransportNotification : public ControlNotification
+{
+public:
+    using Value = std::variant<float, TimeSignature, PlayingMode, SyncMode>;
+
+    TransportNotification(TransportAction action,
+                          Value value,
+                          std::chrono::microseconds timestamp) : ControlNotification(NotificationType::TRANSPORT_UPDATE, timestamp),
+                                                                 _action(action),
+                                                                 _value(value) {}
+
+    TransportAction action() const {return _action;}
+    /* Holds the tempo, time signature, playing mode or sync mode depending on action() */
+    const Value&    value() const {return _value;}
+
+private:
+    TransportAction _action;
+    Value           _value;
+};
+
+class ClippingNotification : public ControlNotification
+{
+public:
+    ClippingNotification(int channel,
+                         ClippingChannelType channel_type,
+                         std::chrono::microseconds timestamp) : ControlNotification(NotificationType::CLIPPING, timestamp),
+                                                                _channel(channel),
+                                                                _channel_type(channel_type) {}
+
+    int                 channel() const {return _channel;}
+    ClippingChannelType channel_type() const {return _channel_type;}
+
+private:
+    int                 _channel;
+    ClippingChannelType _channel_type;
+};
+
+/**
+ * @brief Interface for receiving notifications, notification() is called from a
+ *        non-rt thread in sushi and should return quickly without blocking.
+ *        The notification object is only valid during the call.
+ */
+class ControlListener
+{
+public:
+    virtual ~ControlListener() = default;
+
+    virtual void notification(const ControlNotification* notification) = 0;
+};
+
 class SushiControl
 {
 public:
@@ -177,6 +377,13 @@ public:
     virtual ControlStatus                              set_parameter_value(int processor_id, int parameter_id, float value) = 0;
     virtual ControlStatus                              set_parameter_value_normalised(int processor_id, int parameter_id, float value) = 0;
     virtual ControlStatus                              set_string_property_value(int processor_id, int parameter_id, const std::string& value) = 0;
+    virtual std::vector<ParameterValue>                get_all_parameter_values() const = 0;
+    virtual ControlStatus                              set_parameter_values(const std::vector<ParameterValue>& values) = 0;
+    virtual EngineSnapshot                             get_engine_snapshot() const = 0;
+
+    // Notifications
+    virtual ControlStatus                              subscribe_to_notifications(NotificationType type, ControlListener* listener) = 0;
+    virtual ControlStatus                              unsubscribe_from_notifications(NotificationType type, ControlListener* listener) = 0;
 
 
 protected:
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Layout of the shared memory region that sushi publishes its state in
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ *
+ * Plain C, so that local clients written in any language can use it.
+ *
+ * The region is only written by sushi. Clients open it with shm_open() using
+ * O_RDONLY and map it with mmap() using PROT_READ. After that the state can be
+ * read without any system calls.
+ *
+ * The region is protected by a sequence lock. A client copies the values it
+ * needs after sushi_shared_state_read_begin(). It retries if
+ * sushi_shared_state_read_retry() returns true afterwards.
+ *
+ *     sushi_transport_state transport;
+ *     uint32_t sequence;
+ *     do
+ *     {
+ *         sequence = sushi_shared_state_read_begin(state);
+ *         transport = state->transport;
+ *     }
+ *     while (sushi_shared_state_read_retry(state, sequence));
+ */
+
+#ifndef SUSHI_SHARED_STATE_H
+#define SUSHI_SHARED_STATE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SUSHI_SHARED_STATE_DEFAULT_NAME     "/sushi_state"
+/* "SUSH" in little endian byte order */
+#define SUSHI_SHARED_STATE_MAGIC            0x48535553u
+/* Incremented on every change to the layout below */
+#define SUSHI_SHARED_STATE_VERSION          1u
+
+#define SUSHI_SHARED_STATE_MAX_PARAMETERS   4096
+#define SUSHI_SHARED_STATE_MAX_CHANNELS     32
+#define SUSHI_SHARED_STATE_MAX_TRACKS       64
+#define SUSHI_SHARED_STATE_TRACK_CHANNELS   10
+
+enum
+{
+    SUSHI_PLAYING_MODE_STOPPED = 0,
+    SUSHI_PLAYING_MODE_PLAYING = 1,
+    SUSHI_PLAYING_MODE_RECORDING = 2
+};
+
+enum
+{
+    SUSHI_SYNC_MODE_INTERNAL = 0,
+    SUSHI_SYNC_MODE_MIDI = 1,
+    SUSHI_SYNC_MODE_GATE = 2,
+    SUSHI_SYNC_MODE_ABLETON_LINK = 3
+};
+
+/* Levels as linear gain values */
+typedef struct sushi_channel_level
+{
+    float peak;
+    float rms;
+    float true_peak;
+} sushi_channel_level;
+
+typedef struct sushi_track_levels
+{
+    uint32_t track_id;
+    uint32_t channels;
+    sushi_channel_level levels[SUSHI_SHARED_STATE_TRACK_CHANNELS];
+} sushi_track_levels;
+
+/* The value is the same as in parameter change notifications, not normalised */
+typedef struct sushi_parameter_value
+{
+    uint32_t processor_id;
+    uint32_t parameter_id;
+    float value;
+} sushi_parameter_value;
+
+typedef struct sushi_transport_state
+{
+    float tempo;
+    int32_t time_signature_numerator;
+    int32_t time_signature_denominator;
+    int32_t playing_mode;
+    int32_t sync_mode;
+} sushi_transport_state;
+
+/* Process times of the engine as a fraction of the time available for one audio
+ * chunk. Only updated if sushi was started with timing statistics enabled */
+typedef struct sushi_engine_timings
+{
+    float average;
+    float min;
+    float max;
+} sushi_engine_timings;
+
+typedef struct sushi_shared_state
+{
+    /* Set once when the region is created */
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+
+    /* Odd while sushi is writing to the region */
+    uint32_t sequence;
+
+    /* Incremented when the set of parameters changes, i.e. when tracks or
+     * processors are added or removed */
+    uint32_t parameter_generation;
+    uint32_t parameter_count;
+
+    /* Time of the last update in microseconds, from CLOCK_MONOTONIC */
+    int64_t timestamp;
+
+    sushi_transport_state transport;
+    sushi_engine_timings engine_timings;
+
+    /* Only updated if metering is enabled in the engine */
+    uint32_t input_channels;
+    uint32_t output_channels;
+    uint32_t track_count;
+    sushi_channel_level inputs[SUSHI_SHARED_STATE_MAX_CHANNELS];
+    sushi_channel_level outputs[SUSHI_SHARED_STATE_MAX_CHANNELS];
+    sushi_track_levels tracks[SUSHI_SHARED_STATE_MAX_TRACKS];
+
+    /* Sorted by processor id and then by parameter id */
+    sushi_parameter_value parameters[SUSHI_SHARED_STATE_MAX_PARAMETERS];
+} sushi_shared_state;
+
+static inline uint32_t sushi_shared_state_read_begin(const sushi_shared_state* state)
+{
+    uint32_t sequence;
+    while ((sequence = __atomic_load_n(&state->sequence, __ATOMIC_ACQUIRE)) & 1u) {}
+    return sequence;
+}
+
+/* Returns non zero if the region was written to while reading and the values read must be discarded */
+static inline int sushi_shared_state_read_retry(const sushi_shared_state* state, uint32_t sequence)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&state->sequence, __ATOMIC_RELAXED) != sequence;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //SUSHI_SHARED_STATE_H
@@ -23,6 +23,7 @@
 
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "../../include/control_interface.h"
@@ -30,32 +31,64 @@
 namespace grpc {
     class Server;
     class ServerBuilder;
+    class ServerCompletionQueue;
 }
 
 namespace sushi_rpc {
 
 class SushiControlService;
+class SushiControlAsyncService;
+
+constexpr int DEFAULT_GRPC_THREADS = 1;
 
 class GrpcServer
 {
 public:
-    GrpcServer(const std::string& listenAddress, sushi::ext::SushiControl* controller);
+    /**
+     * @brief Create a gRPC server. Calls are served asynchronously from a fixed
+     *        number of threads, regardless of how many clients are connected.
+     * @param listenAddress Address and port to listen on
+     * @param controller The controller to forward calls to
+     * @param threads The number of threads serving calls
+     * @param cpu_cores If not empty, the server threads are only allowed to run
+     *                  on these cores, i.e. to keep them away from the audio threads
+     */
+    GrpcServer(const std::string& listenAddress,
+               sushi::ext::SushiControl* controller,
+               int threads = DEFAULT_GRPC_THREADS,
+               const std::vector<int>& cpu_cores = {});
 
     ~GrpcServer();
 
     void start();
 
+    /**
+     * @brief Check if the server threads could be restricted to the cpu cores
+     *        passed to the constructor, valid after start()
+     * @return false if setting the affinity of any server thread failed
+     */
+    bool cpu_affinity_set() const {return _cpu_affinity_set;}
+
     void stop();
 
     void waitForCompletion();
 
 private:
-
-    std::string                          _listenAddress;
-    std::unique_ptr<SushiControlService> _service;
-    std::unique_ptr<grpc::ServerBuilder> _server_builder;
-    std::unique_ptr<grpc::Server>        _server;
-    sushi::ext::SushiControl*            _controller;
+    void _worker(grpc::ServerCompletionQueue* queue);
+
+    bool _set_cpu_affinity(std::thread& thread);
+
+    std::string                                  _listenAddress;
+    std::unique_ptr<SushiControlService>         _service;
+    std::unique_ptr<SushiControlAsyncService>    _async_service;
+    std::unique_ptr<grpc::ServerBuilder>         _server_builder;
+    std::unique_ptr<grpc::Server>                _server;
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> _completion_queues;
+    std::vector<std::thread>                     _worker_threads;
+    sushi::ext::SushiControl*                    _controller;
+    int                                          _thread_count;
+    std::vector<int>                             _cpu_cores;
+    bool                                         _cpu_affinity_set{true};
 };
 
 
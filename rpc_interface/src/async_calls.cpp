@@ -0,0 +1,468 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Calls of the gRPC SushiController service, run on completion queues
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+#include <grpc++/alarm.h>
+
+#include "async_calls.h"
+#include "notification_queue.h"
+
+namespace sushi_rpc {
+
+using AsyncService = SushiController::AsyncService;
+
+/* How long an idle notification stream waits before checking if it should close,
+ * new notifications wake it up immediately */
+constexpr auto STREAM_IDLE_TIMEOUT = std::chrono::seconds(1);
+
+struct AsyncCallContext
+{
+    SushiControlAsyncService*    async_service;
+    SushiControlService*         service;
+    grpc::ServerCompletionQueue* queue;
+};
+
+/**
+ * @brief A unary call, the request is handled directly on the completion queue
+ *        thread by the matching method of SushiControlService.
+ */
+template <typename Request, typename Response>
+class UnaryCall : public CompletionTag
+{
+public:
+    using RequestFunction = void (AsyncService::*)(grpc::ServerContext*,
+                                                   Request*,
+                                                   grpc::ServerAsyncResponseWriter<Response>*,
+                                                   grpc::CompletionQueue*,
+                                                   grpc::ServerCompletionQueue*,
+                                                   void*);
+
+    using HandlerFunction = grpc::Status (SushiControlService::*)(grpc::ServerContext*, const Request*, Response*);
+
+    UnaryCall(const AsyncCallContext& context,
+              RequestFunction request_function,
+              HandlerFunction handler_function) : _call_context(context),
+                                                  _request_function(request_function),
+                                                  _handler_function(handler_function),
+                                                  _responder(&_context)
+    {
+        AsyncService* async_service = _call_context.async_service;
+        (async_service->*_request_function)(&_context, &_request, &_responder,
+                                            _call_context.queue, _call_context.queue, this);
+    }
+
+    void proceed(bool ok) override
+    {
+        if (_finished || ok == false)
+        {
+            /* Either the response is sent, or the server is shutting down */
+            delete this;
+            return;
+        }
+        if (_call_context.service->running())
+        {
+            new UnaryCall(_call_context, _request_function, _handler_function);
+        }
+        auto status = (_call_context.service->*_handler_function)(&_context, &_request, &_response);
+        _finished = true;
+        _responder.Finish(_response, status, this);
+    }
+
+private:
+    AsyncCallContext    _call_context;
+    RequestFunction     _request_function;
+    HandlerFunction     _handler_function;
+
+    grpc::ServerContext _context;
+    Request             _request;
+    Response            _response;
+    grpc::ServerAsyncResponseWriter<Response> _responder;
+    bool                _finished{false};
+};
+
+/**
+ * @brief A server streaming call that sends notifications of one type until the
+ *        client cancels the call or the service is stopped. No thread is held
+ *        while waiting, notifications are queued from the event dispatcher
+ *        thread and an alarm on the completion queue wakes up the call.
+ */
+template <typename MessageType>
+class NotificationStreamCall : public CompletionTag, public NotificationSubscriber
+{
+public:
+    using RequestFunction = void (AsyncService::*)(grpc::ServerContext*,
+                                                   NotificationFilter*,
+                                                   grpc::ServerAsyncWriter<MessageType>*,
+                                                   grpc::CompletionQueue*,
+                                                   grpc::ServerCompletionQueue*,
+                                                   void*);
+
+    NotificationStreamCall(const AsyncCallContext& context,
+                           sushi::ext::NotificationType type,
+                           RequestFunction request_function) : _call_context(context),
+                                                               _type(type),
+                                                               _request_function(request_function),
+                                                               _writer(&_context),
+                                                               _done_tag(this)
+    {
+        _context.AsyncNotifyWhenDone(&_done_tag);
+        AsyncService* async_service = _call_context.async_service;
+        (async_service->*_request_function)(&_context, &_filter, &_writer,
+                                            _call_context.queue, _call_context.queue, this);
+    }
+
+    void proceed(bool ok) override
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+        switch (_state)
+        {
+            case State::REQUESTED:
+            {
+                if (ok == false)
+                {
+                    /* The server shut down before the call was started */
+                    lock.unlock();
+                    delete this;
+                    return;
+                }
+                if (_call_context.service->running())
+                {
+                    new NotificationStreamCall(_call_context, _type, _request_function);
+                }
+                if (_filter.max_rate() < 0.0f)
+                {
+                    _finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Negative max rate"));
+                    return;
+                }
+                _set_filter();
+                /* The service lock is taken before the call lock when notifying,
+                 * so the call lock can't be held while subscribing */
+                lock.unlock();
+                bool subscribed = _call_context.service->add_subscriber(_type, this);
+                lock.lock();
+                if (subscribed == false)
+                {
+                    _finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Too many notification streams"));
+                    return;
+                }
+                _subscribed = true;
+                break;
+            }
+
+            case State::WRITING:
+                if (ok == false)
+                {
+                    /* The client has disconnected */
+                    _finish(grpc::Status::OK);
+                    return;
+                }
+                break;
+
+            case State::WAITING:
+                /* The alarm either expired or was cancelled to wake up the call */
+                break;
+
+            case State::FINISHING:
+            {
+                bool subscribed = _subscribed;
+                lock.unlock();
+                if (subscribed)
+                {
+                    _call_context.service->remove_subscriber(_type, this);
+                }
+                lock.lock();
+                _finished = true;
+                bool destroy = _done;
+                lock.unlock();
+                if (destroy)
+                {
+                    delete this;
+                }
+                return;
+            }
+        }
+        _send_next();
+    }
+
+    /* Called from the event dispatcher thread, with the subscriber lock in the service held */
+    void notify(const sushi::ext::ControlNotification* notification) override
+    {
+        if (_processors.empty() == false)
+        {
+            auto id = notification_filter_id(notification);
+            if (id.has_value() && std::binary_search(_processors.begin(), _processors.end(), id.value()) == false)
+            {
+                return;
+            }
+        }
+        MessageType message;
+        int64_t key;
+        if (to_grpc(message, key, notification) == false)
+        {
+            return;
+        }
+        if (_queue.push(message, key) || _queue.overflowed())
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _wake_up();
+        }
+    }
+
+    void close() override
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _closed = true;
+        _wake_up();
+    }
+
+private:
+    enum class State
+    {
+        REQUESTED,
+        WAITING,
+        WRITING,
+        FINISHING
+    };
+
+    /* Tags the AsyncNotifyWhenDone() operation, which completes when the call
+     * is finished or cancelled by the client */
+    class DoneTag : public CompletionTag
+    {
+    public:
+        explicit DoneTag(NotificationStreamCall* call) : _call(call) {}
+
+        void proceed(bool /*ok*/) override
+        {
+            _call->_call_done();
+        }
+
+    private:
+        NotificationStreamCall* _call;
+    };
+
+    void _call_done()
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+        _done = true;
+        _wake_up();
+        bool destroy = _finished;
+        lock.unlock();
+        if (destroy)
+        {
+            delete this;
+        }
+    }
+
+    void _set_filter()
+    {
+        for (const auto& processor : _filter.processors())
+        {
+            _processors.push_back(processor.id());
+        }
+        std::sort(_processors.begin(), _processors.end());
+        if (_filter.max_rate() > 0.0f)
+        {
+            _min_interval = std::chrono::microseconds(static_cast<int64_t>(1'000'000 / _filter.max_rate()));
+        }
+    }
+
+    /* Called with the call lock held. Writes the next queued message or sets
+     * an alarm to wake up the call later, only one of those is pending at a time */
+    void _send_next()
+    {
+        if (_done || _closed || _call_context.service->running() == false)
+        {
+            _finish(grpc::Status::OK);
+            return;
+        }
+        if (_queue.overflowed())
+        {
+            /* Notifications have been lost, so the client has to get the current state again */
+            _finish(grpc::Status(grpc::StatusCode::DATA_LOSS, "Notification queue overflowed, client is too slow"));
+            return;
+        }
+        if (_next_message < _messages.size())
+        {
+            _state = State::WRITING;
+            _writer.Write(_messages[_next_message++], this);
+            return;
+        }
+        auto now = std::chrono::system_clock::now();
+        if (now < _next_send_time)
+        {
+            /* Rate limited, notifications arriving in the meantime are coalesced in the queue */
+            _set_alarm(_next_send_time, false);
+            return;
+        }
+        if (_queue.pop_all(_messages))
+        {
+            _next_message = 0;
+            _next_send_time = now + _min_interval;
+            _state = State::WRITING;
+            _writer.Write(_messages[_next_message++], this);
+            return;
+        }
+        _set_alarm(now + STREAM_IDLE_TIMEOUT, true);
+    }
+
+    void _set_alarm(std::chrono::system_clock::time_point deadline, bool wake_on_notification)
+    {
+        _state = State::WAITING;
+        _wake_on_notification = wake_on_notification;
+        _alarm.Set(_call_context.queue, deadline, this);
+    }
+
+    /* Called with the call lock held, cancelling the alarm makes it complete immediately */
+    void _wake_up()
+    {
+        if (_state == State::WAITING && (_wake_on_notification || _done || _closed || _queue.overflowed()))
+        {
+            _wake_on_notification = false;
+            _alarm.Cancel();
+        }
+    }
+
+    void _finish(const grpc::Status& status)
+    {
+        _state = State::FINISHING;
+        _writer.Finish(status, this);
+    }
+
+    AsyncCallContext                _call_context;
+    sushi::ext::NotificationType    _type;
+    RequestFunction                 _request_function;
+
+    grpc::ServerContext             _context;
+    NotificationFilter              _filter;
+    grpc::ServerAsyncWriter<MessageType> _writer;
+    grpc::Alarm                     _alarm;
+    DoneTag                         _done_tag;
+
+    std::vector<int>                _processors;
+    std::chrono::microseconds       _min_interval{0};
+    std::chrono::system_clock::time_point _next_send_time;
+    NotificationQueue<MessageType>  _queue;
+    std::vector<MessageType>        _messages;
+    size_t                          _next_message{0};
+
+    std::mutex                      _lock;
+    State                           _state{State::REQUESTED};
+    bool                            _wake_on_notification{false};
+    bool                            _subscribed{false};
+    bool                            _closed{false};
+    bool                            _done{false};
+    bool                            _finished{false};
+};
+
+/* The request functions are members of base classes of AsyncService, so Request
+ * and Response are only deduced from the handler */
+template <typename Request, typename Response>
+void request_unary_call(const AsyncCallContext& context,
+                        typename UnaryCall<Request, Response>::RequestFunction request_function,
+                        grpc::Status (SushiControlService::*handler_function)(grpc::ServerContext*, const Request*, Response*))
+{
+    new UnaryCall<Request, Response>(context, request_function, handler_function);
+}
+
+template <typename MessageType>
+void request_stream_call(const AsyncCallContext& context,
+                         sushi::ext::NotificationType type,
+                         typename NotificationStreamCall<MessageType>::RequestFunction request_function)
+{
+    new NotificationStreamCall<MessageType>(context, type, request_function);
+}
+
+void request_async_calls(SushiControlAsyncService* async_service,
+                         SushiControlService* service,
+                         grpc::ServerCompletionQueue* queue)
+{
+    AsyncCallContext context{async_service, service, queue};
+
+    // Engine control
+    request_unary_call(context, &AsyncService::RequestGetSamplerate, &SushiControlService::GetSamplerate);
+    request_unary_call(context, &AsyncService::RequestGetPlayingMode, &SushiControlService::GetPlayingMode);
+    request_unary_call(context, &AsyncService::RequestSetPlayingMode, &SushiControlService::SetPlayingMode);
+    request_unary_call(context, &AsyncService::RequestGetSyncMode, &SushiControlService::GetSyncMode);
+    request_unary_call(context, &AsyncService::RequestSetSyncMode, &SushiControlService::SetSyncMode);
+    request_unary_call(context, &AsyncService::RequestGetTempo, &SushiControlService::GetTempo);
+    request_unary_call(context, &AsyncService::RequestSetTempo, &SushiControlService::SetTempo);
+    request_unary_call(context, &AsyncService::RequestGetTimeSignature, &SushiControlService::GetTimeSignature);
+    request_unary_call(context, &AsyncService::RequestSetTimeSignature, &SushiControlService::SetTimeSignature);
+    request_unary_call(context, &AsyncService::RequestGetTracks, &SushiControlService::GetTracks);
+    // Keyboard control
+    request_unary_call(context, &AsyncService::RequestSendNoteOn, &SushiControlService::SendNoteOn);
+    request_unary_call(context, &AsyncService::RequestSendNoteOff, &SushiControlService::SendNoteOff);
+    request_unary_call(context, &AsyncService::RequestSendNoteAftertouch, &SushiControlService::SendNoteAftertouch);
+    request_unary_call(context, &AsyncService::RequestSendAftertouch, &SushiControlService::SendAftertouch);
+    request_unary_call(context, &AsyncService::RequestSendPitchBend, &SushiControlService::SendPitchBend);
+    request_unary_call(context, &AsyncService::RequestSendModulation, &SushiControlService::SendModulation);
+    // Cpu timings
+    request_unary_call(context, &AsyncService::RequestGetEngineTimings, &SushiControlService::GetEngineTimings);
+    request_unary_call(context, &AsyncService::RequestGetTrackTimings, &SushiControlService::GetTrackTimings);
+    request_unary_call(context, &AsyncService::RequestGetProcessorTimings, &SushiControlService::GetProcessorTimings);
+    request_unary_call(context, &AsyncService::RequestResetAllTimings, &SushiControlService::ResetAllTimings);
+    request_unary_call(context, &AsyncService::RequestResetTrackTimings, &SushiControlService::ResetTrackTimings);
+    request_unary_call(context, &AsyncService::RequestResetProcessorTimings, &SushiControlService::ResetProcessorTimings);
+    // Track control
+    request_unary_call(context, &AsyncService::RequestGetTrackId, &SushiControlService::GetTrackId);
+    request_unary_call(context, &AsyncService::RequestGetTrackInfo, &SushiControlService::GetTrackInfo);
+    request_unary_call(context, &AsyncService::RequestGetTrackProcessors, &SushiControlService::GetTrackProcessors);
+    request_unary_call(context, &AsyncService::RequestGetTrackParameters, &SushiControlService::GetTrackParameters);
+    // Processor control
+    request_unary_call(context, &AsyncService::RequestGetProcessorId, &SushiControlService::GetProcessorId);
+    request_unary_call(context, &AsyncService::RequestGetProcessorInfo, &SushiControlService::GetProcessorInfo);
+    request_unary_call(context, &AsyncService::RequestGetProcessorBypassState, &SushiControlService::GetProcessorBypassState);
+    request_unary_call(context, &AsyncService::RequestSetProcessorBypassState, &SushiControlService::SetProcessorBypassState);
+    request_unary_call(context, &AsyncService::RequestGetProcessorCurrentProgram, &SushiControlService::GetProcessorCurrentProgram);
+    request_unary_call(context, &AsyncService::RequestGetProcessorCurrentProgramName, &SushiControlService::GetProcessorCurrentProgramName);
+    request_unary_call(context, &AsyncService::RequestGetProcessorProgramName, &SushiControlService::GetProcessorProgramName);
+    request_unary_call(context, &AsyncService::RequestGetProcessorPrograms, &SushiControlService::GetProcessorPrograms);
+    request_unary_call(context, &AsyncService::RequestSetProcessorProgram, &SushiControlService::SetProcessorProgram);
+    request_unary_call(context, &AsyncService::RequestGetProcessorParameters, &SushiControlService::GetProcessorParameters);
+    // Parameter control
+    request_unary_call(context, &AsyncService::RequestGetParameterId, &SushiControlService::GetParameterId);
+    request_unary_call(context, &AsyncService::RequestGetParameterInfo, &SushiControlService::GetParameterInfo);
+    request_unary_call(context, &AsyncService::RequestGetParameterValue, &SushiControlService::GetParameterValue);
+    request_unary_call(context, &AsyncService::RequestGetParameterValueNormalised, &SushiControlService::GetParameterValueNormalised);
+    request_unary_call(context, &AsyncService::RequestGetParameterValueAsString, &SushiControlService::GetParameterValueAsString);
+    request_unary_call(context, &AsyncService::RequestGetStringPropertyValue, &SushiControlService::GetStringPropertyValue);
+    request_unary_call(context, &AsyncService::RequestSetParameterValue, &SushiControlService::SetParameterValue);
+    request_unary_call(context, &AsyncService::RequestSetParameterValueNormalised, &SushiControlService::SetParameterValueNormalised);
+    request_unary_call(context, &AsyncService::RequestSetStringPropertyValue, &SushiControlService::SetStringPropertyValue);
+    request_unary_call(context, &AsyncService::RequestGetAllParameterValues, &SushiControlService::GetAllParameterValues);
+    request_unary_call(context, &AsyncService::RequestSetParameterValues, &SushiControlService::SetParameterValues);
+    request_unary_call(context, &AsyncService::RequestGetEngineSnapshot, &SushiControlService::GetEngineSnapshot);
+    // Notifications
+    request_stream_call<ParameterValue>(context, sushi::ext::NotificationType::PARAMETER_CHANGE,
+                                        &AsyncService::RequestSubscribeToParameterUpdates);
+    request_stream_call<ProcessorUpdate>(context, sushi::ext::NotificationType::PROCESSOR_UPDATE,
+                                         &AsyncService::RequestSubscribeToProcessorChanges);
+    request_stream_call<TrackUpdate>(context, sushi::ext::NotificationType::TRACK_UPDATE,
+                                     &AsyncService::RequestSubscribeToTrackChanges);
+    request_stream_call<TransportUpdate>(context, sushi::ext::NotificationType::TRANSPORT_UPDATE,
+                                         &AsyncService::RequestSubscribeToTransportChanges);
+    request_stream_call<ClipNotification>(context, sushi::ext::NotificationType::CLIPPING,
+                                          &AsyncService::RequestSubscribeToClipNotifications);
+}
+
+}// sushi_rpc
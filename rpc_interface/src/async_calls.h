@@ -0,0 +1,63 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Calls of the gRPC SushiController service, run on completion queues
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_ASYNC_CALLS_H
+#define SUSHI_ASYNC_CALLS_H
+
+#include "control_service.h"
+
+namespace sushi_rpc {
+
+/* Not nested, so that it can be forward declared */
+class SushiControlAsyncService : public SushiController::AsyncService {};
+
+/**
+ * @brief Every operation started on a completion queue is tagged with a
+ *        CompletionTag, proceed() is then called from the thread polling the
+ *        queue when the operation completes.
+ */
+class CompletionTag
+{
+public:
+    virtual ~CompletionTag() = default;
+
+    /**
+     * @brief Continue the call after an operation has completed.
+     * @param ok The ok flag returned from the completion queue.
+     */
+    virtual void proceed(bool ok) = 0;
+};
+
+/**
+ * @brief Request one call of every rpc of the service on the given completion
+ *        queue. Each call requests a new call of the same rpc when it starts
+ *        so that the queue is always ready to accept one call of each rpc.
+ *        Calls delete themselves when finished.
+ * @param async_service The service registered with the server
+ * @param service The implementation of the calls
+ * @param queue The completion queue to run the calls on
+ */
+void request_async_calls(SushiControlAsyncService* async_service,
+                         SushiControlService* service,
+                         grpc::ServerCompletionQueue* queue);
+
+}// sushi_rpc
+
+#endif //SUSHI_ASYNC_CALLS_H
@@ -18,6 +18,8 @@
  * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <algorithm>
+
 #include "control_service.h"
 
 namespace sushi_rpc {
@@ -158,6 +160,41 @@ inline void to_grpc(sushi_rpc::TrackInfo& dest, const sushi::ext::TrackInfo& src
     dest.set_processor_count(src.processor_count);
 }
 
+inline void to_grpc(sushi_rpc::ParameterState& dest, const sushi::ext::ParameterState& src)
+{
+    to_grpc(*dest.mutable_info(), src.info);
+    dest.set_value(src.value);
+}
+
+inline void to_grpc(sushi_rpc::EngineSnapshot& dest, const sushi::ext::EngineSnapshot& src)
+{
+    dest.set_samplerate(src.samplerate);
+    dest.mutable_playing_mode()->set_mode(to_grpc(src.playing_mode));
+    dest.mutable_sync_mode()->set_mode(to_grpc(src.sync_mode));
+    dest.set_tempo(src.tempo);
+    dest.mutable_time_signature()->set_numerator(src.time_signature.numerator);
+    dest.mutable_time_signature()->set_denominator(src.time_signature.denominator);
+    dest.mutable_tracks()->Reserve(static_cast<int>(src.tracks.size()));
+    for (const auto& track : src.tracks)
+    {
+        auto track_state = dest.add_tracks();
+        to_grpc(*track_state->mutable_info(), track.info);
+        for (const auto& parameter : track.parameters)
+        {
+            to_grpc(*track_state->add_parameters(), parameter);
+        }
+        for (const auto& processor : track.processors)
+        {
+            auto processor_state = track_state->add_processors();
+            to_grpc(*processor_state->mutable_info(), processor.info);
+            for (const auto& parameter : processor.parameters)
+            {
+                to_grpc(*processor_state->add_parameters(), parameter);
+            }
+        }
+    }
+}
+
 inline void to_grpc(sushi_rpc::CpuTimings& dest, const sushi::ext::CpuTimings& src)
 {
     dest.set_average(src.avg);
@@ -165,6 +202,178 @@ inline void to_grpc(sushi_rpc::CpuTimings& dest, const sushi::ext::CpuTimings& s
     dest.set_max(src.max);
 }
 
+bool to_grpc(ParameterValue& dest, int64_t& key, const sushi::ext::ControlNotification* src)
+{
+    if (src->type() != sushi::ext::NotificationType::PARAMETER_CHANGE)
+    {
+        return false;
+    }
+    auto typed_src = static_cast<const sushi::ext::ParameterChangeNotification*>(src);
+    dest.mutable_parameter()->set_processor_id(typed_src->processor_id());
+    dest.mutable_parameter()->set_parameter_id(typed_src->parameter_id());
+    dest.set_value(typed_src->value());
+    key = (static_cast<int64_t>(typed_src->processor_id()) << 32) | static_cast<uint32_t>(typed_src->parameter_id());
+    return true;
+}
+
+bool to_grpc(ProcessorUpdate& dest, int64_t& key, const sushi::ext::ControlNotification* src)
+{
+    if (src->type() != sushi::ext::NotificationType::PROCESSOR_UPDATE)
+    {
+        return false;
+    }
+    auto typed_src = static_cast<const sushi::ext::ProcessorNotification*>(src);
+    dest.set_action(typed_src->action() == sushi::ext::ProcessorAction::ADDED ? ProcessorUpdate::PROCESSOR_ADDED :
+                                                                                ProcessorUpdate::PROCESSOR_DELETED);
+    dest.mutable_processor()->set_id(typed_src->processor_id());
+    dest.mutable_parent_track()->set_id(typed_src->parent_track_id());
+    /* Changes to the audio graph must all be delivered, in order */
+    key = NO_COALESCE;
+    return true;
+}
+
+bool to_grpc(TrackUpdate& dest, int64_t& key, const sushi::ext::ControlNotification* src)
+{
+    if (src->type() != sushi::ext::NotificationType::TRACK_UPDATE)
+    {
+        return false;
+    }
+    auto typed_src = static_cast<const sushi::ext::TrackNotification*>(src);
+    dest.set_action(typed_src->action() == sushi::ext::TrackAction::ADDED ? TrackUpdate::TRACK_ADDED :
+                                                                            TrackUpdate::TRACK_DELETED);
+    dest.mutable_track()->set_id(typed_src->track_id());
+    key = NO_COALESCE;
+    return true;
+}
+
+bool to_grpc(TransportUpdate& dest, int64_t& key, const sushi::ext::ControlNotification* src)
+{
+    if (src->type() != sushi::ext::NotificationType::TRANSPORT_UPDATE)
+    {
+        return false;
+    }
+    auto typed_src = static_cast<const sushi::ext::TransportNotification*>(src);
+    switch (typed_src->action())
+    {
+        case sushi::ext::TransportAction::TEMPO_CHANGED:
+            dest.set_tempo(std::get<float>(typed_src->value()));
+            break;
+
+        case sushi::ext::TransportAction::TIME_SIGNATURE_CHANGED:
+        {
+            auto signature = std::get<sushi::ext::TimeSignature>(typed_src->value());
+            dest.mutable_time_signature()->set_numerator(signature.numerator);
+            dest.mutable_time_signature()->set_denominator(signature.denominator);
+            break;
+        }
+
+        case sushi::ext::TransportAction::PLAYING_MODE_CHANGED:
+            dest.mutable_playing_mode()->set_mode(to_grpc(std::get<sushi::ext::PlayingMode>(typed_src->value())));
+            break;
+
+        case sushi::ext::TransportAction::SYNC_MODE_CHANGED:
+            dest.mutable_sync_mode()->set_mode(to_grpc(std::get<sushi::ext::SyncMode>(typed_src->value())));
+            break;
+    }
+    key = static_cast<int64_t>(typed_src->action());
+    return true;
+}
+
+bool to_grpc(ClipNotification& dest, int64_t& key, const sushi::ext::ControlNotification* src)
+{
+    if (src->type() != sushi::ext::NotificationType::CLIPPING)
+    {
+        return false;
+    }
+    auto typed_src = static_cast<const sushi::ext::ClippingNotification*>(src);
+    bool input = typed_src->channel_type() == sushi::ext::ClippingChannelType::INPUT;
+    dest.set_channel(typed_src->channel());
+    dest.set_channel_type(input ? ClipNotification::INPUT : ClipNotification::OUTPUT);
+    key = static_cast<int64_t>(typed_src->channel()) * 2 + (input ? 0 : 1);
+    return true;
+}
+
+std::optional<int> notification_filter_id(const sushi::ext::ControlNotification* notification)
+{
+    switch (notification->type())
+    {
+        case sushi::ext::NotificationType::PARAMETER_CHANGE:
+            return static_cast<const sushi::ext::ParameterChangeNotification*>(notification)->processor_id();
+
+        case sushi::ext::NotificationType::PROCESSOR_UPDATE:
+            return static_cast<const sushi::ext::ProcessorNotification*>(notification)->processor_id();
+
+        case sushi::ext::NotificationType::TRACK_UPDATE:
+            return static_cast<const sushi::ext::TrackNotification*>(notification)->track_id();
+
+        default:
+            return std::nullopt;
+    }
+}
+
+SushiControlService::SushiControlService(sushi::ext::SushiControl* controller) : _controller{controller}
+{
+    for (int i = 0; i < NOTIFICATION_TYPES; ++i)
+    {
+        _controller->subscribe_to_notifications(static_cast<sushi::ext::NotificationType>(i), this);
+    }
+}
+
+SushiControlService::~SushiControlService()
+{
+    for (int i = 0; i < NOTIFICATION_TYPES; ++i)
+    {
+        _controller->unsubscribe_from_notifications(static_cast<sushi::ext::NotificationType>(i), this);
+    }
+}
+
+void SushiControlService::stop_all_calls()
+{
+    _running = false;
+    std::lock_guard<std::mutex> lock(_subscriber_lock);
+    for (auto& subscribers : _subscribers)
+    {
+        for (auto subscriber : subscribers)
+        {
+            subscriber->close();
+        }
+    }
+}
+
+void SushiControlService::notification(const sushi::ext::ControlNotification* notification)
+{
+    std::lock_guard<std::mutex> lock(_subscriber_lock);
+    for (auto subscriber : _subscribers[static_cast<int>(notification->type())])
+    {
+        subscriber->notify(notification);
+    }
+}
+
+bool SushiControlService::add_subscriber(sushi::ext::NotificationType type, NotificationSubscriber* subscriber)
+{
+    std::lock_guard<std::mutex> lock(_subscriber_lock);
+    /* Checked under the lock so no subscriber is added after stop_all_calls() */
+    if (_running == false || _subscriber_count >= MAX_NOTIFICATION_STREAMS)
+    {
+        return false;
+    }
+    _subscribers[static_cast<int>(type)].push_back(subscriber);
+    _subscriber_count++;
+    return true;
+}
+
+void SushiControlService::remove_subscriber(sushi::ext::NotificationType type, NotificationSubscriber* subscriber)
+{
+    std::lock_guard<std::mutex> lock(_subscriber_lock);
+    auto& subscribers = _subscribers[static_cast<int>(type)];
+    auto subscriber_iter = std::find(subscribers.begin(), subscribers.end(), subscriber);
+    if (subscriber_iter != subscribers.end())
+    {
+        subscribers.erase(subscriber_iter);
+        _subscriber_count--;
+    }
+}
+
 grpc::Status SushiControlService::GetSamplerate(grpc::ServerContext* /*context*/,
                                                 const sushi_rpc::GenericVoidValue* /*request*/,
                                                 sushi_rpc::GenericFloatValue* response)
@@ -649,4 +858,42 @@ grpc::Status SushiControlService::SetStringPropertyValue(grpc::ServerContext* /*
     return to_grpc_status(status);
 }
 
+grpc::Status SushiControlService::GetAllParameterValues(grpc::ServerContext* /*context*/,
+                                                        const sushi_rpc::GenericVoidValue* /*request*/,
+                                                        sushi_rpc::ParameterValueList* response)
+{
+    auto values = _controller->get_all_parameter_values();
+    response->mutable_values()->Reserve(static_cast<int>(values.size()));
+    for (const auto& value : values)
+    {
+        auto dest = response->add_values();
+        dest->mutable_parameter()->set_processor_id(value.processor_id);
+        dest->mutable_parameter()->set_parameter_id(value.parameter_id);
+        dest->set_value(value.value);
+    }
+    return grpc::Status::OK;
+}
+
+grpc::Status SushiControlService::SetParameterValues(grpc::ServerContext* /*context*/,
+                                                     const sushi_rpc::ParameterValueList* request,
+                                                     sushi_rpc::GenericVoidValue* /*response*/)
+{
+    std::vector<sushi::ext::ParameterValue> values;
+    values.reserve(request->values_size());
+    for (const auto& value : request->values())
+    {
+        values.push_back({value.parameter().processor_id(), value.parameter().parameter_id(), value.value()});
+    }
+    auto status = _controller->set_parameter_values(values);
+    return to_grpc_status(status);
+}
+
+grpc::Status SushiControlService::GetEngineSnapshot(grpc::ServerContext* /*context*/,
+                                                    const sushi_rpc::GenericVoidValue* /*request*/,
+                                                    sushi_rpc::EngineSnapshot* response)
+{
+    to_grpc(*response, _controller->get_engine_snapshot());
+    return grpc::Status::OK;
+}
+
 } // sushi_rpc
@@ -18,32 +18,78 @@
  * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <algorithm>
+
+#include <pthread.h>
+
 #include "sushi_rpc/grpc_server.h"
-#include "control_service.h"
+#include "async_calls.h"
 
 namespace sushi_rpc {
 
 GrpcServer::GrpcServer(const std::string& listenAddress,
-                       sushi::ext::SushiControl*controller) : _listenAddress{listenAddress},
-                                                              _service{new SushiControlService(controller)},
-                                                              _server_builder{new grpc::ServerBuilder()},
-                                                              _controller{controller}
+                       sushi::ext::SushiControl* controller,
+                       int threads,
+                       const std::vector<int>& cpu_cores) : _listenAddress{listenAddress},
+                                                            _service{new SushiControlService(controller)},
+                                                            _async_service{new SushiControlAsyncService()},
+                                                            _server_builder{new grpc::ServerBuilder()},
+                                                            _controller{controller},
+                                                            _thread_count{std::max(1, threads)},
+                                                            _cpu_cores{cpu_cores}
 {
 
 }
 
-GrpcServer::~GrpcServer() = default;
+GrpcServer::~GrpcServer()
+{
+    stop();
+}
 
 void GrpcServer::start()
 {
     _server_builder->AddListeningPort(_listenAddress, grpc::InsecureServerCredentials());
-    _server_builder->RegisterService(_service.get());
+    _server_builder->RegisterService(_async_service.get());
+    for (int i = 0; i < _thread_count; ++i)
+    {
+        _completion_queues.push_back(_server_builder->AddCompletionQueue());
+    }
     _server = _server_builder->BuildAndStart();
+    if (_server == nullptr)
+    {
+        _completion_queues.clear();
+        return;
+    }
+    for (auto& queue : _completion_queues)
+    {
+        request_async_calls(_async_service.get(), _service.get(), queue.get());
+        _worker_threads.emplace_back(&GrpcServer::_worker, this, queue.get());
+        _cpu_affinity_set = _set_cpu_affinity(_worker_threads.back()) && _cpu_affinity_set;
+    }
 }
 
 void GrpcServer::stop()
 {
-    // Maybe redundant
+    if (_server == nullptr)
+    {
+        return;
+    }
+    /* Streaming calls must end before Shutdown() can return */
+    _service->stop_all_calls();
+    _server->Shutdown();
+    /* Completion queues must be shut down after the server, the worker
+     * threads then exit when the queues are drained */
+    for (auto& queue : _completion_queues)
+    {
+        queue->Shutdown();
+    }
+    for (auto& thread : _worker_threads)
+    {
+        thread.join();
+    }
+    _worker_threads.clear();
+    _completion_queues.clear();
+    _server.reset();
 }
 
 void GrpcServer::waitForCompletion()
@@ -51,4 +97,33 @@ void GrpcServer::waitForCompletion()
     _server->Wait();
 }
 
-}// sushi_rpc
\ No newline at end of file
+bool GrpcServer::_set_cpu_affinity(std::thread& thread)
+{
+    if (_cpu_cores.empty())
+    {
+        return true;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (auto core : _cpu_cores)
+    {
+        if (core < 0 || core >= CPU_SETSIZE)
+        {
+            return false;
+        }
+        CPU_SET(core, &cpus);
+    }
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus) == 0;
+}
+
+void GrpcServer::_worker(grpc::ServerCompletionQueue* queue)
+{
+    void* tag;
+    bool ok;
+    while (queue->Next(&tag, &ok))
+    {
+        static_cast<CompletionTag*>(tag)->proceed(ok);
+    }
+}
+
+}// sushi_rpc
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Thread safe queue for passing notifications to a streaming gRPC call
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_NOTIFICATION_QUEUE_H
+#define SUSHI_NOTIFICATION_QUEUE_H
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace sushi_rpc {
+
+/* Messages pushed with this key are always queued */
+constexpr int64_t NO_COALESCE = -1;
+constexpr size_t DEFAULT_MAX_QUEUED_NOTIFICATIONS = 1000;
+
+/**
+ * @brief Notifications are pushed from the thread sending notifications and
+ *        popped in batches from the thread serving the stream. If a message is
+ *        pushed with the same key as a message already waiting in the queue, it
+ *        replaces that message, so a slow client only gets the latest value.
+ *        If a message has to be dropped because the queue is full, the queue
+ *        is marked as overflowed and drops all further messages, as the stream
+ *        is no longer complete.
+ */
+template <typename T>
+class NotificationQueue
+{
+public:
+    explicit NotificationQueue(size_t max_size = DEFAULT_MAX_QUEUED_NOTIFICATIONS) : _max_size(max_size)
+    {
+        _queue.reserve(max_size);
+    }
+
+    /**
+     * @brief Push a message to the queue.
+     * @param message The message to queue
+     * @param key Messages with the same key replace each other while queued.
+     * @return false if the queue is full or overflowed and the message was dropped
+     */
+    bool push(const T& message, int64_t key = NO_COALESCE)
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_overflowed)
+        {
+            return false;
+        }
+        if (key != NO_COALESCE)
+        {
+            auto queued = _queued_keys.find(key);
+            if (queued != _queued_keys.end())
+            {
+                _queue[queued->second] = message;
+                return true;
+            }
+        }
+        if (_queue.size() >= _max_size)
+        {
+            _overflowed = true;
+            return false;
+        }
+        if (key != NO_COALESCE)
+        {
+            _queued_keys[key] = _queue.size();
+        }
+        _queue.push_back(message);
+        return true;
+    }
+
+    /**
+     * @brief Move all queued messages to messages, without waiting.
+     * @param messages Output vector, cleared before the queued messages are added
+     * @return true if any messages were returned
+     */
+    bool pop_all(std::vector<T>& messages)
+    {
+        messages.clear();
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_queue.empty())
+        {
+            return false;
+        }
+        std::swap(messages, _queue);
+        _queued_keys.clear();
+        return true;
+    }
+
+    /**
+     * @brief Check if any message has been dropped because the queue was full
+     */
+    bool overflowed()
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        return _overflowed;
+    }
+
+private:
+    std::vector<T>                      _queue;
+    std::unordered_map<int64_t, size_t> _queued_keys;
+    size_t                              _max_size;
+    bool                                _overflowed{false};
+    std::mutex                          _lock;
+};
+
+}// sushi_rpc
+
+#endif //SUSHI_NOTIFICATION_QUEUE_H
@@ -39,6 +39,7 @@ enum class AudioFrontendStatus
     INVALID_OUTPUT_FILE,
     INVALID_SEQUENCER_DATA,
     INVALID_CHUNK_SIZE,
+    INVALID_SAMPLE_RATE,
     AUDIO_HW_ERROR
 };
 
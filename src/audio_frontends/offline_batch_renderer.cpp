@@ -0,0 +1,250 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Renders a batch of audio files through the same configuration
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "logging.h"
+#include "offline_batch_renderer.h"
+#include "offline_frontend.h"
+#include "engine/audio_engine.h"
+#include "engine/midi_dispatcher.h"
+
+namespace sushi {
+namespace audio_frontend {
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("batch render");
+
+constexpr char JOB_SEPARATOR = '\t';
+constexpr char JOB_COMMENT = '#';
+constexpr auto DEFAULT_OUTPUT_SUFFIX = "_proc.wav";
+
+jsonconfig::JsonConfigReturnStatus OfflineBatchRenderer::init()
+{
+    auto [status, document] = jsonconfig::JsonConfigurator::parse_file(_config.config_filename);
+    if (status == jsonconfig::JsonConfigReturnStatus::OK)
+    {
+        _json_data = std::move(document);
+    }
+    return status;
+}
+
+int OfflineBatchRenderer::render(const std::vector<OfflineRenderJob>& jobs)
+{
+    assert(_json_data);
+    int concurrent_jobs = _config.concurrent_jobs;
+    if (concurrent_jobs <= 0)
+    {
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        concurrent_jobs = std::max(1, cores / std::max(1, _config.rt_cpu_cores));
+    }
+    concurrent_jobs = std::min(concurrent_jobs, static_cast<int>(jobs.size()));
+    SUSHI_LOG_INFO("Rendering {} files, {} at a time", jobs.size(), concurrent_jobs);
+
+    std::atomic<int> next_job{0};
+    std::atomic<int> failed_jobs{0};
+    auto worker = [&]()
+    {
+        for (int job = next_job++; job < static_cast<int>(jobs.size()); job = next_job++)
+        {
+            if (_render_job(jobs[job]) == false)
+            {
+                failed_jobs++;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < concurrent_jobs; ++i)
+    {
+        workers.emplace_back(worker);
+    }
+    for (auto& thread : workers)
+    {
+        thread.join();
+    }
+    return failed_jobs.load();
+}
+
+std::vector<OfflineRenderJob> OfflineBatchRenderer::jobs_from_list_file(const std::string& path)
+{
+    std::vector<OfflineRenderJob> jobs;
+    std::ifstream list_file(path);
+    if (!list_file.good())
+    {
+        SUSHI_LOG_ERROR("Unable to open batch file list {}", path);
+        return jobs;
+    }
+    std::string line;
+    while (std::getline(list_file, line))
+    {
+        if (line.empty() || line.front() == JOB_COMMENT)
+        {
+            continue;
+        }
+        OfflineRenderJob job;
+        auto separator = line.find(JOB_SEPARATOR);
+        job.input_filename = line.substr(0, separator);
+        if (separator != std::string::npos && separator + 1 < line.length())
+        {
+            job.output_filename = line.substr(separator + 1);
+        }
+        else
+        {
+            job.output_filename = job.input_filename + DEFAULT_OUTPUT_SUFFIX;
+        }
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+/* Returns the canonical path of a file or directory, or an empty string if it doesn't exist */
+inline std::string real_path(const std::string& path)
+{
+    char* resolved = realpath(path.c_str(), nullptr);
+    if (resolved == nullptr)
+    {
+        return std::string();
+    }
+    std::string real(resolved);
+    free(resolved);
+    return real;
+}
+
+std::vector<OfflineRenderJob> OfflineBatchRenderer::jobs_from_directory(const std::string& input_dir,
+                                                                        const std::string& output_dir)
+{
+    std::vector<OfflineRenderJob> jobs;
+    /* The output files have the same names as the input files, so rendering to the
+     * input directory would overwrite the files being rendered */
+    auto real_input_dir = real_path(input_dir);
+    if (real_input_dir.empty() == false && real_input_dir == real_path(output_dir))
+    {
+        SUSHI_LOG_ERROR("Batch output directory {} is the same as the input directory", output_dir);
+        return jobs;
+    }
+    DIR* dir = opendir(input_dir.c_str());
+    if (dir == nullptr)
+    {
+        SUSHI_LOG_ERROR("Unable to open batch input directory {}", input_dir);
+        return jobs;
+    }
+    dirent* entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        if (entry->d_name[0] == '.')
+        {
+            continue;
+        }
+        std::string input_file = input_dir + "/" + entry->d_name;
+        bool regular_file = entry->d_type == DT_REG;
+        /* Not all file systems fill in d_type */
+        if (entry->d_type == DT_UNKNOWN)
+        {
+            struct stat file_stats;
+            regular_file = stat(input_file.c_str(), &file_stats) == 0 && S_ISREG(file_stats.st_mode);
+        }
+        if (regular_file)
+        {
+            jobs.push_back({input_file, output_dir + "/" + entry->d_name});
+        }
+    }
+    closedir(dir);
+    /* Directory order is arbitrary, sort to make logs and failures reproducible */
+    std::sort(jobs.begin(), jobs.end(), [](const auto& lhs, const auto& rhs)
+                                        {
+                                            return lhs.input_filename < rhs.input_filename;
+                                        });
+    return jobs;
+}
+
+bool OfflineBatchRenderer::_render_job(const OfflineRenderJob& job)
+{
+    SUSHI_LOG_INFO("Rendering {} to {}", job.input_filename, job.output_filename);
+    auto engine = std::make_unique<engine::AudioEngine>(_config.sample_rate, _config.rt_cpu_cores);
+    auto midi_dispatcher = std::make_unique<midi_dispatcher::MidiDispatcher>(engine.get());
+    jsonconfig::JsonConfigurator configurator(engine.get(), midi_dispatcher.get(), _json_data, _config.config_filename);
+    midi_dispatcher->set_midi_inputs(1);
+    midi_dispatcher->set_midi_outputs(1);
+
+    auto [audio_config_status, audio_config] = configurator.load_audio_config();
+    if (audio_config_status != jsonconfig::JsonConfigReturnStatus::OK)
+    {
+        SUSHI_LOG_ERROR("Error reading host config for {}", job.input_filename);
+        return false;
+    }
+    OfflineFrontendConfiguration frontend_config(job.input_filename,
+                                                 job.output_filename,
+                                                 false,
+                                                 audio_config.cv_inputs.value_or(0),
+                                                 audio_config.cv_outputs.value_or(0),
+                                                 _config.output_sample_rate,
+                                                 _config.track_parallel);
+    OfflineFrontend frontend(engine.get());
+    if (frontend.init(&frontend_config) != AudioFrontendStatus::OK)
+    {
+        SUSHI_LOG_ERROR("Error initializing offline frontend for {}", job.input_filename);
+        return false;
+    }
+
+    if (configurator.load_host_config() != jsonconfig::JsonConfigReturnStatus::OK ||
+        configurator.load_tracks() != jsonconfig::JsonConfigReturnStatus::OK)
+    {
+        SUSHI_LOG_ERROR("Failed to load tracks for {}", job.input_filename);
+        return false;
+    }
+    auto status = configurator.load_midi();
+    if (status != jsonconfig::JsonConfigReturnStatus::OK && status != jsonconfig::JsonConfigReturnStatus::NO_MIDI_DEFINITIONS)
+    {
+        SUSHI_LOG_ERROR("Failed to load MIDI mapping for {}", job.input_filename);
+        return false;
+    }
+    status = configurator.load_cv_gate();
+    if (status != jsonconfig::JsonConfigReturnStatus::OK && status != jsonconfig::JsonConfigReturnStatus::NO_CV_GATE_DEFINITIONS)
+    {
+        SUSHI_LOG_ERROR("Failed to load CV and Gate configuration for {}", job.input_filename);
+        return false;
+    }
+    auto [event_status, events] = configurator.load_event_list();
+    if (event_status == jsonconfig::JsonConfigReturnStatus::OK)
+    {
+        frontend.add_sequencer_events(events);
+    }
+    else if (event_status != jsonconfig::JsonConfigReturnStatus::NO_EVENTS_DEFINITIONS)
+    {
+        SUSHI_LOG_ERROR("Failed to load Event list for {}", job.input_filename);
+        return false;
+    }
+
+    frontend.run();
+    frontend.cleanup();
+    SUSHI_LOG_INFO("Finished rendering {}", job.output_filename);
+    return true;
+}
+
+} // end namespace audio_frontend
+} // end namespace sushi
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+ /**
+ * @brief Renders a batch of audio files through the same configuration
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ *
+ * @details Every file is rendered by its own engine and offline frontend, set up from
+ * a json config that is only read and parsed once. Several files are rendered
+ * concurrently, each from a separate thread. Plugin libraries are only loaded
+ * once by the process and shared by all engines.
+ */
+
+#ifndef SUSHI_OFFLINE_BATCH_RENDERER_H
+#define SUSHI_OFFLINE_BATCH_RENDERER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine/json_configurator.h"
+
+namespace sushi {
+
+namespace audio_frontend {
+
+struct OfflineRenderJob
+{
+    std::string input_filename;
+    std::string output_filename;
+};
+
+struct OfflineBatchConfiguration
+{
+    std::string config_filename;
+    float sample_rate;
+    /* Cores used by each engine, see --multicore-processing */
+    int rt_cpu_cores{1};
+    /* Files rendered at the same time, 0 means as many as there are free cores */
+    int concurrent_jobs{0};
+    int output_sample_rate{0};
+    bool track_parallel{false};
+};
+
+class OfflineBatchRenderer
+{
+public:
+    OfflineBatchRenderer(const OfflineBatchConfiguration& config) : _config(config) {}
+
+    /**
+     * @brief Read and parse the json config file, must be called before render()
+     * @return JsonConfigReturnStatus::OK if success, different error code otherwise.
+     */
+    jsonconfig::JsonConfigReturnStatus init();
+
+    /**
+     * @brief Render all files, blocks until all files are done.
+     * @param jobs The input and output file of each render.
+     * @return The number of files that could not be rendered.
+     */
+    int render(const std::vector<OfflineRenderJob>& jobs);
+
+    /**
+     * @brief Read a list of jobs from a text file with one job per line. The input and
+     *        output filename are separated by a tab. If there is no output filename,
+     *        the output is written to (input_file)_proc.wav. Empty lines and lines
+     *        starting with # are ignored.
+     */
+    static std::vector<OfflineRenderJob> jobs_from_list_file(const std::string& path);
+
+    /**
+     * @brief Make one job for every file in a directory, hidden files and sub directories
+     *        are ignored. The output files get the same names as the input files, so
+     *        no jobs are made if output_dir is the same directory as input_dir.
+     */
+    static std::vector<OfflineRenderJob> jobs_from_directory(const std::string& input_dir,
+                                                             const std::string& output_dir);
+
+private:
+    /* Build an engine from the config and render a single file with it */
+    bool _render_job(const OfflineRenderJob& job);
+
+    OfflineBatchConfiguration _config;
+    std::shared_ptr<const rapidjson::Document> _json_data;
+};
+
+} // end namespace audio_frontend
+} // end namespace sushi
+
+#endif //SUSHI_OFFLINE_BATCH_RENDERER_H
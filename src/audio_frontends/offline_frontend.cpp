@@ -18,9 +18,14 @@
 * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
 */
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <cstring>
 #include <random>
+#include <thread>
+
+#include <pthread.h>
 
 #include "logging.h"
 #include "offline_frontend.h"
@@ -33,6 +38,11 @@ SUSHI_GET_LOGGER_WITH_MODULE_NAME("offline audio");
 
 constexpr float INPUT_NOISE_LEVEL = powf(10, (-24.0f/20.0f)); // -24 dB input noise
 constexpr int   NOISE_SEED = 5; // Using a constant seed makes potential errors reproducible
+constexpr auto  FILE_IO_WAIT_PERIOD = std::chrono::microseconds(200);
+constexpr float BENCHMARK_SIGNAL_LEVEL = 0.5f; // -6 dB sweep
+constexpr float BENCHMARK_SWEEP_START = 20.0f;
+constexpr float BENCHMARK_SWEEP_END = 20000.0f;
+constexpr float BENCHMARK_SWEEP_SECONDS = 10.0f;
 
 template<class random_device, class random_dist>
 void fill_buffer_with_noise(ChunkSampleBuffer& buffer, random_device& dev, random_dist& dist)
@@ -56,6 +66,86 @@ void fill_cv_buffer_with_noise(engine::ControlBuffer& buffer, random_device& dev
     }
 }
 
+/* Generates the input signals for benchmarks, always from the same starting state */
+class BenchmarkSignalGenerator
+{
+public:
+    BenchmarkSignalGenerator(BenchmarkSignal signal, float sample_rate) : _signal(signal),
+                                                                          _sample_rate(sample_rate)
+    {
+        _rand_gen.seed(NOISE_SEED);
+        _sweep_end = std::min(BENCHMARK_SWEEP_END, 0.45f * sample_rate);
+    }
+
+    void fill(ChunkSampleBuffer& buffer, engine::ControlBuffer& controls)
+    {
+        switch (_signal)
+        {
+            case BenchmarkSignal::SILENCE:
+                buffer.clear();
+                break;
+
+            case BenchmarkSignal::NOISE:
+                fill_buffer_with_noise(buffer, _rand_gen, _normal_dist);
+                fill_cv_buffer_with_noise(controls, _rand_gen, _normal_dist);
+                break;
+
+            case BenchmarkSignal::SWEEP:
+            {
+                /* Exponential sweep that restarts every BENCHMARK_SWEEP_SECONDS */
+                int64_t sweep_length = static_cast<int64_t>(BENCHMARK_SWEEP_SECONDS * _sample_rate);
+                float* first_channel = buffer.channel(0);
+                for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+                {
+                    double position = static_cast<double>((_sample + i) % sweep_length) / sweep_length;
+                    double frequency = BENCHMARK_SWEEP_START * std::pow(_sweep_end / BENCHMARK_SWEEP_START, position);
+                    first_channel[i] = BENCHMARK_SIGNAL_LEVEL * static_cast<float>(std::sin(_phase));
+                    _phase = std::fmod(_phase + 2.0 * M_PI * frequency / _sample_rate, 2.0 * M_PI);
+                }
+                for (int c = 1; c < buffer.channel_count(); ++c)
+                {
+                    std::copy(first_channel, first_channel + AUDIO_CHUNK_SIZE, buffer.channel(c));
+                }
+                break;
+            }
+
+            case BenchmarkSignal::IMPULSE:
+            {
+                /* One impulse every second */
+                int64_t period = static_cast<int64_t>(_sample_rate);
+                buffer.clear();
+                int64_t offset = (period - _sample % period) % period;
+                if (offset < AUDIO_CHUNK_SIZE)
+                {
+                    for (int c = 0; c < buffer.channel_count(); ++c)
+                    {
+                        buffer.channel(c)[offset] = 1.0f;
+                    }
+                }
+                break;
+            }
+        }
+        _sample += AUDIO_CHUNK_SIZE;
+    }
+
+private:
+    BenchmarkSignal _signal;
+    float _sample_rate;
+    float _sweep_end;
+    int64_t _sample{0};
+    double _phase{0.0};
+    std::ranlux24 _rand_gen;
+    std::normal_distribution<float> _normal_dist{0.0f, INPUT_NOISE_LEVEL};
+};
+
+static bool pin_current_thread_to_core(int core)
+{
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
 AudioFrontendStatus OfflineFrontend::init(BaseAudioFrontendConfiguration* config)
 {
     auto ret_code = BaseAudioFrontend::init(config);
@@ -66,6 +156,8 @@ AudioFrontendStatus OfflineFrontend::init(BaseAudioFrontendConfiguration* config
 
     auto off_config = static_cast<OfflineFrontendConfiguration*>(_config);
     _dummy_mode = off_config->dummy_mode;
+    _benchmark = off_config->benchmark;
+    _benchmark_result.reset();
 
     if (_dummy_mode == false)
     {
@@ -77,24 +169,63 @@ AudioFrontendStatus OfflineFrontend::init(BaseAudioFrontendConfiguration* config
             SUSHI_LOG_ERROR("Unable to open input file {}", off_config->input_filename);
             return AudioFrontendStatus::INVALID_INPUT_FILE;
         }
-        _mono = _soundfile_info.channels == 1;
-        auto sample_rate_file = _soundfile_info.samplerate;
-        if (sample_rate_file != _engine->sample_rate())
+        _channels = _soundfile_info.channels;
+        if (_channels > MAX_OFFLINE_FRONTEND_CHANNELS)
         {
-            SUSHI_LOG_WARNING("Sample rate mismatch between file ({}) and engine ({})",
-                              sample_rate_file,
-                              _engine->sample_rate());
+            cleanup();
+            SUSHI_LOG_ERROR("Input file has {} channels, max is {}", _channels, MAX_OFFLINE_FRONTEND_CHANNELS);
+            return AudioFrontendStatus::INVALID_N_CHANNELS;
+        }
+        int sample_rate_file = _soundfile_info.samplerate;
+        int sample_rate_engine = static_cast<int>(_engine->sample_rate());
+        _output_sample_rate = off_config->output_sample_rate > 0 ? off_config->output_sample_rate : sample_rate_file;
+        _input_resamplers.clear();
+        _output_resamplers.clear();
+        if (dsp::PolyphaseResampler::supported(sample_rate_file, sample_rate_engine) == false ||
+            dsp::PolyphaseResampler::supported(sample_rate_engine, _output_sample_rate) == false)
+        {
+            cleanup();
+            SUSHI_LOG_ERROR("Can't convert between {} Hz, {} Hz and the engine sample rate {} Hz",
+                            sample_rate_file, _output_sample_rate, sample_rate_engine);
+            return AudioFrontendStatus::INVALID_SAMPLE_RATE;
+        }
+        if (sample_rate_file != sample_rate_engine)
+        {
+            SUSHI_LOG_INFO("Converting input from {} Hz to the engine sample rate {} Hz", sample_rate_file, sample_rate_engine);
+            for (int c = 0; c < _channels; ++c)
+            {
+                _input_resamplers.push_back(std::make_unique<dsp::PolyphaseResampler>(sample_rate_file, sample_rate_engine));
+            }
+        }
+        if (_output_sample_rate != sample_rate_engine)
+        {
+            SUSHI_LOG_INFO("Converting output from {} Hz to {} Hz", sample_rate_engine, _output_sample_rate);
+            for (int c = 0; c < _channels; ++c)
+            {
+                _output_resamplers.push_back(std::make_unique<dsp::PolyphaseResampler>(sample_rate_engine, _output_sample_rate));
+            }
         }
 
-        // Open output file with same format as input file
-        if (!(_output_file = sf_open(off_config->output_filename.c_str(), SFM_WRITE, &_soundfile_info)))
+        // Open output file with same format as input file, but possibly a different sample rate
+        SF_INFO output_info = _soundfile_info;
+        output_info.samplerate = _output_sample_rate;
+        if (!(_output_file = sf_open(off_config->output_filename.c_str(), SFM_WRITE, &output_info)))
         {
             cleanup();
             SUSHI_LOG_ERROR("Unable to open output file {}", off_config->output_filename);
             return AudioFrontendStatus::INVALID_OUTPUT_FILE;
         }
-        _engine->set_audio_input_channels(OFFLINE_FRONTEND_CHANNELS);
-        _engine->set_audio_output_channels(OFFLINE_FRONTEND_CHANNELS);
+        // Mono files are processed in stereo, of which only the left channel is written
+        int engine_channels = std::max(_channels, OFFLINE_FRONTEND_CHANNELS);
+        _buffer = ChunkSampleBuffer(engine_channels);
+        _track_parallel = off_config->track_parallel;
+        if (_track_parallel)
+        {
+            _block_in_buffers.assign(OFFLINE_IO_BLOCK_CHUNKS, ChunkSampleBuffer(engine_channels));
+            _block_out_buffers.assign(OFFLINE_IO_BLOCK_CHUNKS, ChunkSampleBuffer(engine_channels));
+        }
+        _engine->set_audio_input_channels(engine_channels);
+        _engine->set_audio_output_channels(engine_channels);
     }
     else
     {
@@ -156,7 +287,12 @@ int time_to_sample_offset(Time chunk_end_time, Time event_time, float samplerate
 
 void OfflineFrontend::run()
 {
-    if (_dummy_mode)
+    if (_dummy_mode && (_benchmark.chunks > 0 || _benchmark.seconds > 0))
+    {
+        _worker = std::thread(&OfflineFrontend::_run_benchmark, this);
+        _worker.join();
+    }
+    else if (_dummy_mode)
     {
         _worker = std::thread(&OfflineFrontend::_process_dummy, this);
     }
@@ -211,59 +347,356 @@ void OfflineFrontend::_process_dummy()
     }
 }
 
+void OfflineFrontend::_run_benchmark()
+{
+    set_flush_denormals_to_zero();
+    if (_benchmark.cpu_core >= 0 && pin_current_thread_to_core(_benchmark.cpu_core) == false)
+    {
+        SUSHI_LOG_WARNING("Failed to pin benchmark thread to cpu core {}", _benchmark.cpu_core);
+    }
+    float sample_rate = _engine->sample_rate();
+    int64_t chunks = _benchmark.chunks;
+    if (chunks == 0)
+    {
+        chunks = std::llround(_benchmark.seconds * sample_rate / AUDIO_CHUNK_SIZE);
+    }
+    int64_t samplecount = 0;
+    double usec_time = 0.0f;
+    Time start_time = std::chrono::microseconds(0);
+    BenchmarkSignalGenerator generator(_benchmark.signal, sample_rate);
+    std::chrono::steady_clock::duration processing_time(0);
+    /* Only the time spent in the engine is measured, not generating the input */
+    auto process_chunk = [&]()
+    {
+        generator.fill(_buffer, _control_buffer);
+        auto chunk_start = std::chrono::steady_clock::now();
+        _engine->update_time(start_time + std::chrono::microseconds(static_cast<uint64_t>(usec_time)), samplecount);
+        samplecount += AUDIO_CHUNK_SIZE;
+        usec_time += AUDIO_CHUNK_SIZE * 1'000'000.0 / sample_rate;
+        _process_events(start_time + std::chrono::microseconds(static_cast<uint64_t>(usec_time)));
+        _engine->process_chunk(&_buffer, &_buffer, &_control_buffer, &_control_buffer);
+        processing_time += std::chrono::steady_clock::now() - chunk_start;
+    };
+
+    for (int64_t i = 0; i < _benchmark.warmup_chunks && _running; ++i)
+    {
+        process_chunk();
+    }
+
+    /* Restart the timer so that no timings from the warm up are included */
+    auto timer = _engine->performance_timer();
+    if (timer)
+    {
+        timer->enable(false);
+        timer->clear_all_timings();
+        timer->store_records(true);
+        timer->enable(true);
+    }
+
+    SUSHI_LOG_INFO("Benchmarking {} chunks", chunks);
+    int64_t measured_chunks = 0;
+    processing_time = std::chrono::steady_clock::duration(0);
+    for (; measured_chunks < chunks && _running; ++measured_chunks)
+    {
+        process_chunk();
+    }
+    std::chrono::duration<double> elapsed = processing_time;
+
+    /* Disabling the timer processes all timings still queued */
+    if (timer)
+    {
+        timer->enable(false);
+        timer->store_records(false);
+    }
+    _benchmark_result = BenchmarkResult{measured_chunks, elapsed.count(), sample_rate};
+    SUSHI_LOG_INFO("Benchmark processed {} chunks in {} s", measured_chunks, elapsed.count());
+}
+
 void OfflineFrontend::_run_blocking()
 {
     set_flush_denormals_to_zero();
-    int readcount;
     int samplecount = 0;
     double usec_time = 0.0f;
     Time start_time = std::chrono::microseconds(0);
 
-    float file_buffer[OFFLINE_FRONTEND_CHANNELS * AUDIO_CHUNK_SIZE];
-    while ( (readcount = static_cast<int>(sf_readf_float(_input_file,
-                                                         file_buffer,
-                                                         static_cast<sf_count_t>(AUDIO_CHUNK_SIZE)))) )
+    /* File reading, writing and sample rate conversion are done in separate threads
+     * and in larger blocks, so that the processing thread only copies audio */
+    for (auto& block : _input_blocks)
     {
-        // Update time and sample counter
-        _engine->update_time(start_time + std::chrono::microseconds(static_cast<uint64_t>(usec_time)), samplecount);
+        block.samples.resize(_channels * OFFLINE_IO_BLOCK_SIZE);
+        _push_block(_free_input_blocks, &block);
+    }
+    for (auto& block : _output_blocks)
+    {
+        block.samples.resize(_channels * OFFLINE_IO_BLOCK_SIZE);
+        _push_block(_free_output_blocks, &block);
+    }
+    std::thread reader(&OfflineFrontend::_read_input, this);
+    std::thread writer(&OfflineFrontend::_write_output, this);
 
-        samplecount += readcount;
-        usec_time += readcount * 1'000'000.f / _engine->sample_rate();
+    AudioFileBlock* output = _pop_block(_free_output_blocks);
+    output->frames = 0;
+    AudioFileBlock* input = nullptr;
+    while (output && (input = _pop_block(_read_input_blocks)) && input->frames > 0)
+    {
+        /* Let the engine render the whole block at once if no events need to be sent during it */
+        Time block_end_time = start_time + std::chrono::microseconds(static_cast<uint64_t>(usec_time + input->frames * 1'000'000.0 / _engine->sample_rate()));
+        if (_track_parallel && input->frames == OFFLINE_IO_BLOCK_SIZE && output->frames == 0 &&
+            (_event_queue.empty() || _event_queue.back()->time() >= block_end_time))
+        {
+            _process_block(*input, *output, start_time + std::chrono::microseconds(static_cast<uint64_t>(usec_time)), samplecount);
+            samplecount += input->frames;
+            usec_time += input->frames * 1'000'000.f / _engine->sample_rate();
+            output->frames = input->frames;
+            _push_block(_processed_output_blocks, output);
+            if ((output = _pop_block(_free_output_blocks)))
+            {
+                output->frames = 0;
+            }
+            _push_block(_free_input_blocks, input);
+            continue;
+        }
 
-        Time chunk_end_time = start_time + std::chrono::microseconds(static_cast<uint64_t>(usec_time));
-        _process_events(chunk_end_time);
+        /* Blocks are a whole number of chunks, except the last one */
+        for (int offset = 0; offset < input->frames && output; offset += AUDIO_CHUNK_SIZE)
+        {
+            int frames = std::min(AUDIO_CHUNK_SIZE, input->frames - offset);
+            // Update time and sample counter
+            _engine->update_time(start_time + std::chrono::microseconds(static_cast<uint64_t>(usec_time)), samplecount);
+
+            samplecount += frames;
+            usec_time += frames * 1'000'000.f / _engine->sample_rate();
+
+            Time chunk_end_time = start_time + std::chrono::microseconds(static_cast<uint64_t>(usec_time));
+            _process_events(chunk_end_time);
+
+            _buffer.clear();
+            for (int c = 0; c < _channels; ++c)
+            {
+                const float* source = &input->samples[c * OFFLINE_IO_BLOCK_SIZE + offset];
+                std::copy(source, source + frames, _buffer.channel(c));
+            }
+            /* Gate and CV are ignored when using file frontend */
+            _engine->process_chunk(&_buffer, &_buffer, &_control_buffer, &_control_buffer);
+
+            for (int c = 0; c < _channels; ++c)
+            {
+                std::copy(_buffer.channel(c), _buffer.channel(c) + frames, &output->samples[c * OFFLINE_IO_BLOCK_SIZE + output->frames]);
+            }
+            output->frames += frames;
+            if (output->frames == OFFLINE_IO_BLOCK_SIZE)
+            {
+                _push_block(_processed_output_blocks, output);
+                if ((output = _pop_block(_free_output_blocks)))
+                {
+                    output->frames = 0;
+                }
+            }
+        }
+        _push_block(_free_input_blocks, input);
+    }
 
-        _buffer.clear();
+    /* Send the remaining frames, followed by an empty block to end the output */
+    if (output && output->frames > 0)
+    {
+        _push_block(_processed_output_blocks, output);
+        output = _pop_block(_free_output_blocks);
+    }
+    if (output)
+    {
+        /* The loop only ends with an output block if input is the end block, or nullptr when stopped */
+        output->frames = 0;
+        output->file_frames = input != nullptr ? input->file_frames : 0;
+        _push_block(_processed_output_blocks, output);
+    }
+    reader.join();
+    writer.join();
+}
 
-        if (_mono)
+void OfflineFrontend::_process_block(const AudioFileBlock& input, AudioFileBlock& output, Time timestamp, int64_t samples)
+{
+    for (int i = 0; i < OFFLINE_IO_BLOCK_CHUNKS; ++i)
+    {
+        auto& buffer = _block_in_buffers[i];
+        buffer.clear();
+        for (int c = 0; c < _channels; ++c)
         {
-            std::copy(file_buffer, file_buffer + AUDIO_CHUNK_SIZE, _buffer.channel(0));
+            const float* source = &input.samples[c * OFFLINE_IO_BLOCK_SIZE + i * AUDIO_CHUNK_SIZE];
+            std::copy(source, source + AUDIO_CHUNK_SIZE, buffer.channel(c));
         }
-        else
+    }
+    /* Gate and CV are ignored when using file frontend */
+    _engine->process_chunks(_block_in_buffers.data(), _block_out_buffers.data(), OFFLINE_IO_BLOCK_CHUNKS,
+                            timestamp, samples, &_control_buffer, &_control_buffer);
+    for (int i = 0; i < OFFLINE_IO_BLOCK_CHUNKS; ++i)
+    {
+        const auto& buffer = _block_out_buffers[i];
+        for (int c = 0; c < _channels; ++c)
         {
-            auto buffer = ChunkSampleBuffer::create_non_owning_buffer(_buffer, 0, 2);
-            buffer.from_interleaved(file_buffer);
+            std::copy(buffer.channel(c), buffer.channel(c) + AUDIO_CHUNK_SIZE, &output.samples[c * OFFLINE_IO_BLOCK_SIZE + i * AUDIO_CHUNK_SIZE]);
         }
-        /* Gate and CV are ignored when using file frontend */
-        _engine->process_chunk(&_buffer, &_buffer, &_control_buffer, &_control_buffer);
+    }
+}
 
-        if (_mono)
+void OfflineFrontend::_read_input()
+{
+    double ratio = static_cast<double>(_engine->sample_rate()) / _soundfile_info.samplerate;
+    std::vector<float> file_buffer(_channels * OFFLINE_IO_BLOCK_SIZE);
+    std::vector<float> channel_buffer(OFFLINE_IO_BLOCK_SIZE);
+    std::vector<std::vector<float>> converted(_channels);
+    int64_t read_frames = 0;
+    int64_t sent_frames = 0;
+    bool end_of_file = false;
+
+    while (!end_of_file)
+    {
+        auto readcount = static_cast<int>(sf_readf_float(_input_file, file_buffer.data(), OFFLINE_IO_BLOCK_SIZE));
+        if (readcount <= 0)
         {
-            std::copy(_buffer.channel(0), _buffer.channel(0) + AUDIO_CHUNK_SIZE, file_buffer );
+            /* Zeros push the remaining samples out of the filters */
+            end_of_file = true;
+            readcount = _input_resamplers.empty() ? 0 : dsp::RESAMPLER_TAPS;
+            std::fill(file_buffer.begin(), file_buffer.end(), 0.0f);
         }
         else
         {
-            auto buffer = ChunkSampleBuffer::create_non_owning_buffer(_buffer, 0, 2);
-            buffer.to_interleaved(file_buffer);
+            read_frames += readcount;
+        }
+        for (int c = 0; c < _channels; ++c)
+        {
+            auto& output = converted[c];
+            for (int i = 0; i < readcount; ++i)
+            {
+                channel_buffer[i] = file_buffer[i * _channels + c];
+            }
+            if (_input_resamplers.empty())
+            {
+                output.insert(output.end(), channel_buffer.begin(), channel_buffer.begin() + readcount);
+            }
+            else
+            {
+                auto& resampler = _input_resamplers[c];
+                size_t size = output.size();
+                output.resize(size + resampler->max_output_samples(readcount));
+                int count = resampler->process(channel_buffer.data(), readcount, output.data() + size);
+                output.resize(size + count);
+            }
         }
 
-        // Write to file
-        // Should we check the number of samples effectively written?
-        // Not done in libsndfile's example
-        sf_writef_float(_output_file, file_buffer, static_cast<sf_count_t>(readcount));
+        /* Send complete blocks, or everything up to the converted length of the file at the end */
+        int64_t available = static_cast<int64_t>(converted[0].size());
+        if (end_of_file)
+        {
+            available = std::min<int64_t>(available, std::llround(read_frames * ratio) - sent_frames);
+        }
+        int offset = 0;
+        while (available - offset >= OFFLINE_IO_BLOCK_SIZE || (end_of_file && available > offset))
+        {
+            auto block = _pop_block(_free_input_blocks);
+            if (block == nullptr)
+            {
+                return;
+            }
+            block->frames = static_cast<int>(std::min<int64_t>(OFFLINE_IO_BLOCK_SIZE, available - offset));
+            for (int c = 0; c < _channels; ++c)
+            {
+                std::copy(&converted[c][offset], &converted[c][offset] + block->frames, &block->samples[c * OFFLINE_IO_BLOCK_SIZE]);
+            }
+            _push_block(_read_input_blocks, block);
+            offset += block->frames;
+            sent_frames += block->frames;
+        }
+        for (auto& channel : converted)
+        {
+            channel.erase(channel.begin(), channel.begin() + offset);
+        }
+    }
+
+    if (auto block = _pop_block(_free_input_blocks); block != nullptr)
+    {
+        block->frames = 0;
+        block->file_frames = read_frames;
+        _push_block(_read_input_blocks, block);
+    }
+}
+
+void OfflineFrontend::_write_output()
+{
+    double ratio = _output_sample_rate / static_cast<double>(_engine->sample_rate());
+    int max_frames = OFFLINE_IO_BLOCK_SIZE;
+    if (_output_resamplers.empty() == false)
+    {
+        max_frames = _output_resamplers[0]->max_output_samples(std::max(OFFLINE_IO_BLOCK_SIZE, dsp::RESAMPLER_TAPS));
+    }
+    std::vector<float> zeros(dsp::RESAMPLER_TAPS, 0.0f);
+    std::vector<float> converted(max_frames);
+    std::vector<float> file_buffer(_channels * max_frames);
+    int64_t processed_frames = 0;
+    int64_t written_frames = 0;
+    bool end_of_output = false;
+
+    while (!end_of_output)
+    {
+        auto block = _pop_block(_processed_output_blocks);
+        if (block == nullptr)
+        {
+            return;
+        }
+        end_of_output = block->frames == 0;
+        processed_frames += block->frames;
+        int count = block->frames;
+        for (int c = 0; c < _channels; ++c)
+        {
+            const float* channel = &block->samples[c * OFFLINE_IO_BLOCK_SIZE];
+            if (_output_resamplers.empty() == false)
+            {
+                /* At the end, zeros push the remaining samples out of the filters */
+                count = end_of_output ? _output_resamplers[c]->process(zeros.data(), dsp::RESAMPLER_TAPS, converted.data()) :
+                                        _output_resamplers[c]->process(channel, block->frames, converted.data());
+                channel = converted.data();
+            }
+            for (int i = 0; i < count; ++i)
+            {
+                file_buffer[i * _channels + c] = channel[i];
+            }
+        }
+        if (_output_resamplers.empty() == false)
+        {
+            /* Don't write past the converted length of the processed audio. At the end this is
+             * rounded from the input to not round twice when both input and output are converted */
+            int64_t output_length = end_of_output ? std::llround(static_cast<double>(block->file_frames) * _output_sample_rate / _soundfile_info.samplerate) :
+                                                    std::llround(processed_frames * ratio);
+            count = static_cast<int>(std::min<int64_t>(count, output_length - written_frames));
+        }
+        if (count > 0)
+        {
+            sf_writef_float(_output_file, file_buffer.data(), static_cast<sf_count_t>(count));
+            written_frames += count;
+        }
+        _push_block(_free_output_blocks, block);
+    }
+}
+
+AudioFileBlock* OfflineFrontend::_pop_block(AudioFileBlockQueue& queue)
+{
+    AudioFileBlock* block;
+    while (queue.pop(block) == false)
+    {
+        if (!_running)
+        {
+            return nullptr;
+        }
+        std::this_thread::sleep_for(FILE_IO_WAIT_PERIOD);
     }
+    return block;
 }
 
+void OfflineFrontend::_push_block(AudioFileBlockQueue& queue, AudioFileBlock* block)
+{
+    /* Can't fail since the queues can hold all blocks */
+    [[maybe_unused]] bool pushed = queue.push(block);
+    assert(pushed);
+}
 
 }; // end namespace audio_frontend
 
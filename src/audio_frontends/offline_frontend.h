@@ -21,22 +21,57 @@
 #ifndef SUSHI_OFFLINE_FRONTEND_H
 #define SUSHI_OFFLINE_FRONTEND_H
 
+#include <array>
 #include <string>
 #include <vector>
 #include <atomic>
+#include <memory>
+#include <optional>
 #include <thread>
 
 #include <sndfile.h>
 
 #include "base_audio_frontend.h"
 #include "library/rt_event.h"
+#include "library/benchmark_report.h"
+#include "dsp_library/resampler.h"
+#include "fifo/circularfifo_memory_relaxed_aquire_release.h"
 
 namespace sushi {
 
 namespace audio_frontend {
 
 constexpr int OFFLINE_FRONTEND_CHANNELS = 2;
+constexpr int MAX_OFFLINE_FRONTEND_CHANNELS = 64;
 constexpr int DUMMY_FRONTEND_CHANNELS = 10;
+/* Frames per block read from or written to file */
+constexpr int OFFLINE_IO_BLOCK_CHUNKS = 128;
+constexpr int OFFLINE_IO_BLOCK_SIZE = OFFLINE_IO_BLOCK_CHUNKS * AUDIO_CHUNK_SIZE;
+/* Blocks in flight between each file thread and the processing thread */
+constexpr int OFFLINE_IO_BLOCKS = 4;
+constexpr int64_t BENCHMARK_DEFAULT_WARMUP_CHUNKS = 1000;
+
+/* Input signals for benchmarks, all are deterministic */
+enum class BenchmarkSignal
+{
+    SILENCE,
+    NOISE,
+    SWEEP,
+    IMPULSE
+};
+
+struct BenchmarkConfiguration
+{
+    /* Number of chunks to measure, if both this and seconds are 0 the dummy
+     * frontend runs until stopped without measuring anything */
+    int64_t chunks{0};
+    float seconds{0};
+    /* Processed before measuring, to not include the cost of cold caches and lazy initialisations */
+    int64_t warmup_chunks{BENCHMARK_DEFAULT_WARMUP_CHUNKS};
+    BenchmarkSignal signal{BenchmarkSignal::NOISE};
+    /* Pin the processing thread to this core, -1 to not pin */
+    int cpu_core{-1};
+};
 
 struct OfflineFrontendConfiguration : public BaseAudioFrontendConfiguration
 {
@@ -45,19 +80,42 @@ struct OfflineFrontendConfiguration : public BaseAudioFrontendConfiguration
                                  const std::string output_filename,
                                  bool dummy_mode,
                                  int cv_inputs,
-                                 int cv_outputs) :
+                                 int cv_outputs,
+                                 int output_sample_rate = 0,
+                                 bool track_parallel = false) :
             BaseAudioFrontendConfiguration(cv_inputs, cv_outputs),
             input_filename(input_filename),
             output_filename(output_filename),
-            dummy_mode(dummy_mode)
+            dummy_mode(dummy_mode),
+            output_sample_rate(output_sample_rate),
+            track_parallel(track_parallel)
     {}
 
     virtual ~OfflineFrontendConfiguration() = default;
     std::string input_filename;
     std::string output_filename;
     bool dummy_mode;
+    /* Sample rate of the output file, 0 means the same as the input file */
+    int output_sample_rate;
+    /* Let the engine render a block at a time, track by track, when no events are sent during it */
+    bool track_parallel;
+    /* Only used in dummy mode */
+    BenchmarkConfiguration benchmark;
+};
+
+/* A block of non-interleaved audio at the engine sample rate, passed between
+ * the file threads and the processing thread. A block with 0 frames marks the
+ * end of the file */
+struct AudioFileBlock
+{
+    std::vector<float> samples;
+    int frames{0};
+    /* Only set in the end block, the number of frames read from the input file */
+    int64_t file_frames{0};
 };
 
+using AudioFileBlockQueue = memory_relaxed_aquire_release::CircularFifo<AudioFileBlock*, OFFLINE_IO_BLOCKS>;
+
 class OfflineFrontend : public BaseAudioFrontend
 {
 public:
@@ -86,18 +144,55 @@ public:
 
     void run() override;
 
+    /**
+     * @brief Get the result of a benchmark run in dummy mode. run() returns when the
+     *        benchmark is done.
+     * @return The measured throughput, empty if no benchmark was configured
+     */
+    const std::optional<BenchmarkResult>& benchmark_result() const
+    {
+        return _benchmark_result;
+    }
+
 private:
     void _process_events(Time end_time);
     void _process_dummy();
+    void _run_benchmark();
     void _run_blocking();
+    /* Process a whole block with a single call to the engine */
+    void _process_block(const AudioFileBlock& input, AudioFileBlock& output, Time timestamp, int64_t samples);
+    /* Reads, converts and deinterleaves the input file, runs in a separate thread */
+    void _read_input();
+    /* Converts, interleaves and writes the output file, runs in a separate thread */
+    void _write_output();
+    /* Waits for a block, returns nullptr if processing was stopped */
+    AudioFileBlock* _pop_block(AudioFileBlockQueue& queue);
+    void _push_block(AudioFileBlockQueue& queue, AudioFileBlock* block);
 
     SNDFILE*            _input_file;
     SNDFILE*            _output_file;
     SF_INFO             _soundfile_info;
-    bool                _mono;
+    int                 _channels{0};
     bool                _dummy_mode;
     std::atomic_bool    _running;
     std::thread         _worker;
+    int                 _output_sample_rate{0};
+    bool                _track_parallel{false};
+    BenchmarkConfiguration _benchmark;
+    std::optional<BenchmarkResult> _benchmark_result;
+
+    /* One per file channel, empty if no conversion is needed */
+    std::vector<std::unique_ptr<dsp::PolyphaseResampler>> _input_resamplers;
+    std::vector<std::unique_ptr<dsp::PolyphaseResampler>> _output_resamplers;
+
+    std::array<AudioFileBlock, OFFLINE_IO_BLOCKS> _input_blocks;
+    std::array<AudioFileBlock, OFFLINE_IO_BLOCKS> _output_blocks;
+    AudioFileBlockQueue _free_input_blocks;
+    AudioFileBlockQueue _read_input_blocks;
+    AudioFileBlockQueue _free_output_blocks;
+    AudioFileBlockQueue _processed_output_blocks;
+    std::vector<ChunkSampleBuffer> _block_in_buffers;
+    std::vector<ChunkSampleBuffer> _block_out_buffers;
 
     SampleBuffer<AUDIO_CHUNK_SIZE> _buffer{DUMMY_FRONTEND_CHANNELS};
     engine::ControlBuffer _control_buffer;
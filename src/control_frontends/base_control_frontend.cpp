@@ -35,9 +35,9 @@ constexpr auto RETRY_INTERVAL = std::chrono::milliseconds(2);
 
 void BaseControlFrontend::send_parameter_change_event(ObjectId processor,
                                                       ObjectId parameter,
-                                                      float value)
+                                                      float value,
+                                                      Time timestamp)
 {
-    Time timestamp = IMMEDIATE_PROCESS;
     auto e = new ParameterChangeEvent(ParameterChangeEvent::Subtype::FLOAT_PARAMETER_CHANGE,
                                       processor, parameter, value, timestamp);
     _event_dispatcher->post_event(e);
@@ -45,9 +45,9 @@ void BaseControlFrontend::send_parameter_change_event(ObjectId processor,
 
 void BaseControlFrontend::send_string_parameter_change_event(ObjectId processor,
                                                              ObjectId parameter,
-                                                             const std::string& value)
+                                                             const std::string& value,
+                                                             Time timestamp)
 {
-    Time timestamp = IMMEDIATE_PROCESS;
     auto e = new StringPropertyChangeEvent(processor, parameter, value, timestamp);
     _event_dispatcher->post_event(e);}
 
@@ -56,26 +56,25 @@ void BaseControlFrontend::send_keyboard_event(ObjectId processor,
                                               KeyboardEvent::Subtype type,
                                               int channel,
                                               int note,
-                                              float velocity)
+                                              float velocity,
+                                              Time timestamp)
 {
-    Time timestamp = IMMEDIATE_PROCESS;
     auto e = new KeyboardEvent(type, processor, channel, note, velocity, timestamp);
     _event_dispatcher->post_event(e);
 }
 
-void BaseControlFrontend::send_note_on_event(ObjectId processor, int channel, int note, float velocity)
+void BaseControlFrontend::send_note_on_event(ObjectId processor, int channel, int note, float velocity, Time timestamp)
 {
-    send_keyboard_event(processor, KeyboardEvent::Subtype::NOTE_ON, channel, note, velocity);
+    send_keyboard_event(processor, KeyboardEvent::Subtype::NOTE_ON, channel, note, velocity, timestamp);
 }
 
-void BaseControlFrontend::send_note_off_event(ObjectId processor, int channel, int note, float velocity)
+void BaseControlFrontend::send_note_off_event(ObjectId processor, int channel, int note, float velocity, Time timestamp)
 {
-    send_keyboard_event(processor, KeyboardEvent::Subtype::NOTE_OFF, channel, note, velocity);
+    send_keyboard_event(processor, KeyboardEvent::Subtype::NOTE_OFF, channel, note, velocity, timestamp);
 }
 
-void BaseControlFrontend::send_program_change_event(ObjectId processor, int program)
+void BaseControlFrontend::send_program_change_event(ObjectId processor, int program, Time timestamp)
 {
-    Time timestamp = IMMEDIATE_PROCESS;
     auto e = new ProgramChangeEvent(processor, program, timestamp);
     _event_dispatcher->post_event(e);
 }
@@ -110,27 +109,27 @@ void BaseControlFrontend::send_remove_processor_event(const std::string &track,
     send_with_callback(e);
 }
 
-void BaseControlFrontend::send_set_tempo_event(float tempo)
+void BaseControlFrontend::send_set_tempo_event(float tempo, Time timestamp)
 {
-    auto e = new SetEngineTempoEvent(tempo, IMMEDIATE_PROCESS);
+    auto e = new SetEngineTempoEvent(tempo, timestamp);
     _event_dispatcher->post_event(e);
 }
 
-void BaseControlFrontend::send_set_time_signature_event(TimeSignature signature)
+void BaseControlFrontend::send_set_time_signature_event(TimeSignature signature, Time timestamp)
 {
-    auto e = new SetEngineTimeSignatureEvent(signature, IMMEDIATE_PROCESS);
+    auto e = new SetEngineTimeSignatureEvent(signature, timestamp);
     _event_dispatcher->post_event(e);
 }
 
-void BaseControlFrontend::send_set_playing_mode_event(PlayingMode mode)
+void BaseControlFrontend::send_set_playing_mode_event(PlayingMode mode, Time timestamp)
 {
-    auto e = new SetEnginePlayingModeStateEvent(mode, IMMEDIATE_PROCESS);
+    auto e = new SetEnginePlayingModeStateEvent(mode, timestamp);
     _event_dispatcher->post_event(e);
 }
 
-void BaseControlFrontend::send_set_sync_mode_event(SyncMode mode)
+void BaseControlFrontend::send_set_sync_mode_event(SyncMode mode, Time timestamp)
 {
-    auto e = new SetEngineSyncModeEvent(mode, IMMEDIATE_PROCESS);
+    auto e = new SetEngineSyncModeEvent(mode, timestamp);
     _event_dispatcher->post_event(e);
 }
 
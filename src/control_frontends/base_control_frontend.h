@@ -64,17 +64,19 @@ public:
 
     virtual void stop() = 0;
 
-    void send_parameter_change_event(ObjectId processor, ObjectId parameter, float value);
+    void send_parameter_change_event(ObjectId processor, ObjectId parameter, float value, Time timestamp = IMMEDIATE_PROCESS);
 
-    void send_string_parameter_change_event(ObjectId processor, ObjectId parameter, const std::string& value);
+    void send_string_parameter_change_event(ObjectId processor, ObjectId parameter, const std::string& value,
+                                            Time timestamp = IMMEDIATE_PROCESS);
 
-    void send_keyboard_event(ObjectId processor, KeyboardEvent::Subtype type, int channel, int note, float velocity);
+    void send_keyboard_event(ObjectId processor, KeyboardEvent::Subtype type, int channel, int note, float velocity,
+                             Time timestamp = IMMEDIATE_PROCESS);
 
-    void send_note_on_event(ObjectId processor, int channel, int note, float velocity);
+    void send_note_on_event(ObjectId processor, int channel, int note, float velocity, Time timestamp = IMMEDIATE_PROCESS);
 
-    void send_note_off_event(ObjectId processor, int channel, int note, float velocity);
+    void send_note_off_event(ObjectId processor, int channel, int note, float velocity, Time timestamp = IMMEDIATE_PROCESS);
 
-    void send_program_change_event(ObjectId processor, int program);
+    void send_program_change_event(ObjectId processor, int program, Time timestamp = IMMEDIATE_PROCESS);
 
     void send_add_track_event(const std::string &name, int channels);
 
@@ -85,13 +87,13 @@ public:
 
     void send_remove_processor_event(const std::string &track, const std::string &name);
 
-    void send_set_tempo_event(float tempo);
+    void send_set_tempo_event(float tempo, Time timestamp = IMMEDIATE_PROCESS);
 
-    void send_set_time_signature_event(TimeSignature signature);
+    void send_set_time_signature_event(TimeSignature signature, Time timestamp = IMMEDIATE_PROCESS);
 
-    void send_set_playing_mode_event(PlayingMode mode);
+    void send_set_playing_mode_event(PlayingMode mode, Time timestamp = IMMEDIATE_PROCESS);
 
-    void send_set_sync_mode_event(SyncMode mode);
+    void send_set_sync_mode_event(SyncMode mode, Time timestamp = IMMEDIATE_PROCESS);
 
     int poster_id() override {return _poster_id;}
 
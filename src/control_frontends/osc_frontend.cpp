@@ -19,6 +19,7 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <sstream>
 
 #include "osc_utils.h"
@@ -41,16 +42,39 @@ static void osc_error(int num, const char* msg, const char* path)
     }
 }
 
+/* Messages received in a bundle carry the timetag of the bundle. Timetags in
+ * the future are converted to timestamps, so that the event dispatcher can
+ * schedule the event. Everything else, and timetags further ahead than
+ * MAX_OSC_SCHEDULING_DELAY, is processed immediately. */
+static Time timestamp_from_message(void* data)
+{
+    lo_timetag timetag = lo_message_get_timestamp(static_cast<lo_message>(data));
+    lo_timetag now;
+    lo_timetag_now(&now);
+    double delay = lo_timetag_diff(timetag, now);
+    if (delay <= 0.0)
+    {
+        return IMMEDIATE_PROCESS;
+    }
+    if (delay > std::chrono::duration<double>(MAX_OSC_SCHEDULING_DELAY).count())
+    {
+        SUSHI_LOG_WARNING("Bundle timetag {} seconds ahead is too far in the future, processing it now", delay);
+        return IMMEDIATE_PROCESS;
+    }
+    return get_current_time() + std::chrono::duration_cast<Time>(std::chrono::duration<double>(delay));
+}
+
 static int osc_send_parameter_change_event(const char* /*path*/,
                                            const char* /*types*/,
                                            lo_arg** argv,
                                            int /*argc*/,
-                                           void* /*data*/,
+                                           void* data,
                                            void* user_data)
 {
     auto connection = static_cast<OscConnection*>(user_data);
     float value = argv[0]->f;
-    connection->instance->send_parameter_change_event(connection->processor, connection->parameter, value);
+    connection->instance->send_parameter_change_event(connection->processor, connection->parameter, value,
+                                                     timestamp_from_message(data));
     SUSHI_LOG_DEBUG("Sending parameter {} on processor {} change to {}.", connection->parameter, connection->processor, value);
     return 0;
 }
@@ -59,12 +83,13 @@ static int osc_send_string_parameter_change_event(const char* /*path*/,
                                                   const char* /*types*/,
                                                   lo_arg** argv,
                                                   int /*argc*/,
-                                                  void* /*data*/,
+                                                  void* data,
                                                   void* user_data)
 {
     auto connection = static_cast<OscConnection*>(user_data);
     std::string value(&argv[0]->s);
-    connection->instance->send_string_parameter_change_event(connection->processor, connection->parameter, value);
+    connection->instance->send_string_parameter_change_event(connection->processor, connection->parameter, value,
+                                                            timestamp_from_message(data));
     SUSHI_LOG_DEBUG("Sending string property {} on processor {} change to {}.", connection->parameter, connection->processor, value);
     return 0;
 }
@@ -73,25 +98,26 @@ static int osc_send_keyboard_event(const char* /*path*/,
                                    const char* /*types*/,
                                    lo_arg** argv,
                                    int /*argc*/,
-                                   void* /*data*/,
+                                   void* data,
                                    void* user_data)
 {
     auto connection = static_cast<OscConnection*>(user_data);
     std::string event(&argv[0]->s);
     int note = argv[1]->i;
     float value = argv[2]->f;
+    Time timestamp = timestamp_from_message(data);
 
     if (event == "note_on")
     {
-        connection->instance->send_note_on_event(connection->processor, 0, note, value);
+        connection->instance->send_note_on_event(connection->processor, 0, note, value, timestamp);
     }
     else if (event == "note_off")
     {
-        connection->instance->send_note_off_event(connection->processor, 0, note, value);
+        connection->instance->send_note_off_event(connection->processor, 0, note, value, timestamp);
     }
     else if (event == "program_change")
     {
-        connection->instance->send_program_change_event(connection->processor, note);
+        connection->instance->send_program_change_event(connection->processor, note, timestamp);
     }
     else
     {
@@ -106,12 +132,12 @@ static int osc_send_program_change_event(const char* /*path*/,
                                    const char* /*types*/,
                                    lo_arg** argv,
                                    int /*argc*/,
-                                   void* /*data*/,
+                                   void* data,
                                    void* user_data)
 {
     auto connection = static_cast<OscConnection*>(user_data);
     int program_id = argv[0]->i;
-    connection->instance->send_program_change_event(connection->processor, program_id);
+    connection->instance->send_program_change_event(connection->processor, program_id, timestamp_from_message(data));
     return 0;
 }
 
@@ -201,13 +227,13 @@ static int osc_set_tempo(const char* /*path*/,
                                 const char* /*types*/,
                                 lo_arg** argv,
                                 int /*argc*/,
-                                void* /*data*/,
+                                void* data,
                                 void* user_data)
 {
     auto instance = static_cast<OSCFrontend*>(user_data);
     float tempo = argv[0]->f;
     SUSHI_LOG_DEBUG("Got a set tempo request to {} bpm", tempo);
-    instance->send_set_tempo_event(tempo);
+    instance->send_set_tempo_event(tempo, timestamp_from_message(data));
     return 0;
 }
 
@@ -215,14 +241,14 @@ static int osc_set_time_signature(const char* /*path*/,
                                   const char* /*types*/,
                                   lo_arg** argv,
                                   int /*argc*/,
-                                  void* /*data*/,
+                                  void* data,
                                   void* user_data)
 {
     auto instance = static_cast<OSCFrontend*>(user_data);
     int numerator = argv[0]->i;
     int denominator = argv[1]->i;
     SUSHI_LOG_DEBUG("Got a set time signature to {}/{} request", numerator, denominator);
-    instance->send_set_time_signature_event({numerator, denominator});
+    instance->send_set_time_signature_event({numerator, denominator}, timestamp_from_message(data));
     return 0;
 }
 
@@ -230,7 +256,7 @@ static int osc_set_playing_mode(const char* /*path*/,
                                 const char* /*types*/,
                                 lo_arg** argv,
                                 int /*argc*/,
-                                void* /*data*/,
+                                void* data,
                                 void* user_data)
 {
     auto instance = static_cast<OSCFrontend*>(user_data);
@@ -251,7 +277,7 @@ static int osc_set_playing_mode(const char* /*path*/,
     }
 
     SUSHI_LOG_DEBUG("Got a set playing mode {} request", mode_str);
-    instance->send_set_playing_mode_event(mode);
+    instance->send_set_playing_mode_event(mode, timestamp_from_message(data));
     return 0;
 }
 
@@ -259,7 +285,7 @@ static int osc_set_tempo_sync_mode(const char* /*path*/,
                                    const char* /*types*/,
                                    lo_arg** argv,
                                    int /*argc*/,
-                                   void* /*data*/,
+                                   void* data,
                                    void* user_data)
 {
     auto instance = static_cast<OSCFrontend*>(user_data);
@@ -283,19 +309,68 @@ static int osc_set_tempo_sync_mode(const char* /*path*/,
         return 0;
     }
     SUSHI_LOG_DEBUG("Got a set sync mode to {} request", mode_str);
-    instance->send_set_sync_mode_event(mode);
+    instance->send_set_sync_mode_event(mode, timestamp_from_message(data));
     return 0;
 }
 
+/* liblo converts numerical arguments to the types a method was registered with,
+ * since messages are dispatched to connections here, the same is done here */
+static int call_with_converted_arguments(const OscConnection& connection, const char* path, const char* types,
+                                         lo_arg** argv, int argc, void* data)
+{
+    if (argc > MAX_OSC_ARGUMENTS || connection.types.size() != static_cast<size_t>(argc))
+    {
+        return 1;
+    }
+    std::array<lo_arg, MAX_OSC_ARGUMENTS> converted_args;
+    std::array<lo_arg*, MAX_OSC_ARGUMENTS> converted_argv;
+    for (int i = 0; i < argc; ++i)
+    {
+        auto to_type = static_cast<lo_type>(connection.types[i]);
+        auto from_type = static_cast<lo_type>(types[i]);
+        if (to_type == from_type)
+        {
+            converted_argv[i] = argv[i];
+            continue;
+        }
+        if (lo_is_numerical_type(to_type) == false || lo_is_numerical_type(from_type) == false)
+        {
+            return 1;
+        }
+        lo_coerce(to_type, &converted_args[i], from_type, argv[i]);
+        converted_argv[i] = &converted_args[i];
+    }
+    auto user_data = const_cast<OscConnection*>(&connection);
+    return connection.handler(path, connection.types.c_str(), converted_argv.data(), argc, data, user_data);
+}
+
 }; // anonymous namespace
 
 OSCFrontend::OSCFrontend(engine::BaseEngine* engine,
                          int server_port,
-                         int send_port) : BaseControlFrontend(engine, EventPosterId::OSC_FRONTEND),
-                                          _osc_server(nullptr),
-                                          _server_port(server_port),
-                                          _send_port(send_port)
-{}
+                         int send_port,
+                         float max_output_rate) : BaseControlFrontend(engine, EventPosterId::OSC_FRONTEND),
+                                                  _osc_server(nullptr),
+                                                  _server_port(server_port),
+                                                  _send_port(send_port),
+                                                  _min_output_interval(IMMEDIATE_PROCESS)
+{
+    if (max_output_rate > 0.0f)
+    {
+        _min_output_interval = std::chrono::duration_cast<Time>(std::chrono::duration<float>(1.0f / max_output_rate));
+    }
+    _path_table = std::make_shared<const OscPathTable>();
+}
+
+template <typename Function>
+bool OSCFrontend::_update_path_table(Function function)
+{
+    std::lock_guard<std::mutex> lock(_path_table_lock);
+    auto table = std::make_shared<OscPathTable>(*_path_table);
+    bool updated = function(*table);
+    std::atomic_store(&_path_table, std::shared_ptr<const OscPathTable>(std::move(table)));
+    return updated;
+}
 
 ControlFrontendStatus OSCFrontend::init()
 {
@@ -307,10 +382,15 @@ ControlFrontendStatus OSCFrontend::init()
         SUSHI_LOG_ERROR("Failed to set up OSC server, Port likely in use");
         return ControlFrontendStatus::INTERFACE_UNAVAILABLE;
     }
+    /* Bundles with future timetags are scheduled by the event dispatcher instead of being held back by liblo */
+    lo_server_enable_queue(lo_server_thread_get_server(_osc_server), 0, 1);
 
     std::stringstream send_port_stream;
     send_port_stream << _send_port;
     _osc_out_address = lo_address_new(nullptr, send_port_stream.str().c_str());
+    /* Registered first, as most incoming messages are for connections. Messages
+     * for other paths are passed on to the methods registered after it */
+    lo_server_thread_add_method(_osc_server, nullptr, nullptr, _dispatch_message, this);
     setup_engine_control();
     _event_dispatcher->subscribe_to_parameter_change_notifications(this);
     _event_dispatcher->subscribe_to_engine_notifications(this);
@@ -324,59 +404,31 @@ OSCFrontend::~OSCFrontend()
         _stop_server();
     }
     lo_server_thread_free(_osc_server);
-    lo_address_free(_osc_out_address);
     _event_dispatcher->unsubscribe_from_parameter_change_notifications(this);
     _event_dispatcher->unsubscribe_from_engine_notifications(this);
+    lo_address_free(_osc_out_address);
+    for (auto& message : _pending_messages)
+    {
+        lo_message_free(message.second);
+    }
 }
 
 bool OSCFrontend::connect_to_parameter(const std::string& processor_name,
                                        const std::string& parameter_name)
 {
-    std::string osc_path = "/parameter/";
-    auto [processor_status, processor_id] = _engine->processor_id_from_name(processor_name);
-    if (processor_status != engine::EngineReturnStatus::OK)
-    {
-        return false;
-    }
-    auto [parameter_status, parameter_id] = _engine->parameter_id_from_name(processor_name, parameter_name);
-    if (parameter_status != engine::EngineReturnStatus::OK)
+    return _update_path_table([&](OscPathTable& table)
     {
-        return false;
-    }
-    osc_path = osc_path + osc::make_safe_path(processor_name) + "/" + osc::make_safe_path(parameter_name);
-    OscConnection* connection = new OscConnection;
-    connection->processor = processor_id;
-    connection->parameter = parameter_id;
-    connection->instance = this;
-    _connections.push_back(std::unique_ptr<OscConnection>(connection));
-    lo_server_thread_add_method(_osc_server, osc_path.c_str(), "f", osc_send_parameter_change_event, connection);
-    SUSHI_LOG_INFO("Added osc callback {}", osc_path);
-    return true;
+        return _add_parameter_connection(table, processor_name, parameter_name, "f", osc_send_parameter_change_event);
+    });
 }
 
 bool OSCFrontend::connect_to_string_parameter(const std::string& processor_name,
                                               const std::string& parameter_name)
 {
-    std::string osc_path = "/parameter/";
-    auto [processor_status, processor_id] = _engine->processor_id_from_name(processor_name);
-    if (processor_status != engine::EngineReturnStatus::OK)
+    return _update_path_table([&](OscPathTable& table)
     {
-        return false;
-    }
-    auto [parameter_status, parameter_id] = _engine->parameter_id_from_name(processor_name, parameter_name);
-    if (parameter_status != engine::EngineReturnStatus::OK)
-    {
-        return false;
-    }
-    osc_path = osc_path + osc::make_safe_path(processor_name) + "/" + osc::make_safe_path(parameter_name);
-    OscConnection* connection = new OscConnection;
-    connection->processor = processor_id;
-    connection->parameter = parameter_id;
-    connection->instance = this;
-    _connections.push_back(std::unique_ptr<OscConnection>(connection));
-    lo_server_thread_add_method(_osc_server, osc_path.c_str(), "s", osc_send_string_parameter_change_event, connection);
-    SUSHI_LOG_INFO("Added osc callback {}", osc_path);
-    return true;
+        return _add_parameter_connection(table, processor_name, parameter_name, "s", osc_send_string_parameter_change_event);
+    });
 }
 
 bool OSCFrontend::connect_from_parameter(const std::string& processor_name, const std::string& parameter_name)
@@ -393,77 +445,45 @@ bool OSCFrontend::connect_from_parameter(const std::string& processor_name, cons
     }
     std::string id_string = "/parameter/" + osc::make_safe_path(processor_name) + "/" +
                                             osc::make_safe_path(parameter_name);
-    _outgoing_connections[processor_id][parameter_id] = id_string;
+    std::lock_guard<std::mutex> lock(_outputs_lock);
+    auto& output = _outgoing_connections[processor_id][parameter_id];
+    output.path = id_string;
+    output.last_sent = IMMEDIATE_PROCESS;
     SUSHI_LOG_INFO("Added osc output from parameter {}/{}", processor_name, parameter_name);
     return true;
 }
 
 bool OSCFrontend::connect_kb_to_track(const std::string& track_name)
 {
-    std::string osc_path = "/keyboard_event/";
-    auto [status, processor_id] = _engine->processor_id_from_name(track_name);
-    if (status != engine::EngineReturnStatus::OK)
+    return _update_path_table([&](OscPathTable& table)
     {
-        return false;
-    }
-    osc_path = osc_path + osc::make_safe_path(track_name);
-    OscConnection* connection = new OscConnection;
-    connection->processor = processor_id;
-    connection->parameter = 0;
-    connection->instance = this;
-    _connections.push_back(std::unique_ptr<OscConnection>(connection));
-    lo_server_thread_add_method(_osc_server, osc_path.c_str(), "sif", osc_send_keyboard_event, connection);
-    SUSHI_LOG_INFO("Added osc callback {}", osc_path);
-    return true;
+        return _add_processor_connection(table, "/keyboard_event/", track_name, "sif", osc_send_keyboard_event);
+    });
 }
 
 bool OSCFrontend::connect_to_program_change(const std::string& processor_name)
 {
-    std::string osc_path = "/program/";
-    auto [processor_status, processor_id] = _engine->processor_id_from_name(processor_name);
-    if (processor_status != engine::EngineReturnStatus::OK)
+    return _update_path_table([&](OscPathTable& table)
     {
-        return false;
-    }
-    osc_path = osc_path + osc::make_safe_path(processor_name);
-    OscConnection* connection = new OscConnection;
-    connection->processor = processor_id;
-    connection->parameter = 0;
-    connection->instance = this;
-    _connections.push_back(std::unique_ptr<OscConnection>(connection));
-    lo_server_thread_add_method(_osc_server, osc_path.c_str(), "i", osc_send_program_change_event, connection);
-    SUSHI_LOG_INFO("Added osc callback {}", osc_path);
-    return true;
+        return _add_processor_connection(table, "/program/", processor_name, "i", osc_send_program_change_event);
+    });
 }
 
 void OSCFrontend::connect_all()
 {
-    auto& processors = _engine->all_processors();
-    for (auto& processor : processors)
+    _connect_new_processors = true;
+    _update_path_table([&](OscPathTable& table)
     {
-        auto parameters = processor.second->all_parameters();
-        for (auto& param : parameters)
+        for (auto& processor : _engine->all_processors())
         {
-            if (param->type() == ParameterType::FLOAT || param->type() == ParameterType::INT || param->type() == ParameterType::BOOL)
-            {
-                connect_to_parameter(processor.second->name(), param->name());
-                connect_from_parameter(processor.second->name(), param->name());
-            }
-            if (param->type() == ParameterType::STRING)
-            {
-                connect_to_string_parameter(processor.second->name(), param->name());
-            }
+            _connect_processor(table, processor.second.get());
         }
-        if (processor.second->supports_programs())
+        for (auto& track : _engine->all_tracks())
         {
-            connect_to_program_change(processor.second->name());
+            _add_processor_connection(table, "/keyboard_event/", track->name(), "sif", osc_send_keyboard_event);
         }
-    }
-    auto& tracks = _engine->all_tracks();
-    for (auto& track : tracks)
-    {
-        connect_kb_to_track(track->name());
-    }
+        return true;
+    });
 }
 
 void OSCFrontend::_start_server()
@@ -499,37 +519,245 @@ void OSCFrontend::setup_engine_control()
     lo_server_thread_add_method(_osc_server, "/engine/set_sync_mode", "s", osc_set_tempo_sync_mode, this);
 }
 
+int OSCFrontend::_dispatch_message(const char* path, const char* types, lo_arg** argv, int argc, void* data, void* user_data)
+{
+    auto instance = static_cast<OSCFrontend*>(user_data);
+    auto table = std::atomic_load(&instance->_path_table);
+    auto entry = table->find(path);
+    if (entry == table->end())
+    {
+        /* Not handled, liblo tries the remaining methods */
+        return 1;
+    }
+    auto& connection = *entry->second;
+    if (connection.types == types)
+    {
+        return connection.handler(path, types, argv, argc, data, &connection);
+    }
+    return call_with_converted_arguments(connection, path, types, argv, argc, data);
+}
+
+bool OSCFrontend::_add_parameter_connection(OscPathTable& table,
+                                            const std::string& processor_name,
+                                            const std::string& parameter_name,
+                                            const char* types,
+                                            lo_method_handler handler)
+{
+    auto [processor_status, processor_id] = _engine->processor_id_from_name(processor_name);
+    if (processor_status != engine::EngineReturnStatus::OK)
+    {
+        return false;
+    }
+    auto [parameter_status, parameter_id] = _engine->parameter_id_from_name(processor_name, parameter_name);
+    if (parameter_status != engine::EngineReturnStatus::OK)
+    {
+        return false;
+    }
+    auto connection = std::make_shared<OscConnection>();
+    connection->processor = processor_id;
+    connection->parameter = parameter_id;
+    connection->instance = this;
+    connection->path = "/parameter/" + osc::make_safe_path(processor_name) + "/" + osc::make_safe_path(parameter_name);
+    connection->types = types;
+    connection->handler = handler;
+    /* Erased first, as the key of an existing entry points to the path of the connection it replaces */
+    table.erase(connection->path);
+    table.emplace(connection->path, connection);
+    SUSHI_LOG_INFO("Added osc callback {}", connection->path);
+    return true;
+}
+
+bool OSCFrontend::_add_processor_connection(OscPathTable& table,
+                                            const std::string& path_prefix,
+                                            const std::string& processor_name,
+                                            const char* types,
+                                            lo_method_handler handler)
+{
+    auto [status, processor_id] = _engine->processor_id_from_name(processor_name);
+    if (status != engine::EngineReturnStatus::OK)
+    {
+        return false;
+    }
+    auto connection = std::make_shared<OscConnection>();
+    connection->processor = processor_id;
+    connection->parameter = 0;
+    connection->instance = this;
+    connection->path = path_prefix + osc::make_safe_path(processor_name);
+    connection->types = types;
+    connection->handler = handler;
+    table.erase(connection->path);
+    table.emplace(connection->path, connection);
+    SUSHI_LOG_INFO("Added osc callback {}", connection->path);
+    return true;
+}
+
+void OSCFrontend::_connect_processor(OscPathTable& table, const Processor* processor)
+{
+    for (auto& param : processor->all_parameters())
+    {
+        if (param->type() == ParameterType::FLOAT || param->type() == ParameterType::INT || param->type() == ParameterType::BOOL)
+        {
+            _add_parameter_connection(table, processor->name(), param->name(), "f", osc_send_parameter_change_event);
+            connect_from_parameter(processor->name(), param->name());
+        }
+        if (param->type() == ParameterType::STRING)
+        {
+            _add_parameter_connection(table, processor->name(), param->name(), "s", osc_send_string_parameter_change_event);
+        }
+    }
+    if (processor->supports_programs())
+    {
+        _add_processor_connection(table, "/program/", processor->name(), "i", osc_send_program_change_event);
+    }
+}
+
+void OSCFrontend::_handle_audio_graph_notification(AudioGraphNotificationEvent* event)
+{
+    switch (event->action())
+    {
+        case AudioGraphNotificationEvent::Action::PROCESSOR_ADDED:
+        case AudioGraphNotificationEvent::Action::TRACK_ADDED:
+        {
+            auto processor = _engine->processor(event->processor());
+            if (_connect_new_processors && processor != nullptr)
+            {
+                bool is_track = event->action() == AudioGraphNotificationEvent::Action::TRACK_ADDED;
+                _update_path_table([&](OscPathTable& table)
+                {
+                    _connect_processor(table, processor);
+                    if (is_track)
+                    {
+                        _add_processor_connection(table, "/keyboard_event/", processor->name(), "sif", osc_send_keyboard_event);
+                    }
+                    return true;
+                });
+            }
+            break;
+        }
+
+        case AudioGraphNotificationEvent::Action::PROCESSOR_DELETED:
+        case AudioGraphNotificationEvent::Action::TRACK_DELETED:
+            _remove_processor_connections(event->processor());
+            break;
+    }
+}
+
+void OSCFrontend::_remove_processor_connections(ObjectId processor_id)
+{
+    _update_path_table([&](OscPathTable& table)
+    {
+        for (auto i = table.begin(); i != table.end();)
+        {
+            i = i->second->processor == processor_id ? table.erase(i) : std::next(i);
+        }
+        return true;
+    });
+    std::lock_guard<std::mutex> lock(_outputs_lock);
+    auto outputs = _outgoing_connections.find(processor_id);
+    if (outputs != _outgoing_connections.end())
+    {
+        /* Pending outputs point into the entries about to be removed */
+        const auto& removed = outputs->second;
+        _pending_outputs.erase(std::remove_if(_pending_outputs.begin(), _pending_outputs.end(), [&](const OscOutput* output)
+        {
+            return std::any_of(removed.begin(), removed.end(), [&](const auto& entry) {return &entry.second == output;});
+        }), _pending_outputs.end());
+        _outgoing_connections.erase(outputs);
+    }
+}
+
 int OSCFrontend::process(Event* event)
 {
     if (event->is_parameter_change_notification())
     {
         auto typed_event = static_cast<ParameterChangeNotificationEvent*>(event);
+        std::lock_guard<std::mutex> lock(_outputs_lock);
         const auto& node = _outgoing_connections.find(typed_event->processor_id());
         if (node != _outgoing_connections.end())
         {
             const auto& param_node = node->second.find(typed_event->parameter_id());
             if (param_node != node->second.end())
             {
-                lo_send(_osc_out_address, param_node->second.c_str(), "f", typed_event->float_value());
-                SUSHI_LOG_DEBUG("Sending parameter change from processor: {}, parameter: {}, value: {}", typed_event->processor_id(), typed_event->parameter_id(), typed_event->float_value());
+                /* Only the latest value is kept until the output is sent */
+                auto& output = param_node->second;
+                output.value = typed_event->float_value();
+                if (output.pending == false)
+                {
+                    output.pending = true;
+                    _pending_outputs.push_back(&output);
+                }
+                SUSHI_LOG_DEBUG("Queued parameter change from processor: {}, parameter: {}, value: {}", typed_event->processor_id(), typed_event->parameter_id(), typed_event->float_value());
             }
         }
         return EventStatus::HANDLED_OK;
     }
-    if (event->is_engine_notification())
+    if (event->is_engine_notification() && static_cast<EngineNotificationEvent*>(event)->is_audio_graph_notification())
+    {
+        _handle_audio_graph_notification(static_cast<AudioGraphNotificationEvent*>(event));
+        return EventStatus::HANDLED_OK;
+    }
+    if (event->is_engine_notification() && static_cast<EngineNotificationEvent*>(event)->is_clipping_notification())
     {
-        // TODO - Currently the only engine notification event so direct casting works
         auto typed_event = static_cast<ClippingNotificationEvent*>(event);
-        if (typed_event->channel_type() == ClippingNotificationEvent::ClipChannelType::INPUT)
+        const char* path = typed_event->channel_type() == ClippingNotificationEvent::ClipChannelType::INPUT ?
+                           "/engine/input_clip_notification" : "/engine/output_clip_notification";
+        lo_message message = lo_message_new();
+        lo_message_add_int32(message, typed_event->channel());
+        _pending_messages.emplace_back(path, message);
+    }
+    return EventStatus::NOT_HANDLED;
+}
+
+void OSCFrontend::notification_cycle_done()
+{
+    std::lock_guard<std::mutex> lock(_outputs_lock);
+    if (_pending_outputs.empty() && _pending_messages.empty())
+    {
+        return;
+    }
+    lo_bundle bundle = lo_bundle_new(LO_TT_IMMEDIATE);
+    int bundle_size = 0;
+    auto add_to_bundle = [&](const char* path, lo_message message)
+    {
+        lo_bundle_add_message(bundle, path, message);
+        if (++bundle_size >= MAX_MESSAGES_PER_BUNDLE)
         {
-            lo_send(_osc_out_address, "/engine/input_clip_notification", "i", typed_event->channel());
+            lo_send_bundle(_osc_out_address, bundle);
+            lo_bundle_free_recursive(bundle);
+            bundle = lo_bundle_new(LO_TT_IMMEDIATE);
+            bundle_size = 0;
         }
-        else if (typed_event->channel_type() == ClippingNotificationEvent::ClipChannelType::OUTPUT)
+    };
+
+    for (auto& message : _pending_messages)
+    {
+        add_to_bundle(message.first, message.second);
+    }
+    _pending_messages.clear();
+
+    /* Outputs that were sent too recently stay pending until a later cycle */
+    Time now = get_current_time();
+    size_t still_pending = 0;
+    for (auto output : _pending_outputs)
+    {
+        if (now - output->last_sent < _min_output_interval)
         {
-            lo_send(_osc_out_address, "/engine/output_clip_notification", "i", typed_event->channel());
+            _pending_outputs[still_pending++] = output;
+            continue;
         }
+        lo_message message = lo_message_new();
+        lo_message_add_float(message, output->value);
+        add_to_bundle(output->path.c_str(), message);
+        output->last_sent = now;
+        output->pending = false;
     }
-    return EventStatus::NOT_HANDLED;
+    _pending_outputs.resize(still_pending);
+
+    if (bundle_size > 0)
+    {
+        lo_send_bundle(_osc_out_address, bundle);
+    }
+    lo_bundle_free_recursive(bundle);
 }
 
 void OSCFrontend::_completion_callback(Event* event, int return_status)
@@ -25,8 +25,14 @@
 #ifndef SUSHI_OSC_FRONTEND_H_H
 #define SUSHI_OSC_FRONTEND_H_H
 
+#include <chrono>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 
 #include "lo/lo.h"
 
@@ -35,18 +41,58 @@
 namespace sushi {
 namespace control_frontend {
 
+/* Default maximum rate of messages sent on each outgoing osc path, in Hz */
+constexpr float DEFAULT_OSC_MAX_OUTPUT_RATE = 50.0f;
+
+/* Outgoing messages are split into several bundles to stay well below the udp packet size */
+constexpr int MAX_MESSAGES_PER_BUNDLE = 100;
+
+/* Incoming messages with more arguments than this are not converted to the argument types of a connection */
+constexpr int MAX_OSC_ARGUMENTS = 8;
+
+/* Incoming bundles with timetags further ahead than this are not scheduled */
+constexpr auto MAX_OSC_SCHEDULING_DELAY = std::chrono::seconds(10);
+
 class OSCFrontend;
 struct OscConnection
 {
     ObjectId processor;
     ObjectId parameter;
     OSCFrontend* instance;
+    std::string path;
+    std::string types;
+    lo_method_handler handler;
+};
+
+/* Maps incoming osc paths to connections. A table is never modified once it is
+ * in use, the keys point to the paths of the connections held by the table */
+using OscPathTable = std::unordered_map<std::string_view, std::shared_ptr<OscConnection>>;
+
+/* Changes of an outgoing parameter are coalesced here until they can be sent */
+struct OscOutput
+{
+    std::string path;
+    float       value;
+    Time        last_sent;
+    bool        pending;
 };
 
 class OSCFrontend : public BaseControlFrontend
 {
 public:
-    OSCFrontend(engine::BaseEngine* engine, int server_port, int send_port);
+    /**
+     * @brief Create an OSC frontend
+     * @param engine The engine to control
+     * @param server_port Port to receive osc messages on
+     * @param send_port Port to send osc messages to
+     * @param max_output_rate Maximum rate in Hz that messages are sent with on each
+     *        outgoing path, only the latest value is sent if a parameter changes
+     *        faster. 0 disables the limit.
+     */
+    OSCFrontend(engine::BaseEngine* engine,
+                int server_port,
+                int send_port,
+                float max_output_rate = DEFAULT_OSC_MAX_OUTPUT_RATE);
 
     ~OSCFrontend();
 
@@ -109,6 +155,8 @@ public:
     /* Inherited from EventPoster */
     int process(Event* event) override;
 
+    void notification_cycle_done() override;
+
     int poster_id() override {return EventPosterId::OSC_FRONTEND;}
 
 private:
@@ -120,16 +168,54 @@ private:
 
     void setup_engine_control();
 
+    /* The only method registered with liblo for connections, looks up the path in the path table */
+    static int _dispatch_message(const char* path, const char* types, lo_arg** argv, int argc, void* data, void* user_data);
+
+    /* Copies the path table, lets function modify the copy and replaces the table with it */
+    template <typename Function>
+    bool _update_path_table(Function function);
+
+    bool _add_parameter_connection(OscPathTable& table,
+                                   const std::string& processor_name,
+                                   const std::string& parameter_name,
+                                   const char* types,
+                                   lo_method_handler handler);
+
+    bool _add_processor_connection(OscPathTable& table,
+                                   const std::string& path_prefix,
+                                   const std::string& processor_name,
+                                   const char* types,
+                                   lo_method_handler handler);
+
+    void _connect_processor(OscPathTable& table, const Processor* processor);
+
+    void _handle_audio_graph_notification(AudioGraphNotificationEvent* event);
+
+    void _remove_processor_connections(ObjectId processor_id);
+
     lo_server_thread _osc_server;
     int _server_port;
     int _send_port;
     lo_address _osc_out_address;
+    Time _min_output_interval;
 
     std::atomic_bool _running;
 
-    /* Currently only stored here so they can be deleted */
-    std::vector<std::unique_ptr<OscConnection>> _connections;
-    std::map<ObjectId, std::map<ObjectId, std::string>> _outgoing_connections;
+    /* Read from the osc server thread, replaced as a whole when connections change */
+    std::shared_ptr<const OscPathTable> _path_table;
+    std::mutex _path_table_lock;
+    /* Set by connect_all(), processors added later are then connected too */
+    std::atomic_bool _connect_new_processors{false};
+
+    /* Outputs are added from both the control and the event dispatcher thread, and
+     * _pending_outputs points into them, so both are guarded by _outputs_lock */
+    std::mutex _outputs_lock;
+    std::map<ObjectId, std::map<ObjectId, OscOutput>> _outgoing_connections;
+    /* Sent as bundles at the end of every event dispatcher cycle */
+    std::vector<OscOutput*> _pending_outputs;
+
+    /* Accessed only from the event dispatcher thread */
+    std::vector<std::pair<const char*, lo_message>> _pending_messages;
 };
 
 }; // namespace control_frontend
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Uniformly partitioned FFT convolution
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+
+#include "convolver.h"
+
+namespace dsp {
+
+UniformConvolver::UniformConvolver(int block_size, const float* impulse_response, int length) :
+        _block_size(block_size),
+        _partitions(std::max(1, (length + block_size - 1) / block_size)),
+        _bins(block_size + 1),
+        _fft(2 * block_size),
+        _ir_real(_partitions * _bins),
+        _ir_imag(_partitions * _bins),
+        _input_real(_partitions * _bins),
+        _input_imag(_partitions * _bins),
+        _input_buffer(2 * block_size),
+        _output_buffer(2 * block_size),
+        _sum_real(_bins),
+        _sum_imag(_bins)
+{
+    /* Each partition is zero padded to the fft size */
+    float scale = 1.0f / _fft.size();
+    std::vector<float> padded(_fft.size());
+    for (int p = 0; p < _partitions; ++p)
+    {
+        std::fill(padded.begin(), padded.end(), 0.0f);
+        int start = p * block_size;
+        int samples = std::max(0, std::min(block_size, length - start));
+        for (int i = 0; i < samples; ++i)
+        {
+            padded[i] = impulse_response[start + i] * scale;
+        }
+        _fft.forward(padded.data(), &_ir_real[p * _bins], &_ir_imag[p * _bins]);
+    }
+}
+
+void UniformConvolver::reset()
+{
+    std::fill(_input_real.begin(), _input_real.end(), 0.0f);
+    std::fill(_input_imag.begin(), _input_imag.end(), 0.0f);
+    std::fill(_input_buffer.begin(), _input_buffer.end(), 0.0f);
+    _current_partition = 0;
+}
+
+void UniformConvolver::process(const float* input, float* output)
+{
+    /* Overlap-save, the fft input is the previous block followed by the current */
+    std::copy(_input_buffer.begin() + _block_size, _input_buffer.end(), _input_buffer.begin());
+    std::copy(input, input + _block_size, _input_buffer.begin() + _block_size);
+
+    _current_partition = _current_partition == 0 ? _partitions - 1 : _current_partition - 1;
+    _fft.forward(_input_buffer.data(), &_input_real[_current_partition * _bins], &_input_imag[_current_partition * _bins]);
+
+    /* Multiply accumulate the spectrum of each delayed input block with the
+     * matching impulse response partition */
+    std::fill(_sum_real.begin(), _sum_real.end(), 0.0f);
+    std::fill(_sum_imag.begin(), _sum_imag.end(), 0.0f);
+    float* sum_re = _sum_real.data();
+    float* sum_im = _sum_imag.data();
+    for (int p = 0; p < _partitions; ++p)
+    {
+        int delayed = (_current_partition + p) % _partitions;
+        const float* x_re = &_input_real[delayed * _bins];
+        const float* x_im = &_input_imag[delayed * _bins];
+        const float* h_re = &_ir_real[p * _bins];
+        const float* h_im = &_ir_imag[p * _bins];
+        for (int k = 0; k < _bins; ++k)
+        {
+            sum_re[k] += x_re[k] * h_re[k] - x_im[k] * h_im[k];
+            sum_im[k] += x_re[k] * h_im[k] + x_im[k] * h_re[k];
+        }
+    }
+
+    _fft.inverse(sum_re, sum_im, _output_buffer.data());
+    /* The first half is the circular wrap-around and is discarded */
+    std::copy(_output_buffer.begin() + _block_size, _output_buffer.end(), output);
+}
+
+} // namespace dsp
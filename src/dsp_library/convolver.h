@@ -0,0 +1,84 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Uniformly partitioned FFT convolution
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ *
+ * The impulse response is split into partitions of the block size, each
+ * convolved in the frequency domain with a delayed input spectrum using
+ * overlap-save. Each call to process() returns the output of the block that
+ * was passed in, so there is no latency when the block size is the audio
+ * chunk size.
+ */
+
+#ifndef SUSHI_CONVOLVER_H
+#define SUSHI_CONVOLVER_H
+
+#include <vector>
+
+#include "fft.h"
+
+namespace dsp {
+
+class UniformConvolver
+{
+public:
+    /**
+     * @brief Create a convolver for a part of an impulse response. Not rt safe.
+     * @param block_size The number of samples processed in each call to process(),
+     *        must be a power of 2
+     * @param impulse_response The impulse response samples
+     * @param length The number of samples in impulse_response
+     */
+    UniformConvolver(int block_size, const float* impulse_response, int length);
+
+    int block_size() const {return _block_size;}
+
+    /**
+     * @brief Clear all processing state
+     */
+    void reset();
+
+    /**
+     * @brief Convolve a block of samples, rt safe.
+     * @param input block_size() input samples
+     * @param output block_size() output samples, overwritten
+     */
+    void process(const float* input, float* output);
+
+private:
+    int _block_size;
+    int _partitions;
+    int _bins;
+    RealFft _fft;
+
+    /* Spectra of the impulse response partitions, already normalised for the inverse fft */
+    std::vector<float> _ir_real;
+    std::vector<float> _ir_imag;
+    /* Spectra of the most recent input blocks, used as a ring buffer */
+    std::vector<float> _input_real;
+    std::vector<float> _input_imag;
+    int _current_partition{0};
+
+    std::vector<float> _input_buffer;
+    std::vector<float> _output_buffer;
+    std::vector<float> _sum_real;
+    std::vector<float> _sum_imag;
+};
+
+} // namespace dsp
+
+#endif //SUSHI_CONVOLVER_H
@@ -21,6 +21,9 @@
 #ifndef SUSHI_ENVELOPES_H
 #define SUSHI_ENVELOPES_H
 
+#include <algorithm>
+#include <cmath>
+
 #include "library/constants.h"
 
 namespace dsp {
@@ -125,6 +128,74 @@ public:
         return _current_level;
     }
 
+    /**
+     * @brief Render the envelope for a number of samples into a buffer. Equivalent
+     *        to calling tick(1) for every sample but the envelope is rendered in
+     *        linear segments and state changes are only handled between segments.
+     * @param output Destination buffer, must hold at least samples values.
+     * @param samples The number of samples to render.
+     */
+    void render(float* output, int samples)
+    {
+        int pos = 0;
+        while (pos < samples)
+        {
+            int remaining = samples - pos;
+            switch (_state)
+            {
+                case EnvelopeState::OFF:
+                case EnvelopeState::SUSTAIN:
+                    std::fill(output + pos, output + samples, _current_level);
+                    pos = samples;
+                    break;
+
+                case EnvelopeState::ATTACK:
+                {
+                    int length = _segment_length(1.0f - _current_level, _attack_factor, remaining);
+                    pos += _render_segment(output + pos, length, _attack_factor, remaining);
+                    if (length <= remaining)
+                    {
+                        _state = EnvelopeState::DECAY;
+                        _current_level = 1.0f;
+                        output[pos - 1] = _current_level;
+                    }
+                    break;
+                }
+
+                case EnvelopeState::DECAY:
+                {
+                    int length = _segment_length(_current_level - _sustain_level, _decay_factor, remaining);
+                    pos += _render_segment(output + pos, length, -_decay_factor, remaining);
+                    if (length <= remaining)
+                    {
+                        _state = EnvelopeState::SUSTAIN;
+                        _current_level = _sustain_level;
+                        output[pos - 1] = _current_level;
+                    }
+                    break;
+                }
+
+                case EnvelopeState::RELEASE:
+                {
+                    /* The release phase ends when the level goes below 0, not when it reaches it */
+                    int length = remaining + 1;
+                    if (_release_factor > 0.0f && _current_level < _release_factor * remaining)
+                    {
+                        length = static_cast<int>(_current_level / _release_factor) + 1;
+                    }
+                    pos += _render_segment(output + pos, length, -_release_factor, remaining);
+                    if (length <= remaining)
+                    {
+                        _state = EnvelopeState::OFF;
+                        _current_level = 0.0f;
+                        output[pos - 1] = _current_level;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
     /**
      * @brief Get the envelopes current level without advancing it.
      * @return The current envelope level.
@@ -174,6 +245,41 @@ public:
     }
 
 private:
+    /**
+     * @brief Calculate the number of samples until a segment reaches its end point,
+     *        the last sample is the one where the level reaches or passes the end.
+     * @return The segment length in samples, or remaining + 1 if the segment does
+     *         not end within remaining samples.
+     */
+    static int _segment_length(float distance, float slope, int remaining)
+    {
+        if (distance <= 0.0f)
+        {
+            return 1;
+        }
+        if (slope <= 0.0f || distance > slope * remaining)
+        {
+            return remaining + 1;
+        }
+        return std::max(1, static_cast<int>(std::ceil(distance / slope)));
+    }
+
+    /**
+     * @brief Render a linear segment without branches, the loop can be vectorised.
+     * @return The number of samples rendered.
+     */
+    int _render_segment(float* output, int length, float slope, int remaining)
+    {
+        int samples = std::min(length, remaining);
+        float start = _current_level;
+        for (int i = 0; i < samples; ++i)
+        {
+            output[i] = start + (i + 1) * slope;
+        }
+        _current_level = start + samples * slope;
+        return samples;
+    }
+
     float _attack_factor{0};
     float _decay_factor{0};
     float _sustain_level{1};
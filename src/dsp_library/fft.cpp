@@ -0,0 +1,166 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Real valued FFT
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <cassert>
+#include <utility>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "fft.h"
+
+namespace dsp {
+
+RealFft::RealFft(int size) : _size(size),
+                             _half_size(size / 2),
+                             _bit_reverse(size / 2),
+                             _real_cos(size / 2 + 1),
+                             _real_sin(size / 2 + 1),
+                             _work_real(size / 2),
+                             _work_imag(size / 2)
+{
+    assert(size >= 4 && (size & (size - 1)) == 0);
+    int bits = 0;
+    while ((1 << bits) < _half_size)
+    {
+        bits++;
+    }
+    for (int i = 0; i < _half_size; ++i)
+    {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b)
+        {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        _bit_reverse[i] = reversed;
+    }
+    for (int length = 2; length <= _half_size; length *= 2)
+    {
+        for (int j = 0; j < length / 2; ++j)
+        {
+            double angle = 2.0 * M_PI * j / length;
+            _stage_cos.push_back(static_cast<float>(std::cos(angle)));
+            _stage_sin.push_back(static_cast<float>(std::sin(angle)));
+        }
+    }
+    for (int k = 0; k <= _half_size; ++k)
+    {
+        double angle = 2.0 * M_PI * k / _size;
+        _real_cos[k] = static_cast<float>(std::cos(angle));
+        _real_sin[k] = static_cast<float>(std::sin(angle));
+    }
+}
+
+void RealFft::forward(const float* input, float* real, float* imag)
+{
+    /* Even samples in the real part and odd samples in the imaginary part */
+    for (int i = 0; i < _half_size; ++i)
+    {
+        _work_real[_bit_reverse[i]] = input[2 * i];
+        _work_imag[_bit_reverse[i]] = input[2 * i + 1];
+    }
+    _complex_fft(false);
+
+    /* Separate the spectra of the even and odd samples and combine them into
+     * the spectrum of the full signal, X[k] = E[k] + W^k * O[k] */
+    for (int k = 0; k <= _half_size; ++k)
+    {
+        int k1 = k == _half_size ? 0 : k;
+        int k2 = k == 0 ? 0 : _half_size - k;
+        float a_re = _work_real[k1];
+        float a_im = _work_imag[k1];
+        float b_re = _work_real[k2];
+        float b_im = -_work_imag[k2];
+        float even_re = 0.5f * (a_re + b_re);
+        float even_im = 0.5f * (a_im + b_im);
+        float odd_re = 0.5f * (a_im - b_im);
+        float odd_im = -0.5f * (a_re - b_re);
+        float c = _real_cos[k];
+        float s = _real_sin[k];
+        real[k] = even_re + c * odd_re + s * odd_im;
+        imag[k] = even_im + c * odd_im - s * odd_re;
+    }
+}
+
+void RealFft::inverse(const float* real, const float* imag, float* output)
+{
+    /* The reverse of the last step in forward(), scaled by 2 */
+    for (int k = 0; k < _half_size; ++k)
+    {
+        float x_re = real[k];
+        float x_im = imag[k];
+        float y_re = real[_half_size - k];
+        float y_im = -imag[_half_size - k];
+        float even_re = x_re + y_re;
+        float even_im = x_im + y_im;
+        float diff_re = x_re - y_re;
+        float diff_im = x_im - y_im;
+        float c = _real_cos[k];
+        float s = _real_sin[k];
+        float odd_re = diff_re * c - diff_im * s;
+        float odd_im = diff_re * s + diff_im * c;
+        int index = _bit_reverse[k];
+        _work_real[index] = even_re - odd_im;
+        _work_imag[index] = even_im + odd_re;
+    }
+    _complex_fft(true);
+
+    for (int i = 0; i < _half_size; ++i)
+    {
+        output[2 * i] = _work_real[i];
+        output[2 * i + 1] = _work_imag[i];
+    }
+}
+
+void RealFft::_complex_fft(bool inverse)
+{
+    float* re = _work_real.data();
+    float* im = _work_imag.data();
+    const float* stage_cos = _stage_cos.data();
+    const float* stage_sin = _stage_sin.data();
+    float sign = inverse ? 1.0f : -1.0f;
+    for (int length = 2; length <= _half_size; length *= 2)
+    {
+        int half = length / 2;
+        for (int i = 0; i < _half_size; i += length)
+        {
+            float* re_1 = re + i;
+            float* im_1 = im + i;
+            float* re_2 = re + i + half;
+            float* im_2 = im + i + half;
+            /* Independent iterations over contiguous data, suitable for vectorisation */
+            for (int j = 0; j < half; ++j)
+            {
+                float w_re = stage_cos[j];
+                float w_im = sign * stage_sin[j];
+                float t_re = re_2[j] * w_re - im_2[j] * w_im;
+                float t_im = re_2[j] * w_im + im_2[j] * w_re;
+                re_2[j] = re_1[j] - t_re;
+                im_2[j] = im_1[j] - t_im;
+                re_1[j] += t_re;
+                im_1[j] += t_im;
+            }
+        }
+        stage_cos += half;
+        stage_sin += half;
+    }
+}
+
+} // namespace dsp
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Real valued FFT
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ *
+ * Radix 2 FFT of real signals, computed as a complex FFT of half the size.
+ * Complex data is kept in split format, with real and imaginary parts in
+ * separate arrays, so that the butterfly loops can be vectorised by the
+ * compiler.
+ */
+
+#ifndef SUSHI_FFT_H
+#define SUSHI_FFT_H
+
+#include <vector>
+
+namespace dsp {
+
+class RealFft
+{
+public:
+    /**
+     * @brief Create an FFT of a given size
+     * @param size The number of real samples, must be a power of 2 and at least 4
+     */
+    explicit RealFft(int size);
+
+    int size() const {return _size;}
+
+    /**
+     * @brief The number of complex bins in a spectrum, size() / 2 + 1
+     */
+    int bins() const {return _size / 2 + 1;}
+
+    /**
+     * @brief Calculate the spectrum of a real signal. Not thread safe as internal
+     *        scratch buffers are used, use one instance per thread.
+     * @param input size() samples
+     * @param real Real part of the spectrum, bins() values
+     * @param imag Imaginary part of the spectrum, bins() values
+     */
+    void forward(const float* input, float* real, float* imag);
+
+    /**
+     * @brief Calculate a real signal from its spectrum. The output is not
+     *        normalised, i.e. it is scaled by size() compared to the input of
+     *        forward().
+     * @param real Real part of the spectrum, bins() values
+     * @param imag Imaginary part of the spectrum, bins() values
+     * @param output size() samples
+     */
+    void inverse(const float* real, const float* imag, float* output);
+
+private:
+    void _complex_fft(bool inverse);
+
+    int _size;
+    int _half_size;
+    std::vector<int> _bit_reverse;
+    /* Twiddle factors of all butterfly stages, stored one stage after another */
+    std::vector<float> _stage_cos;
+    std::vector<float> _stage_sin;
+    /* Twiddle factors used to split the half size complex spectrum */
+    std::vector<float> _real_cos;
+    std::vector<float> _real_sin;
+    std::vector<float> _work_real;
+    std::vector<float> _work_imag;
+};
+
+} // namespace dsp
+
+#endif //SUSHI_FFT_H
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Table based approximations of exponential and logarithmic functions
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ *
+ * The functions split the argument into an integer exponent, which is handled
+ * exactly, and a fractional part that is looked up in a small table with linear
+ * interpolation. Relative errors are in the order of 1e-6, and powers of 2, i.e.
+ * unity gain, are reproduced exactly.
+ */
+
+#ifndef SUSHI_LOOKUP_TABLES_H
+#define SUSHI_LOOKUP_TABLES_H
+
+#include <array>
+#include <cmath>
+
+namespace dsp {
+namespace lookup {
+
+constexpr int TABLE_SIZE = 256;
+
+/* One extra point for interpolation at the end of the range and one guard
+ * point for arguments that round up to the end of the range */
+using Table = std::array<float, TABLE_SIZE + 2>;
+
+/**
+ * @brief Table of 2^x for x in [0, 1]. The table is created on the first call,
+ *        so call once from a non-rt thread before using it from the rt thread.
+ */
+inline const Table& exp2_table()
+{
+    static const Table table = []()
+    {
+        Table t;
+        for (int i = 0; i <= TABLE_SIZE; ++i)
+        {
+            t[i] = static_cast<float>(std::exp2(static_cast<double>(i) / TABLE_SIZE));
+        }
+        t[TABLE_SIZE + 1] = t[TABLE_SIZE];
+        return t;
+    }();
+    return table;
+}
+
+/**
+ * @brief Table of log2(x) for x in [0.5, 1]. The table is created on the first call,
+ *        so call once from a non-rt thread before using it from the rt thread.
+ */
+inline const Table& log2_table()
+{
+    static const Table table = []()
+    {
+        Table t;
+        for (int i = 0; i <= TABLE_SIZE; ++i)
+        {
+            t[i] = static_cast<float>(std::log2(0.5 + 0.5 * static_cast<double>(i) / TABLE_SIZE));
+        }
+        t[TABLE_SIZE + 1] = t[TABLE_SIZE];
+        return t;
+    }();
+    return table;
+}
+
+inline float interpolate(const Table& table, float position)
+{
+    int index = static_cast<int>(position);
+    float fraction = position - index;
+    return table[index] + fraction * (table[index + 1] - table[index]);
+}
+
+/**
+ * @brief Table based approximation of 2^x
+ */
+inline float exp2(float x)
+{
+    float whole = std::floor(x);
+    float mantissa = interpolate(exp2_table(), (x - whole) * TABLE_SIZE);
+    return std::ldexp(mantissa, static_cast<int>(whole));
+}
+
+/**
+ * @brief Table based approximation of log2(x), x must be larger than 0
+ */
+inline float log2(float x)
+{
+    int exponent;
+    float mantissa = std::frexp(x, &exponent);
+    return exponent + interpolate(log2_table(), (mantissa - 0.5f) * (2 * TABLE_SIZE));
+}
+
+} // end namespace lookup
+} // end namespace dsp
+
+#endif //SUSHI_LOOKUP_TABLES_H
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Polyphase sample rate converter
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <numeric>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "resampler.h"
+
+namespace dsp {
+
+/* Zeroth order modified bessel function of the first kind, for the kaiser window */
+static double bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; ++k)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1.0e-12)
+        {
+            break;
+        }
+    }
+    return sum;
+}
+
+PolyphaseResampler::PolyphaseResampler(int input_rate, int output_rate)
+{
+    static_assert(RESAMPLER_TAPS % 4 == 0);
+    assert(supported(input_rate, output_rate));
+    int divisor = std::gcd(input_rate, output_rate);
+    _up = output_rate / divisor;
+    _down = input_rate / divisor;
+
+    /* Windowed sinc prototype filter at the upsampled rate. The center is put
+     * on a whole sample so that the delay can be compensated for exactly,
+     * which leaves the last coefficient at 0.
+     * The cutoff of a windowed sinc is its -6 dB point in the middle of the
+     * transition band, so it is placed half the transition width, estimated
+     * with Kaiser's formula, below the lower nyquist frequency. That puts the
+     * stopband edge at nyquist and nothing above it is aliased. */
+    int length = RESAMPLER_TAPS * _up;
+    double transition = (RESAMPLER_ATTENUATION - 7.95) / (14.36 * (length - 1));
+    double nyquist = 0.5 * std::min(input_rate, output_rate) / (static_cast<double>(input_rate) * _up);
+    double cutoff = nyquist - 0.5 * transition;
+    double center = (length - 1) / 2;
+    double window_norm = bessel_i0(RESAMPLER_KAISER_BETA);
+    std::vector<double> prototype(length);
+    double sum = 0.0;
+    for (int i = 0; i < length; ++i)
+    {
+        double t = i - center;
+        double sinc = t == 0.0 ? 2.0 * cutoff : std::sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+        double x = t / (center + 1.0);
+        double window = std::abs(x) < 1.0 ? bessel_i0(RESAMPLER_KAISER_BETA * std::sqrt(1.0 - x * x)) / window_norm : 0.0;
+        prototype[i] = sinc * window;
+        sum += prototype[i];
+    }
+
+    /* Split into phases, normalised so that the gain at dc is 1 after
+     * compensating for the inserted zeros */
+    _coefficients.resize(length);
+    for (int phase = 0; phase < _up; ++phase)
+    {
+        for (int tap = 0; tap < RESAMPLER_TAPS; ++tap)
+        {
+            double value = prototype[tap * _up + phase] * _up / sum;
+            _coefficients[phase * RESAMPLER_TAPS + RESAMPLER_TAPS - 1 - tap] = static_cast<float>(value);
+        }
+    }
+    reset();
+}
+
+bool PolyphaseResampler::supported(int input_rate, int output_rate)
+{
+    if (input_rate <= 0 || output_rate <= 0)
+    {
+        return false;
+    }
+    return output_rate / std::gcd(input_rate, output_rate) <= RESAMPLER_MAX_PHASES;
+}
+
+int PolyphaseResampler::max_output_samples(int input_samples) const
+{
+    return static_cast<int>(static_cast<int64_t>(input_samples) * _up / _down) + 2;
+}
+
+int PolyphaseResampler::process(const float* input, int samples, float* output)
+{
+    constexpr int HISTORY = RESAMPLER_TAPS - 1;
+    if (static_cast<int>(_buffer.size()) < HISTORY + samples)
+    {
+        _buffer.resize(HISTORY + samples, 0.0f);
+    }
+    std::copy(input, input + samples, _buffer.begin() + HISTORY);
+
+    int output_samples = 0;
+    const float* buffer = _buffer.data();
+    while (_input_index < samples)
+    {
+        /* The window ends at the current input sample. 4 independent sums let
+         * the compiler vectorise the loop without reordering operations */
+        const float* coeffs = &_coefficients[_phase * RESAMPLER_TAPS];
+        const float* data = buffer + _input_index;
+        float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < RESAMPLER_TAPS; i += 4)
+        {
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                sum[lane] += coeffs[i + lane] * data[i + lane];
+            }
+        }
+        output[output_samples++] = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+
+        _phase += _down;
+        _input_index += _phase / _up;
+        _phase %= _up;
+    }
+    _input_index -= samples;
+    std::copy(_buffer.begin() + samples, _buffer.begin() + samples + HISTORY, _buffer.begin());
+    return output_samples;
+}
+
+void PolyphaseResampler::reset()
+{
+    std::fill(_buffer.begin(), _buffer.end(), 0.0f);
+    /* Start at the center of the filter to compensate for its delay */
+    int delay = (RESAMPLER_TAPS * _up - 1) / 2;
+    _input_index = delay / _up;
+    _phase = delay % _up;
+    if (_buffer.size() < RESAMPLER_TAPS - 1)
+    {
+        _buffer.resize(RESAMPLER_TAPS - 1, 0.0f);
+    }
+}
+
+} // namespace dsp
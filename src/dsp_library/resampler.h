@@ -0,0 +1,98 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Polyphase sample rate converter
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ *
+ * Converts between two integer sample rates by a rational factor up / down.
+ * Conceptually the signal is upsampled by inserting up - 1 zeros between each
+ * sample, lowpass filtered and then decimated by down. Only the filter phase
+ * needed for each output sample is evaluated, which makes the cost
+ * proportional to the number of output samples.
+ */
+
+#ifndef SUSHI_RESAMPLER_H
+#define SUSHI_RESAMPLER_H
+
+#include <vector>
+
+namespace dsp {
+
+/* Filter taps per phase, must be a multiple of 4. Sets the width of the
+ * transition band, which is around 5.7 / RESAMPLER_TAPS of the input rate */
+constexpr int RESAMPLER_TAPS = 64;
+/* Stopband attenuation in dB and the kaiser window beta that gives it */
+constexpr double RESAMPLER_ATTENUATION = 90.0;
+constexpr double RESAMPLER_KAISER_BETA = 9.0;
+/* Limits the filter to RESAMPLER_TAPS * RESAMPLER_MAX_PHASES coefficients.
+ * Enough for conversions between all common rates, i.e. 11025 to 48000 Hz
+ * needs 640 phases. Pairs of rates with a small common divisor need more. */
+constexpr int RESAMPLER_MAX_PHASES = 1024;
+
+class PolyphaseResampler
+{
+public:
+    /**
+     * @brief Create a resampler for a single channel. Not rt safe.
+     * @param input_rate The sample rate of the input in Hz
+     * @param output_rate The sample rate of the output in Hz, the pair of rates
+     *        must be supported()
+     */
+    PolyphaseResampler(int input_rate, int output_rate);
+
+    /**
+     * @brief Whether converting between the two rates needs at most
+     *        RESAMPLER_MAX_PHASES filter phases
+     */
+    static bool supported(int input_rate, int output_rate);
+
+    /**
+     * @brief The largest number of samples process() can output for a given input
+     */
+    int max_output_samples(int input_samples) const;
+
+    /**
+     * @brief Convert a block of samples. The delay of the filter is compensated
+     *        for, so the output is aligned with the input, but the last
+     *        RESAMPLER_TAPS / 2 input samples are only output once more input, or
+     *        zeros at the end of the signal, has been passed.
+     *        Allocates memory if the block is larger than any previous block.
+     * @param input Input samples
+     * @param samples The number of input samples
+     * @param output Output buffer, must fit max_output_samples(samples) samples
+     * @return The number of samples written to output
+     */
+    int process(const float* input, int samples, float* output);
+
+    /**
+     * @brief Clear all processing state
+     */
+    void reset();
+
+private:
+    int _up;
+    int _down;
+    /* Coefficients for each phase, in reverse order */
+    std::vector<float> _coefficients;
+    /* The last RESAMPLER_TAPS - 1 input samples followed by the current block */
+    std::vector<float> _buffer;
+    int _phase{0};
+    int _input_index{0};
+};
+
+} // namespace dsp
+
+#endif //SUSHI_RESAMPLER_H
@@ -21,10 +21,37 @@
 #ifndef SUSHI_AUDIO_SAMPLE_H
 #define SUSHI_AUDIO_SAMPLE_H
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace dsp {
 
+enum class InterpolationMode
+{
+    LINEAR,
+    CUBIC
+};
+
+/**
+ * @brief Linear interpolation between 2 sample points.
+ */
+inline float linear_interpolation(float x0, float x1, float weight)
+{
+    return x0 + weight * (x1 - x0);
+}
+
+/**
+ * @brief 4 point, 3rd order Hermite (Catmull-Rom) interpolation between x0 and x1.
+ */
+inline float cubic_interpolation(float xm1, float x0, float x1, float x2, float weight)
+{
+    float c1 = 0.5f * (x1 - xm1);
+    float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+    float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+    return ((c3 * weight + c2) * weight + c1) * weight + x0;
+}
+
 /**
  * @brief Class to wrap a mono audio sample into a prettier interface
  */
@@ -65,7 +92,118 @@ public:
         return (sample_high * weight + sample_low * (1.0f - weight));
     }
 
+    /**
+     * @brief Return the value at sample position. Does 4 point cubic (Catmull-Rom)
+     *        interpolation.
+     * @param position The position in the sample buffer.
+     * @return A cubic interpolated sample value.
+     */
+    float cubic_at(double position) const
+    {
+        assert(position >= 0);
+        assert(_data);
+
+        int sample_pos = static_cast<int>(position);
+        float weight = position - sample_pos;
+        return cubic_interpolation(value(sample_pos - 1), value(sample_pos),
+                                   value(sample_pos + 1), value(sample_pos + 2), weight);
+    }
+
+    /**
+     * @brief Render a block of samples and add them to an output buffer. The bulk of
+     *        the block is rendered without bounds checking and in a form the compiler
+     *        can vectorise, only positions close to the start or end of the sample
+     *        data are checked.
+     * @param output The buffer to add the rendered samples to.
+     * @param gain Gain to apply, one value per rendered sample.
+     * @param position The sample position of the first rendered sample.
+     * @param speed The increment in sample position per rendered sample, must be > 0.
+     * @param samples The number of samples to render.
+     * @param mode The type of interpolation to use.
+     * @return The sample position following the last rendered sample.
+     */
+    double render(float* output, const float* gain, double position, double speed,
+                  int samples, InterpolationMode mode) const
+    {
+        assert(position >= 0);
+        assert(speed > 0);
+        assert(_data);
+
+        /* Points needed before and after the current position, plus a guard sample
+         * to stay on the safe side of rounding errors in the position calculation */
+        int points_before = mode == InterpolationMode::CUBIC ? 1 : 0;
+        int points_after = mode == InterpolationMode::CUBIC ? 3 : 2;
+
+        int first = std::min(samples, _samples_until(position, points_before, speed));
+        int last = std::clamp(_samples_until(position, _length - points_after, speed), first, samples);
+
+        for (int i = 0; i < first; ++i)
+        {
+            output[i] += gain[i] * _checked_at(position + i * speed, mode);
+        }
+        if (mode == InterpolationMode::CUBIC)
+        {
+            for (int i = first; i < last; ++i)
+            {
+                double pos = position + i * speed;
+                int sample_pos = static_cast<int>(pos);
+                float weight = pos - sample_pos;
+                output[i] += gain[i] * cubic_interpolation(_data[sample_pos - 1], _data[sample_pos],
+                                                           _data[sample_pos + 1], _data[sample_pos + 2], weight);
+            }
+        }
+        else
+        {
+            for (int i = first; i < last; ++i)
+            {
+                double pos = position + i * speed;
+                int sample_pos = static_cast<int>(pos);
+                float weight = pos - sample_pos;
+                output[i] += gain[i] * linear_interpolation(_data[sample_pos], _data[sample_pos + 1], weight);
+            }
+        }
+        for (int i = last; i < samples; ++i)
+        {
+            output[i] += gain[i] * _checked_at(position + i * speed, mode);
+        }
+        return position + samples * speed;
+    }
+
+    /**
+     * @brief Return the value at an index in the sample data.
+     * @param index The index of the sample.
+     * @return The sample value, or 0 if index is outside of the sample data.
+     */
+    float value(int index) const
+    {
+        return (index >= 0 && index < _length) ? _data[index] : 0.0f;
+    }
+
+    /**
+     * @return The number of samples in the data.
+     */
+    int length() const
+    {
+        return _length;
+    }
+
 private:
+    float _checked_at(double position, InterpolationMode mode) const
+    {
+        return mode == InterpolationMode::CUBIC ? cubic_at(position) : at(position);
+    }
+
+    /* Number of steps of size speed from position until reaching limit, or 0 if
+     * already past it */
+    static int _samples_until(double position, double limit, double speed)
+    {
+        if (position >= limit)
+        {
+            return 0;
+        }
+        return static_cast<int>(std::min(std::ceil((limit - position) / speed), static_cast<double>(std::numeric_limits<int>::max())));
+    }
+
     const float* _data{nullptr};
     int _length{0};
 };
@@ -21,6 +21,7 @@
 #ifndef SUSHI_VALUE_SMOOTHER_H
 #define SUSHI_VALUE_SMOOTHER_H
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <cassert>
@@ -119,6 +120,69 @@ public:
         }
     }
 
+    /**
+     * @brief Advance the smoother a number of sample points and write all intermediate
+     *        values to output. Equivalent to, but cheaper than, calling next_value()
+     *        for every sample.
+     * @param output Destination buffer, must hold at least samples values
+     * @param samples The number of sample points to advance
+     */
+    void next_values(T* output, int samples)
+    {
+        if constexpr (mode == Mode::RAMP)
+        {
+            assert(_spec.steps >= 0);
+            int ramp_samples = std::min(_spec.count, samples);
+            T start = _current_value;
+            T step = _spec.step;
+            /* Calculated from the start value rather than accumulated so the loop can be vectorised */
+            for (int i = 0; i < ramp_samples; ++i)
+            {
+                output[i] = start + (i + 1) * step;
+            }
+            _spec.count -= ramp_samples;
+            if (_spec.count == 0)
+            {
+                _current_value = _target_value;
+                std::fill(output + ramp_samples, output + samples, _target_value);
+            }
+            else
+            {
+                _current_value = start + ramp_samples * step;
+            }
+        }
+        else
+        {
+            assert(_spec.coeff != 0);
+            /* The filter response is calculated in closed form, target + delta * coeff^n,
+             * in FILTER_LANES interleaved lanes so that the loop can be vectorised */
+            T delta[FILTER_LANES];
+            T lane_delta = _current_value - _target_value;
+            for (auto& d : delta)
+            {
+                lane_delta *= _spec.coeff;
+                d = lane_delta;
+            }
+            int i = 0;
+            for (; i + FILTER_LANES <= samples; i += FILTER_LANES)
+            {
+                for (int lane = 0; lane < FILTER_LANES; ++lane)
+                {
+                    output[i + lane] = _target_value + delta[lane];
+                    delta[lane] *= _spec.lane_coeff;
+                }
+            }
+            for (int lane = 0; i < samples; ++i, ++lane)
+            {
+                output[i] = _target_value + delta[lane];
+            }
+            if (samples > 0)
+            {
+                _current_value = output[samples - 1];
+            }
+        }
+    }
+
     /**
      * @brief Test whether the smoother has reached the target value.
      * @return true if the value has reached the target value, false otherwise
@@ -155,8 +219,11 @@ private:
     struct FilterSpecific
     {
         T   coeff{0};
+        T   lane_coeff{0};
     };
 
+    static constexpr int FILTER_LANES = 4;
+
     static constexpr T TIMECONSTANTS_RISE_TIME = 2.19;
     static constexpr T STATIONARY_LIMIT = 0.001;
     static_assert(mode == Mode::RAMP || mode == Mode::FILTER);
@@ -166,6 +233,7 @@ private:
         if constexpr (mode == Mode::FILTER)
         {
             _spec.coeff = std::exp(-1.0 * TIMECONSTANTS_RISE_TIME / (lag_time.count() * sample_rate));
+            _spec.lane_coeff = std::pow(_spec.coeff, FILTER_LANES);
         }
         else
         {
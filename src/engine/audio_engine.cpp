@@ -37,6 +37,7 @@
 #include "plugins/step_sequencer_plugin.h"
 #include "plugins/cv_to_control_plugin.h"
 #include "plugins/control_to_cv_plugin.h"
+#include "plugins/convolution_plugin.h"
 #include "library/vst2x_wrapper.h"
 #include "library/vst3x_wrapper.h"
 
@@ -87,13 +88,21 @@ AudioEngine::AudioEngine(float sample_rate, int rt_cpu_cores) : BaseEngine::Base
                                                                 _multicore_processing(rt_cpu_cores > 1),
                                                                 _rt_cores(rt_cpu_cores),
                                                                 _transport(sample_rate),
-                                                                _clip_detector(sample_rate)
+                                                                _clip_detector(sample_rate),
+                                                                _meter_service(sample_rate)
 {
     this->set_sample_rate(sample_rate);
     _event_dispatcher.run();
     if (_multicore_processing)
     {
         _worker_pool = twine::WorkerPool::create_worker_pool(_rt_cores);
+        _block_worker_pool = twine::WorkerPool::create_worker_pool(_rt_cores);
+        _block_workers.reserve(_rt_cores);
+        for (int i = 0; i < _rt_cores; ++i)
+        {
+            _block_workers.push_back({this, i});
+            _block_worker_pool->add_worker(_block_worker_function, &_block_workers.back());
+        }
     }
 }
 
@@ -117,17 +126,20 @@ void AudioEngine::set_sample_rate(float sample_rate)
     _transport.set_sample_rate(sample_rate);
     _process_timer.set_timing_period(sample_rate, AUDIO_CHUNK_SIZE);
     _clip_detector.set_sample_rate(sample_rate);
+    _meter_service.set_sample_rate(sample_rate);
 }
 
 void AudioEngine::set_audio_input_channels(int channels)
 {
     _clip_detector.set_input_channels(channels);
+    _meter_service.set_input_channels(channels);
     BaseEngine::set_audio_input_channels(channels);
 }
 
 void AudioEngine::set_audio_output_channels(int channels)
 {
     _clip_detector.set_output_channels(channels);
+    _meter_service.set_output_channels(channels);
     BaseEngine::set_audio_output_channels(channels);
 }
 
@@ -352,6 +364,22 @@ int AudioEngine::n_channels_in_track(int track)
     return 0;
 }
 
+Processor* AudioEngine::_make_plugin(const std::string& uid, const std::string& path, PluginType type)
+{
+    switch (type)
+    {
+        case PluginType::INTERNAL:
+            return _make_internal_plugin(uid);
+
+        case PluginType::VST2X:
+            return new vst2::Vst2xWrapper(_host_control, path);
+
+        case PluginType::VST3X:
+            return new vst3::Vst3xWrapper(_host_control, path, uid);
+    }
+    return nullptr;
+}
+
 Processor* AudioEngine::_make_internal_plugin(const std::string& uid)
 {
     Processor* instance = nullptr;
@@ -399,6 +427,10 @@ Processor* AudioEngine::_make_internal_plugin(const std::string& uid)
     {
         instance = new control_to_cv_plugin::ControlToCvPlugin(_host_control);
     }
+    else if (uid == "sushi.testing.convolution")
+    {
+        instance = new convolution_plugin::ConvolutionPlugin(_host_control);
+    }
     return instance;
 }
 
@@ -510,6 +542,10 @@ void AudioEngine::process_chunk(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffer,
     {
         _clip_detector.detect_clipped_samples(*in_buffer, _main_out_queue, true);
     }
+    if (_metering_enabled)
+    {
+        _meter_service.process_inputs(*in_buffer);
+    }
     _copy_audio_to_tracks(in_buffer);
 
     if (_multicore_processing)
@@ -531,6 +567,14 @@ void AudioEngine::process_chunk(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffer,
         _worker_pool->wait_for_workers_idle();
     }
 
+    if (_metering_enabled)
+    {
+        for (int i = 0; i < static_cast<int>(_audio_graph.size()); ++i)
+        {
+            _meter_service.process_track(i, *_audio_graph[i]);
+        }
+    }
+
     _main_out_queue.push(RtEvent::make_synchronisation_event(_transport.current_process_time()));
     _copy_audio_from_tracks(out_buffer);
     _state.store(update_state(state));
@@ -539,6 +583,110 @@ void AudioEngine::process_chunk(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffer,
     {
         _clip_detector.detect_clipped_samples(*out_buffer, _main_out_queue, false);
     }
+    if (_metering_enabled)
+    {
+        _meter_service.process_outputs(*out_buffer, static_cast<int>(_audio_graph.size()), _transport.current_process_time());
+    }
+    _process_timer.stop_timer(engine_timestamp, ENGINE_TIMING_ID);
+}
+
+void AudioEngine::process_chunks(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffers,
+                                 SampleBuffer<AUDIO_CHUNK_SIZE>* out_buffers,
+                                 int chunks,
+                                 Time timestamp,
+                                 int64_t samples,
+                                 ControlBuffer* in_controls,
+                                 ControlBuffer* out_controls)
+{
+    if (_track_major_rendering_possible() == false)
+    {
+        BaseEngine::process_chunks(in_buffers, out_buffers, chunks, timestamp, samples, in_controls, out_controls);
+        return;
+    }
+    twine::ThreadRtFlag rt_flag;
+    auto engine_timestamp = _process_timer.start_timer();
+
+    RtEvent in_event;
+    while (_internal_control_queue.pop(in_event))
+    {
+        send_rt_event(in_event);
+    }
+    while (_main_in_queue.pop(in_event))
+    {
+        send_rt_event(in_event);
+    }
+    auto state = _state.load();
+
+    /* Tracks are at different points in time while rendering, so each chunk gets its own copy of the transport */
+    _chunk_transports.resize(chunks, _transport);
+    for (int i = 0; i < chunks; ++i)
+    {
+        update_time(_chunk_time(timestamp, i), samples + i * AUDIO_CHUNK_SIZE);
+        _chunk_transports[i] = _transport;
+        if (_input_clip_detection_enabled)
+        {
+            _clip_detector.detect_clipped_samples(in_buffers[i], _main_out_queue, true);
+        }
+    }
+    _event_dispatcher.set_time(_transport.current_process_time());
+
+    int tracks = static_cast<int>(_audio_graph.size());
+    _track_chunk_outputs.resize(tracks);
+    for (int t = 0; t < tracks; ++t)
+    {
+        auto& outputs = _track_chunk_outputs[t];
+        int channels = _audio_graph[t]->max_output_channels();
+        if (static_cast<int>(outputs.size()) != chunks || (chunks > 0 && outputs.front().channel_count() != channels))
+        {
+            outputs.assign(chunks, ChunkSampleBuffer(channels));
+        }
+        _track_block_events[_audio_graph[t]->id()].clear();
+    }
+
+    if (_multicore_processing && tracks > 1)
+    {
+        /* Tracks buffer their events internally in multicore mode, so they can render in parallel */
+        _block_in_buffers = in_buffers;
+        _block_chunks = chunks;
+        _block_worker_pool->wakeup_workers();
+        _block_worker_pool->wait_for_workers_idle();
+    }
+    else
+    {
+        for (int t = 0; t < tracks; ++t)
+        {
+            _render_track_chunks(t, in_buffers, chunks);
+        }
+    }
+    for (const auto& track : _audio_graph)
+    {
+        for (const auto& event : _track_block_events[track->id()])
+        {
+            _process_outgoing_event(*out_controls, event);
+        }
+    }
+    out_controls->gate_values = _outgoing_gate_values;
+
+    _main_out_queue.push(RtEvent::make_synchronisation_event(_transport.current_process_time()));
+    for (int i = 0; i < chunks; ++i)
+    {
+        out_buffers[i].clear();
+        for (const auto& c : _out_audio_connections)
+        {
+            auto track = std::find_if(_audio_graph.begin(), _audio_graph.end(), [&c](const Track* t) {return t->id() == c.track;});
+            if (track != _audio_graph.end())
+            {
+                auto& track_out = _track_chunk_outputs[std::distance(_audio_graph.begin(), track)][i];
+                auto engine_out = ChunkSampleBuffer::create_non_owning_buffer(out_buffers[i], c.engine_channel, 1);
+                engine_out.add(ChunkSampleBuffer::create_non_owning_buffer(track_out, c.track_channel, 1));
+            }
+        }
+        if (_output_clip_detection_enabled)
+        {
+            _clip_detector.detect_clipped_samples(out_buffers[i], _main_out_queue, false);
+        }
+    }
+    _state.store(update_state(state));
     _process_timer.stop_timer(engine_timestamp, ENGINE_TIMING_ID);
 }
 
@@ -710,6 +858,7 @@ EngineReturnStatus AudioEngine::delete_track(const std::string &track_name)
         return EngineReturnStatus::INVALID_TRACK;
     }
     auto track = track_node->second.get();
+    auto track_id = track->id();
     if (realtime())
     {
         auto remove_track_event = RtEvent::make_remove_track_event(track->id());
@@ -722,7 +871,16 @@ EngineReturnStatus AudioEngine::delete_track(const std::string &track_name)
         {
             SUSHI_LOG_ERROR("Failed to remove processor {} from processing part", track_name);
         }
-        return _deregister_processor(track_name);
+        if (removed)
+        {
+            _track_block_events[track_id] = std::vector<RtEvent>();
+        }
+        auto status = _deregister_processor(track_name);
+        if (status == EngineReturnStatus::OK)
+        {
+            _notify_audio_graph_change(AudioGraphNotificationEvent::Action::TRACK_DELETED, track_id, track_id);
+        }
+        return status;
     }
     else
     {
@@ -732,7 +890,13 @@ EngineReturnStatus AudioEngine::delete_track(const std::string &track_name)
             {
                 _audio_graph.erase(track_in_graph);
                 _remove_processor_from_realtime_part(track->id());
-                return _deregister_processor(track_name);
+                _track_block_events[track_id] = std::vector<RtEvent>();
+                auto status = _deregister_processor(track_name);
+                if (status == EngineReturnStatus::OK)
+                {
+                    _notify_audio_graph_change(AudioGraphNotificationEvent::Action::TRACK_DELETED, track_id, track_id);
+                }
+                return status;
             }
             SUSHI_LOG_WARNING("Plugin track {} was not in the audio graph", track_name);
         }
@@ -753,25 +917,11 @@ EngineReturnStatus AudioEngine::add_plugin_to_track(const std::string &track_nam
         return EngineReturnStatus::INVALID_TRACK;
     }
     auto track = static_cast<Track*>(track_node->second.get());
-    Processor* plugin{nullptr};
-    switch (plugin_type)
+    Processor* plugin = _make_plugin(plugin_uid, plugin_path, plugin_type);
+    if(plugin == nullptr)
     {
-        case PluginType::INTERNAL:
-            plugin = _make_internal_plugin(plugin_uid);
-            if(plugin == nullptr)
-            {
-                SUSHI_LOG_ERROR("Unrecognised internal plugin \"{}\"", plugin_uid);
-                return EngineReturnStatus::INVALID_PLUGIN_UID;
-            }
-            break;
-
-        case PluginType::VST2X:
-            plugin = new vst2::Vst2xWrapper(_host_control, plugin_path);
-            break;
-
-        case PluginType::VST3X:
-            plugin = new vst3::Vst3xWrapper(_host_control, plugin_path, plugin_uid);
-            break;
+        SUSHI_LOG_ERROR("Unrecognised internal plugin \"{}\"", plugin_uid);
+        return EngineReturnStatus::INVALID_PLUGIN_UID;
     }
 
     auto processor_status = plugin->init(_sample_rate);
@@ -780,6 +930,15 @@ EngineReturnStatus AudioEngine::add_plugin_to_track(const std::string &track_nam
         SUSHI_LOG_ERROR("Failed to initialize plugin {}", plugin_name);
         return EngineReturnStatus::INVALID_PLUGIN_UID;
     }
+    if (plugin_type != PluginType::INTERNAL)
+    {
+        /* The plugin is already loaded, so record its metadata for later lookups */
+        auto& metadata_cache = PluginMetadataCache::instance();
+        if (metadata_cache.lookup(plugin_path, plugin_uid).has_value() == false)
+        {
+            metadata_cache.store(plugin_path, plugin_uid, plugin);
+        }
+    }
     EngineReturnStatus status = _register_processor(plugin, plugin_name);
     if(status != EngineReturnStatus::OK)
     {
@@ -812,9 +971,36 @@ EngineReturnStatus AudioEngine::add_plugin_to_track(const std::string &track_nam
             return EngineReturnStatus::ERROR;
         }
     }
+    _notify_audio_graph_change(AudioGraphNotificationEvent::Action::PROCESSOR_ADDED, plugin->id(), track->id());
     return EngineReturnStatus::OK;
 }
 
+std::optional<PluginMetadata> AudioEngine::plugin_metadata(const std::string& plugin_uid,
+                                                           const std::string& plugin_path,
+                                                           PluginType plugin_type)
+{
+    auto& metadata_cache = PluginMetadataCache::instance();
+    if (plugin_type != PluginType::INTERNAL)
+    {
+        auto metadata = metadata_cache.lookup(plugin_path, plugin_uid);
+        if (metadata.has_value())
+        {
+            return metadata;
+        }
+    }
+    std::unique_ptr<Processor> plugin(_make_plugin(plugin_uid, plugin_path, plugin_type));
+    if (plugin == nullptr || plugin->init(_sample_rate) != ProcessorReturnCode::OK)
+    {
+        SUSHI_LOG_ERROR("Failed to load plugin \"{}\" to read its metadata", plugin_uid);
+        return std::nullopt;
+    }
+    if (plugin_type == PluginType::INTERNAL)
+    {
+        return PluginMetadataCache::read_metadata(plugin.get());
+    }
+    return metadata_cache.store(plugin_path, plugin_uid, plugin.get());
+}
+
 /* TODO - In the future it should be possible to remove plugins without deleting them
  * and consequentally to add them to a different track or have plugins not associated
  * to a particular track. */
@@ -854,7 +1040,13 @@ EngineReturnStatus AudioEngine::remove_plugin_from_track(const std::string &trac
         }
         _remove_processor_from_realtime_part(processor->id());
     }
-    return _deregister_processor(processor->name());
+    auto processor_id = processor->id();
+    auto status = _deregister_processor(processor->name());
+    if (status == EngineReturnStatus::OK)
+    {
+        _notify_audio_graph_change(AudioGraphNotificationEvent::Action::PROCESSOR_DELETED, processor_id, track->id());
+    }
+    return status;
 }
 
 const Processor* AudioEngine::processor(ObjectId processor_id) const
@@ -880,6 +1072,10 @@ EngineReturnStatus AudioEngine::_register_new_track(const std::string& name, Tra
         delete track;
         return status;
     }
+    if (track->id() < _track_block_events.size())
+    {
+        _track_block_events[track->id()].reserve(MAX_TRACK_BLOCK_EVENTS);
+    }
     if (_multicore_processing)
     {
         // Have tracks buffer their events internally as outputting directly might not be thread safe
@@ -911,10 +1107,17 @@ EngineReturnStatus AudioEngine::_register_new_track(const std::string& name, Tra
     {
         _worker_pool->add_worker(Track::ext_render_function, track);
     }
+    _notify_audio_graph_change(AudioGraphNotificationEvent::Action::TRACK_ADDED, track->id(), track->id());
     SUSHI_LOG_INFO("Track {} successfully added to engine", name);
     return EngineReturnStatus::OK;
 }
 
+void AudioEngine::_notify_audio_graph_change(AudioGraphNotificationEvent::Action action, ObjectId processor, ObjectId track)
+{
+    _audio_graph_generation.fetch_add(1, std::memory_order_release);
+    _event_dispatcher.post_event(new AudioGraphNotificationEvent(action, processor, track, IMMEDIATE_PROCESS));
+}
+
 bool AudioEngine::_handle_internal_events(RtEvent& event)
 {
     switch (event.type())
@@ -1006,6 +1209,7 @@ bool AudioEngine::_handle_internal_events(RtEvent& event)
         {
             /* Eventually we might want to do sample accurate tempo changes */
             _transport.set_tempo(event.tempo_event()->tempo());
+            _main_out_queue.push(event); // Notify listeners of the change
             break;
         }
 
@@ -1013,18 +1217,21 @@ bool AudioEngine::_handle_internal_events(RtEvent& event)
         {
             /* Eventually we might want to do sample accurate time signature changes */
             _transport.set_time_signature(event.time_signature_event()->time_signature());
+            _main_out_queue.push(event); // Notify listeners of the change
             break;
         }
 
         case RtEventType::PLAYING_MODE:
         {
             _transport.set_playing_mode(event.playing_mode_event()->mode());
+            _main_out_queue.push(event); // Notify listeners of the change
             break;
         }
 
         case RtEventType::SYNC_MODE:
         {
             _transport.set_sync_mode(event.sync_mode_event()->mode());
+            _main_out_queue.push(event); // Notify listeners of the change
             break;
         }
 
@@ -1044,6 +1251,65 @@ void AudioEngine::_retrieve_events_from_tracks(ControlBuffer& buffer)
     }
 }
 
+bool AudioEngine::_track_major_rendering_possible() const
+{
+    /* Cv and gate routing makes tracks depend on each other, or on the frontend, every chunk */
+    return _cv_inputs == 0 && _cv_outputs == 0 && _cv_in_routes.empty() && _gate_in_routes.empty() &&
+           _metering_enabled == false;
+}
+
+void AudioEngine::_render_track_chunks(int track_index, SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffers, int chunks)
+{
+    auto track = _audio_graph[track_index];
+    auto& outputs = _track_chunk_outputs[track_index];
+    for (int i = 0; i < chunks; ++i)
+    {
+        HostControl::set_thread_transport(&_chunk_transports[i]);
+        for (const auto& c : _in_audio_connections)
+        {
+            if (c.track == track->id())
+            {
+                auto engine_in = ChunkSampleBuffer::create_non_owning_buffer(in_buffers[i], c.engine_channel, 1);
+                auto track_in = track->input_channel(c.track_channel);
+                track_in = engine_in;
+            }
+        }
+        track->render();
+        for (int c = 0; c < outputs[i].channel_count(); ++c)
+        {
+            auto track_out = track->output_channel(c);
+            auto stored_out = ChunkSampleBuffer::create_non_owning_buffer(outputs[i], c, 1);
+            stored_out = track_out;
+        }
+        /* In multicore mode each track has its own event queue, otherwise tracks
+         * render one at a time and share _processor_out_queue */
+        auto& queue = _multicore_processing ? track->output_event_buffer() : _processor_out_queue;
+        auto& events = _track_block_events[track->id()];
+        RtEvent event;
+        while (queue.pop(event))
+        {
+            /* Never allocate here, events that don't fit in the reserved space are dropped */
+            if (events.size() < events.capacity())
+            {
+                events.push_back(event);
+            }
+        }
+    }
+    HostControl::set_thread_transport(nullptr);
+}
+
+void AudioEngine::_block_worker_function(void* arg)
+{
+    auto worker = static_cast<BlockWorker*>(arg);
+    auto engine = worker->engine;
+    int tracks = static_cast<int>(engine->_audio_graph.size());
+    int workers = static_cast<int>(engine->_block_workers.size());
+    for (int t = worker->index; t < tracks; t += workers)
+    {
+        engine->_render_track_chunks(t, engine->_block_in_buffers, engine->_block_chunks);
+    }
+}
+
 void AudioEngine::_copy_audio_to_tracks(ChunkSampleBuffer* input)
 {
     for (const auto& c : _in_audio_connections)
@@ -1171,27 +1437,32 @@ void AudioEngine::_process_outgoing_events(ControlBuffer& buffer, RtSafeRtEventF
     RtEvent event;
     while (source_queue.pop(event))
     {
-        switch (event.type())
-        {
-            case RtEventType::CV_EVENT:
-            {
-                auto typed_event = event.cv_event();
-                buffer.cv_values[typed_event->cv_id()] = typed_event->value();
-                break;
-            }
+        _process_outgoing_event(buffer, event);
+    }
+    buffer.gate_values = _outgoing_gate_values;
+}
 
-            case RtEventType::GATE_EVENT:
-            {
-                auto typed_event = event.gate_event();
-                _outgoing_gate_values[typed_event->gate_no()] = typed_event->value();
-                break;
-            }
+void AudioEngine::_process_outgoing_event(ControlBuffer& buffer, const RtEvent& event)
+{
+    switch (event.type())
+    {
+        case RtEventType::CV_EVENT:
+        {
+            auto typed_event = event.cv_event();
+            buffer.cv_values[typed_event->cv_id()] = typed_event->value();
+            break;
+        }
 
-            default:
-                _main_out_queue.push(event);
+        case RtEventType::GATE_EVENT:
+        {
+            auto typed_event = event.gate_event();
+            _outgoing_gate_values[typed_event->gate_no()] = typed_event->value();
+            break;
         }
+
+        default:
+            _main_out_queue.push(event);
     }
-    buffer.gate_values = _outgoing_gate_values;
 }
 
 RealtimeState update_state(RealtimeState current_state)
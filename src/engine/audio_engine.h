@@ -36,6 +36,7 @@
 #include "engine/transport.h"
 #include "engine/host_control.h"
 #include "engine/controller.h"
+#include "engine/meter_service.h"
 #include "library/time.h"
 #include "library/sample_buffer.h"
 #include "library/elk_allocator.h"
@@ -78,6 +79,8 @@ private:
 
 
 constexpr int MAX_RT_PROCESSOR_ID = 1000;
+/* Events a track can send during one call to process_chunks(), any further events are dropped */
+constexpr int MAX_TRACK_BLOCK_EVENTS = 4 * MAX_EVENTS_IN_QUEUE;
 
 class AudioEngine : public BaseEngine
 {
@@ -287,6 +290,31 @@ public:
                        ControlBuffer* in_controls,
                        ControlBuffer* out_controls) override;
 
+    /**
+     * @brief Process several consecutive chunks, for offline processing. Tracks only
+     *        depend on each other through cv and gate routing, so unless that or
+     *        metering is used, each track renders all chunks on its own before
+     *        the track outputs are summed. With multicore processing, tracks
+     *        render in parallel. Otherwise the chunks are processed one at a time.
+     *        Events sent to the engine take effect at the start of the first chunk.
+     *        Not rt safe, as buffers are allocated when the number of chunks or
+     *        tracks changes.
+     * @param in_buffers Input audio buffers, one for each chunk
+     * @param out_buffers Output audio buffers, one for each chunk
+     * @param chunks The number of chunks
+     * @param timestamp Time at the start of the first chunk
+     * @param samples Number of samples processed before the first chunk
+     * @param in_controls input control voltage and gate data
+     * @param out_controls output control voltage and gate data
+     */
+    void process_chunks(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffers,
+                        SampleBuffer<AUDIO_CHUNK_SIZE>* out_buffers,
+                        int chunks,
+                        Time timestamp,
+                        int64_t samples,
+                        ControlBuffer* in_controls,
+                        ControlBuffer* out_controls) override;
+
     /**
      * @brief Set the current time for the start of the current audio chunk
      * @param timestamp Current time in microseconds
@@ -416,6 +444,19 @@ public:
                                            const std::string &plugin_path,
                                            PluginType plugin_type) override;
 
+    /**
+     * @brief Get the parameters, channels, programs and latency of a plugin. External
+     *        plugins are looked up in the PluginMetadataCache first, and only loaded
+     *        if not found there, in which case the cache is updated.
+     * @param plugin_uid The unique id of the plugin
+     * @param plugin_path The file to load the plugin from, only valid for external plugins
+     * @param plugin_type The type of plugin, i.e. internal or external
+     * @return The metadata of the plugin, std::nullopt if the plugin could not be loaded
+     */
+    std::optional<PluginMetadata> plugin_metadata(const std::string& plugin_uid,
+                                                  const std::string& plugin_path,
+                                                  PluginType plugin_type) override;
+
     /**
      * @brief Remove a given plugin from a track and delete it
      * @param track_name The unique name of the track that contains the plugin
@@ -479,6 +520,25 @@ public:
         _output_clip_detection_enabled = enabled;
     }
 
+    /**
+     * @brief Enable level metering of engine inputs, outputs and all tracks
+     * @param enabled Enable if true, disable if false
+     */
+    void enable_metering(bool enabled) override
+    {
+        _metering_enabled = enabled;
+    }
+
+    const MeterService* meter_service() override
+    {
+        return &_meter_service;
+    }
+
+    int audio_graph_generation() const override
+    {
+        return _audio_graph_generation.load(std::memory_order_acquire);
+    }
+
     sushi::dispatcher::BaseEventDispatcher* event_dispatcher() override
     {
         return &_event_dispatcher;
@@ -512,6 +572,15 @@ private:
      */
     Processor* _make_internal_plugin(const std::string& uid);
 
+    /**
+     * @brief Instantiate a plugin of any type, without initialising it
+     * @param uid String unique id
+     * @param path The file to load the plugin from, only used for external plugins
+     * @param type The type of plugin
+     * @return Pointer to plugin instance, nullptr if an internal plugin uid is not valid
+     */
+    Processor* _make_plugin(const std::string& uid, const std::string& path, PluginType type);
+
     /**
      * @brief Register a newly created processor in all lookup containers
      *        and take ownership of it.
@@ -548,6 +617,12 @@ private:
      */
     EngineReturnStatus _register_new_track(const std::string& name, Track* track);
 
+    /**
+     * @brief Let listeners of engine notifications know that a track or processor
+     *        was added or deleted. Not rt safe.
+     */
+    void _notify_audio_graph_change(AudioGraphNotificationEvent::Action action, ObjectId processor, ObjectId track);
+
     /**
      * @brief Checks whether a processor exists in the engine.
      * @param processor_name The unique name of the processor.
@@ -582,13 +657,46 @@ private:
 
     void _process_outgoing_events(ControlBuffer& buffer, RtSafeRtEventFifo& source_queue);
 
+    void _process_outgoing_event(ControlBuffer& buffer, const RtEvent& event);
+
+    bool _track_major_rendering_possible() const;
+
+    /* Render all chunks of process_chunks() for one track in _audio_graph */
+    void _render_track_chunks(int track_index, SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffers, int chunks);
+
+    /* Worker function of _block_worker_pool, renders every n:th track of the current block */
+    static void _block_worker_function(void* arg);
+
+    struct BlockWorker
+    {
+        AudioEngine* engine;
+        int index;
+    };
+
     const bool _multicore_processing;
     const int  _rt_cores;
 
     std::unique_ptr<twine::WorkerPool> _worker_pool;
 
+    /* Renders tracks in parallel in process_chunks(). A separate pool as the workers
+     * of _worker_pool render one chunk of a single track each */
+    std::unique_ptr<twine::WorkerPool> _block_worker_pool;
+    std::vector<BlockWorker> _block_workers;
+    SampleBuffer<AUDIO_CHUNK_SIZE>* _block_in_buffers{nullptr};
+    int _block_chunks{0};
+
     std::vector<Track*> _audio_graph;
 
+    /* Output of each track in _audio_graph for each chunk, and the transport
+     * state for each chunk, when tracks render several chunks on their own */
+    std::vector<std::vector<ChunkSampleBuffer>> _track_chunk_outputs;
+    std::vector<Transport> _chunk_transports;
+    /* Events sent by each track while rendering a block, indexed by track id and
+     * collected after every chunk so the event queues, which only hold MAX_EVENTS_IN_QUEUE
+     * events, never receive more than one chunk's worth before they are emptied.
+     * Room for MAX_TRACK_BLOCK_EVENTS is reserved when a track is registered */
+    std::vector<std::vector<RtEvent>> _track_block_events{std::vector<std::vector<RtEvent>>(MAX_RT_PROCESSOR_ID)};
+
     // All registered processors indexed by their unique name
     std::map<std::string, std::unique_ptr<Processor>> _processors;
 
@@ -626,6 +734,7 @@ private:
     BitSet32 _outgoing_gate_values{0};
 
     std::atomic<RealtimeState> _state{RealtimeState::STOPPED};
+    std::atomic<int> _audio_graph_generation{0};
 
     RtSafeRtEventFifo _internal_control_queue;
     RtSafeRtEventFifo _main_in_queue;
@@ -646,6 +755,9 @@ private:
     bool _input_clip_detection_enabled{false};
     bool _output_clip_detection_enabled{false};
     ClipDetector _clip_detector;
+
+    bool _metering_enabled{false};
+    MeterService _meter_service;
 };
 
 /**
@@ -27,11 +27,14 @@
 #include <utility>
 #include <bitset>
 #include <limits>
+#include <optional>
 
 #include "library/constants.h"
 #include "base_event_dispatcher.h"
 #include "engine/track.h"
+#include "engine/meter_service.h"
 #include "library/base_performance_timer.h"
+#include "library/plugin_metadata_cache.h"
 #include "library/time.h"
 #include "library/sample_buffer.h"
 #include "library/types.h"
@@ -213,6 +216,27 @@ public:
                                ControlBuffer* in_controls,
                                ControlBuffer* out_controls) = 0;
 
+    /**
+     * @brief Process several consecutive chunks, for offline processing where the
+     *        engine can render ahead. The chunks follow on from the time and sample
+     *        count given for the first chunk without gaps. The default
+     *        implementation processes one chunk at a time.
+     */
+    virtual void process_chunks(SampleBuffer<AUDIO_CHUNK_SIZE>* in_buffers,
+                                SampleBuffer<AUDIO_CHUNK_SIZE>* out_buffers,
+                                int chunks,
+                                Time timestamp,
+                                int64_t samples,
+                                ControlBuffer* in_controls,
+                                ControlBuffer* out_controls)
+    {
+        for (int i = 0; i < chunks; ++i)
+        {
+            update_time(_chunk_time(timestamp, i), samples + i * AUDIO_CHUNK_SIZE);
+            process_chunk(&in_buffers[i], &out_buffers[i], in_controls, out_controls);
+        }
+    }
+
     virtual void update_time(Time /*timestamp*/, int64_t /*samples*/) = 0;
 
     virtual void set_output_latency(Time /*latency*/) = 0;
@@ -275,12 +299,27 @@ public:
         return EngineReturnStatus::OK;
     }
 
+    virtual std::optional<PluginMetadata> plugin_metadata(const std::string & /*uid*/,
+                                                          const std::string & /*file*/,
+                                                          PluginType /*plugin_type*/)
+    {
+        return std::nullopt;
+    }
+
     virtual EngineReturnStatus remove_plugin_from_track(const std::string & /*track_id*/,
                                                         const std::string & /*plugin_id*/)
     {
         return EngineReturnStatus::OK;
     }
 
+    /**
+     * @brief Get a counter that is incremented every time a track or processor is
+     *        added or removed, so that cached views of the audio graph can tell
+     *        whether they are still current. Safe to call from any thread.
+     * @return The current audio graph generation
+     */
+    virtual int audio_graph_generation() const {return 0;}
+
     virtual const Processor* processor(ObjectId /*processor_id*/) const {return nullptr;}
 
     virtual Processor* mutable_processor(ObjectId /*processor_id*/) {return nullptr;}
@@ -321,9 +360,22 @@ public:
 
     virtual void enable_output_clip_detection(bool /*enabled*/) {}
 
+    virtual void enable_metering(bool /*enabled*/) {}
+
+    virtual const MeterService* meter_service()
+    {
+        return nullptr;
+    }
+
     virtual void print_timings_to_log() {}
 
 protected:
+    /* Start time of a chunk counted from a chunk starting at timestamp */
+    Time _chunk_time(Time timestamp, int chunk) const
+    {
+        return timestamp + std::chrono::microseconds(static_cast<int64_t>(chunk * AUDIO_CHUNK_SIZE * 1'000'000.0 / _sample_rate));
+    }
+
     float _sample_rate;
     int _audio_inputs{0};
     int _audio_outputs{0};
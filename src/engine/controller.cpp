@@ -18,6 +18,8 @@
  * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <algorithm>
+
 #include "engine/controller.h"
 #include "engine/base_engine.h"
 
@@ -105,14 +107,36 @@ inline ext::CpuTimings to_external(sushi::performance::ProcessTimings& internal)
     return {internal.avg_case, internal.min_case, internal.max_case};
 }
 
+inline ext::ParameterInfo to_external(const ParameterDescriptor* descriptor)
+{
+    ext::ParameterInfo info;
+    info.id = descriptor->id();
+    info.label = descriptor->label();
+    info.name = descriptor->name();
+    info.unit = descriptor->unit();
+    info.type = to_external(descriptor->type());
+    info.min_range = descriptor->min_range();
+    info.max_range = descriptor->max_range();
+    info.automatable = descriptor->type() == ParameterType::FLOAT ||
+                       descriptor->type() == ParameterType::INT   ||
+                       descriptor->type() == ParameterType::BOOL;
+    return info;
+}
+
 Controller::Controller(engine::BaseEngine* engine) : _engine{engine}
 {
     _event_dispatcher = _engine->event_dispatcher();
     _transport = _engine->transport();
     _performance_timer = engine->performance_timer();
+    _event_dispatcher->subscribe_to_parameter_change_notifications(this);
+    _event_dispatcher->subscribe_to_engine_notifications(this);
 }
 
-Controller::~Controller() = default;
+Controller::~Controller()
+{
+    _event_dispatcher->unsubscribe_from_parameter_change_notifications(this);
+    _event_dispatcher->unsubscribe_from_engine_notifications(this);
+}
 
 float Controller::get_samplerate() const
 {
@@ -190,22 +214,7 @@ void Controller::set_timing_statistics_enabled(bool enabled) const
 std::vector<ext::TrackInfo> Controller::get_tracks() const
 {
     SUSHI_LOG_DEBUG("get_tracks called");
-    auto& tracks = _engine->all_tracks();
-    std::vector<ext::TrackInfo> returns;
-    for (const auto& t : tracks)
-    {
-        ext::TrackInfo info;
-        info.id = t->id();
-        info.name = t->name();
-        info.label = t->label();
-        info.input_busses = t->input_busses();
-        info.input_channels = t->input_channels();
-        info.output_busses = t->output_busses();
-        info.output_channels = t->output_channels();
-        info.processor_count = static_cast<int>(t->process_chain().size());
-        returns.push_back(info);
-    }
-    return returns;
+    return _mirror()->tracks;
 }
 
 ext::ControlStatus Controller::send_note_on(int track_id, int channel, int note, float velocity)
@@ -307,106 +316,60 @@ std::pair<ext::ControlStatus, int> Controller::get_track_id(const std::string& t
 std::pair<ext::ControlStatus, ext::TrackInfo> Controller::get_track_info(int track_id) const
 {
     SUSHI_LOG_DEBUG("get_track_info called with track {}", track_id);
-    ext::TrackInfo info;
-    const auto& tracks = _engine->all_tracks();
-    for (const auto& track : tracks)
+    auto mirror = _mirror();
+    auto track = mirror->track_index.find(static_cast<ObjectId>(track_id));
+    if (track == mirror->track_index.end())
     {
-        if (static_cast<int>(track->id()) == track_id)
-        {
-            info.label = track->label();
-            info.name = track->name();
-            info.id = track->id();
-            info.input_channels = track->input_channels();
-            info.input_busses = track->input_busses();
-            info.output_channels = track->output_channels();
-            info.output_busses = track->output_busses();
-            info.processor_count = static_cast<int>(track->process_chain().size());
-            return {ext::ControlStatus::OK, info};
-        }
+        return {ext::ControlStatus::NOT_FOUND, ext::TrackInfo()};
     }
-    return {ext::ControlStatus::NOT_FOUND, info};
+    return {ext::ControlStatus::OK, mirror->tracks[track->second]};
 }
 
 std::pair<ext::ControlStatus, std::vector<ext::ProcessorInfo>> Controller::get_track_processors(int track_id) const
 {
     SUSHI_LOG_DEBUG("get_track_processors called for track: {}", track_id);
-    const auto& tracks = _engine->all_tracks();
-    for (const auto& track : tracks)
+    auto mirror = _mirror();
+    auto processors = mirror->track_processors.find(static_cast<ObjectId>(track_id));
+    if (processors == mirror->track_processors.end())
     {
-        if (static_cast<int>(track->id()) == track_id)
-        {
-            std::vector<ext::ProcessorInfo> infos;
-            const auto& procs = track->process_chain();
-            for (const auto& processor : procs)
-            {
-                ext::ProcessorInfo info;
-                info.label = processor->label();
-                info.name = processor->name();
-                info.id = processor->id();
-                info.parameter_count = processor->parameter_count();
-                info.program_count = processor->supports_programs()? processor->program_count() : 0;
-                infos.push_back(info);
-            }
-            return {ext::ControlStatus::OK, infos};
-        }
+        return {ext::ControlStatus::NOT_FOUND, std::vector<ext::ProcessorInfo>()};
     }
-    return {ext::ControlStatus::NOT_FOUND, std::vector<ext::ProcessorInfo>()};
+    return {ext::ControlStatus::OK, processors->second};
 }
 
 std::pair<ext::ControlStatus, std::vector<ext::ParameterInfo>> Controller::get_track_parameters(int track_id) const
 {
     SUSHI_LOG_DEBUG("get_track_parameters called for track: {}", track_id);
-    const auto& tracks = _engine->all_tracks();
-    for (const auto& track : tracks)
+    auto mirror = _mirror();
+    if (mirror->track_index.count(static_cast<ObjectId>(track_id)) == 0)
     {
-        if (static_cast<int>(track->id()) == track_id)
-        {
-            std::vector<ext::ParameterInfo> infos;
-            const auto& params = track->all_parameters();
-            for (const auto& param : params)
-            {
-                ext::ParameterInfo info;
-                info.label = param->label();
-                info.name = param->name();
-                info.unit = param->unit();
-                info.id = param->id();
-                info.type = ext::ParameterType::FLOAT;
-                info.min_range = param->min_range();
-                info.max_range = param->max_range();
-                infos.push_back(info);
-            }
-            return {ext::ControlStatus::OK, infos};
-        }
+        return {ext::ControlStatus::NOT_FOUND, std::vector<ext::ParameterInfo>()};
     }
-    return {ext::ControlStatus::NOT_FOUND, std::vector<ext::ParameterInfo>()};
+    return {ext::ControlStatus::OK, mirror->processors.at(static_cast<ObjectId>(track_id)).parameters};
 }
 
 std::pair<ext::ControlStatus, int> Controller::get_processor_id(const std::string& processor_name) const
 {
     SUSHI_LOG_DEBUG("get_processor_id called with processor {}", processor_name);
-    auto [status, id] = _engine->processor_id_from_name(processor_name);
-    if (status == engine::EngineReturnStatus::OK)
+    auto mirror = _mirror();
+    auto id = mirror->processor_ids.find(processor_name);
+    if (id == mirror->processor_ids.end())
     {
-        return {ext::ControlStatus::OK, id};
+        return {ext::ControlStatus::NOT_FOUND, 0};
     }
-    return {ext::ControlStatus::NOT_FOUND, 0};
+    return {ext::ControlStatus::OK, id->second};
 }
 
 std::pair<ext::ControlStatus, ext::ProcessorInfo> Controller::get_processor_info(int processor_id) const
 {
     SUSHI_LOG_DEBUG("get_processor_info called with processor {}", processor_id);
-    ext::ProcessorInfo info;
-    auto processor = _engine->processor(static_cast<ObjectId>(processor_id));
-    if (processor == nullptr)
+    auto mirror = _mirror();
+    auto processor = mirror->processors.find(static_cast<ObjectId>(processor_id));
+    if (processor == mirror->processors.end())
     {
-        return {ext::ControlStatus::NOT_FOUND, info};
+        return {ext::ControlStatus::NOT_FOUND, ext::ProcessorInfo()};
     }
-    info.id = processor_id;
-    info.name = processor->name();
-    info.label = processor->label();
-    info.parameter_count = processor->parameter_count();
-    info.program_count = processor->supports_programs()? processor->program_count() : 0;
-    return {ext::ControlStatus::OK, info};
+    return {ext::ControlStatus::OK, processor->second.info};
 }
 
 std::pair<ext::ControlStatus, bool> Controller::get_processor_bypass_state(int processor_id) const
@@ -514,43 +477,27 @@ std::pair<ext::ControlStatus, std::vector<ext::ParameterInfo>>
 Controller::get_processor_parameters(int processor_id) const
 {
     SUSHI_LOG_DEBUG("get_processor_parameters called with processor {}", processor_id);
-    const auto& procs = _engine->all_processors();
-    for (const auto& proc : procs)
+    auto mirror = _mirror();
+    auto processor = mirror->processors.find(static_cast<ObjectId>(processor_id));
+    if (processor == mirror->processors.end())
     {
-        if (static_cast<int>(proc.second->id()) == processor_id)
-        {
-            std::vector<ext::ParameterInfo> infos;
-            const auto& params = proc.second->all_parameters();
-            for (const auto& param : params)
-            {
-                ext::ParameterInfo info;
-                info.label = param->label();
-                info.name = param->name();
-                info.unit = param->unit();
-                info.id = param->id();
-                info.type = ext::ParameterType::FLOAT;
-                info.min_range = param->min_range();
-                info.max_range = param->max_range();
-                infos.push_back(info);
-            }
-            return {ext::ControlStatus::OK, infos};
-        }
+        return {ext::ControlStatus::NOT_FOUND, std::vector<ext::ParameterInfo>()};
     }
-    return {ext::ControlStatus::NOT_FOUND, std::vector<ext::ParameterInfo>()};
+    return {ext::ControlStatus::OK, processor->second.parameters};
 }
 
 std::pair<ext::ControlStatus, int> Controller::get_parameter_id(int processor_id, const std::string& parameter_name) const
 {
     SUSHI_LOG_DEBUG("get_parameter_id called with processor {} and parameter {}", processor_id, parameter_name);
-    auto processor = _engine->processor(static_cast<ObjectId>(processor_id));
-    if (processor == nullptr)
+    auto mirror = _mirror();
+    auto processor = mirror->processors.find(static_cast<ObjectId>(processor_id));
+    if (processor != mirror->processors.end())
     {
-        return {ext::ControlStatus::NOT_FOUND, 0};
-    }
-    auto descr = processor->parameter_from_name(parameter_name);
-    if (descr != nullptr)
-    {
-        return {ext::ControlStatus::OK, descr->id()};
+        auto id = processor->second.parameter_ids.find(parameter_name);
+        if (id != processor->second.parameter_ids.end())
+        {
+            return {ext::ControlStatus::OK, id->second};
+        }
     }
     return {ext::ControlStatus::NOT_FOUND, 0};
 }
@@ -558,39 +505,30 @@ std::pair<ext::ControlStatus, int> Controller::get_parameter_id(int processor_id
 std::pair<ext::ControlStatus, ext::ParameterInfo> Controller::get_parameter_info(int processor_id, int parameter_id) const
 {
     SUSHI_LOG_DEBUG("get_parameter_info called with processor {} and parameter {}", processor_id, parameter_id);
-    ext::ParameterInfo info;
-    auto processor = _engine->processor(static_cast<ObjectId>(processor_id));
-    if (processor != nullptr)
+    auto mirror = _mirror();
+    auto processor = mirror->processors.find(static_cast<ObjectId>(processor_id));
+    if (processor != mirror->processors.end())
     {
-        auto descr = processor->parameter_from_id(static_cast<ObjectId>(parameter_id));
-        if (descr != nullptr)
+        auto index = processor->second.parameter_index.find(static_cast<ObjectId>(parameter_id));
+        if (index != processor->second.parameter_index.end())
         {
-            info.id = descr->id();
-            info.label = descr->label();
-            info.name = descr->name();
-            info.unit = descr->unit();
-            info.type = to_external(descr->type());
-            info.min_range = descr->min_range();
-            info.max_range = descr->max_range();
-            info.automatable =  descr->type() == ParameterType::FLOAT || // TODO - this might not be the way we eventually want it
-                                descr->type() == ParameterType::INT   ||
-                                descr->type() == ParameterType::BOOL;
-            return {ext::ControlStatus::OK, info};
+            return {ext::ControlStatus::OK, processor->second.parameters[index->second.first]};
         }
     }
-    return {ext::ControlStatus::NOT_FOUND, info};
+    return {ext::ControlStatus::NOT_FOUND, ext::ParameterInfo()};
 }
 
 std::pair<ext::ControlStatus, float> Controller::get_parameter_value(int processor_id, int parameter_id) const
 {
     SUSHI_LOG_DEBUG("get_parameter_value called with processor {} and parameter {}", processor_id, parameter_id);
-    auto processor = _engine->processor(static_cast<ObjectId>(processor_id));
-    if (processor != nullptr)
+    auto mirror = _mirror();
+    auto processor = mirror->processors.find(static_cast<ObjectId>(processor_id));
+    if (processor != mirror->processors.end())
     {
-        auto[status, value] = processor->parameter_value(static_cast<ObjectId>(parameter_id));
-        if (status == ProcessorReturnCode::OK)
+        auto index = processor->second.parameter_index.find(static_cast<ObjectId>(parameter_id));
+        if (index != processor->second.parameter_index.end() && index->second.second >= 0)
         {
-            return {ext::ControlStatus::OK, value};
+            return {ext::ControlStatus::OK, mirror->values[index->second.second].load(std::memory_order_relaxed)};
         }
     }
     return {ext::ControlStatus::NOT_FOUND, 0};
@@ -661,6 +599,336 @@ ext::ControlStatus Controller::set_string_property_value(int /*processor_id*/, i
     return ext::ControlStatus::UNSUPPORTED_OPERATION;
 }
 
+std::vector<ext::ParameterValue> Controller::get_all_parameter_values() const
+{
+    SUSHI_LOG_DEBUG("get_all_parameter_values called");
+    auto mirror = _mirror();
+    std::vector<ext::ParameterValue> values;
+    values.reserve(mirror->value_ids.size());
+    for (size_t slot = 0; slot < mirror->value_ids.size(); ++slot)
+    {
+        const auto& [processor_id, parameter_id] = mirror->value_ids[slot];
+        values.push_back({static_cast<int>(processor_id), static_cast<int>(parameter_id),
+                          mirror->values[slot].load(std::memory_order_relaxed)});
+    }
+    return values;
+}
+
+ext::ControlStatus Controller::set_parameter_values(const std::vector<ext::ParameterValue>& values)
+{
+    SUSHI_LOG_DEBUG("set_parameter_values called with {} values", values.size());
+    if (values.empty())
+    {
+        return ext::ControlStatus::OK;
+    }
+    std::vector<ParameterChangeBatchEvent::ParameterValue> batch;
+    batch.reserve(values.size());
+    for (const auto& value : values)
+    {
+        batch.push_back({static_cast<ObjectId>(value.processor_id), static_cast<ObjectId>(value.parameter_id), value.value});
+    }
+    _event_dispatcher->post_event(new ParameterChangeBatchEvent(std::move(batch), IMMEDIATE_PROCESS));
+    return ext::ControlStatus::OK;
+}
+
+ext::EngineSnapshot Controller::get_engine_snapshot() const
+{
+    SUSHI_LOG_DEBUG("get_engine_snapshot called");
+    ext::EngineSnapshot snapshot;
+    snapshot.samplerate = _engine->sample_rate();
+    snapshot.playing_mode = to_external(_transport->playing_mode());
+    snapshot.sync_mode = to_external(_transport->sync_mode());
+    snapshot.tempo = _transport->current_tempo();
+    snapshot.time_signature = to_external(_transport->current_time_signature());
+
+    auto mirror = _mirror();
+    auto parameter_states = [&mirror](ObjectId processor_id)
+    {
+        const auto& processor = mirror->processors.at(processor_id);
+        std::vector<ext::ParameterState> states;
+        states.reserve(processor.parameters.size());
+        for (const auto& parameter : processor.parameters)
+        {
+            int slot = processor.parameter_index.at(static_cast<ObjectId>(parameter.id)).second;
+            states.push_back({parameter, slot >= 0 ? mirror->values[slot].load(std::memory_order_relaxed) : 0.0f});
+        }
+        return states;
+    };
+
+    for (const auto& track : mirror->tracks)
+    {
+        ext::TrackState track_state;
+        track_state.info = track;
+        track_state.parameters = parameter_states(static_cast<ObjectId>(track.id));
+        for (const auto& processor : mirror->track_processors.at(static_cast<ObjectId>(track.id)))
+        {
+            ext::ProcessorState processor_state;
+            processor_state.info = processor;
+            processor_state.parameters = parameter_states(static_cast<ObjectId>(processor.id));
+            track_state.processors.push_back(std::move(processor_state));
+        }
+        snapshot.tracks.push_back(std::move(track_state));
+    }
+    return snapshot;
+}
+
+ext::ControlStatus Controller::subscribe_to_notifications(ext::NotificationType type, ext::ControlListener* listener)
+{
+    SUSHI_LOG_DEBUG("subscribe_to_notifications called with type {}", static_cast<int>(type));
+    int index = static_cast<int>(type);
+    if (index < 0 || index >= NOTIFICATION_TYPES || listener == nullptr)
+    {
+        return ext::ControlStatus::INVALID_ARGUMENTS;
+    }
+    std::lock_guard<std::mutex> lock(_listener_lock);
+    auto& listeners = _listeners[index];
+    if (std::find(listeners.begin(), listeners.end(), listener) == listeners.end())
+    {
+        listeners.push_back(listener);
+    }
+    return ext::ControlStatus::OK;
+}
+
+ext::ControlStatus Controller::unsubscribe_from_notifications(ext::NotificationType type, ext::ControlListener* listener)
+{
+    SUSHI_LOG_DEBUG("unsubscribe_from_notifications called with type {}", static_cast<int>(type));
+    int index = static_cast<int>(type);
+    if (index < 0 || index >= NOTIFICATION_TYPES)
+    {
+        return ext::ControlStatus::INVALID_ARGUMENTS;
+    }
+    std::lock_guard<std::mutex> lock(_listener_lock);
+    auto& listeners = _listeners[index];
+    auto listener_iter = std::find(listeners.begin(), listeners.end(), listener);
+    if (listener_iter == listeners.end())
+    {
+        return ext::ControlStatus::NOT_FOUND;
+    }
+    listeners.erase(listener_iter);
+    return ext::ControlStatus::OK;
+}
+
+int Controller::process(Event* event)
+{
+    if (event->is_parameter_change_notification())
+    {
+        auto typed_event = static_cast<ParameterChangeNotificationEvent*>(event);
+        auto mirror = _mirror();
+        auto processor = mirror->processors.find(typed_event->processor_id());
+        if (processor != mirror->processors.end())
+        {
+            auto index = processor->second.parameter_index.find(typed_event->parameter_id());
+            if (index != processor->second.parameter_index.end() && index->second.second >= 0)
+            {
+                mirror->values[index->second.second].store(typed_event->float_value(), std::memory_order_relaxed);
+            }
+        }
+        _notify_listeners(ext::ParameterChangeNotification(typed_event->processor_id(),
+                                                           typed_event->parameter_id(),
+                                                           typed_event->float_value(),
+                                                           typed_event->time()));
+        return EventStatus::HANDLED_OK;
+    }
+    if (event->is_engine_notification() == false)
+    {
+        return EventStatus::UNRECOGNIZED_EVENT;
+    }
+
+    auto engine_event = static_cast<EngineNotificationEvent*>(event);
+    if (engine_event->is_audio_graph_notification())
+    {
+        /* Rebuild the mirror here rather than in the first query after the change */
+        _mirror();
+        auto typed_event = static_cast<AudioGraphNotificationEvent*>(event);
+        switch (typed_event->action())
+        {
+            case AudioGraphNotificationEvent::Action::PROCESSOR_ADDED:
+                _notify_listeners(ext::ProcessorNotification(ext::ProcessorAction::ADDED, typed_event->processor(),
+                                                             typed_event->track(), typed_event->time()));
+                break;
+
+            case AudioGraphNotificationEvent::Action::PROCESSOR_DELETED:
+                _notify_listeners(ext::ProcessorNotification(ext::ProcessorAction::DELETED, typed_event->processor(),
+                                                             typed_event->track(), typed_event->time()));
+                break;
+
+            case AudioGraphNotificationEvent::Action::TRACK_ADDED:
+                _notify_listeners(ext::TrackNotification(ext::TrackAction::ADDED, typed_event->track(), typed_event->time()));
+                break;
+
+            case AudioGraphNotificationEvent::Action::TRACK_DELETED:
+                _notify_listeners(ext::TrackNotification(ext::TrackAction::DELETED, typed_event->track(), typed_event->time()));
+                break;
+        }
+    }
+    else if (engine_event->is_transport_notification())
+    {
+        auto typed_event = static_cast<TransportNotificationEvent*>(event);
+        switch (typed_event->action())
+        {
+            case TransportNotificationEvent::Action::TEMPO_CHANGED:
+                _notify_listeners(ext::TransportNotification(ext::TransportAction::TEMPO_CHANGED,
+                                                             typed_event->tempo(), typed_event->time()));
+                break;
+
+            case TransportNotificationEvent::Action::TIME_SIGNATURE_CHANGED:
+                _notify_listeners(ext::TransportNotification(ext::TransportAction::TIME_SIGNATURE_CHANGED,
+                                                             to_external(typed_event->time_signature()), typed_event->time()));
+                break;
+
+            case TransportNotificationEvent::Action::PLAYING_MODE_CHANGED:
+                _notify_listeners(ext::TransportNotification(ext::TransportAction::PLAYING_MODE_CHANGED,
+                                                             to_external(typed_event->playing_mode()), typed_event->time()));
+                break;
+
+            case TransportNotificationEvent::Action::SYNC_MODE_CHANGED:
+                _notify_listeners(ext::TransportNotification(ext::TransportAction::SYNC_MODE_CHANGED,
+                                                             to_external(typed_event->sync_mode()), typed_event->time()));
+                break;
+        }
+    }
+    else if (engine_event->is_clipping_notification())
+    {
+        auto typed_event = static_cast<ClippingNotificationEvent*>(event);
+        auto channel_type = typed_event->channel_type() == ClippingNotificationEvent::ClipChannelType::INPUT ?
+                            ext::ClippingChannelType::INPUT : ext::ClippingChannelType::OUTPUT;
+        _notify_listeners(ext::ClippingNotification(typed_event->channel(), channel_type, typed_event->time()));
+    }
+    return EventStatus::HANDLED_OK;
+}
+
+void Controller::_notify_listeners(const ext::ControlNotification& notification)
+{
+    std::lock_guard<std::mutex> lock(_listener_lock);
+    for (auto listener : _listeners[static_cast<int>(notification.type())])
+    {
+        listener->notification(&notification);
+    }
+}
+
+void Controller::notification_cycle_done()
+{
+    Time now = get_current_time();
+    if (now - _last_value_refresh > CONTROLLER_VALUE_REFRESH_INTERVAL)
+    {
+        _last_value_refresh = now;
+        _refresh_parameter_values(*_mirror());
+    }
+}
+
+std::shared_ptr<const Controller::EngineMirror> Controller::_mirror() const
+{
+    int generation = _engine->audio_graph_generation();
+    auto mirror = std::atomic_load(&_engine_mirror);
+    if (mirror != nullptr && mirror->generation == generation)
+    {
+        return mirror;
+    }
+    std::lock_guard<std::mutex> lock(_mirror_lock);
+    mirror = std::atomic_load(&_engine_mirror);
+    if (mirror == nullptr || mirror->generation != generation)
+    {
+        /* If the graph changes again while building, the generation read above
+         * is older than the new one and the next call will rebuild again */
+        mirror = _build_mirror(generation);
+        std::atomic_store(&_engine_mirror, mirror);
+    }
+    return mirror;
+}
+
+std::shared_ptr<const Controller::EngineMirror> Controller::_build_mirror(int generation) const
+{
+    SUSHI_LOG_DEBUG("Rebuilding engine mirror, generation {}", generation);
+    auto mirror = std::make_shared<EngineMirror>();
+    mirror->generation = generation;
+
+    std::vector<const Processor*> processors;
+    for (const auto& processor : _engine->all_processors())
+    {
+        processors.push_back(processor.second.get());
+    }
+    std::sort(processors.begin(), processors.end(), [](auto lhs, auto rhs) {return lhs->id() < rhs->id();});
+
+    std::vector<float> values;
+    for (auto processor : processors)
+    {
+        MirroredProcessor& entry = mirror->processors[processor->id()];
+        entry.info.id = processor->id();
+        entry.info.name = processor->name();
+        entry.info.label = processor->label();
+        entry.info.parameter_count = processor->parameter_count();
+        entry.info.program_count = processor->supports_programs()? processor->program_count() : 0;
+        for (const auto& descriptor : processor->all_parameters())
+        {
+            int slot = -1;
+            auto [status, value] = processor->parameter_value(descriptor->id());
+            if (status == ProcessorReturnCode::OK)
+            {
+                slot = static_cast<int>(values.size());
+                values.push_back(value);
+                mirror->value_ids.emplace_back(processor->id(), descriptor->id());
+            }
+            entry.parameter_index[descriptor->id()] = {static_cast<int>(entry.parameters.size()), slot};
+            entry.parameter_ids[descriptor->name()] = descriptor->id();
+            entry.parameters.push_back(to_external(descriptor));
+        }
+        mirror->processor_ids[processor->name()] = processor->id();
+    }
+    mirror->values = std::make_unique<std::atomic<float>[]>(values.size());
+    for (size_t slot = 0; slot < values.size(); ++slot)
+    {
+        mirror->values[slot].store(values[slot], std::memory_order_relaxed);
+    }
+
+    for (const auto& track : _engine->all_tracks())
+    {
+        ext::TrackInfo info;
+        info.id = track->id();
+        info.name = track->name();
+        info.label = track->label();
+        info.input_busses = track->input_busses();
+        info.input_channels = track->input_channels();
+        info.output_busses = track->output_busses();
+        info.output_channels = track->output_channels();
+        info.processor_count = static_cast<int>(track->process_chain().size());
+        mirror->track_index[track->id()] = static_cast<int>(mirror->tracks.size());
+        mirror->tracks.push_back(info);
+
+        auto& track_processors = mirror->track_processors[track->id()];
+        for (const auto& processor : track->process_chain())
+        {
+            auto entry = mirror->processors.find(processor->id());
+            if (entry != mirror->processors.end())
+            {
+                track_processors.push_back(entry->second.info);
+            }
+        }
+    }
+    return mirror;
+}
+
+void Controller::_refresh_parameter_values(const EngineMirror& mirror)
+{
+    const Processor* processor = nullptr;
+    for (size_t slot = 0; slot < mirror.value_ids.size(); ++slot)
+    {
+        const auto& [processor_id, parameter_id] = mirror.value_ids[slot];
+        if (processor == nullptr || processor->id() != processor_id)
+        {
+            processor = _engine->processor(processor_id);
+            if (processor == nullptr)
+            {
+                continue;
+            }
+        }
+        auto [status, value] = processor->parameter_value(parameter_id);
+        if (status == ProcessorReturnCode::OK)
+        {
+            mirror.values[slot].store(value, std::memory_order_relaxed);
+        }
+    }
+}
+
 std::pair<ext::ControlStatus, ext::CpuTimings> Controller::_get_timings(int node) const
 {
     if (_performance_timer->enabled())
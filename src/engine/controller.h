@@ -18,8 +18,16 @@
  * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "control_interface.h"
 #include "base_event_dispatcher.h"
+#include "library/event_interface.h"
 #include "transport.h"
 #include "library/base_performance_timer.h"
 
@@ -30,7 +38,11 @@ namespace sushi {
 
 namespace engine {class BaseEngine;}
 
-class Controller : public ext::SushiControl
+/* Parameter values are read back from the processors this often, to pick up
+ * changes that are not sent as notifications */
+constexpr auto CONTROLLER_VALUE_REFRESH_INTERVAL = std::chrono::milliseconds(50);
+
+class Controller : public ext::SushiControl, public EventPoster
 {
 public:
     Controller(engine::BaseEngine* engine);
@@ -89,14 +101,79 @@ public:
     ext::ControlStatus                                  set_parameter_value(int processor_id, int parameter_id, float value) override;
     ext::ControlStatus                                  set_parameter_value_normalised(int processor_id, int parameter_id, float value) override;
     ext::ControlStatus                                  set_string_property_value(int processor_id, int parameter_id, const std::string& value) override;
+    std::vector<ext::ParameterValue>                    get_all_parameter_values() const override;
+    ext::ControlStatus                                  set_parameter_values(const std::vector<ext::ParameterValue>& values) override;
+    ext::EngineSnapshot                                 get_engine_snapshot() const override;
+
+    ext::ControlStatus                                  subscribe_to_notifications(ext::NotificationType type, ext::ControlListener* listener) override;
+    ext::ControlStatus                                  unsubscribe_from_notifications(ext::NotificationType type, ext::ControlListener* listener) override;
+
+    /* Inherited from EventPoster, receives notifications from the event dispatcher
+     * and forwards them to the subscribed listeners */
+    int process(Event* event) override;
+
+    void notification_cycle_done() override;
+
+    int poster_id() override {return EventPosterId::CONTROLLER;}
 
 protected:
+    struct MirroredProcessor
+    {
+        ext::ProcessorInfo                              info;
+        std::vector<ext::ParameterInfo>                 parameters;
+        /* Index in parameters and slot in the value table, by parameter id.
+         * The slot is -1 for parameters that have no readable value */
+        std::unordered_map<ObjectId, std::pair<int, int>> parameter_index;
+        std::unordered_map<std::string, ObjectId>       parameter_ids;
+    };
+
+    /**
+     * @brief Copy of the tracks, processors and parameters of the engine that
+     *        queries are answered from, so that they never touch the live
+     *        objects of the engine. Rebuilt when the audio graph changes and
+     *        never modified after it is published, except for the parameter
+     *        values, which are atomics updated in place.
+     */
+    struct EngineMirror
+    {
+        int                                             generation;
+        std::vector<ext::TrackInfo>                     tracks;
+        std::unordered_map<ObjectId, int>               track_index;
+        std::unordered_map<ObjectId, std::vector<ext::ProcessorInfo>> track_processors;
+        std::unordered_map<ObjectId, MirroredProcessor> processors;
+        std::unordered_map<std::string, ObjectId>       processor_ids;
+        /* Processor and parameter id of every slot in the value table, sorted by processor */
+        std::vector<std::pair<ObjectId, ObjectId>>      value_ids;
+        std::unique_ptr<std::atomic<float>[]>           values;
+    };
+
+    /**
+     * @brief Get the current mirror of the engine, rebuilding it first if the
+     *        audio graph has changed since it was built. Safe to call from any thread.
+     */
+    std::shared_ptr<const EngineMirror> _mirror() const;
+
+    std::shared_ptr<const EngineMirror> _build_mirror(int generation) const;
+
+    void _refresh_parameter_values(const EngineMirror& mirror);
+
     std::pair<ext::ControlStatus, ext::CpuTimings> _get_timings(int node) const;
 
+    void _notify_listeners(const ext::ControlNotification& notification);
+
     engine::BaseEngine*                 _engine;
     dispatcher::BaseEventDispatcher*    _event_dispatcher;
     engine::Transport*                  _transport;
     performance::BasePerformanceTimer*  _performance_timer;
+
+    static constexpr int NOTIFICATION_TYPES = static_cast<int>(ext::NotificationType::CLIPPING) + 1;
+    std::array<std::vector<ext::ControlListener*>, NOTIFICATION_TYPES> _listeners;
+    std::mutex                          _listener_lock;
+
+    /* Published with atomic loads and stores, rebuilds are serialised by _mirror_lock */
+    mutable std::shared_ptr<const EngineMirror> _engine_mirror;
+    mutable std::mutex                  _mirror_lock;
+    Time                                _last_value_refresh{IMMEDIATE_PROCESS};
 };
 
 } //namespace sushi
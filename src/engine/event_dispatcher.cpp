@@ -18,6 +18,8 @@
  * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <algorithm>
+
 #include "event_dispatcher.h"
 #include "engine/base_engine.h"
 #include "logging.h"
@@ -115,30 +117,82 @@ int EventDispatcher::process(Event* event)
     if (event->maps_to_rt_event())
     {
         auto [send_now, sample_offset] = _event_timer.sample_offset_from_realtime(event->time());
-        if (send_now)
+        if (send_now == false)
         {
-            if (_out_rt_queue->push(event->to_rt_event(sample_offset)))
-            {
-                return EventStatus::HANDLED_OK;
-            }
+            _scheduled_events.emplace(event->time(), event);
+            return EventStatus::QUEUED_HANDLING;
+        }
+        /* Events wait behind earlier ones that didn't fit in the rt queue, so that
+         * a retried event never overwrites a newer change of the same parameter */
+        if (_waiting_list.empty() && _out_rt_queue->push(event->to_rt_event(sample_offset)))
+        {
+            return EventStatus::HANDLED_OK;
         }
         _waiting_list.push_front(event);
         return EventStatus::QUEUED_HANDLING;
     }
+    if (event->is_parameter_change_batch())
+    {
+        return _process_parameter_change_batch(static_cast<ParameterChangeBatchEvent*>(event));
+    }
     if (event->is_parameter_change_notification())
     {
         _publish_parameter_events(event);
         return EventStatus::HANDLED_OK;
     }
+    if (event->is_engine_notification())
+    {
+        _publish_engine_notification_events(event);
+        return EventStatus::HANDLED_OK;
+    }
     return EventStatus::UNRECOGNIZED_EVENT;
 }
 
+int EventDispatcher::_process_parameter_change_batch(ParameterChangeBatchEvent* event)
+{
+    auto [send_now, sample_offset] = _event_timer.sample_offset_from_realtime(event->time());
+    if (send_now == false)
+    {
+        _scheduled_events.emplace(event->time(), event);
+        return EventStatus::QUEUED_HANDLING;
+    }
+    if (_waiting_list.empty() == false)
+    {
+        _waiting_list.push_front(event);
+        return EventStatus::QUEUED_HANDLING;
+    }
+    const auto& values = event->values();
+    size_t index = event->sent_count();
+    for (; index < values.size(); ++index)
+    {
+        const auto& value = values[index];
+        if (_out_rt_queue->push(RtEvent::make_parameter_change_event(value.processor_id, sample_offset,
+                                                                     value.parameter_id, value.value)) == false)
+        {
+            break;
+        }
+    }
+    event->set_sent_count(index);
+    if (index == values.size())
+    {
+        return EventStatus::HANDLED_OK;
+    }
+    /* The rt queue is full, send the remaining values in the next cycle */
+    _waiting_list.push_front(event);
+    return EventStatus::QUEUED_HANDLING;
+}
+
 void EventDispatcher::_event_loop()
 {
     do
     {
         auto start_time = std::chrono::system_clock::now();
 
+        /* Events that could not be handled in the last cycle are retried once
+         * per cycle, before any new events, to not spin on a full rt queue */
+        _retry_list.swap(_waiting_list);
+        _retry_due_events();
+
         /* Handle incoming Events */
         while (Event* event = _next_event())
         {
@@ -167,6 +221,7 @@ void EventDispatcher::_event_loop()
             _in_rt_queue->pop(rt_event);
             _process_rt_event(rt_event);
         }
+        _publish_notification_cycle_done();
         std::this_thread::sleep_until(start_time + THREAD_PERIODICITY);
     }
     while (_running);
@@ -211,13 +266,24 @@ int EventDispatcher::_process_rt_event(RtEvent &rt_event)
     return EventStatus::HANDLED_OK;
 }
 
+void EventDispatcher::_retry_due_events()
+{
+    /* Scheduled events are sorted by time, so only the first ones need to be checked */
+    auto event = _scheduled_events.begin();
+    while (event != _scheduled_events.end() && _event_timer.sample_offset_from_realtime(event->first).first)
+    {
+        _retry_list.push_front(event->second);
+        event = _scheduled_events.erase(event);
+    }
+}
+
 Event*EventDispatcher::_next_event()
 {
     Event* event = nullptr;
-    if (!_waiting_list.empty())
+    if (!_retry_list.empty())
     {
-        event = _waiting_list.back();
-        _waiting_list.pop_back();
+        event = _retry_list.back();
+        _retry_list.pop_back();
     }
     else if (!_in_queue.empty())
     {
@@ -250,6 +316,22 @@ void EventDispatcher::_publish_engine_notification_events(sushi::Event*event)
     }
 }
 
+void EventDispatcher::_publish_notification_cycle_done()
+{
+    for (auto& listener : _parameter_change_listeners)
+    {
+        listener->notification_cycle_done();
+    }
+    for (auto& listener : _engine_notification_listeners)
+    {
+        /* Listeners subscribing to both types of notifications are only called once */
+        if (std::find(_parameter_change_listeners.begin(), _parameter_change_listeners.end(), listener) == _parameter_change_listeners.end())
+        {
+            listener->notification_cycle_done();
+        }
+    }
+}
+
 EventDispatcherStatus EventDispatcher::deregister_poster(EventPoster* poster)
 {
     if (_posters[poster->poster_id()] != nullptr)
@@ -22,6 +22,7 @@
 #define SUSHI_EVENT_DISPATCHER_H
 
 #include <deque>
+#include <map>
 #include <vector>
 #include <thread>
 
@@ -105,11 +106,16 @@ private:
 
     int _process_rt_event(RtEvent& rt_event);
 
+    int _process_parameter_change_batch(ParameterChangeBatchEvent* event);
+
+    void _retry_due_events();
+
     Event* _next_event();
 
     void _publish_keyboard_events(Event* event);
     void _publish_parameter_events(Event* event);
     void _publish_engine_notification_events(Event* event);
+    void _publish_notification_cycle_done();
 
     std::atomic<bool>           _running;
     std::thread                 _event_thread;
@@ -120,6 +126,8 @@ private:
     RtSafeRtEventFifo*          _in_rt_queue;
     RtSafeRtEventFifo*          _out_rt_queue;
     std::deque<Event*>          _waiting_list;
+    std::deque<Event*>          _retry_list;
+    std::multimap<Time, Event*> _scheduled_events;
 
     Worker                      _worker;
     event_timer::EventTimer     _event_timer;
@@ -36,11 +36,21 @@ public:
 
     void post_event(Event* event) {_event_dispatcher->post_event(event);}
 
-    const engine::Transport* transport() {return _transport;}
+    const engine::Transport* transport() {return _thread_transport ? _thread_transport : _transport;}
+
+    /**
+     * @brief Make transport() return another transport for calls from the current
+     *        thread. Used by the engine when tracks render several chunks ahead on
+     *        their own, so that each chunk sees the transport state of its own time.
+     * @param transport The transport to use, or nullptr to go back to the engine's
+     */
+    static void set_thread_transport(const engine::Transport* transport) {_thread_transport = transport;}
 
 protected:
     dispatcher::BaseEventDispatcher* _event_dispatcher;
     engine::Transport*               _transport;
+
+    inline static thread_local const engine::Transport* _thread_transport{nullptr};
 };
 
 } // end namespace sushi
@@ -18,7 +18,14 @@
  * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <array>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <string_view>
+
+#include <unistd.h>
 
 #include "rapidjson/error/en.h"
 #include "rapidjson/stringbuffer.h"
@@ -36,6 +43,211 @@ using namespace midi_dispatcher;
 SUSHI_GET_LOGGER_WITH_MODULE_NAME("jsonconfig");
 
 constexpr int ERROR_DISPLAY_CHARS = 50;
+/* Returned from _parse_section() when there is no document to refer to */
+const rapidjson::Value EMPTY_JSON_VALUE;
+constexpr int SECTION_COUNT = static_cast<int>(JsonSection::EVENTS) + 1;
+
+/* Where the sections of already validated config files are recorded, empty if disabled */
+static std::string validation_cache_directory;
+
+constexpr uint32_t VALIDATION_FILE_MAGIC = 0x56535553; // "SUSV"
+constexpr uint32_t VALIDATION_FILE_VERSION = 1;
+constexpr uint32_t ALL_SECTIONS = (1u << SECTION_COUNT) - 1;
+
+/* Header of the validation cache files, followed by the path of the config file.
+ * All fields must match the loaded config file for the sections to be trusted. */
+struct ValidationFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t content_size;
+    uint64_t content_hash;
+    uint64_t schema_hash;
+    uint32_t sections;
+    uint32_t path_size;
+};
+
+/* In-situ parsing makes the strings of the document point into the file buffer,
+ * so both are kept in one allocation that the returned document aliases */
+struct InsituDocument
+{
+    std::vector<char> buffer;
+    rapidjson::Document document;
+};
+
+inline const char* schema_text(JsonSection section)
+{
+    switch(section)
+    {
+        case JsonSection::HOST_CONFIG:
+            return
+                #include "json_schemas/host_config_schema.json"
+                                                              ;
+        case JsonSection::TRACKS:
+            return
+                #include "json_schemas/tracks_schema.json"
+                                                        ;
+        case JsonSection::MIDI:
+            return
+                #include "json_schemas/midi_schema.json"
+                                                       ;
+        case JsonSection::CV_GATE:
+            return
+                #include "json_schemas/cv_gate_schema.json"
+                                                         ;
+        case JsonSection::EVENTS:
+        default:
+            return
+                #include "json_schemas/events_schema.json"
+                                                        ;
+    }
+}
+
+/* Schemas are compiled on first use and shared by all configurators, a
+ * SchemaDocument is immutable and can be used from several threads */
+inline const rapidjson::SchemaDocument& compiled_schema(JsonSection section)
+{
+    static const auto schemas = []()
+    {
+        std::array<std::unique_ptr<rapidjson::SchemaDocument>, SECTION_COUNT> compiled;
+        for (int i = 0; i < SECTION_COUNT; ++i)
+        {
+            rapidjson::Document schema;
+            schema.Parse(schema_text(static_cast<JsonSection>(i)));
+            compiled[i] = std::make_unique<rapidjson::SchemaDocument>(schema);
+        }
+        return compiled;
+    }();
+    return *schemas[static_cast<int>(section)];
+}
+
+inline std::pair<JsonConfigReturnStatus, std::shared_ptr<const rapidjson::Document>> parse_config_file(const std::string& path,
+                                                                                                      uint64_t& content_size,
+                                                                                                      uint64_t& content_hash)
+{
+    std::ifstream config_file(path, std::ios::binary);
+    if(!config_file.good())
+    {
+        SUSHI_LOG_ERROR("Invalid file passed to JsonConfigurator {}", path);
+        return {JsonConfigReturnStatus::INVALID_FILE, nullptr};
+    }
+    auto parsed = std::make_shared<InsituDocument>();
+    parsed->buffer.assign(std::istreambuf_iterator<char>(config_file), std::istreambuf_iterator<char>());
+    content_size = parsed->buffer.size();
+    content_hash = std::hash<std::string_view>()(std::string_view(parsed->buffer.data(), parsed->buffer.size()));
+    parsed->buffer.push_back('\0');
+    parsed->document.ParseInsitu(parsed->buffer.data());
+    if(parsed->document.HasParseError())
+    {
+        /* The buffer was modified by the parser, so the error context is read again */
+        std::ifstream original_file(path);
+        std::string config_file_contents((std::istreambuf_iterator<char>(original_file)), std::istreambuf_iterator<char>());
+        [[maybe_unused]] int err_offset = parsed->document.GetErrorOffset();
+        SUSHI_LOG_ERROR("Error parsing JSON config file: {} @ pos {}: \"{}\"",
+                       rapidjson::GetParseError_En(parsed->document.GetParseError()),
+                       err_offset,
+                       config_file_contents.substr(std::max(0, err_offset - ERROR_DISPLAY_CHARS), ERROR_DISPLAY_CHARS)        );
+        return {JsonConfigReturnStatus::INVALID_FILE, nullptr};
+    }
+    return {JsonConfigReturnStatus::OK, std::shared_ptr<const rapidjson::Document>(parsed, &parsed->document)};
+}
+
+/* The schemas are part of the key so that files validated by another version are validated again */
+inline uint64_t schema_hash()
+{
+    static const uint64_t hash = []()
+    {
+        std::string schemas;
+        for (int i = 0; i < SECTION_COUNT; ++i)
+        {
+            schemas += schema_text(static_cast<JsonSection>(i));
+        }
+        return std::hash<std::string>()(schemas);
+    }();
+    return hash;
+}
+
+inline std::string canonical_path(const std::string& path)
+{
+    char resolved[PATH_MAX];
+    return realpath(path.c_str(), resolved) != nullptr ? std::string(resolved) : path;
+}
+
+inline std::string validation_file_name(const std::string& path, uint64_t content_hash)
+{
+    auto hash = std::hash<std::string>()(path + ":" + std::to_string(content_hash) + ":" + std::to_string(schema_hash()));
+    char name[32];
+    snprintf(name, sizeof(name), "%016zx.valid", hash);
+    return validation_cache_directory + "/" + name;
+}
+
+/* Returns the validated sections recorded in file_name, or 0 if the file
+ * is missing or was written for another config file or schema version */
+inline uint32_t read_validated_sections(const std::string& file_name, const std::string& path,
+                                        uint64_t content_size, uint64_t content_hash)
+{
+    FILE* file = fopen(file_name.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return 0;
+    }
+    ValidationFileHeader header;
+    std::string recorded_path;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              header.magic == VALIDATION_FILE_MAGIC &&
+              header.version == VALIDATION_FILE_VERSION &&
+              header.path_size == path.size();
+    if (ok)
+    {
+        recorded_path.resize(header.path_size);
+        ok = fread(recorded_path.data(), 1, recorded_path.size(), file) == recorded_path.size();
+    }
+    fclose(file);
+    if (ok == false || recorded_path != path || header.content_size != content_size ||
+        header.content_hash != content_hash || header.schema_hash != schema_hash())
+    {
+        return 0;
+    }
+    return header.sections;
+}
+
+inline void write_validated_sections(const std::string& file_name, const std::string& path,
+                                     uint64_t content_size, uint64_t content_hash, uint32_t sections)
+{
+    ValidationFileHeader header{VALIDATION_FILE_MAGIC, VALIDATION_FILE_VERSION, content_size, content_hash,
+                                schema_hash(), sections, static_cast<uint32_t>(path.size())};
+    /* A unique temporary file, as several processes may validate the same config */
+    std::string temp_file = file_name + ".XXXXXX";
+    int fd = mkstemp(temp_file.data());
+    FILE* file = fd < 0 ? nullptr : fdopen(fd, "wb");
+    if (file == nullptr)
+    {
+        SUSHI_LOG_WARNING("Failed to create validation cache file {}", temp_file);
+        if (fd >= 0)
+        {
+            close(fd);
+            remove(temp_file.c_str());
+        }
+        return;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(path.data(), 1, path.size(), file) == path.size();
+    ok = (fclose(file) == 0) && ok;
+    if (ok == false || rename(temp_file.c_str(), file_name.c_str()) != 0)
+    {
+        SUSHI_LOG_WARNING("Failed to write validation cache file {}", file_name);
+        remove(temp_file.c_str());
+    }
+}
+
+JsonConfigurator::~JsonConfigurator()
+{
+    /* Sections validated since the cache file was read, if not all of them were */
+    if (_validation_file.empty() == false && _validated_sections != _recorded_sections)
+    {
+        write_validated_sections(_validation_file, _validation_path, _content_size, _content_hash, _validated_sections);
+    }
+}
 
 std::pair<JsonConfigReturnStatus, AudioConfig> JsonConfigurator::load_audio_config()
 {
@@ -142,6 +354,12 @@ JsonConfigReturnStatus JsonConfigurator::load_host_config()
         }
     }
 
+    if (host_config.HasMember("metering"))
+    {
+        _engine->enable_metering(host_config["metering"].GetBool());
+        SUSHI_LOG_INFO("Setting engine metering {}", host_config["metering"].GetBool() ? "enabled" : "disabled");
+    }
+
     return JsonConfigReturnStatus::OK;
 }
 
@@ -429,64 +647,83 @@ JsonConfigurator::load_event_list()
 
 std::pair<JsonConfigReturnStatus, const rapidjson::Value&> JsonConfigurator::_parse_section(JsonSection section)
 {
-    if (_json_data.IsObject() == false)
+    if (_json_data == nullptr)
     {
-        auto res = _load_data();
+        auto [res, document] = parse_config_file(_document_path, _content_size, _content_hash);
         if (res != JsonConfigReturnStatus::OK)
         {
-            return {res, _json_data};
+            return {res, EMPTY_JSON_VALUE};
+        }
+        _json_data = std::move(document);
+        if (validation_cache_directory.empty() == false)
+        {
+            _validation_path = canonical_path(_document_path);
+            _validation_file = validation_file_name(_validation_path, _content_hash);
+            _validated_sections = read_validated_sections(_validation_file, _validation_path, _content_size, _content_hash);
+            _recorded_sections = _validated_sections;
         }
     }
-    if(_validate_against_schema(_json_data, section) == false)
+    const rapidjson::Document& json_data = *_json_data;
+    uint32_t section_flag = 1u << static_cast<int>(section);
+    if ((_validated_sections & section_flag) == 0)
     {
-        SUSHI_LOG_ERROR("Config file {} does not follow schema: {}", _document_path, (int)section);
-        return {JsonConfigReturnStatus::INVALID_CONFIGURATION, _json_data};
+        if(_validate_against_schema(json_data, section) == false)
+        {
+            SUSHI_LOG_ERROR("Config file {} does not follow schema: {}", _document_path, (int)section);
+            return {JsonConfigReturnStatus::INVALID_CONFIGURATION, json_data};
+        }
+        _validated_sections |= section_flag;
+        if (_validation_file.empty() == false && _validated_sections == ALL_SECTIONS)
+        {
+            write_validated_sections(_validation_file, _validation_path, _content_size, _content_hash, _validated_sections);
+            _recorded_sections = _validated_sections;
+        }
     }
 
     switch(section)
     {
         case JsonSection::HOST_CONFIG:
-            if(_json_data.HasMember("host_config") == false)
+            if(json_data.HasMember("host_config") == false)
             {
                 SUSHI_LOG_INFO("Config file does not have any Host Config definitions");
-                return {JsonConfigReturnStatus::NO_MIDI_DEFINITIONS, _json_data};
+                return {JsonConfigReturnStatus::NO_MIDI_DEFINITIONS, json_data};
             }
-            return {JsonConfigReturnStatus::OK, _json_data["host_config"]};
+            return {JsonConfigReturnStatus::OK, json_data["host_config"]};
 
         case JsonSection::TRACKS:
-            if(_json_data.HasMember("tracks") == false)
+            if(json_data.HasMember("tracks") == false)
             {
                 SUSHI_LOG_INFO("Config file does not have any Track definitions");
-                return {JsonConfigReturnStatus::NO_MIDI_DEFINITIONS, _json_data};
+                return {JsonConfigReturnStatus::NO_MIDI_DEFINITIONS, json_data};
             }
-            return {JsonConfigReturnStatus::OK, _json_data["tracks"]};
+            return {JsonConfigReturnStatus::OK, json_data["tracks"]};
 
         case JsonSection::MIDI:
-            if(_json_data.HasMember("midi") == false)
+            if(json_data.HasMember("midi") == false)
             {
                 SUSHI_LOG_INFO("Config file does not have MIDI definitions");
-                return {JsonConfigReturnStatus::NO_MIDI_DEFINITIONS, _json_data};
+                return {JsonConfigReturnStatus::NO_MIDI_DEFINITIONS, json_data};
             }
-            return {JsonConfigReturnStatus::OK, _json_data["midi"]};
+            return {JsonConfigReturnStatus::OK, json_data["midi"]};
 
         case JsonSection::CV_GATE:
-            if(_json_data.HasMember("cv_control") == false)
+            if(json_data.HasMember("cv_control") == false)
             {
                 SUSHI_LOG_INFO("Config file does not have CV/Gate definitions");
-                return {JsonConfigReturnStatus::NO_CV_GATE_DEFINITIONS, _json_data};
+                return {JsonConfigReturnStatus::NO_CV_GATE_DEFINITIONS, json_data};
             }
-            return {JsonConfigReturnStatus::OK, _json_data["cv_control"]};
+            return {JsonConfigReturnStatus::OK, json_data["cv_control"]};
 
         case JsonSection::EVENTS:
-            if(_json_data.HasMember("events") == false)
+            if(json_data.HasMember("events") == false)
             {
                 SUSHI_LOG_INFO("Config file does not have any Event definitions");
-                return {JsonConfigReturnStatus::NO_EVENTS_DEFINITIONS, _json_data};
+                return {JsonConfigReturnStatus::NO_EVENTS_DEFINITIONS, json_data};
             }
-            return {JsonConfigReturnStatus::OK, _json_data["events"]};
+            return {JsonConfigReturnStatus::OK, json_data["events"]};
 
         default:
-            return {JsonConfigReturnStatus::INVALID_CONFIGURATION, _json_data};
+            return {JsonConfigReturnStatus::INVALID_CONFIGURATION, json_data};
     }
 }
 
@@ -673,45 +910,9 @@ Event* JsonConfigurator::_parse_event(const rapidjson::Value& json_event, bool w
     return nullptr;
 }
 
-bool JsonConfigurator::_validate_against_schema(rapidjson::Value& config, JsonSection section)
+bool JsonConfigurator::_validate_against_schema(const rapidjson::Value& config, JsonSection section)
 {
-    const char* schema_char_array = nullptr;
-    switch(section)
-    {
-        case JsonSection::HOST_CONFIG:
-            schema_char_array =
-                #include "json_schemas/host_config_schema.json"
-                                                              ;
-            break;
-
-        case JsonSection::TRACKS:
-            schema_char_array =
-                #include "json_schemas/tracks_schema.json"
-                                                        ;
-            break;
-
-        case JsonSection::MIDI:
-            schema_char_array =
-                #include "json_schemas/midi_schema.json"
-                                                       ;
-            break;
-
-        case JsonSection::CV_GATE:
-            schema_char_array =
-                #include "json_schemas/cv_gate_schema.json"
-                                                         ;
-            break;
-
-        case JsonSection::EVENTS:
-            schema_char_array =
-                #include "json_schemas/events_schema.json"
-                                                        ;
-    }
-
-    rapidjson::Document schema;
-    schema.Parse(schema_char_array);
-    rapidjson::SchemaDocument schema_document(schema);
-    rapidjson::SchemaValidator schema_validator(schema_document);
+    rapidjson::SchemaValidator schema_validator(compiled_schema(section));
 
     // Validate Schema
     if (!config.Accept(schema_validator))
@@ -729,27 +930,16 @@ bool JsonConfigurator::_validate_against_schema(rapidjson::Value& config, JsonSe
     return true;
 }
 
-JsonConfigReturnStatus JsonConfigurator::_load_data()
+std::pair<JsonConfigReturnStatus, std::shared_ptr<const rapidjson::Document>> JsonConfigurator::parse_file(const std::string& path)
 {
-    std::ifstream config_file(_document_path);
-    if(!config_file.good())
-    {
-        SUSHI_LOG_ERROR("Invalid file passed to JsonConfigurator {}", _document_path);
-        return JsonConfigReturnStatus::INVALID_FILE;
-    }
-    //iterate through every char in file and store in the string
-    std::string config_file_contents((std::istreambuf_iterator<char>(config_file)), std::istreambuf_iterator<char>());
-    _json_data.Parse(config_file_contents.c_str());
-    if(_json_data.HasParseError())
-    {
-        [[maybe_unused]] int err_offset = _json_data.GetErrorOffset();
-        SUSHI_LOG_ERROR("Error parsing JSON config file: {} @ pos {}: \"{}\"",
-                       rapidjson::GetParseError_En(_json_data.GetParseError()),
-                       err_offset,
-                       config_file_contents.substr(std::max(0, err_offset - ERROR_DISPLAY_CHARS), ERROR_DISPLAY_CHARS)        );
-        return JsonConfigReturnStatus::INVALID_FILE;
-    }
-    return JsonConfigReturnStatus::OK;
+    uint64_t content_size;
+    uint64_t content_hash;
+    return parse_config_file(path, content_size, content_hash);
+}
+
+void JsonConfigurator::set_validation_cache_directory(const std::string& directory)
+{
+    validation_cache_directory = directory;
 }
 
 } // namespace jsonconfig
@@ -25,6 +25,7 @@
 #ifndef SUSHI_CONFIG_FROM_JSON_H
 #define SUSHI_CONFIG_FROM_JSON_H
 
+#include <memory>
 #include <optional>
 
 #include "rapidjson/document.h"
@@ -74,7 +75,22 @@ public:
                                                 _midi_dispatcher(midi_dispatcher),
                                                 _document_path(path){}
 
-    ~JsonConfigurator() {}
+    /**
+     * @brief Create a configurator that reads from an already parsed config file instead
+     *        of reading and parsing the file again. The document is only read, so the same
+     *        document can be used by several configurators concurrently.
+     * @param document A document returned from parse_file()
+     * @param path The path the document was read from, only used for logging
+     */
+    JsonConfigurator(engine::BaseEngine* engine,
+                     midi_dispatcher::MidiDispatcher* midi_dispatcher,
+                     std::shared_ptr<const rapidjson::Document> document,
+                     const std::string& path) : _engine(engine),
+                                                _midi_dispatcher(midi_dispatcher),
+                                                _document_path(path),
+                                                _json_data(std::move(document)){}
+
+    ~JsonConfigurator();
 
     /**
      * @brief Reads the json config  and returns all audio frontend configuration options
@@ -127,6 +143,25 @@ public:
      */
     std::pair<JsonConfigReturnStatus, std::vector<Event*>> load_event_list();
 
+    /**
+     * @brief Reads and parses a json config file without validating or applying it
+     * @param path String which denotes the path of the file.
+     * @return A tuple of status and the parsed document, the document is only valid if
+     *         status is JsonConfigReturnStatus::OK
+     */
+    static std::pair<JsonConfigReturnStatus, std::shared_ptr<const rapidjson::Document>> parse_file(const std::string& path);
+
+    /**
+     * @brief Record which sections of a config file have passed schema validation in a
+     *        directory, together with the path, size and hash of the file, and skip
+     *        validating them when the same file is loaded again. The record is written
+     *        once all sections are validated, or when the configurator is destroyed.
+     *        Only applies to configurators created from a path.
+     *        Not thread safe, call before loading any config file.
+     * @param directory An existing, writable directory. An empty string disables the cache.
+     */
+    static void set_validation_cache_directory(const std::string& directory);
+
 private:
     /**
      * @brief Helper function to retrieve a particular section of the json configuration
@@ -171,15 +206,22 @@ private:
      * @param section JsonSection to denote which json section is to be validated.
      * @return true if json follows schema, false otherwise
      */
-    bool _validate_against_schema(rapidjson::Value& config, JsonSection section);
-
-    JsonConfigReturnStatus _load_data();
+    bool _validate_against_schema(const rapidjson::Value& config, JsonSection section);
 
     engine::BaseEngine* _engine;
     midi_dispatcher::MidiDispatcher* _midi_dispatcher;
 
     std::string _document_path;
-    rapidjson::Document _json_data;
+    /* Parsed on first use unless passed in the constructor */
+    std::shared_ptr<const rapidjson::Document> _json_data;
+    /* Bit i is set when JsonSection i of _json_data has passed validation */
+    uint32_t _validated_sections{0};
+    /* The sections in _validation_file when it was last read or written */
+    uint32_t _recorded_sections{0};
+    std::string _validation_file;
+    std::string _validation_path;
+    uint64_t _content_size{0};
+    uint64_t _content_hash{0};
 };
 
 }/* namespace JSONCONFIG */
@@ -0,0 +1,259 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Engine level metering of engine inputs, outputs and track outputs
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "engine/meter_service.h"
+
+namespace sushi {
+namespace engine {
+
+constexpr ObjectId NO_TRACK = std::numeric_limits<ObjectId>::max();
+/* Samples of the signal before the interpolated point used by the true peak filter */
+constexpr int TRUE_PEAK_DELAY = TRUE_PEAK_TAPS / 2 - 1;
+
+/* The metering loops keep 4 independent accumulators so that the compiler can
+ * vectorise them without having to reorder floating point operations */
+inline float max_abs(const float* data, int samples)
+{
+    float max[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < samples; i += 4)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            max[lane] = std::max(max[lane], std::abs(data[i + lane]));
+        }
+    }
+    return std::max(std::max(max[0], max[1]), std::max(max[2], max[3]));
+}
+
+inline float sum_of_squares(const float* data, int samples)
+{
+    float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < samples; i += 4)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            sum[lane] += data[i + lane] * data[i + lane];
+        }
+    }
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+inline void set_level(ChannelLevel& level, float peak, float mean_square, float true_peak)
+{
+    level.peak = peak;
+    level.rms = std::sqrt(mean_square);
+    level.true_peak = true_peak;
+}
+
+MeterService::MeterService(float sample_rate)
+{
+    static_assert(AUDIO_CHUNK_SIZE % 4 == 0);
+    /* Hann windowed sinc interpolators for fractional positions 1/4, 2/4 and 3/4
+     * between two samples, normalised to unity gain at dc */
+    for (int phase = 0; phase < TRUE_PEAK_OVERSAMPLING - 1; ++phase)
+    {
+        float fraction = static_cast<float>(phase + 1) / TRUE_PEAK_OVERSAMPLING;
+        float sum = 0.0f;
+        for (int tap = 0; tap < TRUE_PEAK_TAPS; ++tap)
+        {
+            float t = static_cast<float>(tap - TRUE_PEAK_DELAY) - fraction;
+            float sinc = std::sin(static_cast<float>(M_PI) * t) / (static_cast<float>(M_PI) * t);
+            float window = 0.5f + 0.5f * std::cos(static_cast<float>(M_PI) * t / (TRUE_PEAK_TAPS / 2));
+            _phases[phase][tap] = sinc * window;
+            sum += sinc * window;
+        }
+        for (auto& coeff : _phases[phase])
+        {
+            coeff /= sum;
+        }
+    }
+    _track_ids.fill(NO_TRACK);
+    this->set_sample_rate(sample_rate);
+}
+
+void MeterService::set_sample_rate(float sample_rate)
+{
+    float chunks_per_second = sample_rate / AUDIO_CHUNK_SIZE;
+    _peak_decay = std::exp(-1.0f / (METER_PEAK_DECAY_TIME * chunks_per_second));
+    _rms_coeff = 1.0f - std::exp(-1.0f / (METER_RMS_TIME * chunks_per_second));
+    _publish_interval = static_cast<int>(sample_rate * std::chrono::duration<float>(METER_PUBLISH_INTERVAL).count());
+}
+
+void MeterService::set_input_channels(int channels)
+{
+    _input_channels = std::min(channels, MAX_METERED_CHANNELS);
+    _input_states.fill(ChannelState());
+}
+
+void MeterService::set_output_channels(int channels)
+{
+    _output_channels = std::min(channels, MAX_METERED_CHANNELS);
+    _output_states.fill(ChannelState());
+}
+
+void MeterService::process_inputs(const ChunkSampleBuffer& buffer)
+{
+    int channels = std::min(_input_channels, buffer.channel_count());
+    for (int c = 0; c < channels; ++c)
+    {
+        _process_channel(buffer.channel(c), _input_states[c]);
+    }
+}
+
+void MeterService::process_track(int index, Track& track)
+{
+    if (index >= MAX_METERED_TRACKS)
+    {
+        return;
+    }
+    if (_track_ids[index] != track.id())
+    {
+        _reset_track(index, track.id());
+    }
+    int channels = std::min(track.output_channels(), TRACK_MAX_CHANNELS);
+    _track_channels[index] = channels;
+    for (int c = 0; c < channels; ++c)
+    {
+        _process_channel(track.output_channel(c).channel(0), _track_states[index][c]);
+    }
+}
+
+void MeterService::process_outputs(const ChunkSampleBuffer& buffer, int tracks, Time timestamp)
+{
+    int channels = std::min(_output_channels, buffer.channel_count());
+    for (int c = 0; c < channels; ++c)
+    {
+        _process_channel(buffer.channel(c), _output_states[c]);
+    }
+    /* Forget tracks that have been removed, so they are reset if a track is added in their place */
+    for (int i = tracks; i < MAX_METERED_TRACKS && _track_ids[i] != NO_TRACK; ++i)
+    {
+        _track_ids[i] = NO_TRACK;
+    }
+
+    _samples_since_publish += AUDIO_CHUNK_SIZE;
+    if (_samples_since_publish >= _publish_interval)
+    {
+        _samples_since_publish = 0;
+        _publish(timestamp);
+    }
+}
+
+void MeterService::snapshot(MeterSnapshot& snapshot) const
+{
+    while (true)
+    {
+        unsigned int sequence = _sequence.load(std::memory_order_acquire);
+        if (sequence & 1u)
+        {
+            continue;
+        }
+        snapshot = _snapshot;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) == sequence)
+        {
+            return;
+        }
+    }
+}
+
+void MeterService::_process_channel(const float* samples, ChannelState& state)
+{
+    float peak = max_abs(samples, AUDIO_CHUNK_SIZE);
+    float mean_square = sum_of_squares(samples, AUDIO_CHUNK_SIZE) / AUDIO_CHUNK_SIZE;
+
+    /* The interpolated samples are delayed by TRUE_PEAK_DELAY samples, hence
+     * the history from the previous chunk is needed */
+    std::array<float, TRUE_PEAK_TAPS - 1 + AUDIO_CHUNK_SIZE> signal;
+    std::copy(state.history.begin(), state.history.end(), signal.begin());
+    std::copy(samples, samples + AUDIO_CHUNK_SIZE, signal.begin() + state.history.size());
+    std::copy(signal.end() - state.history.size(), signal.end(), state.history.begin());
+
+    float true_peak = peak;
+    std::array<float, AUDIO_CHUNK_SIZE> interpolated;
+    for (const auto& coeffs : _phases)
+    {
+        for (int n = 0; n < AUDIO_CHUNK_SIZE; ++n)
+        {
+            float sum = 0.0f;
+            for (int tap = 0; tap < TRUE_PEAK_TAPS; ++tap)
+            {
+                sum += coeffs[tap] * signal[n + tap];
+            }
+            interpolated[n] = sum;
+        }
+        true_peak = std::max(true_peak, max_abs(interpolated.data(), AUDIO_CHUNK_SIZE));
+    }
+
+    state.peak = std::max(peak, state.peak * _peak_decay);
+    state.true_peak = std::max(true_peak, state.true_peak * _peak_decay);
+    state.mean_square += _rms_coeff * (mean_square - state.mean_square);
+}
+
+void MeterService::_reset_track(int index, ObjectId id)
+{
+    _track_ids[index] = id;
+    _track_states[index].fill(ChannelState());
+}
+
+void MeterService::_publish(Time timestamp)
+{
+    /* Sequence lock, the sequence number is odd while the snapshot is updated */
+    unsigned int sequence = _sequence.load(std::memory_order_relaxed);
+    _sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    _snapshot.timestamp = timestamp;
+    _snapshot.input_channels = _input_channels;
+    _snapshot.output_channels = _output_channels;
+    for (int c = 0; c < _input_channels; ++c)
+    {
+        const auto& state = _input_states[c];
+        set_level(_snapshot.inputs[c], state.peak, state.mean_square, state.true_peak);
+    }
+    for (int c = 0; c < _output_channels; ++c)
+    {
+        const auto& state = _output_states[c];
+        set_level(_snapshot.outputs[c], state.peak, state.mean_square, state.true_peak);
+    }
+    int tracks = 0;
+    while (tracks < MAX_METERED_TRACKS && _track_ids[tracks] != NO_TRACK)
+    {
+        auto& track = _snapshot.track_levels[tracks];
+        track.track_id = _track_ids[tracks];
+        track.channels = _track_channels[tracks];
+        for (int c = 0; c < track.channels; ++c)
+        {
+            const auto& state = _track_states[tracks][c];
+            set_level(track.levels[c], state.peak, state.mean_square, state.true_peak);
+        }
+        tracks++;
+    }
+    _snapshot.tracks = tracks;
+
+    _sequence.store(sequence + 2, std::memory_order_release);
+}
+
+} // namespace engine
+} // namespace sushi
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Engine level metering of engine inputs, outputs and track outputs
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ *
+ * Levels are computed in the audio thread and published a number of times per
+ * second to a snapshot protected by a sequence lock, which any number of
+ * non-rt threads can poll at their own rate without blocking the audio thread.
+ */
+
+#ifndef SUSHI_METER_SERVICE_H
+#define SUSHI_METER_SERVICE_H
+
+#include <array>
+#include <atomic>
+
+#include "engine/track.h"
+#include "library/id_generator.h"
+#include "library/sample_buffer.h"
+#include "library/spinlock.h"
+#include "library/time.h"
+
+namespace sushi {
+namespace engine {
+
+constexpr int MAX_METERED_CHANNELS = 32;
+constexpr int MAX_METERED_TRACKS = 64;
+constexpr int TRUE_PEAK_OVERSAMPLING = 4;
+constexpr int TRUE_PEAK_TAPS = 8;
+constexpr auto METER_PUBLISH_INTERVAL = std::chrono::milliseconds(10);
+constexpr float METER_PEAK_DECAY_TIME = 0.3f;
+constexpr float METER_RMS_TIME = 0.3f;
+
+/**
+ * @brief Levels of a single channel, as linear gain values
+ */
+struct ChannelLevel
+{
+    /* Sample peak, with a decay */
+    float peak{0.0f};
+    /* Exponentially averaged rms level */
+    float rms{0.0f};
+    /* Inter sample peak estimated by oversampling, with a decay */
+    float true_peak{0.0f};
+};
+
+struct TrackLevels
+{
+    ObjectId track_id{0};
+    int channels{0};
+    std::array<ChannelLevel, TRACK_MAX_CHANNELS> levels;
+};
+
+/**
+ * @brief The levels of all metered channels at a point in time
+ */
+struct MeterSnapshot
+{
+    Time timestamp{IMMEDIATE_PROCESS};
+    int input_channels{0};
+    int output_channels{0};
+    int tracks{0};
+    std::array<ChannelLevel, MAX_METERED_CHANNELS> inputs;
+    std::array<ChannelLevel, MAX_METERED_CHANNELS> outputs;
+    std::array<TrackLevels, MAX_METERED_TRACKS> track_levels;
+};
+
+class MeterService
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(MeterService);
+
+    explicit MeterService(float sample_rate);
+
+    /* Configuration functions, not to be called while processing */
+
+    void set_sample_rate(float sample_rate);
+
+    void set_input_channels(int channels);
+
+    void set_output_channels(int channels);
+
+    /* Called from the audio thread once every chunk, in this order */
+
+    /**
+     * @brief Meter the engine input channels
+     * @param buffer The engine input buffer
+     */
+    void process_inputs(const ChunkSampleBuffer& buffer);
+
+    /**
+     * @brief Meter the outputs of a track. Tracks beyond MAX_METERED_TRACKS are ignored.
+     * @param index The index of the track in the processing order
+     * @param track The track to meter
+     */
+    void process_track(int index, Track& track);
+
+    /**
+     * @brief Meter the engine output channels and publish a new snapshot if due.
+     * @param buffer The engine output buffer
+     * @param tracks The number of tracks processed this chunk
+     * @param timestamp The process time of the current chunk
+     */
+    void process_outputs(const ChunkSampleBuffer& buffer, int tracks, Time timestamp);
+
+    /**
+     * @brief Get the latest published levels. Safe to call from any non-rt thread.
+     *        Will spin briefly if called while a snapshot is being published.
+     * @param snapshot Filled with the latest levels
+     */
+    void snapshot(MeterSnapshot& snapshot) const;
+
+private:
+    /* Running state of one metered channel */
+    struct ChannelState
+    {
+        float peak{0.0f};
+        float mean_square{0.0f};
+        float true_peak{0.0f};
+        std::array<float, TRUE_PEAK_TAPS - 1> history{};
+    };
+
+    void _process_channel(const float* samples, ChannelState& state);
+
+    void _reset_track(int index, ObjectId id);
+
+    void _publish(Time timestamp);
+
+    float _peak_decay;
+    float _rms_coeff;
+    int _publish_interval;
+    int _samples_since_publish{0};
+
+    /* Polyphase filter for the 3 interpolated phases, phase 0 is the signal itself */
+    std::array<std::array<float, TRUE_PEAK_TAPS>, TRUE_PEAK_OVERSAMPLING - 1> _phases;
+
+    int _input_channels{0};
+    int _output_channels{0};
+    std::array<ChannelState, MAX_METERED_CHANNELS> _input_states;
+    std::array<ChannelState, MAX_METERED_CHANNELS> _output_states;
+    std::array<std::array<ChannelState, TRACK_MAX_CHANNELS>, MAX_METERED_TRACKS> _track_states;
+    std::array<ObjectId, MAX_METERED_TRACKS> _track_ids{};
+    std::array<int, MAX_METERED_TRACKS> _track_channels{};
+
+    alignas(ASSUMED_CACHE_LINE_SIZE) std::atomic<unsigned int> _sequence{0};
+    MeterSnapshot _snapshot;
+};
+
+} // namespace engine
+} // namespace sushi
+
+#endif //SUSHI_METER_SERVICE_H
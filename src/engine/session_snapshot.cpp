@@ -0,0 +1,333 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Binary snapshots of the state of all processors in a session
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "engine/session_snapshot.h"
+#include "library/event.h"
+#include "logging.h"
+
+namespace sushi {
+namespace engine {
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("snapshot");
+
+/* Layout of the file:
+ *   SnapshotFileHeader
+ *   For every processor:
+ *     ProcessorRecord
+ *     The name, padded to a multiple of 4 bytes
+ *     ParameterRecord * parameter_count
+ *   State chunks, each starting at a multiple of CHUNK_ALIGNMENT bytes
+ */
+struct SnapshotFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t processor_count;
+    int32_t  time_signature_numerator;
+    int32_t  time_signature_denominator;
+    float    tempo;
+};
+
+enum ProcessorFlags : uint32_t
+{
+    BYPASSED = 1u,
+    HAS_PROGRAM = 2u
+};
+
+struct ProcessorRecord
+{
+    uint32_t name_size;
+    uint32_t parameter_count;
+    uint32_t flags;
+    int32_t  program;
+    /* Offset of the state chunk from the start of the file, chunk_size is 0 if there is none */
+    uint64_t chunk_offset;
+    uint64_t chunk_size;
+};
+
+struct ParameterRecord
+{
+    uint32_t parameter_id;
+    float    value;
+};
+
+constexpr size_t CHUNK_ALIGNMENT = 16;
+
+inline size_t padded_size(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+template <typename T>
+inline void append(std::vector<uint8_t>& buffer, const T& value)
+{
+    auto bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+/* Flush the directory entry of file_name to disk, so that a rename of it survives a power loss */
+inline bool sync_directory_of(const std::string& file_name)
+{
+    auto separator = file_name.rfind('/');
+    std::string directory = ".";
+    if (separator != std::string::npos)
+    {
+        directory = separator == 0 ? "/" : file_name.substr(0, separator);
+    }
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+SnapshotStatus save_session_snapshot(BaseEngine* engine, const std::string& file_name)
+{
+    auto transport = engine->transport();
+    SnapshotFileHeader header{SNAPSHOT_FILE_MAGIC, SNAPSHOT_FILE_VERSION, 0,
+                              transport->current_time_signature().numerator,
+                              transport->current_time_signature().denominator,
+                              transport->current_tempo()};
+
+    /* Records are built in memory first, as the chunk offsets depend on their total size */
+    std::vector<uint8_t> records;
+    std::vector<std::vector<uint8_t>> chunks;
+    std::vector<size_t> record_offsets;
+    for (const auto& [name, processor] : engine->all_processors())
+    {
+        ProcessorRecord record{static_cast<uint32_t>(name.size()), 0, 0, 0, 0, 0};
+        if (processor->bypassed())
+        {
+            record.flags |= ProcessorFlags::BYPASSED;
+        }
+        if (processor->supports_programs())
+        {
+            record.flags |= ProcessorFlags::HAS_PROGRAM;
+            record.program = processor->current_program();
+        }
+        std::vector<ParameterRecord> parameters;
+        for (const auto& descriptor : processor->all_parameters())
+        {
+            auto [status, value] = processor->parameter_value(descriptor->id());
+            if (status == ProcessorReturnCode::OK)
+            {
+                parameters.push_back({descriptor->id(), value});
+            }
+        }
+        record.parameter_count = static_cast<uint32_t>(parameters.size());
+
+        auto [chunk_status, chunk] = processor->state_chunk();
+        record.chunk_size = chunk_status == ProcessorReturnCode::OK ? chunk.size() : 0;
+        chunks.push_back(record.chunk_size > 0 ? std::move(chunk) : std::vector<uint8_t>());
+
+        record_offsets.push_back(records.size());
+        append(records, record);
+        records.insert(records.end(), name.begin(), name.end());
+        records.resize(padded_size(records.size(), sizeof(uint32_t)), 0);
+        for (const auto& parameter : parameters)
+        {
+            append(records, parameter);
+        }
+        header.processor_count++;
+    }
+
+    size_t offset = padded_size(sizeof(header) + records.size(), CHUNK_ALIGNMENT);
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        if (chunks[i].empty() == false)
+        {
+            uint64_t chunk_offset = offset;
+            std::memcpy(records.data() + record_offsets[i] + offsetof(ProcessorRecord, chunk_offset),
+                        &chunk_offset, sizeof(chunk_offset));
+            offset = padded_size(offset + chunks[i].size(), CHUNK_ALIGNMENT);
+        }
+    }
+
+    /* Write to a temporary file and rename it, so that a crash while saving
+     * never leaves a partially written snapshot behind */
+    std::string temp_file = file_name + ".tmp";
+    FILE* file = fopen(temp_file.c_str(), "wb");
+    if (file == nullptr)
+    {
+        SUSHI_LOG_ERROR("Failed to create snapshot file {}", temp_file);
+        return SnapshotStatus::FILE_ERROR;
+    }
+    const uint8_t padding[CHUNK_ALIGNMENT] = {};
+    size_t written = sizeof(header) + records.size();
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(records.data(), 1, records.size(), file) == records.size();
+    for (const auto& chunk : chunks)
+    {
+        if (ok && chunk.empty() == false)
+        {
+            size_t padding_size = padded_size(written, CHUNK_ALIGNMENT) - written;
+            ok = fwrite(padding, 1, padding_size, file) == padding_size &&
+                 fwrite(chunk.data(), 1, chunk.size(), file) == chunk.size();
+            written += padding_size + chunk.size();
+        }
+    }
+    /* The data must be on disk before the rename, or a power loss could leave
+     * an empty or partial file behind under the final name */
+    ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = (fclose(file) == 0) && ok;
+    if (ok == false || rename(temp_file.c_str(), file_name.c_str()) != 0)
+    {
+        SUSHI_LOG_ERROR("Failed to write snapshot file {}", file_name);
+        remove(temp_file.c_str());
+        return SnapshotStatus::FILE_ERROR;
+    }
+    if (sync_directory_of(file_name) == false)
+    {
+        SUSHI_LOG_WARNING("Failed to sync the directory of snapshot file {}", file_name);
+    }
+    SUSHI_LOG_INFO("Saved state of {} processors to {}", header.processor_count, file_name);
+    return SnapshotStatus::OK;
+}
+
+/* Restores the state of one processor from its record, and adds its parameter
+ * values to batch. Returns false if the record is malformed */
+inline bool restore_processor(BaseEngine* engine, const uint8_t* file_data, size_t file_size, size_t& offset,
+                              std::vector<ParameterChangeBatchEvent::ParameterValue>& batch)
+{
+    if (offset + sizeof(ProcessorRecord) > file_size)
+    {
+        return false;
+    }
+    ProcessorRecord record;
+    std::memcpy(&record, file_data + offset, sizeof(record));
+    offset += sizeof(record);
+    size_t parameters_size = static_cast<size_t>(record.parameter_count) * sizeof(ParameterRecord);
+    if (offset + padded_size(record.name_size, sizeof(uint32_t)) + parameters_size > file_size ||
+        (record.chunk_size > 0 && (record.chunk_offset > file_size || record.chunk_size > file_size - record.chunk_offset)))
+    {
+        return false;
+    }
+    std::string name(reinterpret_cast<const char*>(file_data + offset), record.name_size);
+    offset += padded_size(record.name_size, sizeof(uint32_t));
+    const uint8_t* parameters = file_data + offset;
+    offset += parameters_size;
+
+    auto [status, id] = engine->processor_id_from_name(name);
+    auto processor = status == EngineReturnStatus::OK ? engine->mutable_processor(id) : nullptr;
+    if (processor == nullptr)
+    {
+        SUSHI_LOG_WARNING("Processor {} in snapshot not found, skipping it", name);
+        return true;
+    }
+    processor->set_bypassed(record.flags & ProcessorFlags::BYPASSED);
+    if (record.chunk_size > 0)
+    {
+        /* The chunk holds the complete state, including program and parameters */
+        if (processor->set_state_chunk(file_data + record.chunk_offset, record.chunk_size) == ProcessorReturnCode::OK)
+        {
+            return true;
+        }
+        SUSHI_LOG_WARNING("Failed to restore state chunk of {}, restoring parameters only", name);
+    }
+    if (record.flags & ProcessorFlags::HAS_PROGRAM)
+    {
+        processor->set_program(record.program);
+    }
+    for (uint32_t i = 0; i < record.parameter_count; ++i)
+    {
+        ParameterRecord parameter;
+        std::memcpy(&parameter, parameters + i * sizeof(ParameterRecord), sizeof(parameter));
+        batch.push_back({id, parameter.parameter_id, parameter.value});
+    }
+    return true;
+}
+
+SnapshotStatus restore_session_snapshot(BaseEngine* engine, const std::string& file_name)
+{
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        SUSHI_LOG_ERROR("Failed to open snapshot file {}", file_name);
+        return SnapshotStatus::FILE_ERROR;
+    }
+    struct stat file_stats;
+    if (fstat(fd, &file_stats) != 0 || file_stats.st_size < static_cast<off_t>(sizeof(SnapshotFileHeader)))
+    {
+        ::close(fd);
+        SUSHI_LOG_ERROR("Snapshot file {} is not a valid snapshot", file_name);
+        return SnapshotStatus::INVALID_FILE;
+    }
+    size_t size = file_stats.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        SUSHI_LOG_ERROR("Failed to map snapshot file {}", file_name);
+        return SnapshotStatus::FILE_ERROR;
+    }
+    /* Chunks are read once, front to back */
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    auto data = static_cast<const uint8_t*>(mapping);
+    SnapshotFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != SNAPSHOT_FILE_MAGIC || header.version != SNAPSHOT_FILE_VERSION)
+    {
+        munmap(mapping, size);
+        SUSHI_LOG_ERROR("Snapshot file {} has the wrong format or version", file_name);
+        return SnapshotStatus::INVALID_FILE;
+    }
+
+    std::vector<ParameterChangeBatchEvent::ParameterValue> batch;
+    size_t offset = sizeof(header);
+    for (uint32_t i = 0; i < header.processor_count; ++i)
+    {
+        if (restore_processor(engine, data, size, offset, batch) == false)
+        {
+            /* Anything restored up to here is left as it is */
+            munmap(mapping, size);
+            SUSHI_LOG_ERROR("Snapshot file {} is truncated or corrupt", file_name);
+            return SnapshotStatus::INVALID_FILE;
+        }
+    }
+    munmap(mapping, size);
+
+    auto dispatcher = engine->event_dispatcher();
+    dispatcher->post_event(new SetEngineTempoEvent(header.tempo, IMMEDIATE_PROCESS));
+    dispatcher->post_event(new SetEngineTimeSignatureEvent({header.time_signature_numerator,
+                                                            header.time_signature_denominator}, IMMEDIATE_PROCESS));
+    if (batch.empty() == false)
+    {
+        dispatcher->post_event(new ParameterChangeBatchEvent(std::move(batch), IMMEDIATE_PROCESS));
+    }
+    SUSHI_LOG_INFO("Restored state of {} processors from {}", header.processor_count, file_name);
+    return SnapshotStatus::OK;
+}
+
+} // namespace engine
+} // namespace sushi
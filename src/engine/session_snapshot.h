@@ -0,0 +1,75 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Binary snapshots of the state of all processors in a session
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ *
+ * A snapshot stores the tempo and time signature, and for every processor its
+ * bypass state, current program, parameter values and the opaque state chunk of
+ * external plugins. Processors are matched by name when restoring, so the tracks
+ * and plugins must already have been created, i.e. from the json config.
+ *
+ * The file is written in the native byte order and is meant to be read back on
+ * the same machine.
+ */
+
+#ifndef SUSHI_SESSION_SNAPSHOT_H
+#define SUSHI_SESSION_SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+
+#include "engine/base_engine.h"
+
+namespace sushi {
+namespace engine {
+
+constexpr uint32_t SNAPSHOT_FILE_MAGIC = 0x50414e53; // "SNAP" in little endian byte order
+/* Incremented on every change to the file layout */
+constexpr uint32_t SNAPSHOT_FILE_VERSION = 1;
+
+enum class SnapshotStatus
+{
+    OK,
+    FILE_ERROR,
+    INVALID_FILE
+};
+
+/**
+ * @brief Save the state of all processors of the engine to a file. Plugin state
+ *        is read from the calling thread, never from the audio thread. Not rt safe.
+ * @param engine The engine to save the state of
+ * @param file_name The file to write, replaced atomically if it already exists
+ * @return OK if the file was written
+ */
+SnapshotStatus save_session_snapshot(BaseEngine* engine, const std::string& file_name);
+
+/**
+ * @brief Restore the state saved with save_session_snapshot(). The file is memory
+ *        mapped and plugin state chunks are passed to the plugins directly from the
+ *        mapping. Parameter values are sent as a single batch through the event
+ *        dispatcher, so they are applied after this function returns. Processors
+ *        in the file that are not found in the engine are skipped. Not rt safe.
+ * @param engine The engine to restore the state of
+ * @param file_name The file to read
+ * @return OK if the file was read, even if some processors were not found
+ */
+SnapshotStatus restore_session_snapshot(BaseEngine* engine, const std::string& file_name);
+
+} // namespace engine
+} // namespace sushi
+
+#endif //SUSHI_SESSION_SNAPSHOT_H
@@ -0,0 +1,338 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Publishes engine state to a shared memory region
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "engine/shared_state_publisher.h"
+#include "logging.h"
+
+namespace sushi {
+namespace engine {
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("shared state");
+
+static_assert(SUSHI_SHARED_STATE_MAX_CHANNELS == MAX_METERED_CHANNELS);
+static_assert(SUSHI_SHARED_STATE_MAX_TRACKS == MAX_METERED_TRACKS);
+static_assert(SUSHI_SHARED_STATE_TRACK_CHANNELS == TRACK_MAX_CHANNELS);
+static_assert(static_cast<int>(PlayingMode::RECORDING) == SUSHI_PLAYING_MODE_RECORDING);
+static_assert(static_cast<int>(SyncMode::ABLETON_LINK) == SUSHI_SYNC_MODE_ABLETON_LINK);
+
+inline uint64_t parameter_key(ObjectId processor_id, ObjectId parameter_id)
+{
+    return static_cast<uint64_t>(processor_id) << 32u | parameter_id;
+}
+
+inline void copy_level(sushi_channel_level& dest, const ChannelLevel& src)
+{
+    dest.peak = src.peak;
+    dest.rms = src.rms;
+    dest.true_peak = src.true_peak;
+}
+
+SharedStatePublisher::SharedStatePublisher(BaseEngine* engine, const std::string& name) : _engine(engine),
+                                                                                          _name(name)
+{}
+
+SharedStatePublisher::~SharedStatePublisher()
+{
+    if (_state == nullptr)
+    {
+        return;
+    }
+    auto dispatcher = _engine->event_dispatcher();
+    dispatcher->unsubscribe_from_parameter_change_notifications(this);
+    dispatcher->unsubscribe_from_engine_notifications(this);
+    munmap(_state, sizeof(sushi_shared_state));
+    shm_unlink(_name.c_str());
+}
+
+bool SharedStatePublisher::init()
+{
+    int fd = shm_open(_name.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd < 0)
+    {
+        SUSHI_LOG_ERROR("Failed to open shared memory object {}: {}", _name, strerror(errno));
+        return false;
+    }
+    void* mapping = MAP_FAILED;
+    if (ftruncate(fd, sizeof(sushi_shared_state)) == 0)
+    {
+        mapping = mmap(nullptr, sizeof(sushi_shared_state), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        SUSHI_LOG_ERROR("Failed to map shared memory object {}: {}", _name, strerror(errno));
+        shm_unlink(_name.c_str());
+        return false;
+    }
+    _state = static_cast<sushi_shared_state*>(mapping);
+    /* The sequence is left odd while the region is set up, in case a
+     * client still has the region of a previous run mapped */
+    __atomic_store_n(&_state->sequence, 1u, __ATOMIC_RELAXED);
+    std::atomic_thread_fence(std::memory_order_release);
+    constexpr auto HEADER_SIZE = offsetof(sushi_shared_state, parameter_generation);
+    std::memset(reinterpret_cast<char*>(_state) + HEADER_SIZE, 0, sizeof(sushi_shared_state) - HEADER_SIZE);
+    _state->magic = SUSHI_SHARED_STATE_MAGIC;
+    _state->version = SUSHI_SHARED_STATE_VERSION;
+    _state->size = sizeof(sushi_shared_state);
+    _engine->enable_metering(true);
+    _parameters_changed = true;
+    _transport_changed = true;
+    _update_parameters();
+    _update_transport();
+    _state->timestamp = get_current_time().count();
+    __atomic_store_n(&_state->sequence, 2u, __ATOMIC_RELEASE);
+
+    auto dispatcher = _engine->event_dispatcher();
+    dispatcher->subscribe_to_parameter_change_notifications(this);
+    dispatcher->subscribe_to_engine_notifications(this);
+    SUSHI_LOG_INFO("Publishing state to shared memory object {}", _name);
+    return true;
+}
+
+int SharedStatePublisher::process(Event* event)
+{
+    if (event->is_parameter_change_notification())
+    {
+        auto typed_event = static_cast<ParameterChangeNotificationEvent*>(event);
+        auto slot = _parameter_slots.find(parameter_key(typed_event->processor_id(), typed_event->parameter_id()));
+        if (slot != _parameter_slots.end())
+        {
+            _pending_values.emplace_back(slot->second, typed_event->float_value());
+        }
+        return EventStatus::HANDLED_OK;
+    }
+    if (event->is_engine_notification())
+    {
+        auto typed_event = static_cast<EngineNotificationEvent*>(event);
+        if (typed_event->is_audio_graph_notification())
+        {
+            _parameters_changed = true;
+        }
+        else if (typed_event->is_transport_notification())
+        {
+            _transport_changed = true;
+        }
+        return EventStatus::HANDLED_OK;
+    }
+    return EventStatus::NOT_HANDLED;
+}
+
+void SharedStatePublisher::notification_cycle_done()
+{
+    bool meters_changed = _update_meters();
+    Time now = get_current_time();
+    if (now - _last_value_refresh > SHARED_STATE_VALUE_REFRESH_INTERVAL)
+    {
+        _last_value_refresh = now;
+        _refresh_parameter_values();
+    }
+    bool timings_due = now - _last_timings_update > SHARED_STATE_TIMINGS_INTERVAL;
+    if (_pending_values.empty() && !_parameters_changed && !_transport_changed && !meters_changed && !timings_due)
+    {
+        return;
+    }
+    _begin_write();
+    _state->timestamp = now.count();
+    if (_parameters_changed)
+    {
+        /* The new values are read from the processors, so any pending values are stale */
+        _pending_values.clear();
+        _update_parameters();
+    }
+    for (const auto& [slot, value] : _pending_values)
+    {
+        _state->parameters[slot].value = value;
+    }
+    _pending_values.clear();
+    if (_transport_changed)
+    {
+        _update_transport();
+    }
+    if (meters_changed)
+    {
+        _state->input_channels = _meters.input_channels;
+        _state->output_channels = _meters.output_channels;
+        _state->track_count = _meters.tracks;
+        for (int c = 0; c < _meters.input_channels; ++c)
+        {
+            copy_level(_state->inputs[c], _meters.inputs[c]);
+        }
+        for (int c = 0; c < _meters.output_channels; ++c)
+        {
+            copy_level(_state->outputs[c], _meters.outputs[c]);
+        }
+        for (int t = 0; t < _meters.tracks; ++t)
+        {
+            const auto& track = _meters.track_levels[t];
+            auto& dest = _state->tracks[t];
+            dest.track_id = track.track_id;
+            dest.channels = track.channels;
+            for (int c = 0; c < track.channels; ++c)
+            {
+                copy_level(dest.levels[c], track.levels[c]);
+            }
+        }
+    }
+    if (timings_due)
+    {
+        _last_timings_update = now;
+        _update_timings();
+    }
+    _end_write();
+}
+
+void SharedStatePublisher::_begin_write()
+{
+    uint32_t sequence = __atomic_load_n(&_state->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&_state->sequence, sequence + 1, __ATOMIC_RELAXED);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SharedStatePublisher::_end_write()
+{
+    uint32_t sequence = __atomic_load_n(&_state->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&_state->sequence, sequence + 1, __ATOMIC_RELEASE);
+}
+
+void SharedStatePublisher::_update_parameters()
+{
+    _parameters_changed = false;
+    std::vector<const Processor*> processors;
+    for (const auto& processor : _engine->all_processors())
+    {
+        processors.push_back(processor.second.get());
+    }
+    std::sort(processors.begin(), processors.end(), [](auto lhs, auto rhs) {return lhs->id() < rhs->id();});
+
+    _parameter_slots.clear();
+    int slot = 0;
+    for (auto processor : processors)
+    {
+        /* Parameter ids are assigned in order, so all_parameters() is already sorted by id */
+        for (auto parameter : processor->all_parameters())
+        {
+            if (slot >= SUSHI_SHARED_STATE_MAX_PARAMETERS)
+            {
+                break;
+            }
+            auto [status, value] = processor->parameter_value(parameter->id());
+            auto& dest = _state->parameters[slot];
+            dest.processor_id = processor->id();
+            dest.parameter_id = parameter->id();
+            dest.value = status == ProcessorReturnCode::OK ? value : 0.0f;
+            _parameter_slots[parameter_key(processor->id(), parameter->id())] = slot++;
+        }
+    }
+    if (slot >= SUSHI_SHARED_STATE_MAX_PARAMETERS)
+    {
+        SUSHI_LOG_WARNING("Parameter table full, only the first {} parameters are published", slot);
+    }
+    _state->parameter_count = slot;
+    _state->parameter_generation++;
+}
+
+void SharedStatePublisher::_refresh_parameter_values()
+{
+    /* Not all parameter changes send notifications, i.e. internal plugins don't when
+     * set from an rt event, so the values are also read back from the processors */
+    std::vector<std::pair<int, float>> changed_values;
+    const Processor* processor = nullptr;
+    for (int slot = 0; slot < static_cast<int>(_state->parameter_count); ++slot)
+    {
+        const auto& entry = _state->parameters[slot];
+        if (processor == nullptr || processor->id() != entry.processor_id)
+        {
+            processor = _engine->processor(entry.processor_id);
+            if (processor == nullptr)
+            {
+                continue;
+            }
+        }
+        auto [status, value] = processor->parameter_value(entry.parameter_id);
+        if (status == ProcessorReturnCode::OK && value != entry.value)
+        {
+            changed_values.emplace_back(slot, value);
+        }
+    }
+    /* Values from notifications received during this cycle are newer, so they are applied last */
+    _pending_values.insert(_pending_values.begin(), changed_values.begin(), changed_values.end());
+}
+
+void SharedStatePublisher::_update_transport()
+{
+    _transport_changed = false;
+    auto transport = _engine->transport();
+    if (transport == nullptr)
+    {
+        return;
+    }
+    _state->transport.tempo = transport->current_tempo();
+    _state->transport.time_signature_numerator = transport->current_time_signature().numerator;
+    _state->transport.time_signature_denominator = transport->current_time_signature().denominator;
+    _state->transport.playing_mode = static_cast<int32_t>(transport->playing_mode());
+    _state->transport.sync_mode = static_cast<int32_t>(transport->sync_mode());
+}
+
+bool SharedStatePublisher::_update_meters()
+{
+    auto meter_service = _engine->meter_service();
+    if (meter_service == nullptr)
+    {
+        return false;
+    }
+    meter_service->snapshot(_meters);
+    if (_meters.timestamp == _last_meter_update)
+    {
+        return false;
+    }
+    _last_meter_update = _meters.timestamp;
+    return true;
+}
+
+bool SharedStatePublisher::_update_timings()
+{
+    auto timer = _engine->performance_timer();
+    if (timer == nullptr || timer->enabled() == false)
+    {
+        return false;
+    }
+    auto timings = timer->timings_for_node(ENGINE_TIMING_ID);
+    if (timings.has_value() == false)
+    {
+        return false;
+    }
+    _state->engine_timings.average = timings->avg_case;
+    _state->engine_timings.min = timings->min_case;
+    _state->engine_timings.max = timings->max_case;
+    return true;
+}
+
+} // namespace engine
+} // namespace sushi
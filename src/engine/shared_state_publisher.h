@@ -0,0 +1,114 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Publishes parameter values, meters, transport state and timings to
+ *        a shared memory region, for UI processes running on the same machine.
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ *
+ * The layout of the region is described in include/sushi_shared_state.h. It is
+ * updated from the event dispatcher thread, once per dispatcher cycle in which
+ * anything changed.
+ */
+
+#ifndef SUSHI_SHARED_STATE_PUBLISHER_H
+#define SUSHI_SHARED_STATE_PUBLISHER_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sushi_shared_state.h"
+#include "engine/base_engine.h"
+#include "library/event_interface.h"
+
+namespace sushi {
+namespace engine {
+
+/* Timings are only copied from the performance timer this often */
+constexpr auto SHARED_STATE_TIMINGS_INTERVAL = std::chrono::milliseconds(100);
+
+/* Parameter values are read back from the processors this often */
+constexpr auto SHARED_STATE_VALUE_REFRESH_INTERVAL = std::chrono::milliseconds(50);
+
+class SharedStatePublisher : public EventPoster
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(SharedStatePublisher);
+
+    /**
+     * @brief Create a publisher, the region is not created until init() is called
+     * @param engine The engine to publish the state of
+     * @param name The name of the shared memory object, as passed to shm_open()
+     */
+    SharedStatePublisher(BaseEngine* engine, const std::string& name = SUSHI_SHARED_STATE_DEFAULT_NAME);
+
+    ~SharedStatePublisher();
+
+    /**
+     * @brief Create and map the shared memory region, publish the current state
+     *        and start listening for changes. Also enables metering in the engine.
+     * @return true if the region was created
+     */
+    bool init();
+
+    /* Inherited from EventPoster, called from the event dispatcher thread */
+    int process(Event* event) override;
+
+    void notification_cycle_done() override;
+
+    int poster_id() override {return EventPosterId::SHARED_STATE;}
+
+    const sushi_shared_state* state() const {return _state;}
+
+private:
+    void _begin_write();
+
+    void _end_write();
+
+    /* Rebuilds the list of parameters and reads their current values from the processors */
+    void _update_parameters();
+
+    /* Queues the values of parameters that changed without a notification */
+    void _refresh_parameter_values();
+
+    void _update_transport();
+
+    /* Returns true if the levels changed since the last update */
+    bool _update_meters();
+
+    bool _update_timings();
+
+    BaseEngine*                     _engine;
+    std::string                     _name;
+    sushi_shared_state*             _state{nullptr};
+
+    /* Slot in the parameter table, by processor id in the upper and parameter id in the lower 32 bits */
+    std::unordered_map<uint64_t, int>   _parameter_slots;
+    std::vector<std::pair<int, float>>  _pending_values;
+    bool                            _parameters_changed{false};
+    bool                            _transport_changed{false};
+
+    MeterSnapshot                   _meters;
+    Time                            _last_meter_update{IMMEDIATE_PROCESS};
+    Time                            _last_timings_update{IMMEDIATE_PROCESS};
+    Time                            _last_value_refresh{IMMEDIATE_PROCESS};
+};
+
+} // namespace engine
+} // namespace sushi
+
+#endif //SUSHI_SHARED_STATE_PUBLISHER_H
@@ -83,6 +83,30 @@ public:
      * @brief Reset all recorded timings
      */
     virtual void clear_all_timings() = 0;
+
+    /**
+     * @brief Keep every timing record and not only the running statistics, so that
+     *        percentiles can be calculated. Memory use grows with the number of
+     *        records, so this is meant for runs of limited length, like benchmarks.
+     * @param enabled Store records if true, only keep statistics if false
+     */
+    virtual void store_records(bool enabled) = 0;
+
+    /**
+     * @brief Get a percentile of the stored timing records from a specific node
+     * @param id An integer id representing a timing node
+     * @param percentile The percentile to get, between 0 and 100
+     * @return The timing as a fraction of the timing period if the node has any stored
+     *         records. Empty otherwise
+     */
+    virtual std::optional<float> percentile_for_node(int id, float percentile) = 0;
+
+    /**
+     * @brief Get the number of stored timing records from a specific node
+     * @param id An integer id representing a timing node
+     * @return The number of records stored since the timings were last cleared
+     */
+    virtual int stored_records_for_node(int id) = 0;
 };
 
 
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Utility functions for writing benchmark results to a file.
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <sstream>
+
+#include "library/benchmark_report.h"
+#include "library/constants.h"
+#include "engine/base_engine.h"
+
+namespace sushi {
+
+static rapidjson::Value timings_object(performance::BasePerformanceTimer* timer, int id,
+                                       rapidjson::Document::AllocatorType& allocator)
+{
+    rapidjson::Value timings_obj(rapidjson::kObjectType);
+    timings_obj.AddMember(rapidjson::Value("records", allocator).Move(),
+                          rapidjson::Value(timer->stored_records_for_node(id)).Move(), allocator);
+
+    auto timings = timer->timings_for_node(id);
+    if (timings.has_value())
+    {
+        timings_obj.AddMember(rapidjson::Value("average", allocator).Move(),
+                              rapidjson::Value(timings->avg_case).Move(), allocator);
+        timings_obj.AddMember(rapidjson::Value("min", allocator).Move(),
+                              rapidjson::Value(timings->min_case).Move(), allocator);
+        timings_obj.AddMember(rapidjson::Value("max", allocator).Move(),
+                              rapidjson::Value(timings->max_case).Move(), allocator);
+    }
+    for (auto percentile : BENCHMARK_PERCENTILES)
+    {
+        auto value = timer->percentile_for_node(id, percentile);
+        if (value.has_value())
+        {
+            std::ostringstream key;
+            key << "p" << percentile;
+            timings_obj.AddMember(rapidjson::Value(key.str().c_str(), allocator).Move(),
+                                  rapidjson::Value(value.value()).Move(), allocator);
+        }
+    }
+    return timings_obj;
+}
+
+rapidjson::Document generate_benchmark_report_document(const sushi::ext::SushiControl* engine_controller,
+                                                       performance::BasePerformanceTimer* timer,
+                                                       const BenchmarkResult& result)
+{
+    rapidjson::Document document;
+    document.SetObject();
+    rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
+
+    double audio_seconds = static_cast<double>(result.chunks) * AUDIO_CHUNK_SIZE / result.sample_rate;
+    document.AddMember(rapidjson::Value("sample_rate", allocator).Move(),
+                       rapidjson::Value(result.sample_rate).Move(), allocator);
+    document.AddMember(rapidjson::Value("chunk_size", allocator).Move(),
+                       rapidjson::Value(AUDIO_CHUNK_SIZE).Move(), allocator);
+    document.AddMember(rapidjson::Value("chunks", allocator).Move(),
+                       rapidjson::Value(result.chunks).Move(), allocator);
+    document.AddMember(rapidjson::Value("seconds", allocator).Move(),
+                       rapidjson::Value(result.seconds).Move(), allocator);
+    document.AddMember(rapidjson::Value("chunks_per_second", allocator).Move(),
+                       rapidjson::Value(result.seconds > 0 ? result.chunks / result.seconds : 0.0).Move(), allocator);
+    document.AddMember(rapidjson::Value("realtime_factor", allocator).Move(),
+                       rapidjson::Value(result.seconds > 0 ? audio_seconds / result.seconds : 0.0).Move(), allocator);
+    document.AddMember(rapidjson::Value("engine", allocator).Move(),
+                       timings_object(timer, engine::ENGINE_TIMING_ID, allocator).Move(), allocator);
+
+    rapidjson::Value tracks(rapidjson::kArrayType);
+    for (auto& track : engine_controller->get_tracks())
+    {
+        rapidjson::Value track_obj(rapidjson::kObjectType);
+        track_obj.AddMember(rapidjson::Value("name", allocator).Move(),
+                            rapidjson::Value(track.name.c_str(), allocator).Move(), allocator);
+        track_obj.AddMember(rapidjson::Value("id", allocator).Move(),
+                            rapidjson::Value(track.id).Move(), allocator);
+        track_obj.AddMember(rapidjson::Value("timings", allocator).Move(),
+                            timings_object(timer, track.id, allocator).Move(), allocator);
+
+        rapidjson::Value processors(rapidjson::kArrayType);
+        for (auto& processor : engine_controller->get_track_processors(track.id).second)
+        {
+            rapidjson::Value processor_obj(rapidjson::kObjectType);
+            processor_obj.AddMember(rapidjson::Value("name", allocator).Move(),
+                                    rapidjson::Value(processor.name.c_str(), allocator).Move(), allocator);
+            processor_obj.AddMember(rapidjson::Value("id", allocator).Move(),
+                                    rapidjson::Value(processor.id).Move(), allocator);
+            processor_obj.AddMember(rapidjson::Value("timings", allocator).Move(),
+                                    timings_object(timer, processor.id, allocator).Move(), allocator);
+            processors.PushBack(processor_obj.Move(), allocator);
+        }
+        track_obj.AddMember(rapidjson::Value("processors", allocator).Move(), processors.Move(), allocator);
+        tracks.PushBack(track_obj.Move(), allocator);
+    }
+    document.AddMember(rapidjson::Value("tracks", allocator).Move(), tracks.Move(), allocator);
+
+    return document;
+}
+
+} // end namespace sushi
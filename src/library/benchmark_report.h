@@ -0,0 +1,58 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Utility functions for writing benchmark results to a file.
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_BENCHMARK_REPORT_H
+#define SUSHI_BENCHMARK_REPORT_H
+
+#include <array>
+#include <cstdint>
+
+#include "engine/controller.h"
+#include "library/base_performance_timer.h"
+#include "rapidjson/document.h"
+
+namespace sushi {
+
+/* Percentiles of the process timings included in the report */
+constexpr std::array BENCHMARK_PERCENTILES = {50.0f, 90.0f, 99.0f, 99.9f};
+
+struct BenchmarkResult
+{
+    int64_t chunks;
+    /* Wall clock time to process all chunks */
+    double seconds;
+    float sample_rate;
+};
+
+/**
+ * @brief Generate a report with the throughput of a benchmark run and the timings
+ *        of the engine, every track and every processor. Timings are given as
+ *        fractions of the time of one chunk at the sample rate used.
+ * @param engine_controller Controller to get tracks and processors from
+ * @param timer The timer used by the engine, with stored records for percentiles
+ * @param result The measured throughput
+ */
+rapidjson::Document generate_benchmark_report_document(const sushi::ext::SushiControl* engine_controller,
+                                                       performance::BasePerformanceTimer* timer,
+                                                       const BenchmarkResult& result);
+
+} // end namespace sushi
+
+#endif //SUSHI_BENCHMARK_REPORT_H
@@ -145,6 +145,23 @@ Event* Event::from_rt_event(RtEvent& rt_event, Time timestamp)
                                                             ClippingNotificationEvent::ClipChannelType::OUTPUT;
             return new ClippingNotificationEvent(typed_ev->channel(), channel_type, timestamp);
         }
+        /* Transport events are only sent from the rt domain after they have been applied */
+        case RtEventType::TEMPO:
+        {
+            return new TransportNotificationEvent(rt_event.tempo_event()->tempo(), timestamp);
+        }
+        case RtEventType::TIME_SIGNATURE:
+        {
+            return new TransportNotificationEvent(rt_event.time_signature_event()->time_signature(), timestamp);
+        }
+        case RtEventType::PLAYING_MODE:
+        {
+            return new TransportNotificationEvent(rt_event.playing_mode_event()->mode(), timestamp);
+        }
+        case RtEventType::SYNC_MODE:
+        {
+            return new TransportNotificationEvent(rt_event.sync_mode_event()->mode(), timestamp);
+        }
         default:
             return nullptr;
 
@@ -22,6 +22,7 @@
 #define SUSHI_CONTROL_EVENT_H
 
 #include <string>
+#include <vector>
 
 #include "types.h"
 #include "id_generator.h"
@@ -88,6 +89,9 @@ public:
     /* Convertible to ParameterChangeNotification */
     virtual bool is_parameter_change_notification() {return false;}
 
+    /* Convertible to ParameterChangeBatchEvent */
+    virtual bool is_parameter_change_batch() {return false;}
+
     /* Convertible to EngineEvent */
     virtual bool is_engine_event() {return false;}
 
@@ -323,6 +327,34 @@ private:
     Subtype     _subtype;
 };
 
+/* A batch of float parameter changes that are sent to the rt domain
+ * together, in as few audio chunks as the rt queue allows. */
+class ParameterChangeBatchEvent : public Event
+{
+public:
+    struct ParameterValue
+    {
+        ObjectId processor_id;
+        ObjectId parameter_id;
+        float    value;
+    };
+
+    ParameterChangeBatchEvent(std::vector<ParameterValue> values, Time timestamp) : Event(timestamp),
+                                                                                    _values(std::move(values)) {}
+
+    bool is_parameter_change_batch() override {return true;}
+
+    const std::vector<ParameterValue>& values() {return _values;}
+
+    /* Index of the first value not yet sent to the rt domain */
+    size_t sent_count() {return _sent_count;}
+    void   set_sent_count(size_t count) {_sent_count = count;}
+
+private:
+    std::vector<ParameterValue> _values;
+    size_t                      _sent_count{0};
+};
+
 class SetProcessorBypassEvent : public Event
 {
 public:
@@ -473,6 +505,15 @@ class EngineNotificationEvent : public Event
 public:
      bool is_engine_notification() override {return true;}
 
+    /* Convertible to ClippingNotificationEvent */
+    virtual bool is_clipping_notification() {return false;}
+
+    /* Convertible to AudioGraphNotificationEvent */
+    virtual bool is_audio_graph_notification() {return false;}
+
+    /* Convertible to TransportNotificationEvent */
+    virtual bool is_transport_notification() {return false;}
+
 protected:
     explicit EngineNotificationEvent(Time timestamp) : Event(timestamp) {}
 };
@@ -488,6 +529,9 @@ public:
     ClippingNotificationEvent(int channel, ClipChannelType channel_type, Time timestamp) : EngineNotificationEvent(timestamp),
                                                                                            _channel(channel),
                                                                                            _channel_type(channel_type) {}
+
+    bool is_clipping_notification() override {return true;}
+
     int channel() {return _channel;}
     ClipChannelType channel_type() {return _channel_type;}
 
@@ -496,6 +540,80 @@ private:
     ClipChannelType _channel_type;
 };
 
+class AudioGraphNotificationEvent : public EngineNotificationEvent
+{
+public:
+    enum class Action
+    {
+        PROCESSOR_ADDED,
+        PROCESSOR_DELETED,
+        TRACK_ADDED,
+        TRACK_DELETED
+    };
+    /* For track actions, processor and track are both the id of the track */
+    AudioGraphNotificationEvent(Action action,
+                                ObjectId processor,
+                                ObjectId track,
+                                Time timestamp) : EngineNotificationEvent(timestamp),
+                                                  _action(action),
+                                                  _processor(processor),
+                                                  _track(track) {}
+
+    bool is_audio_graph_notification() override {return true;}
+
+    Action      action() {return _action;}
+    ObjectId    processor() {return _processor;}
+    ObjectId    track() {return _track;}
+
+private:
+    Action      _action;
+    ObjectId    _processor;
+    ObjectId    _track;
+};
+
+class TransportNotificationEvent : public EngineNotificationEvent
+{
+public:
+    enum class Action
+    {
+        TEMPO_CHANGED,
+        TIME_SIGNATURE_CHANGED,
+        PLAYING_MODE_CHANGED,
+        SYNC_MODE_CHANGED
+    };
+    TransportNotificationEvent(float tempo, Time timestamp) : EngineNotificationEvent(timestamp),
+                                                              _action(Action::TEMPO_CHANGED),
+                                                              _tempo(tempo) {}
+
+    TransportNotificationEvent(TimeSignature signature, Time timestamp) : EngineNotificationEvent(timestamp),
+                                                                          _action(Action::TIME_SIGNATURE_CHANGED),
+                                                                          _signature(signature) {}
+
+    TransportNotificationEvent(PlayingMode mode, Time timestamp) : EngineNotificationEvent(timestamp),
+                                                                   _action(Action::PLAYING_MODE_CHANGED),
+                                                                   _playing_mode(mode) {}
+
+    TransportNotificationEvent(SyncMode mode, Time timestamp) : EngineNotificationEvent(timestamp),
+                                                                _action(Action::SYNC_MODE_CHANGED),
+                                                                _sync_mode(mode) {}
+
+    bool is_transport_notification() override {return true;}
+
+    Action          action() {return _action;}
+    /* Only the value matching action() is valid */
+    float           tempo() {return _tempo;}
+    TimeSignature   time_signature() {return _signature;}
+    PlayingMode     playing_mode() {return _playing_mode;}
+    SyncMode        sync_mode() {return _sync_mode;}
+
+private:
+    Action          _action;
+    float           _tempo{0};
+    TimeSignature   _signature{0, 0};
+    PlayingMode     _playing_mode{PlayingMode::STOPPED};
+    SyncMode        _sync_mode{SyncMode::INTERNAL};
+};
+
 class AsynchronousWorkEvent : public Event
 {
 public:
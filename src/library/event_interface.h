@@ -32,6 +32,8 @@ enum EventPosterId : int
     MIDI_DISPATCHER,
     OSC_FRONTEND,
     WORKER,
+    CONTROLLER,
+    SHARED_STATE,
     MAX_POSTERS
 };
 
@@ -48,6 +50,13 @@ public:
      */
     virtual int process(Event* /*event*/) {return EventStatus::UNRECOGNIZED_EVENT;};
 
+    /**
+     * @brief Called from the event dispatcher thread once every dispatcher cycle,
+     *        after all notifications from that cycle have been passed to process().
+     *        Lets posters subscribing to notifications send them in batches.
+     */
+    virtual void notification_cycle_done() {}
+
     /**
      * @brief The unique id of this poster.
      * @return
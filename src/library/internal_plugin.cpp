@@ -18,6 +18,8 @@
  * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <algorithm>
+
 #include "library/internal_plugin.h"
 
 namespace sushi {
@@ -53,6 +55,7 @@ FloatParameterValue* InternalPlugin::register_float_parameter(const std::string&
     /* The parameter id must match the value storage index*/
     assert(param->id() == _parameter_values.size());
     _parameter_values.push_back(value);
+    _parameter_changes.push_back(true);
     return _parameter_values.back().float_parameter_value();
 }
 
@@ -77,6 +80,7 @@ IntParameterValue* InternalPlugin::register_int_parameter(const std::string& id,
     /* The parameter id must match the value storage index*/
     assert(param->id() == _parameter_values.size());
     _parameter_values.push_back(value);
+    _parameter_changes.push_back(true);
     return _parameter_values.back().int_parameter_value();
 }
 
@@ -94,6 +98,7 @@ BoolParameterValue* InternalPlugin::register_bool_parameter(const std::string& i
     /* The parameter id must match the value storage index*/
     assert(param->id() == _parameter_values.size());
     _parameter_values.push_back(value_storage);
+    _parameter_changes.push_back(true);
     return _parameter_values.back().bool_parameter_value();
 }
 
@@ -110,6 +115,7 @@ bool InternalPlugin::register_string_property(const std::string &id,
     /* We don't provide a string value class but must push a dummy container here for ids to match */
     ParameterStorage value_storage = ParameterStorage::make_bool_parameter_storage(param, false);
     _parameter_values.push_back(value_storage);
+    _parameter_changes.push_back(true);
     return true;
 }
 
@@ -126,6 +132,7 @@ bool InternalPlugin::register_data_property(const std::string &id,
     /* We don't provide a data value class but must push a dummy container here for ids to match */
     ParameterStorage value_storage = ParameterStorage::make_bool_parameter_storage(param, false);
     _parameter_values.push_back(value_storage);
+    _parameter_changes.push_back(true);
     return true;
 }
 
@@ -166,6 +173,7 @@ void InternalPlugin::process_event(const RtEvent& event)
                 default:
                     break;
             }
+            mark_parameter_changed(typed_event->param_id());
             break;
         }
 
@@ -177,6 +185,7 @@ void InternalPlugin::process_event(const RtEvent& event)
 void InternalPlugin::set_parameter_and_notify(FloatParameterValue* storage, float new_value)
 {
     storage->set(new_value);
+    mark_parameter_changed(storage->descriptor()->id());
     if (maybe_output_cv_value(storage->descriptor()->id(), new_value) == false)
     {
         auto e = RtEvent::make_parameter_change_event(this->id(), 0, storage->descriptor()->id(), storage->value());
@@ -187,6 +196,7 @@ void InternalPlugin::set_parameter_and_notify(FloatParameterValue* storage, floa
 void InternalPlugin::set_parameter_and_notify(IntParameterValue*storage, int new_value)
 {
     storage->set(new_value);
+    mark_parameter_changed(storage->descriptor()->id());
     auto e = RtEvent::make_parameter_change_event(this->id(), 0, storage->descriptor()->id(), storage->value());
     output_event(e);
 }
@@ -194,10 +204,29 @@ void InternalPlugin::set_parameter_and_notify(IntParameterValue*storage, int new
 void InternalPlugin::set_parameter_and_notify(BoolParameterValue*storage, bool new_value)
 {
     storage->set(new_value);
+    mark_parameter_changed(storage->descriptor()->id());
     auto e = RtEvent::make_parameter_change_event(this->id(), 0, storage->descriptor()->id(), storage->value());
     output_event(e);
 }
 
+void InternalPlugin::mark_parameter_changed(ObjectId parameter_id)
+{
+    if (parameter_id < _parameter_changes.size())
+    {
+        _parameter_changes[parameter_id] = true;
+        _parameters_changed = true;
+    }
+}
+
+void InternalPlugin::clear_parameter_changes()
+{
+    if (_parameters_changed)
+    {
+        std::fill(_parameter_changes.begin(), _parameter_changes.end(), false);
+        _parameters_changed = false;
+    }
+}
+
 std::pair<ProcessorReturnCode, float> InternalPlugin::parameter_value(ObjectId parameter_id) const
 {
     if (parameter_id >= _parameter_values.size())
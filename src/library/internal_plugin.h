@@ -22,6 +22,7 @@
 #define SUSHI_INTERNAL_PLUGIN_H
 
 #include <deque>
+#include <vector>
 
 #include "library/processor.h"
 #include "library/plugin_parameters.h"
@@ -155,11 +156,48 @@ protected:
      */
     void set_parameter_and_notify(BoolParameterValue*storage, bool new_value);
 
+    /**
+     * @brief Check whether a parameter has changed since the last call to
+     *        clear_parameter_changes(). All parameters are regarded as changed
+     *        when first registered.
+     * @param parameter_id The id of the parameter to query
+     * @return true if the parameter has been set since changes were last cleared
+     */
+    bool parameter_changed(ObjectId parameter_id) const
+    {
+        return parameter_id < _parameter_changes.size() && _parameter_changes[parameter_id];
+    }
+
+    /**
+     * @brief Check whether any parameter has changed since the last call to
+     *        clear_parameter_changes(). Intended for plugins that need to
+     *        recalculate internal state only when their parameters move.
+     * @return true if at least one parameter has been set since changes were last cleared
+     */
+    bool parameters_changed() const {return _parameters_changed;}
+
+    /**
+     * @brief Flag a parameter as changed, i.e. if a plugin needs to force a
+     *        recalculation of values depending on the parameter.
+     * @param parameter_id The id of the parameter to flag
+     */
+    void mark_parameter_changed(ObjectId parameter_id);
+
+    /**
+     * @brief Reset the change status of all parameters, typically called from
+     *        process_audio() once a plugin has acted on the changes.
+     */
+    void clear_parameter_changes();
+
 private:
     /* TODO - consider container type to use here. Deque has the very desirable property
      * that iterators are never invalidated by adding to the containers.
      * For arrays or std::vectors we need to know the maximum capacity for that to work. */
     std::deque<ParameterStorage> _parameter_values;
+
+    /* Change flags indexed by parameter id, sized at registration, never resized from the rt thread */
+    std::vector<bool> _parameter_changes;
+    bool _parameters_changed{true};
 };
 
 } // end namespace sushi
@@ -84,6 +84,79 @@ rapidjson::Document generate_processor_parameter_document(const sushi::ext::Sush
     return document;
 }
 
+inline const char* parameter_type_name(ParameterType type)
+{
+    switch (type)
+    {
+        case ParameterType::FLOAT:  return "float";
+        case ParameterType::INT:    return "int";
+        case ParameterType::BOOL:   return "bool";
+        case ParameterType::STRING: return "string";
+        case ParameterType::DATA:   return "data";
+    }
+    return "";
+}
+
+rapidjson::Document generate_plugin_metadata_document(const PluginMetadata& metadata)
+{
+    rapidjson::Document document;
+    document.SetObject();
+    rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
+
+    document.AddMember(rapidjson::Value("label", allocator).Move(),
+                       rapidjson::Value(metadata.label.c_str(), allocator).Move(), allocator);
+
+    document.AddMember(rapidjson::Value("input_channels", allocator).Move(),
+                       rapidjson::Value(metadata.max_input_channels).Move(), allocator);
+
+    document.AddMember(rapidjson::Value("output_channels", allocator).Move(),
+                       rapidjson::Value(metadata.max_output_channels).Move(), allocator);
+
+    document.AddMember(rapidjson::Value("latency", allocator).Move(),
+                       rapidjson::Value(metadata.latency).Move(), allocator);
+
+    rapidjson::Value parameters(rapidjson::kArrayType);
+    for (const auto& parameter : metadata.parameters)
+    {
+        rapidjson::Value parameter_obj(rapidjson::kObjectType);
+        parameter_obj.AddMember(rapidjson::Value("name", allocator).Move(),
+                                rapidjson::Value(parameter.name.c_str(), allocator).Move(), allocator);
+
+        parameter_obj.AddMember(rapidjson::Value("label", allocator).Move(),
+                                rapidjson::Value(parameter.label.c_str(), allocator).Move(), allocator);
+
+        parameter_obj.AddMember(rapidjson::Value("unit", allocator).Move(),
+                                rapidjson::Value(parameter.unit.c_str(), allocator).Move(), allocator);
+
+        parameter_obj.AddMember(rapidjson::Value("type", allocator).Move(),
+                                rapidjson::Value(parameter_type_name(parameter.type), allocator).Move(), allocator);
+
+        parameter_obj.AddMember(rapidjson::Value("id", allocator).Move(),
+                                rapidjson::Value(parameter.id).Move(), allocator);
+
+        parameter_obj.AddMember(rapidjson::Value("min", allocator).Move(),
+                                rapidjson::Value(parameter.min_range).Move(), allocator);
+
+        parameter_obj.AddMember(rapidjson::Value("max", allocator).Move(),
+                                rapidjson::Value(parameter.max_range).Move(), allocator);
+
+        parameter_obj.AddMember(rapidjson::Value("automatable", allocator).Move(),
+                                rapidjson::Value(parameter.automatable).Move(), allocator);
+
+        parameters.PushBack(parameter_obj.Move(), allocator);
+    }
+    document.AddMember(rapidjson::Value("parameters", allocator).Move(), parameters.Move(), allocator);
+
+    rapidjson::Value programs(rapidjson::kArrayType);
+    for (const auto& program_name : metadata.program_names)
+    {
+        programs.PushBack(rapidjson::Value(program_name.c_str(), allocator).Move(), allocator);
+    }
+    document.AddMember(rapidjson::Value("programs", allocator).Move(), programs.Move(), allocator);
+
+    return document;
+}
+
 } // end namespace sushi
 
 std::ostream& operator<<(std::ostream& out, const rapidjson::Document& document)
@@ -22,12 +22,15 @@
 #define SUSHI_PARAMETER_DUMP_H
 
 #include "engine/controller.h"
+#include "library/plugin_metadata_cache.h"
 #include "rapidjson/document.h"
 
 namespace sushi {
 
 rapidjson::Document generate_processor_parameter_document(const sushi::ext::SushiControl* engine_controller);
 
+rapidjson::Document generate_plugin_metadata_document(const PluginMetadata& metadata);
+
 } // end namespace sushi
 
 std::ostream& operator<<(std::ostream& out, const rapidjson::Document& document);
@@ -18,6 +18,8 @@
  * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "performance_timer.h"
@@ -29,6 +31,9 @@ namespace sushi {
 namespace performance {
 
 constexpr auto EVALUATION_INTERVAL = std::chrono::seconds(1);
+/* Records are usually stored when processing faster than realtime, the log
+ * queue needs to be emptied more often then to not drop records */
+constexpr auto STORING_EVALUATION_INTERVAL = std::chrono::milliseconds(5);
 constexpr double SEC_TO_NANOSEC = 1'000'000'000.0;
 constexpr float AVERAGEING_FACTOR = 0.3f;
 
@@ -91,7 +96,14 @@ void PerformanceTimer::_worker()
     {
         auto start_time = std::chrono::system_clock::now();
         this->_update_timings();
-        std::this_thread::sleep_until(start_time + EVALUATION_INTERVAL);
+        if (_store_records)
+        {
+            std::this_thread::sleep_until(start_time + STORING_EVALUATION_INTERVAL);
+        }
+        else
+        {
+            std::this_thread::sleep_until(start_time + EVALUATION_INTERVAL);
+        }
     }
 }
 
@@ -110,6 +122,14 @@ void PerformanceTimer::_update_timings()
         const auto& timings = _timings[id];
         auto new_timings = _calculate_timings(node.second);
         _timings[id].timings = _merge_timings(timings.timings, new_timings);
+        if (_store_records)
+        {
+            auto& records = _timings[id].records;
+            for (const auto& entry : node.second)
+            {
+                records.push_back(static_cast<float>(entry.delta_time.count()) / _period);
+            }
+        }
     }
 }
 
@@ -150,6 +170,7 @@ bool PerformanceTimer::clear_timings_for_node(int id)
     if (node != _timings.end())
     {
         new (&node->second.timings) (ProcessTimings);
+        node->second.records.clear();
         return true;
     }
     return false;
@@ -161,7 +182,43 @@ void PerformanceTimer::clear_all_timings()
     for (auto& node : _timings)
     {
         new (&node.second.timings) (ProcessTimings);
+        node.second.records.clear();
+    }
+}
+
+void PerformanceTimer::store_records(bool enabled)
+{
+    _store_records = enabled;
+}
+
+std::optional<float> PerformanceTimer::percentile_for_node(int id, float percentile)
+{
+    std::vector<float> records;
+    {
+        std::lock_guard<std::mutex> lock(_timing_lock);
+        const auto& node = _timings.find(id);
+        if (node == _timings.end() || node->second.records.empty())
+        {
+            return std::nullopt;
+        }
+        records = node->second.records;
+    }
+    /* Nearest rank */
+    float rank = std::clamp(percentile, 0.0f, 100.0f) / 100.0f * (records.size() - 1);
+    auto nth = records.begin() + static_cast<int>(std::lround(rank));
+    std::nth_element(records.begin(), nth, records.end());
+    return *nth;
+}
+
+int PerformanceTimer::stored_records_for_node(int id)
+{
+    std::lock_guard<std::mutex> lock(_timing_lock);
+    const auto& node = _timings.find(id);
+    if (node == _timings.end())
+    {
+        return 0;
     }
+    return static_cast<int>(node->second.records.size());
 }
 
 } // namespace performance
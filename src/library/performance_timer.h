@@ -140,6 +140,12 @@ public:
      */
     void clear_all_timings() override;
 
+    void store_records(bool enabled) override;
+
+    std::optional<float> percentile_for_node(int id, float percentile) override;
+
+    int stored_records_for_node(int id) override;
+
 protected:
 
     struct TimingLogPoint
@@ -152,6 +158,8 @@ protected:
     {
         int id;
         ProcessTimings timings;
+        /* Only filled if records are stored, as fractions of the timing period */
+        std::vector<float> records;
     };
 
     void _worker();
@@ -163,6 +171,7 @@ protected:
     std::thread _process_thread;
     float _period;
     std::atomic_bool _enabled;
+    std::atomic_bool _store_records{false};
 
     std::map<int, TimingNode>  _timings;
     std::mutex _timing_lock;
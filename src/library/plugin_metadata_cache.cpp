@@ -0,0 +1,386 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Persistent cache of plugin metadata, so that plugin binaries don't need
+ *        to be loaded to learn about their parameters, channels and programs
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+#include <sys/stat.h>
+
+#include "library/plugin_metadata_cache.h"
+#include "logging.h"
+
+namespace sushi {
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("plugincache");
+
+constexpr uint32_t METADATA_FILE_MAGIC = 0x4d535553; // "SUSM"
+constexpr uint32_t METADATA_FILE_VERSION = 2;
+
+/* Header of the cache files, followed by the path and uid of the plugin and the
+ * metadata fields in the order they are declared in PluginMetadata. Strings and
+ * lists are stored as a uint32 count followed by the elements, all in native
+ * byte order. The path and uid are compared on reads, as file names are hashes. */
+struct MetadataFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    int64_t  source_size;
+    int64_t  source_mtime;
+};
+
+/* Architecture directory of the library inside a vst3 bundle, as named by the VST3 SDK */
+#if defined(__x86_64__)
+constexpr char VST3_BUNDLE_ARCH[] = "x86_64-linux";
+#elif defined(__aarch64__)
+constexpr char VST3_BUNDLE_ARCH[] = "aarch64-linux";
+#elif defined(__arm__)
+constexpr char VST3_BUNDLE_ARCH[] = "armv7l-linux";
+#elif defined(__i386__)
+constexpr char VST3_BUNDLE_ARCH[] = "i386-linux";
+#else
+constexpr char VST3_BUNDLE_ARCH[] = "unknown-linux";
+#endif
+
+/* Vst3 plugins are bundle directories, whose size and mtime don't change when the
+ * library inside is replaced, so the library at Contents/<arch>/<name>.so is used */
+inline std::string plugin_library_path(const std::string& path, const struct stat& path_stats)
+{
+    if (S_ISDIR(path_stats.st_mode) == false)
+    {
+        return path;
+    }
+    auto bundle = path;
+    while (bundle.size() > 1 && bundle.back() == '/')
+    {
+        bundle.pop_back();
+    }
+    auto name = bundle.substr(bundle.find_last_of('/') + 1);
+    auto extension = name.rfind('.');
+    if (extension != std::string::npos && extension > 0)
+    {
+        name.erase(extension);
+    }
+    return bundle + "/Contents/" + VST3_BUNDLE_ARCH + "/" + name + ".so";
+}
+
+inline bool plugin_file_stats(const std::string& path, int64_t& size, int64_t& mtime)
+{
+    struct stat file_stats;
+    if (stat(path.c_str(), &file_stats) != 0)
+    {
+        return false;
+    }
+    if (S_ISDIR(file_stats.st_mode) &&
+        stat(plugin_library_path(path, file_stats).c_str(), &file_stats) != 0)
+    {
+        return false;
+    }
+    size = file_stats.st_size;
+    mtime = static_cast<int64_t>(file_stats.st_mtim.tv_sec) * 1'000'000'000 + file_stats.st_mtim.tv_nsec;
+    return true;
+}
+
+class MetadataWriter
+{
+public:
+    template <typename T>
+    void write(const T& value)
+    {
+        auto bytes = reinterpret_cast<const char*>(&value);
+        _buffer.insert(_buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    void write(const std::string& string)
+    {
+        write(static_cast<uint32_t>(string.size()));
+        _buffer.insert(_buffer.end(), string.begin(), string.end());
+    }
+
+    const std::vector<char>& buffer() const {return _buffer;}
+
+private:
+    std::vector<char> _buffer;
+};
+
+/* Reads fields back from a cache file, once a read has failed all following
+ * reads fail as well, so that errors only need to be checked at the end */
+class MetadataReader
+{
+public:
+    explicit MetadataReader(const std::vector<char>& buffer) : _buffer(buffer) {}
+
+    template <typename T>
+    T read()
+    {
+        T value{};
+        if (_available(sizeof(T)))
+        {
+            std::memcpy(&value, _buffer.data() + _position, sizeof(T));
+            _position += sizeof(T);
+        }
+        return value;
+    }
+
+    std::string read_string()
+    {
+        auto size = read<uint32_t>();
+        if (_available(size) == false)
+        {
+            return "";
+        }
+        std::string string(_buffer.data() + _position, size);
+        _position += size;
+        return string;
+    }
+
+    /* Returns a count, or 0 if there are fewer bytes left than count elements
+     * of at least min_size bytes would need, as that can only be a corrupt file */
+    uint32_t read_count(size_t min_size)
+    {
+        auto count = read<uint32_t>();
+        return _available(count * min_size) ? count : 0;
+    }
+
+    bool ok() const {return _ok;}
+
+    bool at_end() const {return _position == _buffer.size();}
+
+private:
+    bool _available(size_t size)
+    {
+        _ok = _ok && size <= _buffer.size() - _position;
+        return _ok;
+    }
+
+    const std::vector<char>& _buffer;
+    size_t _position{0};
+    bool _ok{true};
+};
+
+PluginMetadataCache& PluginMetadataCache::instance()
+{
+    static PluginMetadataCache cache;
+    return cache;
+}
+
+std::optional<PluginMetadata> PluginMetadataCache::lookup(const std::string& path, const std::string& uid)
+{
+    int64_t source_size;
+    int64_t source_mtime;
+    if (plugin_file_stats(path, source_size, source_mtime) == false)
+    {
+        return std::nullopt;
+    }
+    std::lock_guard<std::mutex> lock(_lock);
+    Key key(path, uid);
+    auto entry = _entries.find(key);
+    if (entry == _entries.end() && _cache_directory.empty() == false)
+    {
+        Entry new_entry;
+        if (_read_cache_file(_cache_file_name(key), key, new_entry))
+        {
+            entry = _entries.emplace(key, std::move(new_entry)).first;
+        }
+    }
+    if (entry == _entries.end())
+    {
+        return std::nullopt;
+    }
+    if (entry->second.source_size != source_size || entry->second.source_mtime != source_mtime)
+    {
+        SUSHI_LOG_INFO("Plugin {} has changed since its metadata was cached", path);
+        _entries.erase(entry);
+        return std::nullopt;
+    }
+    return entry->second.metadata;
+}
+
+PluginMetadata PluginMetadataCache::store(const std::string& path, const std::string& uid, Processor* plugin)
+{
+    Entry entry;
+    entry.metadata = read_metadata(plugin);
+    if (plugin_file_stats(path, entry.source_size, entry.source_mtime) == false)
+    {
+        return entry.metadata;
+    }
+    std::lock_guard<std::mutex> lock(_lock);
+    Key key(path, uid);
+    if (_cache_directory.empty() == false)
+    {
+        _write_cache_file(_cache_file_name(key), key, entry);
+    }
+    return (_entries[key] = std::move(entry)).metadata;
+}
+
+void PluginMetadataCache::set_cache_directory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _cache_directory = directory;
+}
+
+PluginMetadata PluginMetadataCache::read_metadata(Processor* processor)
+{
+    PluginMetadata metadata;
+    metadata.label = processor->label();
+    metadata.max_input_channels = processor->max_input_channels();
+    metadata.max_output_channels = processor->max_output_channels();
+    metadata.latency = processor->latency();
+    for (const auto& descriptor : processor->all_parameters())
+    {
+        metadata.parameters.push_back({descriptor->id(), descriptor->name(), descriptor->label(), descriptor->unit(),
+                                       descriptor->type(), descriptor->min_range(), descriptor->max_range(),
+                                       descriptor->automatable()});
+    }
+    if (processor->supports_programs())
+    {
+        auto [status, program_names] = processor->all_program_names();
+        if (status == ProcessorReturnCode::OK)
+        {
+            metadata.program_names = std::move(program_names);
+        }
+    }
+    return metadata;
+}
+
+bool PluginMetadataCache::_read_cache_file(const std::string& cache_file, const Key& key, Entry& entry)
+{
+    FILE* file = fopen(cache_file.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    std::vector<char> buffer;
+    char block[4096];
+    size_t bytes_read;
+    while ((bytes_read = fread(block, 1, sizeof(block), file)) > 0)
+    {
+        buffer.insert(buffer.end(), block, block + bytes_read);
+    }
+    fclose(file);
+
+    MetadataReader reader(buffer);
+    auto header = reader.read<MetadataFileHeader>();
+    if (reader.ok() == false || header.magic != METADATA_FILE_MAGIC || header.version != METADATA_FILE_VERSION)
+    {
+        SUSHI_LOG_INFO("Ignoring metadata cache file {} with wrong format or version", cache_file);
+        return false;
+    }
+    auto path = reader.read_string();
+    auto uid = reader.read_string();
+    if (reader.ok() == false || path != key.first || uid != key.second)
+    {
+        SUSHI_LOG_INFO("Ignoring metadata cache file {}, it belongs to another plugin", cache_file);
+        return false;
+    }
+    entry.source_size = header.source_size;
+    entry.source_mtime = header.source_mtime;
+    auto& metadata = entry.metadata;
+    metadata.label = reader.read_string();
+    metadata.max_input_channels = reader.read<int32_t>();
+    metadata.max_output_channels = reader.read<int32_t>();
+    metadata.latency = reader.read<int32_t>();
+    /* Every parameter takes at least 7 fields of 4 bytes */
+    auto parameter_count = reader.read_count(7 * sizeof(uint32_t));
+    for (uint32_t i = 0; i < parameter_count; ++i)
+    {
+        ParameterMetadata parameter;
+        parameter.id = reader.read<uint32_t>();
+        parameter.name = reader.read_string();
+        parameter.label = reader.read_string();
+        parameter.unit = reader.read_string();
+        parameter.type = static_cast<ParameterType>(reader.read<int32_t>());
+        parameter.min_range = reader.read<float>();
+        parameter.max_range = reader.read<float>();
+        parameter.automatable = reader.read<uint8_t>() != 0;
+        metadata.parameters.push_back(std::move(parameter));
+    }
+    auto program_count = reader.read_count(sizeof(uint32_t));
+    for (uint32_t i = 0; i < program_count; ++i)
+    {
+        metadata.program_names.push_back(reader.read_string());
+    }
+    if (reader.ok() == false || reader.at_end() == false)
+    {
+        SUSHI_LOG_WARNING("Metadata cache file {} is corrupt", cache_file);
+        return false;
+    }
+    return true;
+}
+
+void PluginMetadataCache::_write_cache_file(const std::string& cache_file, const Key& key, const Entry& entry)
+{
+    MetadataWriter writer;
+    writer.write(MetadataFileHeader{METADATA_FILE_MAGIC, METADATA_FILE_VERSION, entry.source_size, entry.source_mtime});
+    writer.write(key.first);
+    writer.write(key.second);
+    const auto& metadata = entry.metadata;
+    writer.write(metadata.label);
+    writer.write(static_cast<int32_t>(metadata.max_input_channels));
+    writer.write(static_cast<int32_t>(metadata.max_output_channels));
+    writer.write(static_cast<int32_t>(metadata.latency));
+    writer.write(static_cast<uint32_t>(metadata.parameters.size()));
+    for (const auto& parameter : metadata.parameters)
+    {
+        writer.write(static_cast<uint32_t>(parameter.id));
+        writer.write(parameter.name);
+        writer.write(parameter.label);
+        writer.write(parameter.unit);
+        writer.write(static_cast<int32_t>(parameter.type));
+        writer.write(parameter.min_range);
+        writer.write(parameter.max_range);
+        writer.write(static_cast<uint8_t>(parameter.automatable));
+    }
+    writer.write(static_cast<uint32_t>(metadata.program_names.size()));
+    for (const auto& program_name : metadata.program_names)
+    {
+        writer.write(program_name);
+    }
+
+    /* Write to a temporary file and rename it, so that other processes never
+     * see a partially written cache file */
+    std::string temp_file = cache_file + ".tmp";
+    FILE* file = fopen(temp_file.c_str(), "wb");
+    if (file == nullptr)
+    {
+        SUSHI_LOG_WARNING("Failed to create metadata cache file {}", temp_file);
+        return;
+    }
+    const auto& buffer = writer.buffer();
+    bool ok = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    ok = (fclose(file) == 0) && ok;
+    if (ok == false || rename(temp_file.c_str(), cache_file.c_str()) != 0)
+    {
+        SUSHI_LOG_WARNING("Failed to write metadata cache file {}", cache_file);
+        remove(temp_file.c_str());
+    }
+}
+
+std::string PluginMetadataCache::_cache_file_name(const Key& key) const
+{
+    auto hash = std::hash<std::string>()(key.first + ":" + key.second);
+    char name[32];
+    snprintf(name, sizeof(name), "%016zx.meta", hash);
+    return _cache_directory + "/" + name;
+}
+
+} // end namespace sushi
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Persistent cache of plugin metadata, so that plugin binaries don't need
+ *        to be loaded to learn about their parameters, channels and programs
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_PLUGIN_METADATA_CACHE_H
+#define SUSHI_PLUGIN_METADATA_CACHE_H
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "library/constants.h"
+#include "library/processor.h"
+
+namespace sushi {
+
+struct ParameterMetadata
+{
+    ObjectId id;
+    std::string name;
+    std::string label;
+    std::string unit;
+    ParameterType type;
+    float min_range;
+    float max_range;
+    bool automatable;
+};
+
+struct PluginMetadata
+{
+    std::string label;
+    int max_input_channels{0};
+    int max_output_channels{0};
+    /* In samples */
+    int latency{0};
+    std::vector<ParameterMetadata> parameters;
+    std::vector<std::string> program_names;
+};
+
+/**
+ * @brief Metadata of external plugins, keyed by plugin path and uid. Entries are
+ *        kept in memory and optionally in a cache directory, where they are stored
+ *        with the size and modification time of the plugin file and ignored when
+ *        the plugin has changed. For VST3 bundles the times of the bundle directory
+ *        are used. None of the functions are rt safe.
+ */
+class PluginMetadataCache
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(PluginMetadataCache);
+
+    PluginMetadataCache() = default;
+
+    /**
+     * @brief The cache instance shared by the whole process
+     */
+    static PluginMetadataCache& instance();
+
+    /**
+     * @brief Get the metadata of a plugin without loading it
+     * @param path The path of the plugin library or bundle
+     * @param uid The uid of the plugin, empty for plugins that don't use one
+     * @return The metadata if the plugin is in the cache and has not changed since
+     *         it was stored, std::nullopt otherwise
+     */
+    std::optional<PluginMetadata> lookup(const std::string& path, const std::string& uid);
+
+    /**
+     * @brief Read the metadata from an initialised plugin and store it in the cache,
+     *        replacing any previous entry for the same plugin
+     * @param path The path the plugin was loaded from
+     * @param uid The uid of the plugin, empty for plugins that don't use one
+     * @param plugin The plugin, must have been initialised
+     * @return The metadata read from plugin
+     */
+    PluginMetadata store(const std::string& path, const std::string& uid, Processor* plugin);
+
+    /**
+     * @brief Store metadata in a directory as well, so that it is available to later
+     *        runs. An empty string disables the file cache.
+     * @param directory An existing, writable directory
+     */
+    void set_cache_directory(const std::string& directory);
+
+    /**
+     * @brief Read the metadata of a processor
+     * @param processor An initialised processor
+     * @return The metadata of processor
+     */
+    static PluginMetadata read_metadata(Processor* processor);
+
+private:
+    struct Entry
+    {
+        PluginMetadata metadata;
+        int64_t source_size;
+        int64_t source_mtime;
+    };
+    using Key = std::pair<std::string, std::string>;
+
+    bool _read_cache_file(const std::string& cache_file, const Key& key, Entry& entry);
+    void _write_cache_file(const std::string& cache_file, const Key& key, const Entry& entry);
+    std::string _cache_file_name(const Key& key) const;
+
+    std::mutex _lock;
+    std::map<Key, Entry> _entries;
+    std::string _cache_directory;
+};
+
+} // end namespace sushi
+
+#endif //SUSHI_PLUGIN_METADATA_CACHE_H
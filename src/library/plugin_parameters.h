@@ -21,12 +21,18 @@
 #ifndef SUSHI_PLUGIN_PARAMETERS_H
 #define SUSHI_PLUGIN_PARAMETERS_H
 
+#include <array>
 #include <memory>
 #include <cmath>
+#include <chrono>
+#include <type_traits>
 #include <string>
 #include <cassert>
 
+#include "dsp_library/lookup_tables.h"
+#include "dsp_library/value_smoother.h"
 #include "library/constants.h"
+#include "library/sample_buffer.h"
 #include "library/id_generator.h"
 #include "library/types.h"
 
@@ -111,6 +117,44 @@ protected:
 };
 
 
+/**
+ * @brief A mapping of the form output_scale * f(input_scale * value), where f is
+ *        approximated with one of the lookup tables in dsp_library/lookup_tables.h.
+ *        Parameter values apply it inline, without a virtual call to the pre processor.
+ */
+struct TableMapping
+{
+    enum class Function
+    {
+        NONE,
+        EXP2,
+        LOG2
+    };
+
+    Function function{Function::NONE};
+    float    input_scale{1.0f};
+    float    output_scale{1.0f};
+};
+
+inline float table_lookup(const TableMapping& mapping, float value)
+{
+    switch (mapping.function)
+    {
+        case TableMapping::Function::EXP2:
+            return dsp::lookup::exp2(value * mapping.input_scale) * mapping.output_scale;
+
+        case TableMapping::Function::LOG2:
+        {
+            float x = value * mapping.input_scale;
+            /* The table only covers x > 0, let std::log2 produce -inf or nan for the rest */
+            return (x > 0.0f ? dsp::lookup::log2(x) : std::log2(x)) * mapping.output_scale;
+        }
+
+        default:
+            return value;
+    }
+}
+
 /**
  * @brief Parameter preprocessor for scaling or non-linear mapping. This basic,
  * templated base class only supports clipping to a pre-defined range.
@@ -120,16 +164,24 @@ class ParameterPreProcessor
 {
 public:
     ParameterPreProcessor(T min, T max): _min_range(min), _max_range(max) {}
+    virtual ~ParameterPreProcessor() = default;
     virtual T process(T raw_value) {return clip(raw_value);}
 
-protected:
-    T clip(T raw_value)
+    T clip(T raw_value) const
     {
         return (raw_value > _max_range? _max_range : (raw_value < _min_range? _min_range : raw_value));
     }
 
+    /**
+     * @brief If the function is not NONE, process() is equal to clipping followed by
+     *        this mapping, which parameter values then apply directly.
+     */
+    const TableMapping& table_mapping() const {return _table_mapping;}
+
+protected:
     T _min_range;
     T _max_range;
+    TableMapping _table_mapping;
 };
 
 /**
@@ -243,32 +295,104 @@ typedef TypedParameterDescriptor<std::string*, ParameterType::STRING> StringProp
 typedef TypedParameterDescriptor<BlobData, ParameterType::DATA>       DataPropertyDescriptor;
 
 
+/*
+ * Mapping policies for use with the statically typed pre processors below.
+ * A mapping policy is a stateless class with a static map() function that
+ * calculates the mapping exactly, and a constexpr TABLE that approximates
+ * it using interpolated lookup tables.
+ */
+struct dBToLinMapping
+{
+    static float map(float value) {return powf(10.0f, value / 20.0f);}
+    static float table_map(float value) {return table_lookup(TABLE, value);}
+
+    static constexpr float DB_TO_LOG2 = 0.166096404744f; // log2(10) / 20
+    static constexpr TableMapping TABLE{TableMapping::Function::EXP2, DB_TO_LOG2, 1.0f};
+};
+
+struct LinTodBMapping
+{
+    static float map(float value) {return 20.0f * log10f(value);}
+    static float table_map(float value) {return table_lookup(TABLE, value);}
+
+    static constexpr float LOG2_TO_DB = 6.02059991328f; // 20 / log2(10)
+    static constexpr TableMapping TABLE{TableMapping::Function::LOG2, 1.0f, LOG2_TO_DB};
+};
+
 /**
- * @brief Preprocessor example to map from decibels to linear gain.
+ * @brief Converts a value in semitones to a frequency ratio, i.e. for exponential
+ *        pitch and frequency controls.
  */
-class dBToLinPreProcessor : public FloatParameterPreProcessor
+struct SemitonesToRatioMapping
+{
+    static float map(float value) {return exp2f(value / 12.0f);}
+    static float table_map(float value) {return table_lookup(TABLE, value);}
+
+    static constexpr TableMapping TABLE{TableMapping::Function::EXP2, 1.0f / 12.0f, 1.0f};
+};
+
+/**
+ * @brief Pre processor that calculates the mapping exactly. Parameters call it
+ *        through a FloatParameterPreProcessor pointer, so process() is still a
+ *        virtual call, only the mapping inside it is resolved at compile time.
+ */
+template<class Mapping>
+class MappedPreProcessor final : public FloatParameterPreProcessor
 {
 public:
-    dBToLinPreProcessor(float min, float max): FloatParameterPreProcessor(min, max) {}
+    MappedPreProcessor(float min, float max): FloatParameterPreProcessor(min, max) {}
+
     float process(float raw_value) override
     {
-        return powf(10.0f, this->clip(raw_value) / 20.0f);
+        return Mapping::map(this->clip(raw_value));
     }
 };
 
 /**
- * @brief Preprocessor example to map from linear gain to decibels.
+ * @brief Statically typed pre processor that approximates the mapping using
+ *        interpolated lookup tables. Intended for parameters that are updated
+ *        often from the rt thread, i.e. automated gain parameters. Parameter
+ *        values do the table lookup themselves, without calling process().
  */
-class LinTodBPreProcessor : public FloatParameterPreProcessor
+template<class Mapping>
+class TableMappedPreProcessor final : public FloatParameterPreProcessor
 {
 public:
-    LinTodBPreProcessor(float min, float max): FloatParameterPreProcessor(min, max) {}
+    TableMappedPreProcessor(float min, float max): FloatParameterPreProcessor(min, max)
+    {
+        _table_mapping = Mapping::TABLE;
+        /* Make sure the lookup tables are created outside of the rt thread */
+        Mapping::table_map(max);
+    }
+
     float process(float raw_value) override
     {
-        return 20.0f * log10(this->clip(raw_value));
+        return Mapping::table_map(this->clip(raw_value));
     }
 };
 
+typedef TableMappedPreProcessor<dBToLinMapping> dBToLinPreProcessor;
+typedef TableMappedPreProcessor<LinTodBMapping> LinTodBPreProcessor;
+
+/* State that only float parameter values carry, empty for other types */
+template<typename T>
+struct ParameterValueState
+{
+    explicit ParameterValueState(const ParameterPreProcessor<T>* /*pre_processor*/) {}
+};
+
+template<>
+struct ParameterValueState<float>
+{
+    explicit ParameterValueState(const ParameterPreProcessor<float>* pre_processor) :
+                                 table_mapping(pre_processor->table_mapping()) {}
+
+    /* Copied from the pre processor so that table lookups need no virtual call */
+    TableMapping table_mapping;
+    bool smoothing{false};
+    ValueSmootherRamp<float> smoother;
+};
+
 template<typename T, ParameterType enumerated_type>
 class ParameterValue
 {
@@ -276,24 +400,118 @@ public:
     ParameterValue(ParameterPreProcessor<T>* pre_processor,
                    T value, ParameterDescriptor* descriptor) : _descriptor(descriptor),
                                                                _pre_processor(pre_processor),
+                                                               _state(pre_processor),
                                                                _raw_value(value),
-                                                               _value(pre_processor->process(value)){}
+                                                               _value(_process(value)){}
 
     ParameterType type() const {return _type;}
     T value() const {return _value;}
     T raw_value() const {return _raw_value;}
     ParameterDescriptor* descriptor() const {return _descriptor;}
 
-    void set_values(T value, T raw_value) {_value = value; _raw_value = raw_value;}
+    void set_values(T value, T raw_value)
+    {
+        _value = value;
+        _raw_value = raw_value;
+        _update_smoother();
+    }
+
     void set(T value)
     {
         _raw_value = value;
-        _value = _pre_processor->process(value);
+        _value = _process(value);
+        _update_smoother();
+    }
+
+    /**
+     * @brief Enable per sample smoothing of the processed value. When enabled, calls
+     *        to render_values() ramp linearly to new values over lag_time. Should be
+     *        called from init() or configure(), only supported for float parameters.
+     * @param lag_time The time to ramp to a new value
+     * @param sample_rate The current sample rate
+     */
+    void set_smoothing(std::chrono::duration<float, std::ratio<1,1>> lag_time, float sample_rate)
+    {
+        static_assert(std::is_same_v<T, float>, "Smoothing only supported for float parameters");
+        _state.smoother.set_lag_time(lag_time, sample_rate);
+        _state.smoother.set_direct(_value);
+        _state.smoothing = true;
     }
+
+    /**
+     * @brief Whether or not per sample smoothing is enabled for this parameter
+     */
+    bool smoothing() const
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            return _state.smoothing;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Whether or not smoothing is enabled and the smoothed value is still moving
+     *        towards the last value set. If not, the per sample values are all equal
+     *        to value() and the parameter can be treated as constant for the next chunk.
+     */
+    bool smoothing_active() const
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            return _state.smoothing && !_state.smoother.stationary();
+        }
+        return false;
+    }
+
+    /**
+     * @brief Fill a buffer with the per sample values of the parameter for the next
+     *        audio chunk. Call once per chunk from process_audio().
+     * @param buffer A 1 channel buffer that will receive the values
+     */
+    void render_values(ChunkSampleBuffer& buffer)
+    {
+        static_assert(std::is_same_v<T, float>, "Smoothing only supported for float parameters");
+        assert(buffer.channel_count() == 1);
+        if (_state.smoothing)
+        {
+            _state.smoother.next_values(buffer.channel(0), AUDIO_CHUNK_SIZE);
+        }
+        else
+        {
+            std::fill(buffer.channel(0), buffer.channel(0) + AUDIO_CHUNK_SIZE, _value);
+        }
+    }
+
 private:
+    T _process(T value) const
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (_state.table_mapping.function != TableMapping::Function::NONE)
+            {
+                return table_lookup(_state.table_mapping, _pre_processor->clip(value));
+            }
+        }
+        return _pre_processor->process(value);
+    }
+
+    void _update_smoother()
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (_state.smoothing)
+            {
+                _state.smoother.set(_value);
+            }
+        }
+    }
+
     ParameterType _type{enumerated_type};
     ParameterDescriptor* _descriptor{nullptr};
     ParameterPreProcessor<T>* _pre_processor{nullptr};
+    /* After _type and _descriptor, which ParameterStorage reads through any union member */
+    ParameterValueState<T> _state;
     T _raw_value;
     T _value;
 };
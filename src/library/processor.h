@@ -303,6 +303,36 @@ public:
      */
     virtual ProcessorReturnCode set_program(int /*program*/) {return ProcessorReturnCode::UNSUPPORTED_OPERATION;}
 
+    /**
+     * @brief Get the complete state of the processor as opaque data, for processors
+     *        whose state is not fully described by their parameters and current
+     *        program, i.e. external plugins. Called from a non-rt thread
+     * @return The state data if return is OK, UNSUPPORTED_OPERATION if the processor
+     *         has no such state
+     */
+    virtual std::pair<ProcessorReturnCode, std::vector<uint8_t>> state_chunk()
+    {
+        return {ProcessorReturnCode::UNSUPPORTED_OPERATION, std::vector<uint8_t>()};
+    }
+
+    /**
+     * @brief Restore a state previously returned from state_chunk(). Called from a
+     *        non-rt thread
+     * @param data The state data, only needs to be valid for the duration of the call
+     * @param size The size of data in bytes
+     * @return OK if the operation was successful, error code otherwise
+     */
+    virtual ProcessorReturnCode set_state_chunk(const uint8_t* /*data*/, size_t /*size*/)
+    {
+        return ProcessorReturnCode::UNSUPPORTED_OPERATION;
+    }
+
+    /**
+     * @brief Get the latency the processor adds to its audio output
+     * @return The latency in samples
+     */
+    virtual int latency() {return 0;}
+
     /**
      * @brief Connect a parameter of the processor to a cv out so that rt updates of
      *        the parameter will be sent to the cv output
@@ -331,6 +331,23 @@ public:
         }
     }
 
+    /**
+     * @brief Apply a per sample gain to the entire buffer.
+     * @param gain A 1 channel buffer holding the gain for every sample
+     */
+    void apply_gain(const SampleBuffer& gain)
+    {
+        assert(gain.channel_count() == 1);
+        for (int channel = 0; channel < _channel_count; ++channel)
+        {
+            float* data = _buffer + size * channel;
+            for (int i = 0; i < size; ++i)
+            {
+                data[i] *= gain._buffer[i];
+            }
+        }
+    }
+
     /**
      * @brief Replace the contents of the buffer with that of another buffer
      * @param source SampleBuffer with either 1 channel or the same number of
@@ -434,6 +451,31 @@ public:
         }
     }
 
+    /**
+     * @brief Sums the content of SampleBuffer source into this buffer after applying a
+     *        per sample gain.
+     *
+     * source has to be either a 1 channel buffer or have the same number of channels
+     * as the destination buffer.
+     * @param source The buffer to copy from
+     * @param gain A 1 channel buffer holding the gain for every sample
+    */
+    void add_with_gain(const SampleBuffer &source, const SampleBuffer& gain)
+    {
+        assert(source.channel_count() == 1 || source.channel_count() == this->channel_count());
+        assert(gain.channel_count() == 1);
+
+        for (int channel = 0; channel < _channel_count; ++channel)
+        {
+            float* dest = _buffer + size * channel;
+            const float* source_data = source._buffer + (source.channel_count() == 1 ? 0 : size * channel);
+            for (int i = 0; i < size; ++i)
+            {
+                dest[i] += source_data[i] * gain._buffer[i];
+            }
+        }
+    }
+
     /**
      * @brief Sums one channel of source buffer into one channel of the buffer after applying gain.
      */
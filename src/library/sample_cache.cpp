@@ -0,0 +1,317 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Process wide cache of decoded sample data, shared between plugin instances
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sndfile.h>
+
+#include "library/sample_cache.h"
+#include "logging.h"
+
+namespace sushi {
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("samplecache");
+
+constexpr uint32_t CACHE_FILE_MAGIC = 0x46535553; // "SUSF"
+constexpr uint32_t CACHE_FILE_VERSION = 3;
+
+/* Header of the cache files, followed by the canonical path of the source file
+ * and the sample data as native floats, starting at data_offset. The path is
+ * compared on loads, as file names are hashes. The size and modification time
+ * of the source file, in nanoseconds, are used to detect when a cache file is
+ * out of date. */
+struct CacheFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    int32_t  frames;
+    int32_t  total_frames;
+    int64_t  source_size;
+    int64_t  source_mtime;
+    uint32_t path_size;
+    uint32_t data_offset;
+};
+
+static std::string canonical_path(const std::string& file_name)
+{
+    char resolved[PATH_MAX];
+    return realpath(file_name.c_str(), resolved) != nullptr ? std::string(resolved) : file_name;
+}
+
+static bool source_file_stats(const std::string& file_name, int64_t& size, int64_t& mtime)
+{
+    struct stat file_stats;
+    if (stat(file_name.c_str(), &file_stats) != 0)
+    {
+        return false;
+    }
+    size = file_stats.st_size;
+    mtime = static_cast<int64_t>(file_stats.st_mtim.tv_sec) * 1'000'000'000 + file_stats.st_mtim.tv_nsec;
+    return true;
+}
+
+SampleCache::~SampleCache()
+{
+    for (auto& entry : _entries)
+    {
+        _free(entry.second);
+    }
+}
+
+SampleCache& SampleCache::instance()
+{
+    static SampleCache cache;
+    return cache;
+}
+
+CachedSample SampleCache::acquire(const std::string& file_name, int max_frames)
+{
+    /* Different spellings of the same file should share one entry and cache file */
+    Key key(canonical_path(file_name), std::max(max_frames, 0));
+    std::lock_guard<std::mutex> lock(_lock);
+    auto cached = _entries.find(key);
+    if (cached != _entries.end())
+    {
+        cached->second.references++;
+        return cached->second.sample;
+    }
+    Entry entry;
+    if (_load(key, entry) == false)
+    {
+        return CachedSample();
+    }
+    entry.references = 1;
+    auto sample = entry.sample;
+    _entries.emplace(key, std::move(entry));
+    _keys[sample.data] = key;
+    return sample;
+}
+
+bool SampleCache::release(const void* data)
+{
+    if (data == nullptr)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_lock);
+    auto key = _keys.find(data);
+    if (key == _keys.end())
+    {
+        return false;
+    }
+    auto i = _entries.find(key->second);
+    assert(i != _entries.end());
+    if (--i->second.references <= 0)
+    {
+        SUSHI_LOG_DEBUG("Releasing cached sample {}", i->first.first);
+        _free(i->second);
+        _entries.erase(i);
+        _keys.erase(key);
+    }
+    return true;
+}
+
+void SampleCache::set_cache_directory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _cache_directory = directory;
+}
+
+int SampleCache::size() const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return static_cast<int>(_entries.size());
+}
+
+bool SampleCache::_load(const Key& key, Entry& entry)
+{
+    const auto& file_name = key.first;
+    std::string cache_file;
+    if (_cache_directory.empty() == false)
+    {
+        cache_file = _cache_file_name(key);
+        if (_map_cache_file(cache_file, file_name, entry))
+        {
+            SUSHI_LOG_INFO("Loaded sample {} from cache file {}", file_name, cache_file);
+            return true;
+        }
+    }
+
+    SF_INFO soundfile_info = {};
+    SNDFILE* sample_file = sf_open(file_name.c_str(), SFM_READ, &soundfile_info);
+    if (sample_file == nullptr)
+    {
+        SUSHI_LOG_ERROR("Failed to open sample file: {}", file_name);
+        return false;
+    }
+    if (soundfile_info.channels != 1)
+    {
+        SUSHI_LOG_ERROR("Sample file {} has {} channels, only mono samples are supported", file_name, soundfile_info.channels);
+        sf_close(sample_file);
+        return false;
+    }
+    int frames = static_cast<int>(soundfile_info.frames);
+    if (key.second > 0)
+    {
+        frames = std::min(frames, key.second);
+    }
+    entry.buffer = std::make_unique<float[]>(frames);
+    int frames_read = static_cast<int>(sf_readf_float(sample_file, entry.buffer.get(), frames));
+    sf_close(sample_file);
+    if (frames_read <= 0)
+    {
+        SUSHI_LOG_ERROR("Failed to read sample data from: {}", file_name);
+        return false;
+    }
+    entry.sample = {entry.buffer.get(), frames_read, static_cast<int>(soundfile_info.frames)};
+
+    if (cache_file.empty() == false)
+    {
+        _write_cache_file(cache_file, file_name, entry);
+    }
+    return true;
+}
+
+bool SampleCache::_map_cache_file(const std::string& cache_file, const std::string& file_name, Entry& entry)
+{
+    int64_t source_size;
+    int64_t source_mtime;
+    if (source_file_stats(file_name, source_size, source_mtime) == false)
+    {
+        return false;
+    }
+    int fd = open(cache_file.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat file_stats;
+    if (fstat(fd, &file_stats) != 0 || file_stats.st_size < static_cast<off_t>(sizeof(CacheFileHeader)))
+    {
+        ::close(fd);
+        return false;
+    }
+    size_t size = file_stats.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    const auto header = static_cast<const CacheFileHeader*>(mapping);
+    const auto path = reinterpret_cast<const char*>(header + 1);
+    if (header->magic != CACHE_FILE_MAGIC || header->version != CACHE_FILE_VERSION ||
+        header->path_size != file_name.size() || header->data_offset % sizeof(float) != 0 ||
+        header->data_offset < sizeof(CacheFileHeader) + header->path_size || header->frames <= 0 ||
+        size != header->data_offset + header->frames * sizeof(float))
+    {
+        SUSHI_LOG_INFO("Cache file {} is not valid", cache_file);
+        munmap(mapping, size);
+        return false;
+    }
+    if (file_name.compare(0, file_name.size(), path, header->path_size) != 0)
+    {
+        SUSHI_LOG_INFO("Cache file {} belongs to another sample file", cache_file);
+        munmap(mapping, size);
+        return false;
+    }
+    if (header->source_size != source_size || header->source_mtime != source_mtime)
+    {
+        SUSHI_LOG_INFO("Cache file {} is out of date", cache_file);
+        munmap(mapping, size);
+        return false;
+    }
+    entry.mapping = mapping;
+    entry.mapping_size = size;
+    entry.sample = {reinterpret_cast<const float*>(static_cast<const char*>(mapping) + header->data_offset),
+                    header->frames, header->total_frames};
+    return true;
+}
+
+void SampleCache::_write_cache_file(const std::string& cache_file, const std::string& file_name, const Entry& entry)
+{
+    auto path_size = static_cast<uint32_t>(file_name.size());
+    /* Pad the path so that the sample data is aligned */
+    auto data_offset = static_cast<uint32_t>((sizeof(CacheFileHeader) + path_size + sizeof(float) - 1) / sizeof(float) * sizeof(float));
+    CacheFileHeader header{CACHE_FILE_MAGIC, CACHE_FILE_VERSION, entry.sample.frames, entry.sample.total_frames,
+                           0, 0, path_size, data_offset};
+    if (source_file_stats(file_name, header.source_size, header.source_mtime) == false)
+    {
+        return;
+    }
+    /* Write to a uniquely named temporary file and rename it, so that other
+     * processes never see, or write into, a partially written cache file */
+    std::string temp_file = cache_file + ".XXXXXX";
+    int fd = mkstemp(temp_file.data());
+    FILE* file = fd < 0 ? nullptr : fdopen(fd, "wb");
+    if (file == nullptr)
+    {
+        SUSHI_LOG_WARNING("Failed to create cache file {}", temp_file);
+        if (fd >= 0)
+        {
+            ::close(fd);
+            remove(temp_file.c_str());
+        }
+        return;
+    }
+    const char padding[sizeof(float)] = {};
+    size_t padding_size = data_offset - sizeof(CacheFileHeader) - path_size;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(file_name.data(), 1, path_size, file) == path_size &&
+              fwrite(padding, 1, padding_size, file) == padding_size &&
+              fwrite(entry.sample.data, sizeof(float), entry.sample.frames, file) == static_cast<size_t>(entry.sample.frames);
+    ok = (fclose(file) == 0) && ok;
+    if (ok == false || rename(temp_file.c_str(), cache_file.c_str()) != 0)
+    {
+        SUSHI_LOG_WARNING("Failed to write cache file {}", cache_file);
+        remove(temp_file.c_str());
+    }
+}
+
+std::string SampleCache::_cache_file_name(const Key& key) const
+{
+    auto hash = std::hash<std::string>()(key.first + ":" + std::to_string(key.second));
+    char name[32];
+    snprintf(name, sizeof(name), "%016zx.f32", hash);
+    return _cache_directory + "/" + name;
+}
+
+void SampleCache::_free(Entry& entry)
+{
+    if (entry.mapping)
+    {
+        munmap(entry.mapping, entry.mapping_size);
+        entry.mapping = nullptr;
+    }
+    entry.buffer.reset();
+}
+
+} // end namespace sushi
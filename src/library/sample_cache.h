@@ -0,0 +1,125 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Process wide cache of decoded sample data, shared between plugin instances
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_SAMPLE_CACHE_H
+#define SUSHI_SAMPLE_CACHE_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "library/constants.h"
+
+namespace sushi {
+
+/**
+ * @brief Mono sample data owned by the SampleCache
+ */
+struct CachedSample
+{
+    const float* data{nullptr};
+    /* The number of frames in data */
+    int frames{0};
+    /* The number of frames in the sample file, larger than frames if only the
+     * beginning of the file was loaded */
+    int total_frames{0};
+};
+
+/**
+ * @brief Sample files are decoded once and shared between all users of the same
+ *        file, with the data kept alive by a reference count. Optionally the
+ *        decoded data is stored as raw floats in a cache directory, and memory
+ *        mapped from there the next time the file is loaded. None of the
+ *        functions are rt safe.
+ */
+class SampleCache
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(SampleCache);
+
+    SampleCache() = default;
+
+    ~SampleCache();
+
+    /**
+     * @brief The cache instance shared by the whole process
+     */
+    static SampleCache& instance();
+
+    /**
+     * @brief Get the data of a mono sample file, decoding the file if it is not
+     *        already in the cache. Each successful call must be matched by a call
+     *        to release().
+     * @param file_name The sample file to load
+     * @param max_frames If > 0, only load up to this many frames from the start of
+     *        the file. Cached separately from the same file loaded in full.
+     * @return The sample data, data is nullptr if the file could not be loaded
+     */
+    CachedSample acquire(const std::string& file_name, int max_frames = 0);
+
+    /**
+     * @brief Release one reference to sample data, the data is freed when the last
+     *        reference is released.
+     * @param data A data pointer returned from acquire()
+     * @return true if data belonged to the cache, false otherwise
+     */
+    bool release(const void* data);
+
+    /**
+     * @brief Store decoded samples in a directory and load them from there with
+     *        mmap when available. An empty string disables the file cache.
+     * @param directory An existing, writable directory
+     */
+    void set_cache_directory(const std::string& directory);
+
+    /**
+     * @brief Get the number of sample files currently in memory
+     */
+    int size() const;
+
+private:
+    struct Entry
+    {
+        std::unique_ptr<float[]> buffer;
+        void* mapping{nullptr};
+        size_t mapping_size{0};
+        CachedSample sample;
+        int references{0};
+    };
+    using Key = std::pair<std::string, int>;
+
+    bool _load(const Key& key, Entry& entry);
+    bool _map_cache_file(const std::string& cache_file, const std::string& file_name, Entry& entry);
+    void _write_cache_file(const std::string& cache_file, const std::string& file_name, const Entry& entry);
+    std::string _cache_file_name(const Key& key) const;
+    void _free(Entry& entry);
+
+    mutable std::mutex _lock;
+    std::map<Key, Entry> _entries;
+    /* The entry of each data pointer handed out, for release() */
+    std::map<const void*, Key> _keys;
+    std::string _cache_directory;
+};
+
+} // end namespace sushi
+
+#endif //SUSHI_SAMPLE_CACHE_H
@@ -252,6 +252,34 @@ ProcessorReturnCode Vst2xWrapper::set_program(int program)
     return ProcessorReturnCode::UNSUPPORTED_OPERATION;
 }
 
+std::pair<ProcessorReturnCode, std::vector<uint8_t>> Vst2xWrapper::state_chunk()
+{
+    if ((_plugin_handle->flags & effFlagsProgramChunks) == 0)
+    {
+        return {ProcessorReturnCode::UNSUPPORTED_OPERATION, std::vector<uint8_t>()};
+    }
+    void* data = nullptr;
+    /* Index 0 requests the whole bank rather than only the current program */
+    int size = _vst_dispatcher(effGetChunk, 0, 0, &data, 0);
+    if (size <= 0 || data == nullptr)
+    {
+        return {ProcessorReturnCode::ERROR, std::vector<uint8_t>()};
+    }
+    auto bytes = static_cast<const uint8_t*>(data);
+    return {ProcessorReturnCode::OK, std::vector<uint8_t>(bytes, bytes + size)};
+}
+
+ProcessorReturnCode Vst2xWrapper::set_state_chunk(const uint8_t* data, size_t size)
+{
+    if ((_plugin_handle->flags & effFlagsProgramChunks) == 0)
+    {
+        return ProcessorReturnCode::UNSUPPORTED_OPERATION;
+    }
+    /* The return value is not a reliable failure signal, many plugins return 0 on success */
+    _vst_dispatcher(effSetChunk, 0, static_cast<VstIntPtr>(size), const_cast<uint8_t*>(data), 0);
+    return ProcessorReturnCode::OK;
+}
+
 void Vst2xWrapper::_cleanup()
 {
     if (_plugin_handle != nullptr)
@@ -107,6 +107,12 @@ public:
 
     ProcessorReturnCode set_program(int program) override;
 
+    std::pair<ProcessorReturnCode, std::vector<uint8_t>> state_chunk() override;
+
+    ProcessorReturnCode set_state_chunk(const uint8_t* data, size_t size) override;
+
+    int latency() override {return _plugin_handle->initialDelay;}
+
     /**
      * @brief Get the vst time information
      * @return A populated VstTimeInfo struct
@@ -18,6 +18,7 @@
  * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */#ifdef SUSHI_BUILD_WITH_VST3
 
+#include <algorithm>
 #include <fstream>
 #include <string>
 #include <climits>
@@ -882,6 +883,64 @@ void Vst3xWrapper::set_parameter_change(ObjectId param_id, float value)
     _host_control.post_event(event);
 }
 
+std::pair<ProcessorReturnCode, std::vector<uint8_t>> Vst3xWrapper::state_chunk()
+{
+    /* The chunk holds the size of the component state, the component state and
+     * then the controller state, which may be empty */
+    Steinberg::MemoryStream component_stream;
+    if (_instance.component()->getState(&component_stream) != Steinberg::kResultTrue)
+    {
+        SUSHI_LOG_WARNING("Failed to get state from processor");
+        return {ProcessorReturnCode::ERROR, std::vector<uint8_t>()};
+    }
+    Steinberg::MemoryStream controller_stream;
+    if (_instance.controller()->getState(&controller_stream) != Steinberg::kResultTrue)
+    {
+        controller_stream.setSize(0);
+    }
+    auto component_size = static_cast<uint32_t>(component_stream.getSize());
+    auto controller_size = static_cast<uint32_t>(controller_stream.getSize());
+    std::vector<uint8_t> state(sizeof(component_size) + component_size + controller_size);
+    std::copy_n(reinterpret_cast<const uint8_t*>(&component_size), sizeof(component_size), state.data());
+    std::copy_n(reinterpret_cast<const uint8_t*>(component_stream.getData()), component_size,
+                state.data() + sizeof(component_size));
+    std::copy_n(reinterpret_cast<const uint8_t*>(controller_stream.getData()), controller_size,
+                state.data() + sizeof(component_size) + component_size);
+    return {ProcessorReturnCode::OK, std::move(state)};
+}
+
+ProcessorReturnCode Vst3xWrapper::set_state_chunk(const uint8_t* data, size_t size)
+{
+    uint32_t component_size;
+    if (size < sizeof(component_size))
+    {
+        return ProcessorReturnCode::ERROR;
+    }
+    std::copy_n(data, sizeof(component_size), reinterpret_cast<uint8_t*>(&component_size));
+    if (size < sizeof(component_size) + component_size)
+    {
+        return ProcessorReturnCode::ERROR;
+    }
+    /* The streams read directly from data, without copying it */
+    auto component_data = const_cast<uint8_t*>(data) + sizeof(component_size);
+    Steinberg::MemoryStream component_stream(component_data, component_size);
+    if (_instance.component()->setState(&component_stream) != Steinberg::kResultTrue)
+    {
+        SUSHI_LOG_WARNING("Failed to set processor state");
+        return ProcessorReturnCode::ERROR;
+    }
+    component_stream.seek(0, Steinberg::MemoryStream::kIBSeekSet, nullptr);
+    _instance.controller()->setComponentState(&component_stream);
+
+    auto controller_size = size - sizeof(component_size) - component_size;
+    if (controller_size > 0)
+    {
+        Steinberg::MemoryStream controller_stream(component_data + component_size, controller_size);
+        _instance.controller()->setState(&controller_stream);
+    }
+    return ProcessorReturnCode::OK;
+}
+
 bool Vst3xWrapper::_sync_controller_to_processor()
 {
     Steinberg::MemoryStream stream;
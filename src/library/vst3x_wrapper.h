@@ -114,6 +114,12 @@ public:
 
     ProcessorReturnCode set_program(int program) override;
 
+    std::pair<ProcessorReturnCode, std::vector<uint8_t>> state_chunk() override;
+
+    ProcessorReturnCode set_state_chunk(const uint8_t* data, size_t size) override;
+
+    int latency() override {return static_cast<int>(_instance.processor()->getLatencySamples());}
+
     static void program_change_callback(void* arg, Event* event, int status)
     {
         reinterpret_cast<Vst3xWrapper*>(arg)->_program_change_callback(event, status);
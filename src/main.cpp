@@ -25,6 +25,9 @@
 #include <csignal>
 #include <memory>
 #include <condition_variable>
+#include <tuple>
+
+#include <sched.h>
 
 #include "twine/src/twine_internal.h"
 
@@ -33,12 +36,18 @@
 #include "generated/version.h"
 #include "engine/audio_engine.h"
 #include "audio_frontends/offline_frontend.h"
+#include "audio_frontends/offline_batch_renderer.h"
 #include "audio_frontends/jack_frontend.h"
 #include "audio_frontends/xenomai_raspa_frontend.h"
 #include "engine/json_configurator.h"
+#include "engine/shared_state_publisher.h"
+#include "engine/session_snapshot.h"
 #include "control_frontends/osc_frontend.h"
 #include "control_frontends/alsa_midi_frontend.h"
 #include "library/parameter_dump.h"
+#include "library/benchmark_report.h"
+#include "library/sample_cache.h"
+#include "library/plugin_metadata_cache.h"
 
 #ifdef SUSHI_BUILD_WITH_RPC_INTERFACE
 #include "sushi_rpc/grpc_server.h"
@@ -93,6 +102,59 @@ void error_exit(const std::string& message)
     std::exit(1);
 }
 
+std::vector<int> parse_cpu_list(const std::string& list)
+{
+    std::vector<int> cores;
+    std::istringstream stream(list);
+    std::string core;
+    while (std::getline(stream, core, ','))
+    {
+        int core_number = 0;
+        try
+        {
+            core_number = std::stoi(core);
+        }
+        catch (const std::logic_error&)
+        {
+            error_exit("Invalid cpu core in list: " + list);
+        }
+        if (core_number < 0 || core_number >= CPU_SETSIZE)
+        {
+            error_exit("Cpu core out of range in list: " + list);
+        }
+        cores.push_back(core_number);
+    }
+    return cores;
+}
+
+/* Splits a --dump-plugin-info argument of the form <type>:<uid>:<path>, the path may contain ':' */
+std::tuple<sushi::engine::PluginType, std::string, std::string> parse_plugin_info(const std::string& argument)
+{
+    auto uid_start = argument.find(':');
+    auto path_start = uid_start == std::string::npos ? std::string::npos : argument.find(':', uid_start + 1);
+    if (path_start == std::string::npos)
+    {
+        error_exit("Invalid plugin, expected <type>:<uid>:<path>: " + argument);
+    }
+    auto type = argument.substr(0, uid_start);
+    auto uid = argument.substr(uid_start + 1, path_start - uid_start - 1);
+    auto path = argument.substr(path_start + 1);
+    if (type == "internal")
+    {
+        return {sushi::engine::PluginType::INTERNAL, uid, path};
+    }
+    if (type == "vst2x")
+    {
+        return {sushi::engine::PluginType::VST2X, uid, path};
+    }
+    if (type == "vst3x")
+    {
+        return {sushi::engine::PluginType::VST3X, uid, path};
+    }
+    error_exit("Invalid plugin type: " + type);
+    return {};
+}
+
 void print_version_and_build_info()
 {
     std::cout << "\nVersion "   << SUSHI__VERSION_MAJ << "."
@@ -156,6 +218,15 @@ int main(int argc, char* argv[])
 
     std::string input_filename;
     std::string output_filename;
+    int output_sample_rate = 0;
+    bool track_parallel = false;
+    std::string batch_list_filename;
+    std::string batch_input_dir;
+    std::string batch_output_dir = std::string(".");
+    int batch_jobs = 0;
+    bool enable_benchmark = false;
+    sushi::audio_frontend::BenchmarkConfiguration benchmark_config;
+    std::string benchmark_report_filename = std::string(SUSHI_BENCHMARK_REPORT_DEFAULT);
 
     std::string log_level = std::string(SUSHI_LOG_LEVEL_DEFAULT);
     std::string log_filename = std::string(SUSHI_LOG_FILENAME_DEFAULT);
@@ -164,7 +235,15 @@ int main(int argc, char* argv[])
     std::string jack_server_name = std::string("");
     int osc_server_port = SUSHI_OSC_SERVER_PORT;
     int osc_send_port = SUSHI_OSC_SEND_PORT;
+    float osc_max_output_rate = SUSHI_OSC_MAX_OUTPUT_RATE;
     std::string grpc_listening_address = std::string(SUSHI_GRPC_LISTENING_PORT);
+    [[maybe_unused]] int grpc_threads = 1;
+    std::vector<int> grpc_cpu_cores;
+    std::string sample_cache_dir;
+    std::string validation_cache_dir;
+    std::string plugin_cache_dir;
+    std::string shared_state_name;
+    std::string state_file;
     FrontendType frontend_type = FrontendType::NONE;
     bool connect_ports = false;
     bool debug_mode_switches = false;
@@ -172,6 +251,7 @@ int main(int argc, char* argv[])
     bool enable_timings = false;
     bool enable_flush_interval = false;
     bool enable_parameter_dump = false;
+    std::string plugin_info;
     std::chrono::seconds log_flush_interval = std::chrono::seconds(0);
 
     for (int i=0; i<cl_parser.optionsCount(); i++)
@@ -209,6 +289,10 @@ int main(int argc, char* argv[])
             enable_parameter_dump = true;
             break;
 
+        case OPT_IDX_DUMP_PLUGIN_INFO:
+            plugin_info = opt.arg;
+            break;
+
         case OPT_IDX_CONFIG_FILE:
             config_filename.assign(opt.arg);
             break;
@@ -225,10 +309,88 @@ int main(int argc, char* argv[])
             output_filename.assign(opt.arg);
             break;
 
+        case OPT_IDX_OUTPUT_SAMPLE_RATE:
+            output_sample_rate = atoi(opt.arg);
+            break;
+
+        case OPT_IDX_TRACK_PARALLEL:
+            track_parallel = true;
+            break;
+
+        case OPT_IDX_BATCH_LIST:
+            batch_list_filename.assign(opt.arg);
+            break;
+
+        case OPT_IDX_BATCH_INPUT_DIR:
+            batch_input_dir.assign(opt.arg);
+            break;
+
+        case OPT_IDX_BATCH_OUTPUT_DIR:
+            batch_output_dir.assign(opt.arg);
+            break;
+
+        case OPT_IDX_BATCH_JOBS:
+            batch_jobs = atoi(opt.arg);
+            break;
+
         case OPT_IDX_USE_DUMMY:
             frontend_type = FrontendType::DUMMY;
             break;
 
+        case OPT_IDX_BENCHMARK:
+        {
+            std::string length(opt.arg);
+            if (length.back() == 's')
+            {
+                benchmark_config.seconds = std::strtof(length.c_str(), nullptr);
+            }
+            else
+            {
+                benchmark_config.chunks = std::strtoll(length.c_str(), nullptr, 0);
+            }
+            enable_benchmark = true;
+            frontend_type = FrontendType::DUMMY;
+            break;
+        }
+
+        case OPT_IDX_BENCHMARK_WARMUP:
+            benchmark_config.warmup_chunks = std::strtoll(opt.arg, nullptr, 0);
+            break;
+
+        case OPT_IDX_BENCHMARK_SIGNAL:
+        {
+            std::string signal(opt.arg);
+            if (signal == "silence")
+            {
+                benchmark_config.signal = sushi::audio_frontend::BenchmarkSignal::SILENCE;
+            }
+            else if (signal == "noise")
+            {
+                benchmark_config.signal = sushi::audio_frontend::BenchmarkSignal::NOISE;
+            }
+            else if (signal == "sweep")
+            {
+                benchmark_config.signal = sushi::audio_frontend::BenchmarkSignal::SWEEP;
+            }
+            else if (signal == "impulse")
+            {
+                benchmark_config.signal = sushi::audio_frontend::BenchmarkSignal::IMPULSE;
+            }
+            else
+            {
+                error_exit("Unknown benchmark signal: " + signal);
+            }
+            break;
+        }
+
+        case OPT_IDX_BENCHMARK_CPU:
+            benchmark_config.cpu_core = atoi(opt.arg);
+            break;
+
+        case OPT_IDX_BENCHMARK_REPORT:
+            benchmark_report_filename.assign(opt.arg);
+            break;
+
         case OPT_IDX_USE_JACK:
             frontend_type = FrontendType::JACK;
             break;
@@ -269,17 +431,49 @@ int main(int argc, char* argv[])
             osc_send_port = atoi(opt.arg);
             break;
 
+        case OPT_IDX_OSC_MAX_RATE:
+            osc_max_output_rate = atof(opt.arg);
+            break;
+
         case OPT_IDX_GRPC_LISTEN_ADDRESS:
             grpc_listening_address = opt.arg;
             break;
 
+        case OPT_IDX_GRPC_THREADS:
+            grpc_threads = atoi(opt.arg);
+            break;
+
+        case OPT_IDX_GRPC_CPUS:
+            grpc_cpu_cores = parse_cpu_list(opt.arg);
+            break;
+
+        case OPT_IDX_SAMPLE_CACHE_DIR:
+            sample_cache_dir = opt.arg;
+            break;
+
+        case OPT_IDX_VALIDATION_CACHE_DIR:
+            validation_cache_dir = opt.arg;
+            break;
+
+        case OPT_IDX_PLUGIN_CACHE_DIR:
+            plugin_cache_dir = opt.arg;
+            break;
+
+        case OPT_IDX_SHARED_STATE:
+            shared_state_name = opt.arg != nullptr ? opt.arg : SUSHI_SHARED_STATE_DEFAULT_NAME;
+            break;
+
+        case OPT_IDX_STATE_FILE:
+            state_file = opt.arg;
+            break;
+
         default:
             SushiArg::print_error("Unhandled option '", opt, "' \n");
             break;
         }
     }
 
-    if (enable_parameter_dump == false)
+    if (enable_parameter_dump == false && plugin_info.empty())
     {
         print_sushi_headline();
     }
@@ -312,7 +506,71 @@ int main(int argc, char* argv[])
     {
         twine::init_xenomai(); // must be called before setting up any worker pools
     }
+    if (sample_cache_dir.empty() == false)
+    {
+        sushi::SampleCache::instance().set_cache_directory(sample_cache_dir);
+    }
+    if (validation_cache_dir.empty() == false)
+    {
+        sushi::jsonconfig::JsonConfigurator::set_validation_cache_directory(validation_cache_dir);
+    }
+    if (plugin_cache_dir.empty() == false)
+    {
+        sushi::PluginMetadataCache::instance().set_cache_directory(plugin_cache_dir);
+    }
+
+    if (batch_list_filename.empty() == false || batch_input_dir.empty() == false)
+    {
+        /* Batch mode builds its own engines, one for each file rendered */
+        std::vector<sushi::audio_frontend::OfflineRenderJob> jobs;
+        if (batch_list_filename.empty() == false)
+        {
+            jobs = sushi::audio_frontend::OfflineBatchRenderer::jobs_from_list_file(batch_list_filename);
+        }
+        if (batch_input_dir.empty() == false)
+        {
+            auto dir_jobs = sushi::audio_frontend::OfflineBatchRenderer::jobs_from_directory(batch_input_dir, batch_output_dir);
+            jobs.insert(jobs.end(), dir_jobs.begin(), dir_jobs.end());
+        }
+        if (jobs.empty())
+        {
+            error_exit("No files to render in batch mode");
+        }
+        sushi::audio_frontend::OfflineBatchConfiguration batch_config;
+        batch_config.config_filename = config_filename;
+        batch_config.sample_rate = SUSHI_SAMPLE_RATE_DEFAULT;
+        batch_config.rt_cpu_cores = rt_cpu_cores;
+        batch_config.concurrent_jobs = batch_jobs;
+        batch_config.output_sample_rate = output_sample_rate;
+        batch_config.track_parallel = track_parallel;
+        sushi::audio_frontend::OfflineBatchRenderer batch_renderer(batch_config);
+        if (batch_renderer.init() != sushi::jsonconfig::JsonConfigReturnStatus::OK)
+        {
+            error_exit("Error reading config file, invalid file: " + config_filename);
+        }
+        int failed = batch_renderer.render(jobs);
+        if (failed > 0)
+        {
+            error_exit(std::to_string(failed) + " of " + std::to_string(jobs.size()) + " files failed to render, check logs for details.");
+        }
+        SUSHI_LOG_INFO("Sushi exited normally.");
+        return 0;
+    }
+
     auto engine = std::make_unique<sushi::engine::AudioEngine>(SUSHI_SAMPLE_RATE_DEFAULT, rt_cpu_cores);
+
+    if (plugin_info.empty() == false)
+    {
+        auto [plugin_type, plugin_uid, plugin_path] = parse_plugin_info(plugin_info);
+        auto metadata = engine->plugin_metadata(plugin_uid, plugin_path, plugin_type);
+        if (metadata.has_value() == false)
+        {
+            error_exit("Failed to load plugin " + plugin_info + ", check logs for details.");
+        }
+        std::cout << sushi::generate_plugin_metadata_document(metadata.value()) << std::endl;
+        return 0;
+    }
+
     auto midi_dispatcher = std::make_unique<sushi::midi_dispatcher::MidiDispatcher>(engine.get());
     auto configurator = std::make_unique<sushi::jsonconfig::JsonConfigurator>(engine.get(),
                                                                               midi_dispatcher.get(),
@@ -322,7 +580,8 @@ int main(int argc, char* argv[])
     midi_dispatcher->set_midi_outputs(1);
 
 #ifdef SUSHI_BUILD_WITH_RPC_INTERFACE
-    auto rpc_server = std::make_unique<sushi_rpc::GrpcServer>(grpc_listening_address, engine->controller());
+    auto rpc_server = std::make_unique<sushi_rpc::GrpcServer>(grpc_listening_address, engine->controller(),
+                                                            grpc_threads, grpc_cpu_cores);
 #endif
 
     std::unique_ptr<sushi::midi_frontend::BaseMidiFrontend>         midi_frontend;
@@ -383,7 +642,13 @@ int main(int argc, char* argv[])
                                                                                                     output_filename,
                                                                                                     dummy,
                                                                                                     cv_inputs,
-                                                                                                    cv_outputs);
+                                                                                                    cv_outputs,
+                                                                                                    output_sample_rate,
+                                                                                                    track_parallel);
+            if (enable_benchmark)
+            {
+                static_cast<sushi::audio_frontend::OfflineFrontendConfiguration*>(frontend_config.get())->benchmark = benchmark_config;
+            }
             audio_frontend = std::make_unique<sushi::audio_frontend::OfflineFrontend>(engine.get());
             break;
         }
@@ -441,6 +706,14 @@ int main(int argc, char* argv[])
     }
     configurator.reset();
 
+    if (state_file.empty() == false && std::ifstream(state_file).good())
+    {
+        if (sushi::engine::restore_session_snapshot(engine.get(), state_file) != sushi::engine::SnapshotStatus::OK)
+        {
+            error_exit("Failed to restore state from " + state_file);
+        }
+    }
+
     if (enable_parameter_dump)
     { 
         std::cout << sushi::generate_processor_parameter_document(engine->controller());
@@ -452,6 +725,16 @@ int main(int argc, char* argv[])
         engine->performance_timer()->enable(true);
     }
 
+    std::unique_ptr<sushi::engine::SharedStatePublisher> shared_state_publisher;
+    if (shared_state_name.empty() == false)
+    {
+        shared_state_publisher = std::make_unique<sushi::engine::SharedStatePublisher>(engine.get(), shared_state_name);
+        if (shared_state_publisher->init() == false)
+        {
+            error_exit("Failed to create shared memory object " + shared_state_name);
+        }
+    }
+
     if (frontend_type == FrontendType::JACK || frontend_type == FrontendType::XENOMAI_RASPA)
     {
         midi_frontend = std::make_unique<sushi::midi_frontend::AlsaMidiFrontend>(midi_dispatcher.get());
@@ -463,7 +746,8 @@ int main(int argc, char* argv[])
         }
         midi_dispatcher->set_frontend(midi_frontend.get());
 
-        osc_frontend = std::make_unique<sushi::control_frontend::OSCFrontend>(engine.get(), osc_server_port, osc_send_port);
+        osc_frontend = std::make_unique<sushi::control_frontend::OSCFrontend>(engine.get(), osc_server_port, osc_send_port,
+                                                                              osc_max_output_rate);
         auto osc_status = osc_frontend->init();
         if (osc_status != sushi::control_frontend::ControlFrontendStatus::OK)
         {
@@ -487,9 +771,24 @@ int main(int argc, char* argv[])
 #ifdef SUSHI_BUILD_WITH_RPC_INTERFACE
     SUSHI_LOG_INFO("Starting gRPC server with address: {}", grpc_listening_address);
     rpc_server->start();
+    if (rpc_server->cpu_affinity_set() == false)
+    {
+        SUSHI_LOG_WARNING("Failed to restrict the gRPC server threads to the cpu cores given with --grpc-cpus");
+    }
 #endif
 
-    if (frontend_type != FrontendType::OFFLINE)
+    if (enable_benchmark)
+    {
+        /* run() returns when the benchmark is done */
+        const auto& result = static_cast<sushi::audio_frontend::OfflineFrontend*>(audio_frontend.get())->benchmark_result();
+        if (result.has_value())
+        {
+            std::ofstream report_file(benchmark_report_filename);
+            report_file << sushi::generate_benchmark_report_document(engine->controller(), engine->performance_timer(), result.value());
+            SUSHI_LOG_INFO("Benchmark report written to {}", benchmark_report_filename);
+        }
+    }
+    else if (frontend_type != FrontendType::OFFLINE)
     {
         std::mutex m;
         std::unique_lock<std::mutex> lock(m);
@@ -506,6 +805,15 @@ int main(int argc, char* argv[])
         midi_frontend->stop();
     }
 
+#ifdef SUSHI_BUILD_WITH_RPC_INTERFACE
+    rpc_server->stop();
+#endif
+
+    if (state_file.empty() == false)
+    {
+        sushi::engine::save_session_snapshot(engine.get(), state_file);
+    }
+
     audio_frontend->cleanup();
     SUSHI_LOG_INFO("Sushi exited normally.");
     return 0;
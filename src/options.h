@@ -19,6 +19,7 @@
  */
 #include <cstdio>
 #include "optionparser.h"
+#include "sushi_shared_state.h"
 
 #define SUSHI_Q(x) #x
 #define SUSHI_QUOTE(x) SUSHI_Q(x)
@@ -31,9 +32,11 @@
 #define SUSHI_LOG_FILENAME_DEFAULT "/tmp/sushi.log"
 #define SUSHI_JSON_FILENAME_DEFAULT "config.json"
 #define SUSHI_SAMPLE_RATE_DEFAULT 48000
+#define SUSHI_BENCHMARK_REPORT_DEFAULT "benchmark_report.json"
 #define SUSHI_JACK_CLIENT_NAME_DEFAULT "sushi"
 #define SUSHI_OSC_SERVER_PORT 24024
 #define SUSHI_OSC_SEND_PORT 24023
+#define SUSHI_OSC_MAX_OUTPUT_RATE 50
 #define SUSHI_GRPC_LISTENING_PORT "[::]:51051"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -106,11 +109,23 @@ enum OptionIndex
     OPT_IDX_LOG_FILE,
     OPT_IDX_LOG_FLUSH_INTERVAL,
     OPT_IDX_DUMP_PARAMETERS,
+    OPT_IDX_DUMP_PLUGIN_INFO,
     OPT_IDX_CONFIG_FILE,
     OPT_IDX_USE_OFFLINE,
     OPT_IDX_INPUT_FILE,
     OPT_IDX_OUTPUT_FILE,
+    OPT_IDX_OUTPUT_SAMPLE_RATE,
+    OPT_IDX_TRACK_PARALLEL,
+    OPT_IDX_BATCH_LIST,
+    OPT_IDX_BATCH_INPUT_DIR,
+    OPT_IDX_BATCH_OUTPUT_DIR,
+    OPT_IDX_BATCH_JOBS,
     OPT_IDX_USE_DUMMY,
+    OPT_IDX_BENCHMARK,
+    OPT_IDX_BENCHMARK_WARMUP,
+    OPT_IDX_BENCHMARK_SIGNAL,
+    OPT_IDX_BENCHMARK_CPU,
+    OPT_IDX_BENCHMARK_REPORT,
     OPT_IDX_USE_JACK,
     OPT_IDX_CONNECT_PORTS,
     OPT_IDX_JACK_CLIENT,
@@ -121,7 +136,15 @@ enum OptionIndex
     OPT_IDX_TIMINGS_STATISTICS,
     OPT_IDX_OSC_RECEIVE_PORT,
     OPT_IDX_OSC_SEND_PORT,
-    OPT_IDX_GRPC_LISTEN_ADDRESS
+    OPT_IDX_OSC_MAX_RATE,
+    OPT_IDX_GRPC_LISTEN_ADDRESS,
+    OPT_IDX_GRPC_THREADS,
+    OPT_IDX_GRPC_CPUS,
+    OPT_IDX_SAMPLE_CACHE_DIR,
+    OPT_IDX_VALIDATION_CACHE_DIR,
+    OPT_IDX_PLUGIN_CACHE_DIR,
+    OPT_IDX_SHARED_STATE,
+    OPT_IDX_STATE_FILE
 };
 
 // Option types (UNUSED is generally used for options that take a value as argument)
@@ -191,6 +214,14 @@ const optionparser::Descriptor usage[] =
         SushiArg::Optional,
         "\t\t--dump-plugins \tDump plugin and parameter data to stdout in JSON format."
     },
+    {
+        OPT_IDX_DUMP_PLUGIN_INFO,
+        OPT_TYPE_UNUSED,
+        "",
+        "dump-plugin-info",
+        SushiArg::NonEmpty,
+        "\t\t--dump-plugin-info=<type>:<uid>:<path> \tDump the parameters, channels and programs of a plugin to stdout in JSON format, without adding it to a track. <type> is internal, vst2x or vst3x, <uid> is empty for vst2x plugins. Read from the metadata cache in --plugin-cache-dir if the plugin is found there."
+    },
     {
         OPT_IDX_CONFIG_FILE,
         OPT_TYPE_UNUSED,
@@ -223,6 +254,54 @@ const optionparser::Descriptor usage[] =
         SushiArg::NonEmpty,
         "\t\t-O <filename>, --output=<filename> \tSpecify output file [default= (input_file).proc.wav]."
     },
+    {
+        OPT_IDX_OUTPUT_SAMPLE_RATE,
+        OPT_TYPE_UNUSED,
+        "",
+        "output-samplerate",
+        SushiArg::NonEmpty,
+        "\t\t--output-samplerate=<rate> \tSample rate of the output file in offline mode [default= same as the input file]."
+    },
+    {
+        OPT_IDX_TRACK_PARALLEL,
+        OPT_TYPE_DISABLED,
+        "",
+        "track-parallel",
+        SushiArg::Optional,
+        "\t\t--track-parallel \tIn offline mode, render each track over larger blocks on its own. Tracks render in parallel if --multicore-processing is used."
+    },
+    {
+        OPT_IDX_BATCH_LIST,
+        OPT_TYPE_UNUSED,
+        "",
+        "batch-list",
+        SushiArg::NonEmpty,
+        "\t\t--batch-list=<filename> \tRender all files in a list offline, with one input and output filename per line, separated by a tab."
+    },
+    {
+        OPT_IDX_BATCH_INPUT_DIR,
+        OPT_TYPE_UNUSED,
+        "",
+        "batch-input-dir",
+        SushiArg::NonEmpty,
+        "\t\t--batch-input-dir=<dir> \tRender all files in a directory offline."
+    },
+    {
+        OPT_IDX_BATCH_OUTPUT_DIR,
+        OPT_TYPE_UNUSED,
+        "",
+        "batch-output-dir",
+        SushiArg::NonEmpty,
+        "\t\t--batch-output-dir=<dir> \tDirectory to write the files rendered with --batch-input-dir to [default= current directory]."
+    },
+    {
+        OPT_IDX_BATCH_JOBS,
+        OPT_TYPE_UNUSED,
+        "",
+        "batch-jobs",
+        SushiArg::NonEmpty,
+        "\t\t--batch-jobs=<n> \tNumber of files to render at the same time in batch mode [default= number of cores / --multicore-processing]."
+    },
     {
         OPT_IDX_USE_DUMMY,
         OPT_TYPE_DISABLED,
@@ -231,6 +310,46 @@ const optionparser::Descriptor usage[] =
         SushiArg::Optional,
         "\t\t-d --dummy \tUse dummy audio frontend. Useful for debugging."
     },
+    {
+        OPT_IDX_BENCHMARK,
+        OPT_TYPE_UNUSED,
+        "",
+        "benchmark",
+        SushiArg::NonEmpty,
+        "\t\t--benchmark=<length> \tMeasure the performance with the dummy frontend for <length> chunks, or seconds of audio if followed by s, and exit."
+    },
+    {
+        OPT_IDX_BENCHMARK_WARMUP,
+        OPT_TYPE_UNUSED,
+        "",
+        "benchmark-warmup",
+        SushiArg::NonEmpty,
+        "\t\t--benchmark-warmup=<chunks> \tChunks to process before measuring in benchmark mode [default=1000]."
+    },
+    {
+        OPT_IDX_BENCHMARK_SIGNAL,
+        OPT_TYPE_UNUSED,
+        "",
+        "benchmark-signal",
+        SushiArg::NonEmpty,
+        "\t\t--benchmark-signal=<signal> \tInput signal in benchmark mode, silence, noise, sweep or impulse [default=noise]."
+    },
+    {
+        OPT_IDX_BENCHMARK_CPU,
+        OPT_TYPE_UNUSED,
+        "",
+        "benchmark-cpu",
+        SushiArg::NonEmpty,
+        "\t\t--benchmark-cpu=<core> \tPin the processing thread to a cpu core in benchmark mode."
+    },
+    {
+        OPT_IDX_BENCHMARK_REPORT,
+        OPT_TYPE_UNUSED,
+        "",
+        "benchmark-report",
+        SushiArg::NonEmpty,
+        "\t\t--benchmark-report=<filename> \tWrite the benchmark results in JSON format to a file [default=" SUSHI_BENCHMARK_REPORT_DEFAULT "]."
+    },
     {
         OPT_IDX_USE_JACK,
         OPT_TYPE_DISABLED,
@@ -311,6 +430,14 @@ const optionparser::Descriptor usage[] =
         SushiArg::NonEmpty,
         "\t\t--osc-send-port=<port> \tPort to output OSC messages to [default port=" SUSHI_QUOTE(SUSHI_OSC_SEND_PORT) "]."
     },
+    {
+        OPT_IDX_OSC_MAX_RATE,
+        OPT_TYPE_UNUSED,
+        "",
+        "osc-max-rate",
+        SushiArg::NonEmpty,
+        "\t\t--osc-max-rate=<hz> \tMaximum rate of outgoing OSC messages on each path, 0 for no limit [default=" SUSHI_QUOTE(SUSHI_OSC_MAX_OUTPUT_RATE) "]."
+    },
     {
         OPT_IDX_GRPC_LISTEN_ADDRESS,
         OPT_TYPE_UNUSED,
@@ -319,6 +446,62 @@ const optionparser::Descriptor usage[] =
         SushiArg::NonEmpty,
         "\t\t--grpc-address=<port> \tgRPC listening address in the format: address:port. By default accepts incoming connections from all ip:s [default port=" SUSHI_GRPC_LISTENING_PORT "]."
     },
+    {
+        OPT_IDX_GRPC_THREADS,
+        OPT_TYPE_UNUSED,
+        "",
+        "grpc-threads",
+        SushiArg::Numeric,
+        "\t\t--grpc-threads=<n> \tNumber of threads serving gRPC calls [default n=1]."
+    },
+    {
+        OPT_IDX_GRPC_CPUS,
+        OPT_TYPE_UNUSED,
+        "",
+        "grpc-cpus",
+        SushiArg::NonEmpty,
+        "\t\t--grpc-cpus=<list> \tComma separated list of cpu cores to run the gRPC threads on, e.g. 0,1. Not pinned by default."
+    },
+    {
+        OPT_IDX_SAMPLE_CACHE_DIR,
+        OPT_TYPE_UNUSED,
+        "",
+        "sample-cache-dir",
+        SushiArg::NonEmpty,
+        "\t\t--sample-cache-dir=<dir> \tStore decoded sample files in <dir> and memory map them from there on later loads."
+    },
+    {
+        OPT_IDX_VALIDATION_CACHE_DIR,
+        OPT_TYPE_UNUSED,
+        "",
+        "validation-cache-dir",
+        SushiArg::NonEmpty,
+        "\t\t--validation-cache-dir=<dir> \tRecord which sections of a config file have passed schema validation in <dir> and skip validating them when the same file is loaded again."
+    },
+    {
+        OPT_IDX_PLUGIN_CACHE_DIR,
+        OPT_TYPE_UNUSED,
+        "",
+        "plugin-cache-dir",
+        SushiArg::NonEmpty,
+        "\t\t--plugin-cache-dir=<dir> \tRecord the parameters, channels and programs of loaded plugins in <dir>, so that they don't need to be read from the plugins again."
+    },
+    {
+        OPT_IDX_SHARED_STATE,
+        OPT_TYPE_DISABLED,
+        "",
+        "shared-state",
+        SushiArg::Optional,
+        "\t\t--shared-state[=<name>] \tPublish parameters, meters and transport state to a shared memory object for local clients [default name=" SUSHI_SHARED_STATE_DEFAULT_NAME "]."
+    },
+    {
+        OPT_IDX_STATE_FILE,
+        OPT_TYPE_UNUSED,
+        "",
+        "state-file",
+        SushiArg::NonEmpty,
+        "\t\t--state-file=<file> \tRestore the state of all processors from <file> at startup if it exists, and save it there on exit."
+    },
     // Don't touch this one (set default values for optionparse library)
     { 0, 0, 0, 0, 0, 0}
 };
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Convolution plugin for reverbs and cabinet simulation
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <vector>
+
+#include <sndfile.h>
+
+#include "plugins/convolution_plugin.h"
+#include "logging.h"
+
+namespace sushi {
+namespace convolution_plugin {
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("convolution");
+
+ConvolutionPlugin::ConvolutionPlugin(HostControl host_control) : InternalPlugin(host_control)
+{
+    _max_input_channels = MAX_CONVOLUTION_CHANNELS;
+    _max_output_channels = MAX_CONVOLUTION_CHANNELS;
+    Processor::set_name(DEFAULT_NAME);
+    Processor::set_label(DEFAULT_LABEL);
+    _dry_parameter = register_float_parameter("dry", "Dry", "dB", 0.0f, -120.0f, 24.0f,
+                                              new dBToLinPreProcessor(-120.0f, 24.0f));
+    _wet_parameter = register_float_parameter("wet", "Wet", "dB", 0.0f, -120.0f, 24.0f,
+                                              new dBToLinPreProcessor(-120.0f, 24.0f));
+    [[maybe_unused]] bool str_pr_ok = register_string_property("impulse_response_file", "Impulse Response File", "");
+    /* Output only, counts the blocks of the reverb tail that were not processed in time */
+    _tail_underruns_parameter = register_int_parameter("tail_underruns", "Tail Under-runs", "", 0, 0, std::numeric_limits<int>::max(),
+                                                       new IntParameterPreProcessor(0, std::numeric_limits<int>::max()));
+    assert(_dry_parameter && _wet_parameter && str_pr_ok && _tail_underruns_parameter);
+}
+
+ConvolutionPlugin::~ConvolutionPlugin()
+{
+    delete _impulse_response_property;
+}
+
+ProcessorReturnCode ConvolutionPlugin::init(float sample_rate)
+{
+    _sample_rate = sample_rate;
+    return ProcessorReturnCode::OK;
+}
+
+void ConvolutionPlugin::configure(float sample_rate)
+{
+    _sample_rate = sample_rate;
+}
+
+void ConvolutionPlugin::set_input_channels(int channels)
+{
+    Processor::set_input_channels(channels);
+    _current_output_channels = channels;
+    _max_output_channels = channels;
+}
+
+void ConvolutionPlugin::process_event(const RtEvent& event)
+{
+    switch (event.type())
+    {
+        case RtEventType::STRING_PROPERTY_CHANGE:
+        {
+            /* The impulse response file is the only string property */
+            auto typed_event = event.string_parameter_change_event();
+            _impulse_response_property = typed_event->value();
+            /* Loading and transforming the impulse response is done in a non-rt callback */
+            auto e = RtEvent::make_async_work_event(&ConvolutionPlugin::non_rt_callback, this->id(), this);
+            _pending_event_id = e.async_work_event()->event_id();
+            output_event(e);
+            break;
+        }
+        case RtEventType::ASYNC_WORK_NOTIFICATION:
+        {
+            auto typed_event = event.async_work_completion_event();
+            if (typed_event->sending_event_id() == _pending_event_id &&
+                typed_event->return_status() == ImpulseResponseChangeStatus::SUCCESS)
+            {
+                std::swap(_convolver, _pending_convolver);
+                if (_pending_convolver)
+                {
+                    _pending_convolver->stop();
+                }
+            }
+            break;
+        }
+
+        default:
+            InternalPlugin::process_event(event);
+            break;
+    }
+}
+
+void ConvolutionPlugin::process_audio(const ChunkSampleBuffer& in_buffer, ChunkSampleBuffer& out_buffer)
+{
+    if (_bypassed)
+    {
+        bypass_process(in_buffer, out_buffer);
+        return;
+    }
+    float dry = _dry_parameter->value();
+    float wet = _wet_parameter->value();
+    out_buffer.clear();
+    int in_channels = in_buffer.channel_count();
+    for (int c = 0; c < out_buffer.channel_count() && in_channels > 0; ++c)
+    {
+        out_buffer.add_with_gain(c, std::min(c, in_channels - 1), in_buffer, dry);
+    }
+    if (_convolver)
+    {
+        _convolver->process(in_buffer, _wet_buffer);
+        for (int c = 0; c < out_buffer.channel_count(); ++c)
+        {
+            out_buffer.add_with_gain(c, std::min(c, _convolver->channels() - 1), _wet_buffer, wet);
+        }
+        if (_convolver->underruns() != _tail_underruns)
+        {
+            _tail_underruns = _convolver->underruns();
+            set_parameter_and_notify(_tail_underruns_parameter, _tail_underruns);
+        }
+    }
+}
+
+int ConvolutionPlugin::_non_rt_callback(EventId id)
+{
+    if (id != _pending_event_id)
+    {
+        SUSHI_LOG_WARNING("Convolution: EventId of non-rt callback didn't match, {} vs {}", id, _pending_event_id);
+        return ImpulseResponseChangeStatus::FAILURE;
+    }
+    /* Deletes the convolver replaced by the previous load, if any */
+    _pending_convolver.reset();
+    /* As in the sample player, several outstanding requests are not handled */
+    std::unique_ptr<std::string> file_name(_impulse_response_property);
+    _impulse_response_property = nullptr;
+
+    SF_INFO soundfile_info = {};
+    SNDFILE* file = sf_open(file_name->c_str(), SFM_READ, &soundfile_info);
+    if (file == nullptr)
+    {
+        SUSHI_LOG_ERROR("Failed to open impulse response file: {}", *file_name);
+        return ImpulseResponseChangeStatus::FAILURE;
+    }
+    if (soundfile_info.samplerate != static_cast<int>(_sample_rate))
+    {
+        SUSHI_LOG_WARNING("Impulse response sample rate {} does not match {}", soundfile_info.samplerate, _sample_rate);
+    }
+    int max_frames = static_cast<int>(MAX_IMPULSE_RESPONSE_TIME.count() * soundfile_info.samplerate);
+    int frames = static_cast<int>(std::min(soundfile_info.frames, static_cast<sf_count_t>(max_frames)));
+    std::vector<float> interleaved(static_cast<size_t>(frames) * soundfile_info.channels);
+    frames = static_cast<int>(sf_readf_float(file, interleaved.data(), frames));
+    sf_close(file);
+    if (frames <= 0)
+    {
+        SUSHI_LOG_ERROR("Failed to read impulse response from: {}", *file_name);
+        return ImpulseResponseChangeStatus::FAILURE;
+    }
+
+    /* Channels beyond what the convolver supports are ignored */
+    int channels = std::min(soundfile_info.channels, MAX_CONVOLUTION_CHANNELS);
+    std::vector<std::vector<float>> impulse_responses(channels, std::vector<float>(frames));
+    for (int c = 0; c < channels; ++c)
+    {
+        for (int i = 0; i < frames; ++i)
+        {
+            impulse_responses[c][i] = interleaved[i * soundfile_info.channels + c];
+        }
+    }
+    _pending_convolver = std::make_unique<PartitionedConvolver>(impulse_responses);
+    SUSHI_LOG_INFO("Convolution: Loaded impulse response of {} frames and {} channels", frames, channels);
+    return ImpulseResponseChangeStatus::SUCCESS;
+}
+
+}// namespace convolution_plugin
+}// namespace sushi
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Convolution plugin for reverbs and cabinet simulation
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#ifndef SUSHI_CONVOLUTION_PLUGIN_H
+#define SUSHI_CONVOLUTION_PLUGIN_H
+
+#include <chrono>
+#include <memory>
+
+#include "library/internal_plugin.h"
+#include "plugins/partitioned_convolver.h"
+
+namespace sushi {
+namespace convolution_plugin {
+
+static const std::string DEFAULT_NAME = "sushi.testing.convolution";
+static const std::string DEFAULT_LABEL = "Convolution";
+constexpr auto MAX_IMPULSE_RESPONSE_TIME = std::chrono::seconds(30);
+
+namespace ImpulseResponseChangeStatus {
+enum ImpulseResponseChange : int
+{
+    SUCCESS = 0,
+    FAILURE
+};}
+
+class ConvolutionPlugin : public InternalPlugin
+{
+public:
+    ConvolutionPlugin(HostControl host_control);
+
+    ~ConvolutionPlugin();
+
+    ProcessorReturnCode init(float sample_rate) override;
+
+    void configure(float sample_rate) override;
+
+    void set_input_channels(int channels) override;
+
+    void process_event(const RtEvent& event) override;
+
+    void process_audio(const ChunkSampleBuffer& in_buffer, ChunkSampleBuffer& out_buffer) override;
+
+    static int non_rt_callback(void* data, EventId id)
+    {
+        return reinterpret_cast<ConvolutionPlugin*>(data)->_non_rt_callback(id);
+    }
+
+private:
+    int _non_rt_callback(EventId id);
+
+    float _sample_rate{0};
+    FloatParameterValue* _dry_parameter;
+    FloatParameterValue* _wet_parameter;
+    IntParameterValue*   _tail_underruns_parameter;
+    int                  _tail_underruns{0};
+
+    std::string*         _impulse_response_property{nullptr};
+    EventId              _pending_event_id{0};
+
+    /* Only the rt thread touches _convolver. A new convolver is created in
+     * _pending_convolver by the non-rt callback and swapped in when the rt
+     * thread receives the completion event. The replaced convolver is then
+     * kept in _pending_convolver until the next callback, so it is never
+     * deleted in the rt thread. */
+    std::unique_ptr<PartitionedConvolver> _convolver;
+    std::unique_ptr<PartitionedConvolver> _pending_convolver;
+
+    ChunkSampleBuffer _wet_buffer{MAX_CONVOLUTION_CHANNELS};
+};
+
+}// namespace convolution_plugin
+}// namespace sushi
+
+#endif //SUSHI_CONVOLUTION_PLUGIN_H
@@ -62,8 +62,8 @@ ProcessorReturnCode EqualizerPlugin::init(float sample_rate)
 
 void EqualizerPlugin::configure(float sample_rate)
 {
-    _sample_rate = sample_rate;
-    return;
+    /* The coefficients are recalculated from the audio thread, in process_audio() */
+    _new_sample_rate.store(sample_rate);
 }
 
 void EqualizerPlugin::set_input_channels(int channels)
@@ -77,20 +77,29 @@ void EqualizerPlugin::set_input_channels(int channels)
 
 void EqualizerPlugin::process_audio(const ChunkSampleBuffer &in_buffer, ChunkSampleBuffer &out_buffer)
 {
-    /* Update parameter values */
-    float frequency = _frequency->value();
-    float gain = _gain->value();
-    float q = _q->value();
-
+    float new_sample_rate = _new_sample_rate.exchange(0.0f);
+    if (new_sample_rate > 0.0f)
+    {
+        /* Coefficients depend on the sample rate, force a recalculation */
+        _sample_rate = new_sample_rate;
+        mark_parameter_changed(_frequency->descriptor()->id());
+    }
     if (!_bypassed)
     {
-        /* Recalculate the coefficients once per audio chunk, this makes for
-         * predictable cpu load for every chunk */
-        dsp::biquad::Coefficients coefficients;
-        dsp::biquad::calc_biquad_peak(coefficients, _sample_rate, frequency, q, gain);
+        /* Recalculate the coefficients only when a parameter has changed, at most
+         * once per audio chunk. Changes are still smoothed inside the filters */
+        if (parameters_changed())
+        {
+            dsp::biquad::Coefficients coefficients;
+            dsp::biquad::calc_biquad_peak(coefficients, _sample_rate, _frequency->value(), _q->value(), _gain->value());
+            for (auto& filter : _filters)
+            {
+                filter.set_coefficients(coefficients);
+            }
+            clear_parameter_changes();
+        }
         for (int i = 0; i < _current_input_channels; ++i)
         {
-            _filters[i].set_coefficients(coefficients);
             _filters[i].process(in_buffer.channel(i), out_buffer.channel(i), AUDIO_CHUNK_SIZE);
         }
     }
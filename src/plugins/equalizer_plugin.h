@@ -21,6 +21,8 @@
 #ifndef EQUALIZER_PLUGIN_H
 #define EQUALIZER_PLUGIN_H
 
+#include <atomic>
+
 #include "library/internal_plugin.h"
 #include "dsp_library/biquad_filter.h"
 
@@ -53,6 +55,9 @@ private:
     FloatParameterValue* _frequency;
     FloatParameterValue* _gain;
     FloatParameterValue* _q;
+
+    /* Set by configure(), 0 when there is no new sample rate to apply */
+    std::atomic<float> _new_sample_rate{0.0f};
 };
 
 }// namespace equalizer_plugin
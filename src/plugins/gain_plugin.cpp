@@ -39,6 +39,18 @@ GainPlugin::GainPlugin(HostControl host_control) : InternalPlugin(host_control)
 GainPlugin::~GainPlugin()
 {}
 
+ProcessorReturnCode GainPlugin::init(float sample_rate)
+{
+    _gain_parameter->set_smoothing(GAIN_SMOOTHING_TIME, sample_rate);
+    return ProcessorReturnCode::OK;
+}
+
+void GainPlugin::configure(float sample_rate)
+{
+    /* The smoother is updated from the audio thread, in process_audio() */
+    _new_sample_rate.store(sample_rate);
+}
+
 void GainPlugin::set_input_channels(int channels)
 {
     Processor::set_input_channels(channels);
@@ -48,11 +60,23 @@ void GainPlugin::set_input_channels(int channels)
 
 void GainPlugin::process_audio(const ChunkSampleBuffer &in_buffer, ChunkSampleBuffer &out_buffer)
 {
-    float gain = _gain_parameter->value();
+    float new_sample_rate = _new_sample_rate.exchange(0.0f);
+    if (new_sample_rate > 0.0f)
+    {
+        _gain_parameter->set_smoothing(GAIN_SMOOTHING_TIME, new_sample_rate);
+    }
     if (!_bypassed)
     {
         out_buffer.clear();
-        out_buffer.add_with_gain(in_buffer, gain);
+        if (_gain_parameter->smoothing_active())
+        {
+            _gain_parameter->render_values(_gain_buffer);
+            out_buffer.add_with_gain(in_buffer, _gain_buffer);
+        }
+        else
+        {
+            out_buffer.add_with_gain(in_buffer, _gain_parameter->value());
+        }
     } else
     {
         bypass_process(in_buffer, out_buffer);
@@ -21,6 +21,8 @@
 #ifndef GAIN_PLUGIN_H
 #define GAIN_PLUGIN_H
 
+#include <atomic>
+
 #include "library/internal_plugin.h"
 
 namespace sushi {
@@ -29,6 +31,7 @@ namespace gain_plugin {
 constexpr int MAX_CHANNELS = 16;
 static const std::string DEFAULT_NAME = "sushi.testing.gain";
 static const std::string DEFAULT_LABEL = "Gain";
+constexpr auto GAIN_SMOOTHING_TIME = std::chrono::milliseconds(20);
 
 class GainPlugin : public InternalPlugin
 {
@@ -37,12 +40,19 @@ public:
 
     ~GainPlugin();
 
+    ProcessorReturnCode init(float sample_rate) override;
+
+    void configure(float sample_rate) override;
+
     void set_input_channels(int channels) override;
 
     void process_audio(const ChunkSampleBuffer &in_buffer, ChunkSampleBuffer &out_buffer) override;
 
 private:
     FloatParameterValue* _gain_parameter;
+    ChunkSampleBuffer _gain_buffer{1};
+    /* Set by configure(), 0 when there is no new sample rate to apply */
+    std::atomic<float> _new_sample_rate{0.0f};
 };
 
 }// namespace gain_plugin
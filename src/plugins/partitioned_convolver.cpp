@@ -0,0 +1,202 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Non-uniformly partitioned convolution with the tail processed in background threads
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "plugins/partitioned_convolver.h"
+
+namespace sushi {
+namespace convolution_plugin {
+
+TailStage::TailStage(int block_size, std::vector<std::unique_ptr<dsp::UniformConvolver>> convolvers) :
+        _block_size(block_size),
+        _channels(static_cast<int>(convolvers.size())),
+        _convolvers(std::move(convolvers)),
+        _input(_channels * TAIL_BUFFER_BLOCKS * block_size, 0.0f),
+        _output(_channels * TAIL_BUFFER_BLOCKS * block_size, 0.0f)
+{
+    assert(block_size % AUDIO_CHUNK_SIZE == 0);
+    for (auto& block : _output_blocks)
+    {
+        block.store(-1);
+    }
+    _worker_thread = std::thread(&TailStage::_worker, this);
+}
+
+TailStage::~TailStage()
+{
+    stop();
+    if (_worker_thread.joinable())
+    {
+        _worker_thread.join();
+    }
+}
+
+bool TailStage::process(const ChunkSampleBuffer& input, ChunkSampleBuffer& output)
+{
+    bool in_time = true;
+    /* The output of block n is played during block n + 2. Whether it is ready
+     * is only checked at block boundaries so that a block is never partially
+     * played */
+    int64_t output_block = _block - 2;
+    if (_position == 0 && output_block >= 0)
+    {
+        _output_ready = _output_blocks[output_block % TAIL_BUFFER_BLOCKS].load(std::memory_order_acquire) == output_block;
+        in_time = _output_ready;
+    }
+    int channel_size = TAIL_BUFFER_BLOCKS * _block_size;
+    int input_offset = static_cast<int>(_block % TAIL_BUFFER_BLOCKS) * _block_size + _position;
+    int output_offset = static_cast<int>(std::max(output_block, int64_t(0)) % TAIL_BUFFER_BLOCKS) * _block_size + _position;
+    for (int c = 0; c < _channels; ++c)
+    {
+        const float* in_data = input.channel(c);
+        std::copy(in_data, in_data + AUDIO_CHUNK_SIZE, &_input[c * channel_size + input_offset]);
+        if (_output_ready)
+        {
+            float* out_data = output.channel(c);
+            const float* tail_data = &_output[c * channel_size + output_offset];
+            for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+            {
+                out_data[i] += tail_data[i];
+            }
+        }
+    }
+
+    _position += AUDIO_CHUNK_SIZE;
+    if (_position == _block_size)
+    {
+        _position = 0;
+        _written_blocks.store(++_block, std::memory_order_release);
+    }
+    return in_time;
+}
+
+void TailStage::_worker()
+{
+    int channel_size = TAIL_BUFFER_BLOCKS * _block_size;
+    int64_t block = 0;
+    while (_running.load(std::memory_order_acquire))
+    {
+        int64_t written = _written_blocks.load(std::memory_order_acquire);
+        if (block == written)
+        {
+            std::this_thread::sleep_for(TAIL_WORKER_PERIODICITY);
+            continue;
+        }
+        if (written - block > 1)
+        {
+            /* Too far behind, the output of the missed blocks has already been
+             * skipped by the audio thread, so start over from the latest block */
+            for (auto& convolver : _convolvers)
+            {
+                convolver->reset();
+            }
+            block = written - 1;
+        }
+        int slot = static_cast<int>(block % TAIL_BUFFER_BLOCKS);
+        for (int c = 0; c < _channels; ++c)
+        {
+            int offset = c * channel_size + slot * _block_size;
+            _convolvers[c]->process(&_input[offset], &_output[offset]);
+        }
+        _output_blocks[slot].store(block, std::memory_order_release);
+        block++;
+    }
+}
+
+PartitionedConvolver::PartitionedConvolver(const std::vector<std::vector<float>>& impulse_responses) :
+        _channels(std::min(static_cast<int>(impulse_responses.size()), MAX_CONVOLUTION_CHANNELS)),
+        _input(_channels),
+        _output(_channels)
+{
+    int head_length = 2 * TAIL_BLOCK_SIZES.front();
+    for (int c = 0; c < _channels; ++c)
+    {
+        const auto& ir = impulse_responses[c];
+        int length = std::min(static_cast<int>(ir.size()), head_length);
+        _head.push_back(std::make_unique<dsp::UniformConvolver>(AUDIO_CHUNK_SIZE, ir.data(), length));
+    }
+
+    for (size_t stage = 0; stage < TAIL_BLOCK_SIZES.size(); ++stage)
+    {
+        int block_size = TAIL_BLOCK_SIZES[stage];
+        int start = 2 * block_size;
+        int end = stage + 1 < TAIL_BLOCK_SIZES.size() ? 2 * TAIL_BLOCK_SIZES[stage + 1] : std::numeric_limits<int>::max();
+        std::vector<std::unique_ptr<dsp::UniformConvolver>> convolvers;
+        for (int c = 0; c < _channels; ++c)
+        {
+            const auto& ir = impulse_responses[c];
+            int length = std::min(static_cast<int>(ir.size()), end) - start;
+            /* Channels with shorter impulse responses get a silent partition */
+            convolvers.push_back(std::make_unique<dsp::UniformConvolver>(block_size, ir.data() + std::min(start, static_cast<int>(ir.size())),
+                                                                         std::max(length, 0)));
+        }
+        bool stage_used = false;
+        for (const auto& ir : impulse_responses)
+        {
+            stage_used |= static_cast<int>(ir.size()) > start;
+        }
+        if (stage_used)
+        {
+            _tail.push_back(std::make_unique<TailStage>(block_size, std::move(convolvers)));
+        }
+    }
+}
+
+void PartitionedConvolver::process(const ChunkSampleBuffer& input, ChunkSampleBuffer& output)
+{
+    for (int c = 0; c < _channels; ++c)
+    {
+        int input_channel = std::min(c, input.channel_count() - 1);
+        if (input_channel >= 0)
+        {
+            _input.replace(c, input_channel, input);
+        }
+        else
+        {
+            std::fill(_input.channel(c), _input.channel(c) + AUDIO_CHUNK_SIZE, 0.0f);
+        }
+        _head[c]->process(_input.channel(c), _output.channel(c));
+    }
+    for (auto& stage : _tail)
+    {
+        if (stage->process(_input, _output) == false)
+        {
+            _underruns++;
+        }
+    }
+    for (int c = 0; c < std::min(_channels, output.channel_count()); ++c)
+    {
+        output.replace(c, c, _output);
+    }
+}
+
+void PartitionedConvolver::stop()
+{
+    for (auto& stage : _tail)
+    {
+        stage->stop();
+    }
+}
+
+} // namespace convolution_plugin
+} // namespace sushi
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Non-uniformly partitioned convolution with the tail processed in background threads
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ *
+ * The head of the impulse response is convolved in the audio thread with
+ * partitions of the audio chunk size, giving zero latency. The rest is split
+ * into tail stages with increasingly larger partitions. Each tail stage runs
+ * in its own non-rt thread and exchanges blocks with the audio thread through
+ * lock-free buffers. A stage with block size L handles the impulse response
+ * from 2L and onwards, which gives its thread one block period to process a
+ * block before the result is needed.
+ */
+
+#ifndef SUSHI_PARTITIONED_CONVOLVER_H
+#define SUSHI_PARTITIONED_CONVOLVER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "library/constants.h"
+#include "library/sample_buffer.h"
+#include "library/spinlock.h"
+#include "dsp_library/convolver.h"
+
+namespace sushi {
+namespace convolution_plugin {
+
+constexpr int MAX_CONVOLUTION_CHANNELS = 2;
+/* Block sizes of the tail stages, stage i covers the impulse response from
+ * 2 * TAIL_BLOCK_SIZES[i] to 2 * TAIL_BLOCK_SIZES[i + 1] */
+constexpr std::array<int, 2> TAIL_BLOCK_SIZES = {8 * AUDIO_CHUNK_SIZE, 64 * AUDIO_CHUNK_SIZE};
+/* Number of blocks in the input and output buffers of a tail stage */
+constexpr int TAIL_BUFFER_BLOCKS = 4;
+constexpr auto TAIL_WORKER_PERIODICITY = std::chrono::milliseconds(1);
+
+/**
+ * @brief A part of the impulse response convolved with a large block size in
+ *        a background thread.
+ */
+class TailStage
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(TailStage);
+
+    /**
+     * @brief Create a tail stage and start its worker thread. Not rt safe.
+     * @param block_size The block size, must be a multiple of AUDIO_CHUNK_SIZE
+     * @param convolvers One convolver per channel with the part of the impulse response
+     *        handled by this stage, delayed by 2 * block_size.
+     */
+    TailStage(int block_size, std::vector<std::unique_ptr<dsp::UniformConvolver>> convolvers);
+
+    ~TailStage();
+
+    /**
+     * @brief Pass one chunk of input to the stage and add its output, called from
+     *        the audio thread.
+     * @param input Input buffer with one channel for each convolver
+     * @param output Output buffer with one channel for each convolver, the output
+     *        of the stage is added to it.
+     * @return false if the output of the stage was not ready in time
+     */
+    bool process(const ChunkSampleBuffer& input, ChunkSampleBuffer& output);
+
+    /**
+     * @brief Signal the worker thread to stop, rt safe.
+     */
+    void stop() {_running.store(false, std::memory_order_release);}
+
+private:
+    void _worker();
+
+    int _block_size;
+    int _channels;
+    std::vector<std::unique_ptr<dsp::UniformConvolver>> _convolvers;
+    /* Ring buffers of TAIL_BUFFER_BLOCKS blocks per channel */
+    std::vector<float> _input;
+    std::vector<float> _output;
+
+    /* Only accessed by the audio thread */
+    int64_t _block{0};
+    int _position{0};
+    bool _output_ready{false};
+
+    /* Number of complete input blocks written by the audio thread */
+    alignas(ASSUMED_CACHE_LINE_SIZE) std::atomic<int64_t> _written_blocks{0};
+    /* The index of the block held by each output slot, written by the worker thread */
+    alignas(ASSUMED_CACHE_LINE_SIZE) std::array<std::atomic<int64_t>, TAIL_BUFFER_BLOCKS> _output_blocks;
+
+    std::atomic_bool _running{true};
+    std::thread _worker_thread;
+};
+
+/**
+ * @brief Multichannel convolver, each channel has its own impulse response.
+ */
+class PartitionedConvolver
+{
+public:
+    SUSHI_DECLARE_NON_COPYABLE(PartitionedConvolver);
+
+    /**
+     * @brief Create a convolver and start the threads of its tail stages. Not rt safe.
+     * @param impulse_responses One impulse response per channel, at most
+     *        MAX_CONVOLUTION_CHANNELS
+     */
+    explicit PartitionedConvolver(const std::vector<std::vector<float>>& impulse_responses);
+
+    int channels() const {return _channels;}
+
+    /**
+     * @brief Process one chunk of audio, called from the audio thread.
+     * @param input Input buffer, if it has fewer channels than the convolver the
+     *        last input channel is used for the remaining convolver channels
+     * @param output Output buffer, overwritten. Only channels that exist both in
+     *        the convolver and in output are written.
+     */
+    void process(const ChunkSampleBuffer& input, ChunkSampleBuffer& output);
+
+    /**
+     * @brief The number of tail blocks that were not processed in time since the
+     *        convolver was created.
+     */
+    int underruns() const {return _underruns;}
+
+    /**
+     * @brief Signal all worker threads to stop, rt safe. The threads are joined
+     *        when the convolver is deleted.
+     */
+    void stop();
+
+private:
+    int _channels;
+    std::vector<std::unique_ptr<dsp::UniformConvolver>> _head;
+    std::vector<std::unique_ptr<TailStage>> _tail;
+    ChunkSampleBuffer _input;
+    ChunkSampleBuffer _output;
+    int _underruns{0};
+};
+
+} // namespace convolution_plugin
+} // namespace sushi
+
+#endif //SUSHI_PARTITIONED_CONVOLVER_H
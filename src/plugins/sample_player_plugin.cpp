@@ -18,8 +18,9 @@
  * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <algorithm>
 #include <cassert>
-#include <sndfile.h>
+#include <limits>
 
 #include "sample_player_plugin.h"
 #include "logging.h"
@@ -29,6 +30,20 @@ namespace sample_player_plugin {
 
 SUSHI_GET_LOGGER_WITH_MODULE_NAME("sampleplayer");
 
+/* The number of frames preloaded when streaming a file, based on the file's own
+ * sample rate. Returns 0, i.e. load the whole file, if it can't be opened. */
+inline int preload_frames(const std::string& file_name)
+{
+    SF_INFO soundfile_info = {};
+    SNDFILE* sample_file = sf_open(file_name.c_str(), SFM_READ, &soundfile_info);
+    if (sample_file == nullptr)
+    {
+        return 0;
+    }
+    sf_close(sample_file);
+    return static_cast<int>(std::chrono::duration<float>(STREAMING_PRELOAD_TIME).count() * soundfile_info.samplerate);
+}
+
 SamplePlayerPlugin::SamplePlayerPlugin(HostControl host_control) : InternalPlugin(host_control)
 {
     Processor::set_name(DEFAULT_NAME);
@@ -39,7 +54,18 @@ SamplePlayerPlugin::SamplePlayerPlugin(HostControl host_control) : InternalPlugi
     _sustain_parameter = register_float_parameter("sustain", "Sustain", "", 1.0f, 0.0f, 1.0f, new FloatParameterPreProcessor(0.0f, 1.0f));
     _release_parameter = register_float_parameter("release", "Release", "s", 0.0f, 0.0f, 10.0f, new FloatParameterPreProcessor(0.0f, 10.0f));
     [[maybe_unused]] bool str_pr_ok = register_string_property("sample_file", "Sample File", "");
-    assert(_volume_parameter && _attack_parameter && _decay_parameter && _sustain_parameter && _release_parameter && str_pr_ok);
+    _polyphony_parameter = register_int_parameter("polyphony", "Polyphony", "", DEFAULT_POLYPHONY, 1, MAX_POLYPHONY,
+                                                   new IntParameterPreProcessor(1, MAX_POLYPHONY));
+    _cubic_interpolation_parameter = register_bool_parameter("cubic_interpolation", "Cubic Interpolation", "", false);
+    /* Takes effect the next time a sample file is loaded */
+    _disk_streaming_parameter = register_bool_parameter("disk_streaming", "Disk Streaming", "", false);
+    /* Output only, counts the audio chunks where streamed data was not available in time,
+     * changes from outside the plugin are ignored */
+    _stream_underruns_parameter = register_int_parameter("stream_underruns", "Stream Under-runs", "", 0, 0, std::numeric_limits<int>::max(),
+                                                         new IntParameterPreProcessor(0, std::numeric_limits<int>::max()));
+    assert(_volume_parameter && _attack_parameter && _decay_parameter && _sustain_parameter && _release_parameter &&
+           str_pr_ok && _polyphony_parameter && _cubic_interpolation_parameter && _disk_streaming_parameter &&
+           _stream_underruns_parameter);
 }
 
 ProcessorReturnCode SamplePlayerPlugin::init(float sample_rate)
@@ -50,6 +76,12 @@ ProcessorReturnCode SamplePlayerPlugin::init(float sample_rate)
         voice.set_samplerate(sample_rate);
         voice.set_sample(&_sample);
     }
+    for (int i = 0; i < MAX_POLYPHONY; ++i)
+    {
+        _free_voices[i] = MAX_POLYPHONY - 1 - i;
+    }
+    _free_voice_count = MAX_POLYPHONY;
+    _active_voice_count = 0;
 
     return ProcessorReturnCode::OK;
 }
@@ -65,20 +97,15 @@ void SamplePlayerPlugin::configure(float sample_rate)
 
 void SamplePlayerPlugin::set_bypassed(bool bypassed)
 {
-    // Kill all voices in bypass so we dont have any hanging notes when turning back on
-    if (bypassed)
-    {
-        for (auto &voice : _voices)
-        {
-            voice.note_off(1.0f, 0);
-        }
-    }
-    Processor::set_bypassed(bypassed);
+    /* The voices are only touched from the rt thread, so bypass is set with an event */
+    _host_control.post_event(new SetProcessorBypassEvent(this->id(), bypassed, IMMEDIATE_PROCESS));
 }
 
 SamplePlayerPlugin::~SamplePlayerPlugin()
 {
-    delete _sample_buffer;
+    auto& cache = SampleCache::instance();
+    cache.release(_sample_buffer);
+    cache.release(_pending_sample.data);
     delete _sample_file_property;
 }
 
@@ -92,31 +119,13 @@ void SamplePlayerPlugin::process_event(const RtEvent& event)
             {
                 break;
             }
-            bool voice_allocated = false;
             auto key_event = event.keyboard_event();
             SUSHI_LOG_DEBUG("Sample Player: note ON, num. {}, vel. {}",
                             key_event->note(), key_event->velocity());
-            for (auto& voice : _voices)
-            {
-                if (!voice.active())
-                {
-                    voice.note_on(key_event->note(), key_event->velocity(), event.sample_offset());
-                    voice_allocated = true;
-                    break;
-                }
-            }
-            // TODO - improve voice stealing algorithm
-            if (!voice_allocated)
-            {
-                for (auto& voice : _voices)
-                {
-                    if (voice.stopping())
-                    {
-                        voice.note_on(key_event->note(), key_event->velocity(), event.sample_offset());
-                        break;
-                    }
-                }
-            }
+            auto& voice = _voices[_allocate_voice()];
+            voice.set_envelope(_attack_parameter->value(), _decay_parameter->value(),
+                               _sustain_parameter->value(), _release_parameter->value());
+            voice.note_on(key_event->note(), key_event->velocity(), event.sample_offset());
             break;
         }
         case RtEventType::NOTE_OFF:
@@ -128,9 +137,10 @@ void SamplePlayerPlugin::process_event(const RtEvent& event)
             auto key_event = event.keyboard_event();
             SUSHI_LOG_DEBUG("Sample Player: note OFF, num. {}, vel. {}",
                             key_event->note(), key_event->velocity());
-            for (auto& voice : _voices)
+            for (int i = 0; i < _active_voice_count; ++i)
             {
-                if (voice.active() && voice.current_note() == key_event->note())
+                auto& voice = _voices[_active_voices[i]];
+                if (!voice.stopping() && voice.current_note() == key_event->note())
                 {
                     voice.note_off(key_event->velocity(), event.sample_offset());
                     break;
@@ -138,15 +148,34 @@ void SamplePlayerPlugin::process_event(const RtEvent& event)
             }
             break;
         }
+        case RtEventType::FLOAT_PARAMETER_CHANGE:
+        case RtEventType::INT_PARAMETER_CHANGE:
+        case RtEventType::BOOL_PARAMETER_CHANGE:
+        {
+            /* The under-run count is output only */
+            if (event.parameter_change_event()->param_id() != _stream_underruns_parameter->descriptor()->id())
+            {
+                InternalPlugin::process_event(event);
+            }
+            break;
+        }
+        case RtEventType::SET_BYPASS:
+        {
+            bool bypassed = static_cast<bool>(event.processor_command_event()->value());
+            // Kill all voices in bypass so we dont have any hanging notes when turning back on
+            if (bypassed)
+            {
+                _stop_all_voices();
+            }
+            Processor::set_bypassed(bypassed);
+            break;
+        }
         case RtEventType::STRING_PROPERTY_CHANGE:
         {
             /* Currently there is only 1 string parameter and it's for changing the sample
              * file, hence no need to check the parameter id */
             auto typed_event = event.string_parameter_change_event();
-            for (auto& voice : _voices)
-            {
-                voice.note_off(1.0f, 0);
-            }
+            _stop_all_voices();
             _sample_file_property = typed_event->value();
             /* Schedule a non-rt callback to handle sample loading */
             auto e = RtEvent::make_async_work_event(&SamplePlayerPlugin::non_rt_callback, this->id(), this);
@@ -160,13 +189,28 @@ void SamplePlayerPlugin::process_event(const RtEvent& event)
             if (typed_event->sending_event_id() == _pending_event_id &&
                 typed_event->return_status() == SampleChangeStatus::SUCCESS)
             {
-                float* old_sample = _sample_buffer;
-                _sample_buffer = reinterpret_cast<float*>(_pending_sample.data);
-                _sample.set_sample(_sample_buffer, _pending_sample.size / sizeof(float));
-                /* Delete the old sample data outside the rt thread */
-                BlobData data{0, reinterpret_cast<uint8_t*>(old_sample)};
-                auto delete_event = RtEvent::make_delete_blob_event(data);
-                output_event(delete_event);
+                const float* old_sample = _sample_buffer;
+                _sample_buffer = _pending_sample.data;
+                _pending_sample.data = nullptr;
+                _sample.set_sample(_sample_buffer, _pending_sample.frames);
+                /* Voices still playing the old sample are cut, as they can't be
+                 * streamed from the new file */
+                _active_streamer = _pending_streamer;
+                auto& streamer = _streamers[_active_streamer];
+                for (int i = 0; i < MAX_POLYPHONY; ++i)
+                {
+                    _voices[i].reset();
+                    _voices[i].set_stream(_pending_streaming ? streamer.buffer(i) : nullptr, _pending_sample.total_frames);
+                }
+                _free_stopped_voices();
+                /* Release the old sample data outside the rt thread. The worker runs
+                 * this before the callback of any later sample change, so there is
+                 * never more than one retired sample */
+                if (old_sample)
+                {
+                    _retired_sample = old_sample;
+                    output_event(RtEvent::make_async_work_event(&SamplePlayerPlugin::release_callback, this->id(), this));
+                }
             }
             break;
         }
@@ -186,12 +230,26 @@ void SamplePlayerPlugin::process_audio(const ChunkSampleBuffer& /* in_buffer */,
     float sustain = _sustain_parameter->value();
     float release = _release_parameter->value();
 
+    auto interpolation = _cubic_interpolation_parameter->value() ? dsp::InterpolationMode::CUBIC :
+                                                                    dsp::InterpolationMode::LINEAR;
     _buffer.clear();
     out_buffer.clear();
-    for (auto& voice : _voices)
+    _limit_polyphony();
+    /* Only voices that are sounding are rendered, so the cost scales with the
+     * number of playing notes and not with the maximum polyphony */
+    bool underrun = false;
+    for (int i = 0; i < _active_voice_count; ++i)
     {
+        auto& voice = _voices[_active_voices[i]];
         voice.set_envelope(attack, decay, sustain, release);
+        voice.set_interpolation(interpolation);
         voice.render(_buffer);
+        underrun |= voice.underrun();
+    }
+    _free_stopped_voices();
+    if (underrun)
+    {
+        set_parameter_and_notify(_stream_underruns_parameter, ++_stream_underruns);
     }
     if (!_bypassed)
     {
@@ -199,22 +257,83 @@ void SamplePlayerPlugin::process_audio(const ChunkSampleBuffer& /* in_buffer */,
     }
 }
 
-BlobData SamplePlayerPlugin::load_sample_file(const std::string &file_name)
+int SamplePlayerPlugin::_allocate_voice()
 {
-    SNDFILE*    sample_file;
-    SF_INFO     soundfile_info = {};
-    if (! (sample_file = sf_open(file_name.c_str(), SFM_READ, &soundfile_info)) )
+    if (_active_voice_count < _polyphony_parameter->value() && _free_voice_count > 0)
     {
-        SUSHI_LOG_ERROR("Failed to open sample file: {}", file_name);
-        return {0, nullptr};
+        int voice = _free_voices[--_free_voice_count];
+        _active_voices[_active_voice_count++] = voice;
+        return voice;
     }
-    assert(soundfile_info.channels == 1);
-    float* sample_buffer = new float[soundfile_info.frames];
-    int samples = sf_readf_float(sample_file, sample_buffer, soundfile_info.frames);
-    assert(samples == soundfile_info.frames);
-    sf_close(sample_file);
+    assert(_active_voice_count > 0);
+    /* Steal the oldest releasing voice, it is likely the quietest one, or
+     * if no voice is releasing, the oldest one */
+    int steal_index = 0;
+    for (int i = 0; i < _active_voice_count; ++i)
+    {
+        if (_voices[_active_voices[i]].stopping())
+        {
+            steal_index = i;
+            break;
+        }
+    }
+    /* Move the stolen voice to the back of the list, as it is now the newest */
+    int voice = _active_voices[steal_index];
+    std::copy(_active_voices.begin() + steal_index + 1, _active_voices.begin() + _active_voice_count,
+              _active_voices.begin() + steal_index);
+    _active_voices[_active_voice_count - 1] = voice;
+    return voice;
+}
 
-    return BlobData{static_cast<int>(samples * sizeof(float)), reinterpret_cast<uint8_t*>(sample_buffer)};
+void SamplePlayerPlugin::_limit_polyphony()
+{
+    int polyphony = _polyphony_parameter->value();
+    if (_active_voice_count <= polyphony)
+    {
+        return;
+    }
+    int sounding = 0;
+    for (int i = 0; i < _active_voice_count; ++i)
+    {
+        const auto& voice = _voices[_active_voices[i]];
+        sounding += voice.active() && voice.fading_out() == false ? 1 : 0;
+    }
+    /* When the polyphony is lowered, the oldest voices above it are faded out */
+    for (int i = 0; i < _active_voice_count && sounding > polyphony; ++i)
+    {
+        auto& voice = _voices[_active_voices[i]];
+        if (voice.active() && voice.fading_out() == false)
+        {
+            voice.fade_out();
+            --sounding;
+        }
+    }
+}
+
+void SamplePlayerPlugin::_free_stopped_voices()
+{
+    int active_count = 0;
+    for (int i = 0; i < _active_voice_count; ++i)
+    {
+        int voice = _active_voices[i];
+        if (_voices[voice].active())
+        {
+            _active_voices[active_count++] = voice;
+        }
+        else
+        {
+            _free_voices[_free_voice_count++] = voice;
+        }
+    }
+    _active_voice_count = active_count;
+}
+
+void SamplePlayerPlugin::_stop_all_voices()
+{
+    for (int i = 0; i < _active_voice_count; ++i)
+    {
+        _voices[_active_voices[i]].note_off(1.0f, 0);
+    }
 }
 
 int SamplePlayerPlugin::_non_rt_callback(EventId id)
@@ -222,13 +341,40 @@ int SamplePlayerPlugin::_non_rt_callback(EventId id)
     if (id == _pending_event_id)
     {
         /* Note that this doesn't handle multiple requests at once, several outstanding work
-         * requests can leak the address string */
-        auto sample_data = load_sample_file(*_sample_file_property);
+         * requests can leak the address string.
+         * Release a sample from an earlier request that was replaced before it was swapped in */
+        auto& cache = SampleCache::instance();
+        cache.release(_pending_sample.data);
+        _pending_sample = CachedSample();
+
+        int max_frames = 0;
+        if (_disk_streaming_parameter->value())
+        {
+            max_frames = preload_frames(*_sample_file_property);
+        }
+        /* Instances using the same file share the sample data through the cache */
+        auto sample = cache.acquire(*_sample_file_property, max_frames);
+        bool streaming = sample.data && sample.frames < sample.total_frames;
+        /* The active streamer may still be used by releasing voices until the
+         * new sample is swapped in, so only the other one is touched here */
+        int streamer_index = 1 - _active_streamer;
+        auto& streamer = _streamers[streamer_index];
+        if (streaming && streamer.open(*_sample_file_property, sample.frames) == false)
+        {
+            cache.release(sample.data);
+            sample = CachedSample();
+        }
+        else if (streaming == false)
+        {
+            streamer.close();
+        }
         delete _sample_file_property;
         _sample_file_property = nullptr;
-        if (sample_data.size > 0)
+        if (sample.data)
         {
-            _pending_sample = sample_data;
+            _pending_sample = sample;
+            _pending_streaming = streaming;
+            _pending_streamer = streamer_index;
             SUSHI_LOG_INFO("SamplePlayer: Successfully loaded sample data");
             return SampleChangeStatus::SUCCESS;
         }
@@ -241,6 +387,12 @@ int SamplePlayerPlugin::_non_rt_callback(EventId id)
     }
 }
 
+int SamplePlayerPlugin::_release_retired_sample()
+{
+    SampleCache::instance().release(_retired_sample);
+    _retired_sample = nullptr;
+    return SampleChangeStatus::SUCCESS;
+}
 
 }// namespace sample_player_plugin
 }// namespace sushi
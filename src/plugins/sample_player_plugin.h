@@ -22,14 +22,19 @@
 #define SUSHI_SAMPLER_PLUGIN_H
 
 #include <array>
+#include <chrono>
 
 #include "library/internal_plugin.h"
+#include "library/sample_cache.h"
 #include "plugins/sample_player_voice.h"
 
 namespace sushi {
 namespace sample_player_plugin {
 
-constexpr size_t TOTAL_POLYPHONY = 8;
+constexpr int MAX_POLYPHONY = 128;
+constexpr int DEFAULT_POLYPHONY = 32;
+/* When streaming from disk, this much of the sample is kept in memory */
+constexpr auto STREAMING_PRELOAD_TIME = std::chrono::milliseconds(500);
 
 static const std::string DEFAULT_NAME = "sushi.testing.sampleplayer";
 static const std::string DEFAULT_LABEL = "Sample player";
@@ -63,11 +68,43 @@ public:
         return reinterpret_cast<SamplePlayerPlugin*>(data)->_non_rt_callback(id);
     }
 
+    static int release_callback(void* data, EventId /*id*/)
+    {
+        return reinterpret_cast<SamplePlayerPlugin*>(data)->_release_retired_sample();
+    }
+
 private:
-    BlobData load_sample_file(const std::string &file_name);
     int _non_rt_callback(EventId id);
 
-    float*  _sample_buffer{nullptr};
+    /**
+     * @brief Return the reference to the sample data that was replaced by the
+     *        last sample change to the SampleCache. Not rt safe.
+     */
+    int _release_retired_sample();
+
+    /**
+     * @brief Get a voice for a new note. Takes a free voice if the current polyphony
+     *        allows it, otherwise steals the oldest releasing voice or, if no voice
+     *        is releasing, the oldest voice.
+     * @return The index of the voice to use.
+     */
+    int _allocate_voice();
+
+    /**
+     * @brief Fade out the oldest voices if more voices are sounding than the current
+     *        polyphony allows, i.e. after the polyphony parameter was lowered
+     */
+    void _limit_polyphony();
+
+    /**
+     * @brief Return voices that have stopped sounding to the list of free voices
+     */
+    void _free_stopped_voices();
+
+    void _stop_all_voices();
+
+    const float* _sample_buffer{nullptr};
+    const float* _retired_sample{nullptr};
     float   _dummy_sample{0.0f};
     dsp::Sample _sample;
 
@@ -77,12 +114,33 @@ private:
     FloatParameterValue* _decay_parameter;
     FloatParameterValue* _sustain_parameter;
     FloatParameterValue* _release_parameter;
+    IntParameterValue*   _polyphony_parameter;
+    BoolParameterValue*  _cubic_interpolation_parameter;
+    BoolParameterValue*  _disk_streaming_parameter;
+    IntParameterValue*   _stream_underruns_parameter;
+    int                  _stream_underruns{0};
 
     std::string*         _sample_file_property{nullptr};
     EventId              _pending_event_id{0};
-    BlobData             _pending_sample{0, 0};
-
-    std::array<sample_player_voice::Voice, TOTAL_POLYPHONY> _voices;
+    CachedSample         _pending_sample;
+    bool                 _pending_streaming{false};
+
+    /* Double buffered, so that voices can keep streaming the old file until the
+     * new sample is swapped in on the rt thread. The non-rt callback only opens
+     * and closes the streamer that is not active. */
+    std::array<sample_player_voice::SampleStreamer, 2> _streamers{sample_player_voice::SampleStreamer(MAX_POLYPHONY),
+                                                                  sample_player_voice::SampleStreamer(MAX_POLYPHONY)};
+    int                  _active_streamer{0};
+    int                  _pending_streamer{0};
+
+    std::array<sample_player_voice::Voice, MAX_POLYPHONY> _voices;
+
+    /* Indices of voices not in use, used as a stack */
+    std::array<int, MAX_POLYPHONY> _free_voices;
+    int _free_voice_count{0};
+    /* Indices of sounding voices, ordered from oldest to newest note */
+    std::array<int, MAX_POLYPHONY> _active_voices;
+    int _active_voice_count{0};
 };
 
 
@@ -18,6 +18,7 @@
  * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
@@ -38,7 +39,16 @@ void Voice::note_on(int note, float velocity, int offset)
 {
     offset = std::min(offset, AUDIO_CHUNK_SIZE - 1);
 
-    /* Completely ignore any currently playing note, it will be cut off abruptly */
+    /* A note that has already sounded is faded out during the next chunk to avoid
+     * a click, a note that was started within this chunk is simply replaced */
+    if (_state == SamplePlayMode::PLAYING || _state == SamplePlayMode::STOPPING)
+    {
+        _fading = true;
+        _fade_pos = _playback_pos;
+        _fade_speed = _playback_speed;
+        _fade_gain = _envelope.level() * _velocity_gain;
+    }
+    _fade_only = false;
     _state = SamplePlayMode::STARTING;
     /* Quadratic velocity curve */
     _velocity_gain = velocity * velocity;
@@ -46,6 +56,10 @@ void Voice::note_on(int note, float velocity, int offset)
     _stop_offset = AUDIO_CHUNK_SIZE;
     _playback_pos = 0.0;
     _current_note = note;
+    if (_stream && _fading == false)
+    {
+        _stream->request();
+    }
     /* The root note of the sample is assumed to be C4 in 44100 Hz*/
     _playback_speed = powf(2, (note - 60)/12.0f) * _samplerate / SAMPLE_FILE_RATE;
     _envelope.gate(true);
@@ -62,37 +76,89 @@ void Voice::note_off(float /*velocity*/, int offset)
     }
 }
 
+void Voice::fade_out()
+{
+    if (_state == SamplePlayMode::PLAYING || _state == SamplePlayMode::STOPPING)
+    {
+        _fading = true;
+        _fade_pos = _playback_pos;
+        _fade_speed = _playback_speed;
+        _fade_gain = _envelope.level() * _velocity_gain;
+    }
+    if (_fading == false)
+    {
+        /* Nothing has sounded yet */
+        reset();
+        return;
+    }
+    _fade_only = true;
+    _state = SamplePlayMode::STOPPING;
+}
+
 void Voice::reset()
 {
     _state = SamplePlayMode::STOPPED;
+    _fading = false;
+    _fade_only = false;
     _envelope.reset();
+    if (_stream)
+    {
+        _stream->stop();
+    }
 }
 
 void Voice::render(sushi::SampleBuffer<AUDIO_CHUNK_SIZE>& output_buffer)
 {
+    _underrun = false;
     if (_state == SamplePlayMode::STOPPED)
     {
         return;
     }
     /* Handle only mono samples for now */
     float* out = output_buffer.channel(0);
-
-    for (int i = _start_offset; i < _stop_offset; ++i)
+    float* envelope = _envelope_buffer.data();
+    if (_fading)
     {
-        out[i] += _sample->at(_playback_pos) * _velocity_gain * _envelope.tick(1);
-        _playback_pos += _playback_speed;
+        _render_fade_out(out);
+        if (_fade_only)
+        {
+            reset();
+            return;
+        }
     }
 
-    /* If there is a note off event, set the envelope to off and
-     * render the rest of the chunk */
+    /* If there is a note off event, render the envelope up to that point and
+     * set the envelope to off and render the rest of the chunk */
+    _envelope.render(envelope + _start_offset, _stop_offset - _start_offset);
+    int end_offset = _stop_offset;
     if (_state == SamplePlayMode::STOPPING)
     {
         _envelope.gate(false);
-        for (int i = _stop_offset; i < AUDIO_CHUNK_SIZE; ++i)
-        {
-            out[i] += _sample->at(_playback_pos) * _velocity_gain * _envelope.tick(1);
-            _playback_pos += _playback_speed;
-        }
+        _envelope.render(envelope + _stop_offset, AUDIO_CHUNK_SIZE - _stop_offset);
+        end_offset = AUDIO_CHUNK_SIZE;
+    }
+
+    for (int i = _start_offset; i < end_offset; ++i)
+    {
+        envelope[i] *= _velocity_gain;
+    }
+    if (_stream)
+    {
+        _underrun = !_render_streamed(out + _start_offset, envelope + _start_offset, _playback_pos,
+                                      _playback_speed, end_offset - _start_offset);
+    }
+    else
+    {
+        _playback_pos = _sample->render(out + _start_offset, envelope + _start_offset, _playback_pos,
+                                        _playback_speed, end_offset - _start_offset, _interpolation);
+    }
+
+    /* A voice that has played past the end of the sample can't produce any more
+     * sound, so it can be freed even if the note is still held */
+    if (_playback_pos >= _sample_length())
+    {
+        reset();
+        return;
     }
 
     /* Handle state changes and reset render limits */
@@ -116,4 +182,103 @@ void Voice::render(sushi::SampleBuffer<AUDIO_CHUNK_SIZE>& output_buffer)
 
 }
 
+/* The stolen note is rendered from where it was, with its gain ramped down to 0.
+ * A streamed voice only restarts its stream once the old note has been read. */
+void Voice::_render_fade_out(float* output)
+{
+    float* gain = _fade_buffer.data();
+    for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+    {
+        gain[i] = _fade_gain * std::max(0.0f, 1.0f - static_cast<float>(i + 1) / STEAL_FADE_SAMPLES);
+    }
+    int samples = std::min(AUDIO_CHUNK_SIZE, STEAL_FADE_SAMPLES);
+    if (_fade_pos < _sample_length())
+    {
+        if (_stream)
+        {
+            _render_streamed(output, gain, _fade_pos, _fade_speed, samples);
+        }
+        else
+        {
+            _sample->render(output, gain, _fade_pos, _fade_speed, samples, _interpolation);
+        }
+    }
+    if (_stream && _fade_only == false)
+    {
+        _stream->request();
+    }
+    _fading = false;
+}
+
+/* The first part of the sample is read from the preloaded data in _sample and
+ * the rest from the stream buffer, where index 0 is the first sample after the
+ * preloaded data. If the streamed data is not available in time, nothing is
+ * rendered and the position is not advanced. */
+bool Voice::_render_streamed(float* output, const float* gain, double& position, float speed, int samples)
+{
+    const int preloaded = _sample->length();
+    const bool cubic = _interpolation == dsp::InterpolationMode::CUBIC;
+    /* Exclusive end of the sample points needed by the interpolation */
+    int needed_end = static_cast<int>(position + (samples - 1) * speed) + (cubic ? 3 : 2);
+
+    if (needed_end <= preloaded)
+    {
+        position = _sample->render(output, gain, position, speed, samples, _interpolation);
+        return true;
+    }
+    if (_stream->ready() == false ||
+        preloaded + _stream->write_count() < std::min(needed_end, _stream_length))
+    {
+        return false;
+    }
+
+    int first_index = static_cast<int>(position) - (cubic ? 1 : 0);
+    if (first_index >= preloaded && needed_end <= _stream_length)
+    {
+        /* All points are in the stream buffer */
+        for (int i = 0; i < samples; ++i)
+        {
+            double pos = position + i * speed;
+            int index = static_cast<int>(pos);
+            float weight = pos - index;
+            index -= preloaded;
+            float value = cubic ? dsp::cubic_interpolation(_stream->at(index - 1), _stream->at(index),
+                                                           _stream->at(index + 1), _stream->at(index + 2), weight) :
+                                  dsp::linear_interpolation(_stream->at(index), _stream->at(index + 1), weight);
+            output[i] += gain[i] * value;
+        }
+    }
+    else
+    {
+        /* Crossing from the preloaded data into the stream or reaching the end of the sample */
+        auto value_at = [&](int index)
+        {
+            if (index < preloaded)
+            {
+                return _sample->value(index);
+            }
+            return index < _stream_length ? _stream->at(index - preloaded) : 0.0f;
+        };
+        for (int i = 0; i < samples; ++i)
+        {
+            double pos = position + i * speed;
+            int index = static_cast<int>(pos);
+            float weight = pos - index;
+            float value = cubic ? dsp::cubic_interpolation(value_at(index - 1), value_at(index),
+                                                           value_at(index + 1), value_at(index + 2), weight) :
+                                  dsp::linear_interpolation(value_at(index), value_at(index + 1), weight);
+            output[i] += gain[i] * value;
+        }
+    }
+    position += samples * speed;
+
+    /* Keep one sample before the current position for cubic interpolation */
+    int consumed = std::min(static_cast<int>(position) - 1 - preloaded, _stream->write_count());
+    if (consumed > 0)
+    {
+        _stream->consume(consumed);
+    }
+    return true;
+}
+
 }// namespace sample_player_voice
\ No newline at end of file
@@ -21,15 +21,21 @@
 #ifndef SUSHI_SAMPLE_VOICE_H
 #define SUSHI_SAMPLE_VOICE_H
 
+#include <array>
+
 #include "library/sample_buffer.h"
 #include "dsp_library/sample_wrapper.h"
 #include "dsp_library/envelopes.h"
+#include "plugins/sample_streamer.h"
 
 namespace sample_player_voice {
 
 // TODO eventually make this configurable
 constexpr float SAMPLE_FILE_RATE = 44100.0f;
 
+/* A note that is cut off when its voice is stolen is faded out over this many samples */
+constexpr int STEAL_FADE_SAMPLES = AUDIO_CHUNK_SIZE;
+
 enum class SamplePlayMode
 {
     STOPPED,
@@ -65,6 +71,23 @@ public:
      */
     void set_sample(dsp::Sample* sample) {_sample = sample;}
 
+    /**
+     * @brief Stream the part of the sample that is not preloaded from a StreamBuffer.
+     * @param stream The buffer to stream from, if nullptr the whole sample is
+     *        expected to be in memory.
+     * @param length The total length of the sample in samples.
+     */
+    void set_stream(StreamBuffer* stream, int length)
+    {
+        _stream = stream;
+        _stream_length = length;
+    }
+
+    /**
+     * @brief Set the type of interpolation used when playing back the sample.
+     */
+    void set_interpolation(dsp::InterpolationMode mode) {_interpolation = mode;}
+
     /**
      * @brief Set the envelope parameters.
      */
@@ -77,22 +100,29 @@ public:
      * @brief Is currently playing sound.
      * @return True if currently playing sound.
      */
-    bool active() {return (_state != SamplePlayMode::STOPPED);}
+    bool active() const {return (_state != SamplePlayMode::STOPPED);}
 
     /**
      * @brief Is currently in the release phase but still playing.
      * @return True if note is currently off but still sounding.
      */
-    bool stopping() {return _state == SamplePlayMode::STOPPING;}
+    bool stopping() const {return _state == SamplePlayMode::STOPPING;}
+
+    /**
+     * @brief Check if streamed sample data was not available in time during the last render.
+     * @return True if the last call to render() had an under-run.
+     */
+    bool underrun() const {return _underrun;}
 
     /**
      * @brief Return the current note being played, if any.
      * @return The current note as a midi note number.
      */
-    int current_note() {return _current_note;}
+    int current_note() const {return _current_note;}
 
     /**
-     * @brief Play a new note within this audio chunk
+     * @brief Play a new note within this audio chunk. If the voice is already
+     *        playing a note, that note is faded out quickly instead of cut off.
      * @param note The midi note number to play, with 60 as middle C.
      * @param velocity Velocity of the note to play. 0 to 1.
      * @param time_offset Offset in samples from the start of the chunk.
@@ -106,6 +136,17 @@ public:
      */
     void note_off(float velocity, int offset);
 
+    /**
+     * @brief Stop the voice within the next chunk, with the same short fade that is
+     *        used when a voice is stolen, i.e. when the polyphony is lowered.
+     */
+    void fade_out();
+
+    /**
+     * @brief Is being faded out by fade_out() and is freed after the next chunk.
+     */
+    bool fading_out() const {return _fade_only;}
+
     /**
      * @brief Reset the voice and kill all sound.
      */
@@ -118,17 +159,36 @@ public:
     void render(sushi::SampleBuffer<AUDIO_CHUNK_SIZE>& output_buffer);
 
 private:
+    /* Render streamed sample data from position, returns false if it was not available */
+    bool _render_streamed(float* output, const float* gain, double& position, float speed, int samples);
+
+    /* Render the remainder of a stolen note with a ramp down to silence */
+    void _render_fade_out(float* output);
+
+    int _sample_length() const {return _stream ? _stream_length : _sample->length();}
 
     float _samplerate{44100};
     dsp::Sample* _sample;
+    dsp::InterpolationMode _interpolation{dsp::InterpolationMode::LINEAR};
+    StreamBuffer* _stream{nullptr};
+    int _stream_length{0};
+    bool _underrun{false};
     SamplePlayMode _state{SamplePlayMode::STOPPED};
     dsp::AdsrEnvelope _envelope;
+    std::array<float, AUDIO_CHUNK_SIZE> _envelope_buffer;
     int _current_note;
     float _playback_speed;
     float _velocity_gain;
     double _playback_pos{0.0};
     int _start_offset{0};
     int _stop_offset{0};
+    bool _fading{false};
+    /* Only the fade is rendered, the voice is stopped after it */
+    bool _fade_only{false};
+    double _fade_pos{0.0};
+    float _fade_speed{1.0f};
+    float _fade_gain{0.0f};
+    std::array<float, AUDIO_CHUNK_SIZE> _fade_buffer;
 };
 
 } // end namespace sample_player_voice
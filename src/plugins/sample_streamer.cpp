@@ -0,0 +1,148 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Disk streaming of sample data for the sample player plugin
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "plugins/sample_streamer.h"
+#include "logging.h"
+
+namespace sample_player_voice {
+
+SUSHI_GET_LOGGER_WITH_MODULE_NAME("samplestreamer");
+
+SampleStreamer::~SampleStreamer()
+{
+    _running = false;
+    if (_worker_thread.joinable())
+    {
+        _worker_thread.join();
+    }
+    close();
+}
+
+bool SampleStreamer::open(const std::string& file_name, int start_frame)
+{
+    SF_INFO soundfile_info = {};
+    SNDFILE* file = sf_open(file_name.c_str(), SFM_READ, &soundfile_info);
+    if (file == nullptr)
+    {
+        SUSHI_LOG_ERROR("Failed to open sample file for streaming: {}", file_name);
+        return false;
+    }
+    if (soundfile_info.channels != 1)
+    {
+        SUSHI_LOG_ERROR("Only mono samples can be streamed, {} has {} channels", file_name, soundfile_info.channels);
+        sf_close(file);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_file_lock);
+    if (_file)
+    {
+        sf_close(_file);
+    }
+    _file = file;
+    _start_frame = start_frame;
+    _length = static_cast<int>(soundfile_info.frames);
+    if (!_buffers)
+    {
+        _buffers = std::make_unique<StreamBuffer[]>(_streams);
+        _file_positions = std::make_unique<int[]>(_streams);
+    }
+    if (_running == false)
+    {
+        _running = true;
+        _worker_thread = std::thread(&SampleStreamer::_worker, this);
+    }
+    return true;
+}
+
+void SampleStreamer::close()
+{
+    std::lock_guard<std::mutex> lock(_file_lock);
+    if (_file)
+    {
+        sf_close(_file);
+        _file = nullptr;
+    }
+}
+
+void SampleStreamer::_worker()
+{
+    std::vector<float> read_buffer(STREAMER_READ_SIZE);
+    while (_running)
+    {
+        bool data_read = false;
+        {
+            std::lock_guard<std::mutex> lock(_file_lock);
+            if (_file)
+            {
+                data_read = _fill_buffers(read_buffer.data());
+            }
+        }
+        /* Keep reading as long as there is data to read and space in the buffers */
+        if (data_read == false)
+        {
+            std::this_thread::sleep_for(STREAMER_PERIODICITY);
+        }
+    }
+}
+
+bool SampleStreamer::_fill_buffers(float* read_buffer)
+{
+    bool data_read = false;
+    for (int i = 0; i < _streams; ++i)
+    {
+        auto& buffer = _buffers[i];
+        int request = buffer.requested();
+        if (request == 0)
+        {
+            continue;
+        }
+        if (request != buffer.served())
+        {
+            buffer.reset(request);
+            _file_positions[i] = _start_frame;
+        }
+        int remaining = _length - _file_positions[i];
+        int frames = std::min({buffer.free_space(), STREAMER_READ_SIZE, remaining});
+        /* Avoid lots of small reads when the buffer is almost full */
+        if (frames <= 0 || (frames < STREAMER_MIN_READ_SIZE && frames < remaining))
+        {
+            continue;
+        }
+        sf_seek(_file, _file_positions[i], SEEK_SET);
+        int frames_read = static_cast<int>(sf_readf_float(_file, read_buffer, frames));
+        if (frames_read <= 0)
+        {
+            SUSHI_LOG_WARNING("Failed to read sample data at frame {}", _file_positions[i]);
+            /* Treat the rest of the file as silence rather than retrying forever */
+            frames_read = frames;
+            std::fill(read_buffer, read_buffer + frames, 0.0f);
+        }
+        buffer.push(read_buffer, frames_read);
+        _file_positions[i] += frames_read;
+        data_read = true;
+    }
+    return data_read;
+}
+
+} // end namespace sample_player_voice
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk
+ *
+ * SUSHI is free software: you can redistribute it and/or modify it under the terms of
+ * the GNU Affero General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * SUSHI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License along with
+ * SUSHI.  If not, see http://www.gnu.org/licenses/
+ */
+
+/**
+ * @brief Disk streaming of sample data for the sample player plugin
+ * @copyright 2017-2019 Modern Ancient Instruments Networked AB, dba Elk, Stockholm
+ *
+ * The beginning of a sample is preloaded into memory and the rest is streamed
+ * from disk by a background thread into one lock-free ring buffer per voice.
+ */
+
+#ifndef SUSHI_SAMPLE_STREAMER_H
+#define SUSHI_SAMPLE_STREAMER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <sndfile.h>
+
+#include "library/constants.h"
+#include "library/spinlock.h"
+
+namespace sample_player_voice {
+
+/* Must be a power of 2 */
+constexpr int STREAM_BUFFER_SIZE = 8192;
+constexpr int STREAMER_READ_SIZE = 2048;
+constexpr int STREAMER_MIN_READ_SIZE = 512;
+constexpr auto STREAMER_PERIODICITY = std::chrono::milliseconds(2);
+
+/**
+ * @brief Single producer, single consumer ring buffer for streamed sample data.
+ *        Each request from the rt thread restarts the stream from the first
+ *        streamed frame. Sample indexes are counted from the start of the stream.
+ */
+class StreamBuffer
+{
+    SUSHI_DECLARE_NON_COPYABLE(StreamBuffer);
+public:
+    StreamBuffer() = default;
+
+    /* Called from the rt thread */
+
+    /**
+     * @brief Request that streaming is (re)started from the first streamed frame
+     */
+    void request()
+    {
+        if (++_generation == 0)
+        {
+            ++_generation;
+        }
+        _requested.store(_generation, std::memory_order_release);
+    }
+
+    /**
+     * @brief Stop streaming data for the current request
+     */
+    void stop()
+    {
+        _requested.store(0, std::memory_order_release);
+    }
+
+    /**
+     * @return true if the streaming thread has started serving the latest request
+     */
+    bool ready() const
+    {
+        return _generation != 0 && _served.load(std::memory_order_acquire) == _generation;
+    }
+
+    /**
+     * @return The number of samples written to the buffer since the start of the stream
+     */
+    int write_count() const
+    {
+        return _write_count.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Access a sample, only valid for indexes between the last call to
+     *        consume() and write_count().
+     */
+    float at(int index) const
+    {
+        return _data[index & (STREAM_BUFFER_SIZE - 1)];
+    }
+
+    /**
+     * @brief Release all samples before index so their space can be reused
+     */
+    void consume(int index)
+    {
+        _read_count.store(index, std::memory_order_release);
+    }
+
+    /* Called from the streaming thread */
+
+    int requested() const
+    {
+        return _requested.load(std::memory_order_acquire);
+    }
+
+    int served() const
+    {
+        return _served.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Empty the buffer and mark a request as being served. The rt thread does
+     *        not touch the buffer until it has seen the request being served.
+     */
+    void reset(int request)
+    {
+        _read_count.store(0, std::memory_order_relaxed);
+        _write_count.store(0, std::memory_order_relaxed);
+        _served.store(request, std::memory_order_release);
+    }
+
+    int free_space() const
+    {
+        return STREAM_BUFFER_SIZE - (_write_count.load(std::memory_order_relaxed) -
+                                     _read_count.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief Write samples to the buffer, there must be at least samples free space.
+     */
+    void push(const float* data, int samples)
+    {
+        int write_count = _write_count.load(std::memory_order_relaxed);
+        for (int i = 0; i < samples; ++i)
+        {
+            _data[(write_count + i) & (STREAM_BUFFER_SIZE - 1)] = data[i];
+        }
+        _write_count.store(write_count + samples, std::memory_order_release);
+    }
+
+private:
+    int _generation{0};
+    alignas(ASSUMED_CACHE_LINE_SIZE) std::atomic<int> _requested{0};
+    alignas(ASSUMED_CACHE_LINE_SIZE) std::atomic<int> _served{0};
+    alignas(ASSUMED_CACHE_LINE_SIZE) std::atomic<int> _read_count{0};
+    alignas(ASSUMED_CACHE_LINE_SIZE) std::atomic<int> _write_count{0};
+    std::array<float, STREAM_BUFFER_SIZE> _data;
+};
+
+/**
+ * @brief Reads sample data from disk in a background thread and feeds a
+ *        StreamBuffer for each voice.
+ */
+class SampleStreamer
+{
+    SUSHI_DECLARE_NON_COPYABLE(SampleStreamer);
+public:
+    explicit SampleStreamer(int streams) : _streams(streams) {}
+
+    ~SampleStreamer();
+
+    /**
+     * @brief Open a mono sample file for streaming and start the streaming thread
+     *        if not already running. Not rt safe.
+     * @param file_name The sample file to stream
+     * @param start_frame The first frame to stream, all frames before this are
+     *        expected to be preloaded.
+     * @return true if the file could be opened, false otherwise.
+     */
+    bool open(const std::string& file_name, int start_frame);
+
+    /**
+     * @brief Close the current file and stop streaming. Not rt safe.
+     */
+    void close();
+
+    /**
+     * @brief Get the stream buffer of a voice. Only valid after a successful call to open().
+     * @param index The voice index
+     * @return A pointer to the StreamBuffer
+     */
+    StreamBuffer* buffer(int index) {return &_buffers[index];}
+
+private:
+    void _worker();
+
+    /* Returns true if any data was read */
+    bool _fill_buffers(float* read_buffer);
+
+    int _streams;
+    std::unique_ptr<StreamBuffer[]> _buffers;
+    std::unique_ptr<int[]> _file_positions;
+
+    std::mutex _file_lock;
+    SNDFILE* _file{nullptr};
+    int _start_frame{0};
+    int _length{0};
+
+    std::thread _worker_thread;
+    std::atomic_bool _running{false};
+};
+
+} // end namespace sample_player_voice
+
+#endif //SUSHI_SAMPLE_STREAMER_H
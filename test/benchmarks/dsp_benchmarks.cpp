@@ -0,0 +1,190 @@
+#include <array>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "library/sample_buffer.h"
+#include "dsp_library/biquad_filter.h"
+#include "dsp_library/envelopes.h"
+#include "dsp_library/value_smoother.h"
+
+using namespace sushi;
+
+constexpr float BENCH_SAMPLE_RATE = 48000;
+constexpr int BENCH_CHANNELS = 2;
+constexpr auto BENCH_SMOOTHING_LAG = std::chrono::milliseconds(20);
+
+/* Fill a buffer with noise so that no operation runs on denormals or constant data */
+static void fill_noise(ChunkSampleBuffer& buffer)
+{
+    std::ranlux24 generator(1234);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (int c = 0; c < buffer.channel_count(); ++c)
+    {
+        float* data = buffer.channel(c);
+        for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+        {
+            data[i] = dist(generator);
+        }
+    }
+}
+
+static void BM_SampleBufferApplyGain(benchmark::State& state)
+{
+    ChunkSampleBuffer buffer(BENCH_CHANNELS);
+    fill_noise(buffer);
+    float gain = 0.5f;
+    for (auto _ : state)
+    {
+        buffer.apply_gain(gain);
+        /* Alternate so the buffer content stays in range */
+        gain = 1.0f / gain;
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * AUDIO_CHUNK_SIZE * BENCH_CHANNELS);
+}
+BENCHMARK(BM_SampleBufferApplyGain);
+
+static void BM_SampleBufferAdd(benchmark::State& state)
+{
+    ChunkSampleBuffer source(BENCH_CHANNELS);
+    ChunkSampleBuffer dest(BENCH_CHANNELS);
+    fill_noise(source);
+    for (auto _ : state)
+    {
+        dest.clear();
+        dest.add(source);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * AUDIO_CHUNK_SIZE * BENCH_CHANNELS);
+}
+BENCHMARK(BM_SampleBufferAdd);
+
+static void BM_SampleBufferAddWithRamp(benchmark::State& state)
+{
+    ChunkSampleBuffer source(BENCH_CHANNELS);
+    ChunkSampleBuffer dest(BENCH_CHANNELS);
+    fill_noise(source);
+    for (auto _ : state)
+    {
+        dest.clear();
+        dest.add_with_ramp(source, 0.2f, 0.8f);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * AUDIO_CHUNK_SIZE * BENCH_CHANNELS);
+}
+BENCHMARK(BM_SampleBufferAddWithRamp);
+
+static void BM_SampleBufferInterleave(benchmark::State& state)
+{
+    ChunkSampleBuffer buffer(BENCH_CHANNELS);
+    fill_noise(buffer);
+    std::vector<float> interleaved(AUDIO_CHUNK_SIZE * BENCH_CHANNELS);
+    for (auto _ : state)
+    {
+        buffer.to_interleaved(interleaved.data());
+        buffer.from_interleaved(interleaved.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * AUDIO_CHUNK_SIZE * BENCH_CHANNELS);
+}
+BENCHMARK(BM_SampleBufferInterleave);
+
+static void BM_SampleBufferCountClipped(benchmark::State& state)
+{
+    ChunkSampleBuffer buffer(BENCH_CHANNELS);
+    fill_noise(buffer);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(buffer.count_clipped_samples());
+    }
+    state.SetItemsProcessed(state.iterations() * AUDIO_CHUNK_SIZE * BENCH_CHANNELS);
+}
+BENCHMARK(BM_SampleBufferCountClipped);
+
+static void BM_BiquadFilter(benchmark::State& state)
+{
+    ChunkSampleBuffer in_buffer(1);
+    ChunkSampleBuffer out_buffer(1);
+    fill_noise(in_buffer);
+    dsp::biquad::Coefficients coefficients;
+    dsp::biquad::calc_biquad_peak(coefficients, BENCH_SAMPLE_RATE, 1000.0f, 1.0f, 2.0f);
+    dsp::biquad::BiquadFilter filter(coefficients);
+    filter.set_smoothing(AUDIO_CHUNK_SIZE);
+    for (auto _ : state)
+    {
+        filter.process(in_buffer.channel(0), out_buffer.channel(0), AUDIO_CHUNK_SIZE);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * AUDIO_CHUNK_SIZE);
+}
+BENCHMARK(BM_BiquadFilter);
+
+template <typename Smoother>
+static void BM_ValueSmoother(benchmark::State& state)
+{
+    Smoother smoother(BENCH_SMOOTHING_LAG, BENCH_SAMPLE_RATE / AUDIO_CHUNK_SIZE);
+    float target = 1.0f;
+    for (auto _ : state)
+    {
+        /* Keep the smoother moving so stationary shortcuts are not taken */
+        if (smoother.stationary())
+        {
+            target = 1.0f - target;
+            smoother.set(target);
+        }
+        benchmark::DoNotOptimize(smoother.next_value());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_ValueSmoother, ValueSmootherRamp<float>);
+BENCHMARK_TEMPLATE(BM_ValueSmoother, ValueSmootherFilter<float>);
+
+template <typename Smoother>
+static void BM_ValueSmootherNextValues(benchmark::State& state)
+{
+    Smoother smoother(BENCH_SMOOTHING_LAG, BENCH_SAMPLE_RATE);
+    std::array<float, AUDIO_CHUNK_SIZE> values;
+    float target = 1.0f;
+    for (auto _ : state)
+    {
+        if (smoother.stationary())
+        {
+            target = 1.0f - target;
+            smoother.set(target);
+        }
+        smoother.next_values(values.data(), AUDIO_CHUNK_SIZE);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * AUDIO_CHUNK_SIZE);
+}
+BENCHMARK_TEMPLATE(BM_ValueSmootherNextValues, ValueSmootherRamp<float>);
+BENCHMARK_TEMPLATE(BM_ValueSmootherNextValues, ValueSmootherFilter<float>);
+
+static void BM_AdsrEnvelope(benchmark::State& state)
+{
+    dsp::AdsrEnvelope envelope;
+    envelope.set_samplerate(BENCH_SAMPLE_RATE);
+    envelope.set_parameters(0.01f, 0.05f, 0.5f, 0.1f);
+    std::array<float, AUDIO_CHUNK_SIZE> output;
+    int chunk = 0;
+    for (auto _ : state)
+    {
+        /* Retrigger regularly so that every segment of the envelope is rendered */
+        int phase = chunk++ % 100;
+        if (phase == 0)
+        {
+            envelope.gate(true);
+        }
+        else if (phase == 50)
+        {
+            envelope.gate(false);
+        }
+        envelope.render(output.data(), AUDIO_CHUNK_SIZE);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * AUDIO_CHUNK_SIZE);
+}
+BENCHMARK(BM_AdsrEnvelope);
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <string>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+
+#include "engine/audio_engine.h"
+#include "engine/event_dispatcher.h"
+#include "engine/midi_dispatcher.h"
+#include "engine/track.h"
+
+using namespace sushi;
+using namespace sushi::engine;
+
+constexpr float BENCH_SAMPLE_RATE = 48000;
+constexpr int BENCH_EVENT_BATCH_SIZE = 64;
+constexpr int BENCH_ENGINE_TRACKS = 8;
+constexpr int BENCH_PLUGINS_PER_TRACK = 4;
+
+/* Plugins are added in this order, round robin, to build up tracks */
+constexpr std::array<const char*, 2> BENCH_PLUGIN_UIDS = {"sushi.testing.equalizer", "sushi.testing.gain"};
+
+/* Swallows all events, so only the routing done by the MidiDispatcher is measured */
+class NullEventDispatcher : public dispatcher::BaseEventDispatcher
+{
+public:
+    void post_event(Event* event) override
+    {
+        delete event;
+    }
+
+    int process(Event* /*event*/) override
+    {
+        return EventStatus::HANDLED_OK;
+    }
+
+    int poster_id() override {return EventPosterId::AUDIO_ENGINE;}
+};
+
+class MidiBenchEngine : public AudioEngine
+{
+public:
+    MidiBenchEngine(float sample_rate) : AudioEngine(sample_rate) {}
+
+    dispatcher::BaseEventDispatcher* event_dispatcher() override
+    {
+        return &_null_dispatcher;
+    }
+
+private:
+    NullEventDispatcher _null_dispatcher;
+};
+
+static void fill_buffer(ChunkSampleBuffer& buffer)
+{
+    for (int c = 0; c < buffer.channel_count(); ++c)
+    {
+        std::fill(buffer.channel(c), buffer.channel(c) + AUDIO_CHUNK_SIZE, 0.5f);
+    }
+}
+
+/* Create a stereo track with the given number of internal plugins, connected
+ * to the first two engine inputs and outputs */
+static bool add_track(AudioEngine& engine, const std::string& name, int plugins)
+{
+    if (engine.create_track(name, 2) != EngineReturnStatus::OK)
+    {
+        return false;
+    }
+    for (int i = 0; i < plugins; ++i)
+    {
+        auto status = engine.add_plugin_to_track(name, BENCH_PLUGIN_UIDS[i % BENCH_PLUGIN_UIDS.size()],
+                                                 name + "_plugin_" + std::to_string(i), "", PluginType::INTERNAL);
+        if (status != EngineReturnStatus::OK)
+        {
+            return false;
+        }
+    }
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        if (engine.connect_audio_input_channel(channel, channel, name) != EngineReturnStatus::OK ||
+            engine.connect_audio_output_channel(channel, channel, name) != EngineReturnStatus::OK)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void BM_MidiDispatcherSendMidi(benchmark::State& state)
+{
+    MidiBenchEngine engine(BENCH_SAMPLE_RATE);
+    engine.set_audio_input_channels(2);
+    engine.set_audio_output_channels(2);
+    midi_dispatcher::MidiDispatcher dispatcher(&engine);
+    dispatcher.set_midi_inputs(1);
+    for (int i = 0; i < state.range(0); ++i)
+    {
+        std::string name = "track_" + std::to_string(i);
+        if (add_track(engine, name, 1) == false ||
+            dispatcher.connect_kb_to_track(0, name) != midi_dispatcher::MidiDispatcherStatus::OK)
+        {
+            state.SkipWithError("Failed to set up tracks");
+            return;
+        }
+    }
+    const std::array<MidiDataByte, 3> messages = {MidiDataByte{0x90, 60, 100, 0},
+                                                  MidiDataByte{0x80, 60, 0, 0},
+                                                  MidiDataByte{0xB0, 1, 64, 0}};
+    for (auto _ : state)
+    {
+        for (const auto& message : messages)
+        {
+            dispatcher.send_midi(0, message, IMMEDIATE_PROCESS);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * messages.size());
+}
+BENCHMARK(BM_MidiDispatcherSendMidi)->Arg(1)->Arg(8);
+
+/* Measures the round trip of events through the dispatcher thread into an
+ * rt queue. As the dispatcher thread wakes up periodically, this is bounded
+ * by the dispatcher period rather than the cost per event. */
+static void BM_EventDispatcherThroughput(benchmark::State& state)
+{
+    AudioEngine engine(BENCH_SAMPLE_RATE);
+    RtSafeRtEventFifo in_rt_queue;
+    RtSafeRtEventFifo out_rt_queue;
+    dispatcher::EventDispatcher dispatcher(&engine, &in_rt_queue, &out_rt_queue);
+    dispatcher.run();
+
+    RtEvent rt_event;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < BENCH_EVENT_BATCH_SIZE; ++i)
+        {
+            dispatcher.post_event(new ParameterChangeEvent(ParameterChangeEvent::Subtype::FLOAT_PARAMETER_CHANGE,
+                                                           0, 0, 0.5f, IMMEDIATE_PROCESS));
+        }
+        int received = 0;
+        while (received < BENCH_EVENT_BATCH_SIZE)
+        {
+            if (out_rt_queue.pop(rt_event))
+            {
+                received++;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+    dispatcher.stop();
+    state.SetItemsProcessed(state.iterations() * BENCH_EVENT_BATCH_SIZE);
+}
+BENCHMARK(BM_EventDispatcherThroughput)->UseRealTime();
+
+static void BM_TrackRender(benchmark::State& state)
+{
+    AudioEngine engine(BENCH_SAMPLE_RATE);
+    engine.set_audio_input_channels(2);
+    engine.set_audio_output_channels(2);
+    if (add_track(engine, "track", static_cast<int>(state.range(0))) == false)
+    {
+        state.SkipWithError("Failed to set up track");
+        return;
+    }
+    auto [status, track_id] = engine.processor_id_from_name("track");
+    assert(status == EngineReturnStatus::OK);
+    /* The engine only creates tracks as Processors of type Track */
+    auto track = static_cast<Track*>(engine.mutable_processor(track_id));
+    auto input = track->input_bus(0);
+    for (auto _ : state)
+    {
+        fill_buffer(input);
+        track->render();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * AUDIO_CHUNK_SIZE);
+}
+BENCHMARK(BM_TrackRender)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+
+/* Arguments are the number of rt cores and the number of tracks */
+static void BM_AudioEngineProcessChunk(benchmark::State& state)
+{
+    AudioEngine engine(BENCH_SAMPLE_RATE, static_cast<int>(state.range(0)));
+    engine.set_audio_input_channels(2);
+    engine.set_audio_output_channels(2);
+    for (int i = 0; i < state.range(1); ++i)
+    {
+        if (add_track(engine, "track_" + std::to_string(i), BENCH_PLUGINS_PER_TRACK) == false)
+        {
+            state.SkipWithError("Failed to set up tracks");
+            return;
+        }
+    }
+    ChunkSampleBuffer in_buffer(2);
+    ChunkSampleBuffer out_buffer(2);
+    ControlBuffer in_controls;
+    ControlBuffer out_controls;
+    fill_buffer(in_buffer);
+    for (auto _ : state)
+    {
+        engine.process_chunk(&in_buffer, &out_buffer, &in_controls, &out_controls);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * AUDIO_CHUNK_SIZE);
+}
+BENCHMARK(BM_AudioEngineProcessChunk)->Apply([](benchmark::internal::Benchmark* benchmark)
+{
+    /* Single core, and multicore for as many cores as the machine has, up to 4 */
+    int max_cores = std::min(4, std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+    for (int cores = 1; cores <= max_cores; cores *= 2)
+    {
+        benchmark->Args({cores, 1});
+        benchmark->Args({cores, BENCH_ENGINE_TRACKS});
+    }
+})->UseRealTime();
@@ -0,0 +1,100 @@
+#include <atomic>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+
+#include "library/rt_event_fifo.h"
+#include "library/simple_fifo.h"
+
+using namespace sushi;
+
+constexpr int BENCH_FIFO_SIZE = 128;
+constexpr int BENCH_BATCH_SIZE = 64;
+
+static RtEvent make_bench_event()
+{
+    return RtEvent::make_parameter_change_event(0, 0, 1, 0.5f);
+}
+
+static void BM_SimpleFifoPushPop(benchmark::State& state)
+{
+    SimpleFifo<RtEvent, BENCH_FIFO_SIZE> fifo;
+    RtEvent event = make_bench_event();
+    RtEvent received;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < BENCH_BATCH_SIZE; ++i)
+        {
+            fifo.push(event);
+        }
+        while (fifo.pop(received))
+        {
+            benchmark::DoNotOptimize(received);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BENCH_BATCH_SIZE);
+}
+BENCHMARK(BM_SimpleFifoPushPop);
+
+static void BM_RtSafeRtEventFifoPushPop(benchmark::State& state)
+{
+    RtSafeRtEventFifo fifo;
+    RtEvent event = make_bench_event();
+    RtEvent received;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < BENCH_BATCH_SIZE; ++i)
+        {
+            fifo.push(event);
+        }
+        while (fifo.pop(received))
+        {
+            benchmark::DoNotOptimize(received);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BENCH_BATCH_SIZE);
+}
+BENCHMARK(BM_RtSafeRtEventFifoPushPop);
+
+/* The rt fifo is meant to be written and read from different threads, this
+ * measures the throughput with a consumer busy-polling on a separate thread */
+static void BM_RtSafeRtEventFifoCrossThread(benchmark::State& state)
+{
+    RtSafeRtEventFifo fifo;
+    std::atomic_bool running{true};
+    std::atomic<int64_t> consumed{0};
+    std::thread consumer([&]()
+    {
+        RtEvent received;
+        while (running)
+        {
+            while (fifo.pop(received))
+            {
+                consumed.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    RtEvent event = make_bench_event();
+    int64_t produced = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < BENCH_BATCH_SIZE; ++i)
+        {
+            while (fifo.push(event) == false)
+            {
+                std::this_thread::yield();
+            }
+        }
+        produced += BENCH_BATCH_SIZE;
+    }
+    while (consumed.load() < produced)
+    {
+        std::this_thread::yield();
+    }
+    running = false;
+    consumer.join();
+    state.SetItemsProcessed(produced);
+}
+BENCHMARK(BM_RtSafeRtEventFifoCrossThread)->UseRealTime();
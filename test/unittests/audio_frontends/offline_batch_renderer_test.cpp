@@ -0,0 +1,107 @@
+#include <fstream>
+
+#include <sndfile.h>
+
+#include "gtest/gtest.h"
+
+#include "engine/json_configurator.h"
+#include "test_utils/test_utils.h"
+
+#define private public
+#include "audio_frontends/offline_batch_renderer.cpp"
+
+using namespace sushi;
+using namespace sushi::audio_frontend;
+
+constexpr float TEST_SAMPLE_RATE = 48000;
+
+sf_count_t file_frames(const std::string& filename)
+{
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    SNDFILE* file = sf_open(filename.c_str(), SFM_READ, &info);
+    if (file == nullptr)
+    {
+        return -1;
+    }
+    sf_close(file);
+    return info.frames;
+}
+
+TEST(TestOfflineBatchRenderer, TestJobsFromListFile)
+{
+    std::string list_filename("./batch_list.txt");
+    std::ofstream list_file(list_filename);
+    list_file << "# Comment\n"
+              << "in_1.wav\tout_1.wav\n"
+              << "\n"
+              << "dir with spaces/in_2.wav\n";
+    list_file.close();
+
+    auto jobs = OfflineBatchRenderer::jobs_from_list_file(list_filename);
+    ASSERT_EQ(2u, jobs.size());
+    EXPECT_EQ("in_1.wav", jobs[0].input_filename);
+    EXPECT_EQ("out_1.wav", jobs[0].output_filename);
+    EXPECT_EQ("dir with spaces/in_2.wav", jobs[1].input_filename);
+    EXPECT_EQ("dir with spaces/in_2.wav_proc.wav", jobs[1].output_filename);
+
+    EXPECT_TRUE(OfflineBatchRenderer::jobs_from_list_file("./no_such_list.txt").empty());
+}
+
+TEST(TestOfflineBatchRenderer, TestJobsFromDirectory)
+{
+    std::string data_dir = test_utils::get_data_dir_path();
+    data_dir.pop_back();
+    auto jobs = OfflineBatchRenderer::jobs_from_directory(data_dir, "./out");
+    ASSERT_FALSE(jobs.empty());
+    EXPECT_TRUE(std::is_sorted(jobs.begin(), jobs.end(), [](const auto& lhs, const auto& rhs)
+                                                         {
+                                                             return lhs.input_filename < rhs.input_filename;
+                                                         }));
+    auto job = std::find_if(jobs.begin(), jobs.end(), [&](const auto& j)
+                                                      {
+                                                          return j.input_filename == data_dir + "/test_sndfile_05.wav";
+                                                      });
+    ASSERT_NE(jobs.end(), job);
+    EXPECT_EQ("./out/test_sndfile_05.wav", job->output_filename);
+
+    EXPECT_TRUE(OfflineBatchRenderer::jobs_from_directory("./no_such_dir", "./out").empty());
+
+    /* Rendering into the input directory would overwrite the input files */
+    EXPECT_TRUE(OfflineBatchRenderer::jobs_from_directory(data_dir, data_dir + "/.").empty());
+}
+
+TEST(TestOfflineBatchRenderer, TestRender)
+{
+    std::string data_dir = test_utils::get_data_dir_path();
+    OfflineBatchConfiguration config;
+    config.config_filename = data_dir + "config.json";
+    config.sample_rate = TEST_SAMPLE_RATE;
+    config.concurrent_jobs = 2;
+    OfflineBatchRenderer module_under_test(config);
+    ASSERT_EQ(jsonconfig::JsonConfigReturnStatus::OK, module_under_test.init());
+
+    std::string input_file = data_dir + "test_sndfile_05.wav";
+    std::vector<OfflineRenderJob> jobs = {{input_file, "./batch_out_0.wav"},
+                                          {input_file, "./batch_out_1.wav"},
+                                          {input_file, "./batch_out_2.wav"},
+                                          {data_dir + "no_such_file.wav", "./batch_out_3.wav"}};
+    EXPECT_EQ(1, module_under_test.render(jobs));
+
+    auto input_frames = file_frames(input_file);
+    ASSERT_GT(input_frames, 0);
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(input_frames, file_frames(jobs[i].output_filename));
+    }
+    EXPECT_EQ(-1, file_frames(jobs[3].output_filename));
+}
+
+TEST(TestOfflineBatchRenderer, TestInvalidConfig)
+{
+    OfflineBatchConfiguration config;
+    config.config_filename = "./no_such_config.json";
+    config.sample_rate = TEST_SAMPLE_RATE;
+    OfflineBatchRenderer module_under_test(config);
+    EXPECT_EQ(jsonconfig::JsonConfigReturnStatus::INVALID_FILE, module_under_test.init());
+}
@@ -14,7 +14,7 @@ using namespace sushi;
 using namespace sushi::audio_frontend;
 using namespace sushi::midi_dispatcher;
 
-constexpr float SAMPLE_RATE = 44000;
+constexpr float SAMPLE_RATE = 48000;
 constexpr int CV_CHANNELS = 0;
 
 class TestOfflineFrontend : public ::testing::Test
@@ -84,6 +84,96 @@ TEST_F(TestOfflineFrontend, TestWavProcessing)
     sf_close(output_file);
 }
 
+TEST_F(TestOfflineFrontend, TestSampleRateConversion)
+{
+    // Run the engine at a different rate than the file, and write the output at a third rate
+    constexpr float ENGINE_SAMPLE_RATE = 44100;
+    constexpr int OUTPUT_SAMPLE_RATE = 96000;
+    EngineMockup engine(ENGINE_SAMPLE_RATE);
+    OfflineFrontend module_under_test(&engine);
+
+    std::string test_data_file(test_utils::get_data_dir_path());
+    test_data_file.append("test_sndfile_05.wav");
+    std::string output_file_name("./test_out_resampled.wav");
+    OfflineFrontendConfiguration config(test_data_file, output_file_name, false, CV_CHANNELS, CV_CHANNELS, OUTPUT_SAMPLE_RATE);
+    auto ret_code = module_under_test.init(&config);
+    ASSERT_EQ(AudioFrontendStatus::OK, ret_code);
+    EXPECT_EQ(2u, module_under_test._input_resamplers.size());
+    EXPECT_EQ(2u, module_under_test._output_resamplers.size());
+    auto input_frames = module_under_test._soundfile_info.frames;
+    int input_rate = module_under_test._soundfile_info.samplerate;
+    module_under_test.run();
+    module_under_test.cleanup();
+
+    SF_INFO soundfile_info = {};
+    SNDFILE* output_file = sf_open(output_file_name.c_str(), SFM_READ, &soundfile_info);
+    ASSERT_NE(nullptr, output_file);
+    EXPECT_EQ(OUTPUT_SAMPLE_RATE, soundfile_info.samplerate);
+    ASSERT_EQ(std::llround(static_cast<double>(input_frames) * OUTPUT_SAMPLE_RATE / input_rate), soundfile_info.frames);
+
+    // The constant 0.5 should come through, except close to the start and end where the filters ring
+    std::vector<float> file_buffer(soundfile_info.frames * soundfile_info.channels);
+    ASSERT_EQ(soundfile_info.frames, sf_readf_float(output_file, file_buffer.data(), soundfile_info.frames));
+    sf_close(output_file);
+    int margin = 2 * OUTPUT_SAMPLE_RATE / input_rate * dsp::RESAMPLER_TAPS;
+    for (int n = margin * soundfile_info.channels; n < (soundfile_info.frames - margin) * soundfile_info.channels; ++n)
+    {
+        ASSERT_NEAR(0.5f, file_buffer[n], 0.01f) << "sample " << n;
+    }
+}
+
+TEST_F(TestOfflineFrontend, TestUnsupportedSampleRate)
+{
+    // Converting to a rate with no large common divisor would need a huge filter
+    std::string test_data_file(test_utils::get_data_dir_path());
+    test_data_file.append("test_sndfile_05.wav");
+    OfflineFrontendConfiguration config(test_data_file, "./test_out.wav", false, CV_CHANNELS, CV_CHANNELS, 48001);
+    ASSERT_EQ(AudioFrontendStatus::INVALID_SAMPLE_RATE, _module_under_test->init(&config));
+    EXPECT_TRUE(_module_under_test->_output_resamplers.empty());
+}
+
+TEST_F(TestOfflineFrontend, TestMultichannelProcessing)
+{
+    // Write a file with a different constant on each channel, long enough to span several blocks
+    constexpr int CHANNELS = 6;
+    constexpr int FRAMES = 2 * OFFLINE_IO_BLOCK_SIZE + 100;
+    std::string input_file_name("./test_multichannel.wav");
+    std::string output_file_name("./test_multichannel_out.wav");
+    SF_INFO soundfile_info = {};
+    soundfile_info.samplerate = static_cast<int>(SAMPLE_RATE);
+    soundfile_info.channels = CHANNELS;
+    soundfile_info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    SNDFILE* file = sf_open(input_file_name.c_str(), SFM_WRITE, &soundfile_info);
+    ASSERT_NE(nullptr, file);
+    std::vector<float> file_buffer(FRAMES * CHANNELS);
+    for (int i = 0; i < FRAMES * CHANNELS; ++i)
+    {
+        file_buffer[i] = 0.1f * (i % CHANNELS + 1);
+    }
+    ASSERT_EQ(FRAMES, sf_writef_float(file, file_buffer.data(), FRAMES));
+    sf_close(file);
+
+    // Let the engine process whole blocks, the output should be the same
+    OfflineFrontendConfiguration config(input_file_name, output_file_name, false, CV_CHANNELS, CV_CHANNELS, 0, true);
+    ASSERT_EQ(AudioFrontendStatus::OK, _module_under_test->init(&config));
+    EXPECT_EQ(CHANNELS, _module_under_test->_buffer.channel_count());
+    _module_under_test->run();
+    _module_under_test->cleanup();
+
+    soundfile_info = {};
+    file = sf_open(output_file_name.c_str(), SFM_READ, &soundfile_info);
+    ASSERT_NE(nullptr, file);
+    ASSERT_EQ(CHANNELS, soundfile_info.channels);
+    ASSERT_EQ(FRAMES, soundfile_info.frames);
+    std::fill(file_buffer.begin(), file_buffer.end(), 0.0f);
+    ASSERT_EQ(FRAMES, sf_readf_float(file, file_buffer.data(), FRAMES));
+    sf_close(file);
+    for (int i = 0; i < FRAMES * CHANNELS; ++i)
+    {
+        ASSERT_FLOAT_EQ(0.1f * (i % CHANNELS + 1), file_buffer[i]) << "sample " << i;
+    }
+}
+
 TEST_F(TestOfflineFrontend, TestInvalidInputFile)
 {
     OfflineFrontendConfiguration config("this_is_not_a_valid_file.extension", "./test_out.wav", false, CV_CHANNELS, CV_CHANNELS);
@@ -160,6 +250,71 @@ TEST_F(TestOfflineFrontend, TestNoiseGeneration)
     ASSERT_NEAR(INPUT_NOISE_LEVEL, rms, 0.002f);
 }
 
+TEST_F(TestOfflineFrontend, TestBenchmarkSignals)
+{
+    ChunkSampleBuffer buffer(2);
+    engine::ControlBuffer controls;
+    const int CHUNKS = static_cast<int>(SAMPLE_RATE) / AUDIO_CHUNK_SIZE + 1;
+
+    /* Impulses on both channels at the start of every second */
+    BenchmarkSignalGenerator impulses(BenchmarkSignal::IMPULSE, SAMPLE_RATE);
+    int impulse_count = 0;
+    for (int chunk = 0; chunk < CHUNKS; ++chunk)
+    {
+        impulses.fill(buffer, controls);
+        for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+        {
+            int64_t sample = chunk * AUDIO_CHUNK_SIZE + i;
+            float expected = sample % static_cast<int64_t>(SAMPLE_RATE) == 0 ? 1.0f : 0.0f;
+            ASSERT_FLOAT_EQ(expected, buffer.channel(0)[i]) << "sample " << sample;
+            ASSERT_FLOAT_EQ(expected, buffer.channel(1)[i]);
+            impulse_count += buffer.channel(0)[i] > 0.0f;
+        }
+    }
+    EXPECT_EQ(2, impulse_count);
+
+    /* The sweep should stay within its level and be identical on every run */
+    BenchmarkSignalGenerator sweep(BenchmarkSignal::SWEEP, SAMPLE_RATE);
+    BenchmarkSignalGenerator sweep_copy(BenchmarkSignal::SWEEP, SAMPLE_RATE);
+    ChunkSampleBuffer copy(2);
+    float peak = 0.0f;
+    for (int chunk = 0; chunk < CHUNKS; ++chunk)
+    {
+        sweep.fill(buffer, controls);
+        sweep_copy.fill(copy, controls);
+        for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+        {
+            ASSERT_FLOAT_EQ(buffer.channel(0)[i], copy.channel(0)[i]);
+            ASSERT_FLOAT_EQ(buffer.channel(0)[i], buffer.channel(1)[i]);
+            peak = std::max(peak, std::abs(buffer.channel(0)[i]));
+        }
+    }
+    EXPECT_LE(peak, BENCHMARK_SIGNAL_LEVEL);
+    EXPECT_GT(peak, 0.9f * BENCHMARK_SIGNAL_LEVEL);
+
+    BenchmarkSignalGenerator silence(BenchmarkSignal::SILENCE, SAMPLE_RATE);
+    silence.fill(buffer, controls);
+    test_utils::assert_buffer_value(0.0f, buffer);
+}
+
+TEST_F(TestOfflineFrontend, TestBenchmark)
+{
+    OfflineFrontendConfiguration config("", "", true, CV_CHANNELS, CV_CHANNELS);
+    config.benchmark.chunks = 200;
+    config.benchmark.warmup_chunks = 20;
+    config.benchmark.signal = BenchmarkSignal::SWEEP;
+    auto ret_code = _module_under_test->init(&config);
+    ASSERT_EQ(AudioFrontendStatus::OK, ret_code);
+
+    /* Returns when the benchmark is done */
+    _module_under_test->run();
+    auto& result = _module_under_test->benchmark_result();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(200, result->chunks);
+    EXPECT_GT(result->seconds, 0.0);
+    EXPECT_FLOAT_EQ(SAMPLE_RATE, result->sample_rate);
+}
+
 TEST(TestAudioFrontendInternals, TestRampCvOutput)
 {
     float data_buffer[AUDIO_CHUNK_SIZE];
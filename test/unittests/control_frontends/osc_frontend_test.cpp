@@ -225,6 +225,115 @@ TEST_F(TestOSCFrontend, TestSetSyncMode)
     EXPECT_EQ(SyncMode::MIDI_SLAVE, rt_event.sync_mode_event()->mode());
 }
 
+TEST_F(TestOSCFrontend, TestBundleTimetag)
+{
+    ASSERT_TRUE(_module_under_test.connect_to_parameter("sampler", "volume"));
+    lo_timetag timetag;
+    lo_timetag_now(&timetag);
+    timetag.sec += 1;
+    lo_bundle bundle = lo_bundle_new(timetag);
+    lo_message message = lo_message_new();
+    lo_message_add_float(message, 3.0f);
+    lo_bundle_add_message(bundle, "/parameter/sampler/volume", message);
+    lo_send_bundle(_address, bundle);
+    lo_bundle_free_recursive(bundle);
+
+    /* The event should be passed on immediately, but scheduled 1 second ahead */
+    auto event = wait_for_event();
+    ASSERT_NE(nullptr, event);
+    EXPECT_TRUE(event->is_parameter_change_event());
+    EXPECT_EQ(3.0f, static_cast<ParameterChangeEvent*>(event.get())->float_value());
+    EXPECT_GT(event->time(), get_current_time() + std::chrono::milliseconds(500));
+
+    /* Messages sent outside of a bundle are processed immediately */
+    lo_send(_address, "/parameter/sampler/volume", "f", 4.0f);
+    event = wait_for_event();
+    ASSERT_NE(nullptr, event);
+    EXPECT_EQ(IMMEDIATE_PROCESS, event->time());
+
+    /* And so are bundles too far in the future to be scheduled */
+    timetag.sec += 3600;
+    bundle = lo_bundle_new(timetag);
+    message = lo_message_new();
+    lo_message_add_float(message, 5.0f);
+    lo_bundle_add_message(bundle, "/parameter/sampler/volume", message);
+    lo_send_bundle(_address, bundle);
+    lo_bundle_free_recursive(bundle);
+    event = wait_for_event();
+    ASSERT_NE(nullptr, event);
+    EXPECT_EQ(5.0f, static_cast<ParameterChangeEvent*>(event.get())->float_value());
+    EXPECT_EQ(IMMEDIATE_PROCESS, event->time());
+}
+
+TEST_F(TestOSCFrontend, TestDispatchFromPathTable)
+{
+    ASSERT_TRUE(_module_under_test.connect_to_parameter("sampler", "volume"));
+    lo_message message = lo_message_new();
+    lo_arg arg;
+    arg.i = 2;
+    lo_arg* argv[] = {&arg};
+
+    /* Int arguments are converted to float, as liblo would have done */
+    EXPECT_EQ(0, OSCFrontend::_dispatch_message("/parameter/sampler/volume", "i", argv, 1, message, &_module_under_test));
+    auto event = wait_for_event();
+    ASSERT_NE(nullptr, event);
+    EXPECT_FLOAT_EQ(2.0f, static_cast<ParameterChangeEvent*>(event.get())->float_value());
+
+    /* Unknown paths and arguments are passed on to other methods */
+    EXPECT_EQ(1, OSCFrontend::_dispatch_message("/parameter/sampler/attack", "i", argv, 1, message, &_module_under_test));
+    EXPECT_EQ(1, OSCFrontend::_dispatch_message("/parameter/sampler/volume", "ii", argv, 2, message, &_module_under_test));
+
+    /* Connections are removed when the processor is deleted */
+    AudioGraphNotificationEvent deleted(AudioGraphNotificationEvent::Action::PROCESSOR_DELETED, 0, 0, IMMEDIATE_PROCESS);
+    _module_under_test.process(&deleted);
+    EXPECT_EQ(1, OSCFrontend::_dispatch_message("/parameter/sampler/volume", "i", argv, 1, message, &_module_under_test));
+    EXPECT_FALSE(_test_dispatcher->got_event());
+    lo_message_free(message);
+}
+
+static int receive_float(const char* /*path*/, const char* /*types*/, lo_arg** argv, int /*argc*/,
+                         void* /*data*/, void* user_data)
+{
+    static_cast<std::vector<float>*>(user_data)->push_back(argv[0]->f);
+    return 0;
+}
+
+TEST_F(TestOSCFrontend, TestCoalescedOutput)
+{
+    std::vector<float> received;
+    lo_server receiver = lo_server_new(std::to_string(OSC_TEST_SEND_PORT).c_str(), nullptr);
+    ASSERT_NE(nullptr, receiver);
+    lo_server_add_method(receiver, "/parameter/sampler/volume", "f", receive_float, &received);
+    ASSERT_TRUE(_module_under_test.connect_from_parameter("sampler", "volume"));
+
+    /* Several changes in one cycle are sent as the latest value only */
+    for (float value : {0.2f, 0.4f, 0.6f})
+    {
+        ParameterChangeNotificationEvent event(ParameterChangeNotificationEvent::Subtype::FLOAT_PARAMETER_CHANGE_NOT,
+                                               0, 0, value, IMMEDIATE_PROCESS);
+        _module_under_test.process(&event);
+    }
+    _module_under_test.notification_cycle_done();
+    while (lo_server_recv_noblock(receiver, 100) > 0) {}
+    ASSERT_EQ(1u, received.size());
+    EXPECT_FLOAT_EQ(0.6f, received[0]);
+
+    /* A change right after is held back by the rate limit until a later cycle */
+    ParameterChangeNotificationEvent event(ParameterChangeNotificationEvent::Subtype::FLOAT_PARAMETER_CHANGE_NOT,
+                                           0, 0, 0.8f, IMMEDIATE_PROCESS);
+    _module_under_test.process(&event);
+    _module_under_test.notification_cycle_done();
+    EXPECT_EQ(0, lo_server_recv_noblock(receiver, 5));
+    EXPECT_EQ(1u, _module_under_test._pending_outputs.size());
+
+    std::this_thread::sleep_for(std::chrono::duration<float>(1.0f / DEFAULT_OSC_MAX_OUTPUT_RATE));
+    _module_under_test.notification_cycle_done();
+    while (lo_server_recv_noblock(receiver, 100) > 0) {}
+    ASSERT_EQ(2u, received.size());
+    EXPECT_FLOAT_EQ(0.8f, received[1]);
+    lo_server_free(receiver);
+}
+
 TEST(TestOSCFrontendInternal, TestMakeSafePath)
 {
     EXPECT_EQ("s_p_a_c_e_", make_safe_path("s p a c e "));
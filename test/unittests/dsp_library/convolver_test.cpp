@@ -0,0 +1,99 @@
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#define private public
+
+#include "dsp_library/fft.cpp"
+#include "dsp_library/convolver.cpp"
+
+using namespace dsp;
+
+constexpr int TEST_FFT_SIZE = 32;
+constexpr int TEST_BLOCK_SIZE = 16;
+constexpr int TEST_IR_LENGTH = 70;
+
+/* Deterministic test signal without any periodicity that could hide errors */
+std::vector<float> make_test_signal(int length, float seed)
+{
+    std::vector<float> signal(length);
+    for (int i = 0; i < length; ++i)
+    {
+        signal[i] = std::sin(seed * (i + 1) * (i + 3));
+    }
+    return signal;
+}
+
+TEST(TestRealFft, TestForward)
+{
+    RealFft module_under_test(TEST_FFT_SIZE);
+    ASSERT_EQ(TEST_FFT_SIZE / 2 + 1, module_under_test.bins());
+    auto signal = make_test_signal(TEST_FFT_SIZE, 0.37f);
+    std::vector<float> real(module_under_test.bins());
+    std::vector<float> imag(module_under_test.bins());
+    module_under_test.forward(signal.data(), real.data(), imag.data());
+
+    /* Compare with a direct dft */
+    for (int k = 0; k < module_under_test.bins(); ++k)
+    {
+        double expected_real = 0;
+        double expected_imag = 0;
+        for (int n = 0; n < TEST_FFT_SIZE; ++n)
+        {
+            double angle = 2.0 * M_PI * k * n / TEST_FFT_SIZE;
+            expected_real += signal[n] * std::cos(angle);
+            expected_imag -= signal[n] * std::sin(angle);
+        }
+        EXPECT_NEAR(expected_real, real[k], 1.0e-4);
+        EXPECT_NEAR(expected_imag, imag[k], 1.0e-4);
+    }
+}
+
+TEST(TestRealFft, TestInverse)
+{
+    RealFft module_under_test(TEST_FFT_SIZE);
+    auto signal = make_test_signal(TEST_FFT_SIZE, 0.11f);
+    std::vector<float> real(module_under_test.bins());
+    std::vector<float> imag(module_under_test.bins());
+    std::vector<float> output(TEST_FFT_SIZE);
+    module_under_test.forward(signal.data(), real.data(), imag.data());
+    module_under_test.inverse(real.data(), imag.data(), output.data());
+    for (int i = 0; i < TEST_FFT_SIZE; ++i)
+    {
+        EXPECT_NEAR(signal[i], output[i] / TEST_FFT_SIZE, 1.0e-5);
+    }
+}
+
+TEST(TestUniformConvolver, TestConvolution)
+{
+    auto ir = make_test_signal(TEST_IR_LENGTH, 0.23f);
+    auto input = make_test_signal(TEST_BLOCK_SIZE * 10, 0.71f);
+    UniformConvolver module_under_test(TEST_BLOCK_SIZE, ir.data(), TEST_IR_LENGTH);
+    ASSERT_EQ(5, module_under_test._partitions);
+
+    std::vector<float> output(input.size());
+    for (size_t i = 0; i < input.size(); i += TEST_BLOCK_SIZE)
+    {
+        module_under_test.process(&input[i], &output[i]);
+    }
+    for (int n = 0; n < static_cast<int>(input.size()); ++n)
+    {
+        float expected = 0;
+        for (int k = 0; k < TEST_IR_LENGTH && k <= n; ++k)
+        {
+            expected += ir[k] * input[n - k];
+        }
+        ASSERT_NEAR(expected, output[n], 1.0e-4);
+    }
+
+    /* After a reset the output should not depend on earlier input */
+    module_under_test.reset();
+    std::vector<float> impulse(TEST_BLOCK_SIZE, 0.0f);
+    impulse[0] = 1.0f;
+    module_under_test.process(impulse.data(), output.data());
+    for (int i = 0; i < TEST_BLOCK_SIZE; ++i)
+    {
+        ASSERT_NEAR(ir[i], output[i], 1.0e-5);
+    }
+}
@@ -66,3 +66,60 @@ TEST_F(TestADSREnvelope, TestParameterLimits)
     EXPECT_FLOAT_EQ(0.0f, level);
     EXPECT_FLOAT_EQ(0.0f, _module_under_test.level());
 }
+
+TEST_F(TestADSREnvelope, TestBlockRendering)
+{
+    constexpr int BLOCK_SIZE = 64;
+    float block[BLOCK_SIZE];
+    AdsrEnvelope reference;
+    reference.set_samplerate(100);
+    reference.set_parameters(0.375f, 0.535f, 0.5f, 0.715f);
+    _module_under_test.set_parameters(0.375f, 0.535f, 0.5f, 0.715f);
+
+    /* Rendering in blocks should give the same result as ticking the envelope
+     * one sample at a time, including state changes in the middle of blocks */
+    _module_under_test.gate(true);
+    reference.gate(true);
+    for (int b = 0; b < 4; ++b)
+    {
+        _module_under_test.render(block, BLOCK_SIZE);
+        for (float value : block)
+        {
+            ASSERT_NEAR(reference.tick(1), value, 1.0e-5f);
+        }
+    }
+    EXPECT_FLOAT_EQ(0.5f, _module_under_test.level());
+
+    _module_under_test.gate(false);
+    reference.gate(false);
+    for (int b = 0; b < 2; ++b)
+    {
+        _module_under_test.render(block, BLOCK_SIZE - b * 13);
+        for (int i = 0; i < BLOCK_SIZE - b * 13; ++i)
+        {
+            ASSERT_NEAR(reference.tick(1), block[i], 1.0e-5f);
+        }
+    }
+    EXPECT_TRUE(_module_under_test.finished());
+    EXPECT_TRUE(reference.finished());
+
+    /* Release in the middle of the attack phase */
+    _module_under_test.gate(true);
+    reference.gate(true);
+    _module_under_test.render(block, 10);
+    for (int i = 0; i < 10; ++i)
+    {
+        ASSERT_NEAR(reference.tick(1), block[i], 1.0e-5f);
+    }
+    _module_under_test.gate(false);
+    reference.gate(false);
+    for (int b = 0; b < 2; ++b)
+    {
+        _module_under_test.render(block, BLOCK_SIZE);
+        for (float value : block)
+        {
+            ASSERT_NEAR(reference.tick(1), value, 1.0e-5f);
+        }
+    }
+    EXPECT_TRUE(_module_under_test.finished());
+}
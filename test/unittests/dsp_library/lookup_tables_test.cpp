@@ -0,0 +1,32 @@
+#include "gtest/gtest.h"
+
+#include "dsp_library/lookup_tables.h"
+
+using namespace dsp;
+
+TEST(TestLookupTables, TestExp2)
+{
+    EXPECT_EQ(1.0f, lookup::exp2(0.0f));
+    EXPECT_EQ(8.0f, lookup::exp2(3.0f));
+    EXPECT_EQ(0.25f, lookup::exp2(-2.0f));
+
+    for (float x = -20.0f; x < 20.0f; x += 0.0173f)
+    {
+        float exact = std::exp2(x);
+        ASSERT_NEAR(exact, lookup::exp2(x), exact * 2.0e-6f);
+    }
+    // Arguments that round up to the end of the table range
+    EXPECT_NEAR(1.0f, lookup::exp2(-1.0e-9f), 1.0e-6f);
+}
+
+TEST(TestLookupTables, TestLog2)
+{
+    EXPECT_EQ(0.0f, lookup::log2(1.0f));
+    EXPECT_EQ(3.0f, lookup::log2(8.0f));
+    EXPECT_EQ(-2.0f, lookup::log2(0.25f));
+
+    for (float x = 1.0e-7f; x < 1.0e5f; x *= 1.0371f)
+    {
+        ASSERT_NEAR(std::log2(x), lookup::log2(x), 1.0e-5f);
+    }
+}
@@ -0,0 +1,123 @@
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#define private public
+
+#include "dsp_library/resampler.cpp"
+
+using namespace dsp;
+
+constexpr int TEST_BLOCK_SIZE = 64;
+constexpr int TEST_LENGTH = TEST_BLOCK_SIZE * 100;
+
+/* Resample a sine wave in blocks, followed by zeros to flush the filter */
+std::vector<float> resample_sine(PolyphaseResampler& resampler, float frequency, int input_rate)
+{
+    std::vector<float> input(TEST_BLOCK_SIZE);
+    std::vector<float> output;
+    std::vector<float> block(resampler.max_output_samples(TEST_BLOCK_SIZE));
+    for (int n = 0; n < TEST_LENGTH + RESAMPLER_TAPS; n += TEST_BLOCK_SIZE)
+    {
+        for (int i = 0; i < TEST_BLOCK_SIZE; ++i)
+        {
+            input[i] = n + i < TEST_LENGTH ? std::sin(2.0 * M_PI * frequency * (n + i) / input_rate) : 0.0f;
+        }
+        int count = resampler.process(input.data(), TEST_BLOCK_SIZE, block.data());
+        EXPECT_LE(count, resampler.max_output_samples(TEST_BLOCK_SIZE));
+        output.insert(output.end(), block.begin(), block.begin() + count);
+    }
+    return output;
+}
+
+TEST(TestPolyphaseResampler, TestRatio)
+{
+    PolyphaseResampler module_under_test(44100, 48000);
+    EXPECT_EQ(160, module_under_test._up);
+    EXPECT_EQ(147, module_under_test._down);
+
+    /* Every 147 input samples should give 160 output samples, except at the
+     * start where the output is delayed by half the filter length */
+    std::vector<float> input(147, 0.0f);
+    std::vector<float> output(module_under_test.max_output_samples(147));
+    int first = module_under_test.process(input.data(), 147, output.data());
+    EXPECT_NEAR(160 - RESAMPLER_TAPS / 2 * 160 / 147, first, 1);
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_EQ(160, module_under_test.process(input.data(), 147, output.data()));
+    }
+}
+
+TEST(TestPolyphaseResampler, TestUpsampledSine)
+{
+    constexpr float FREQUENCY = 1000;
+    PolyphaseResampler module_under_test(32000, 48000);
+    auto output = resample_sine(module_under_test, FREQUENCY, 32000);
+    ASSERT_GE(output.size(), TEST_LENGTH * 3u / 2u);
+
+    /* The output should be the same sine at the new rate, also in phase as the
+     * delay of the filter is compensated for. Skip the start and the end
+     * where the filter sees the edges of the signal */
+    for (int n = RESAMPLER_TAPS * 2; n < TEST_LENGTH * 3 / 2 - RESAMPLER_TAPS * 2; ++n)
+    {
+        float expected = std::sin(2.0 * M_PI * FREQUENCY * n / 48000);
+        ASSERT_NEAR(expected, output[n], 1.0e-3f) << "sample " << n;
+    }
+}
+
+TEST(TestPolyphaseResampler, TestDownsampledSine)
+{
+    constexpr float FREQUENCY = 1000;
+    constexpr float ALIASING_FREQUENCY = 40000;
+    PolyphaseResampler module_under_test(96000, 44100);
+    auto output = resample_sine(module_under_test, FREQUENCY, 96000);
+    for (int n = RESAMPLER_TAPS * 2; n < TEST_LENGTH * 441 / 960 - RESAMPLER_TAPS * 2; ++n)
+    {
+        float expected = std::sin(2.0 * M_PI * FREQUENCY * n / 44100);
+        ASSERT_NEAR(expected, output[n], 1.0e-3f) << "sample " << n;
+    }
+
+    /* Frequencies above the new nyquist frequency should be filtered out */
+    module_under_test.reset();
+    output = resample_sine(module_under_test, ALIASING_FREQUENCY, 96000);
+    for (int n = RESAMPLER_TAPS * 2; n < TEST_LENGTH * 441 / 960 - RESAMPLER_TAPS * 2; ++n)
+    {
+        ASSERT_NEAR(0.0f, output[n], 1.0e-3f) << "sample " << n;
+    }
+}
+
+TEST(TestPolyphaseResampler, TestStopband)
+{
+    /* Just above the new nyquist frequency, the filter should already be in its stopband */
+    constexpr float ALIASING_FREQUENCY = 23000;
+    PolyphaseResampler module_under_test(48000, 44100);
+    auto output = resample_sine(module_under_test, ALIASING_FREQUENCY, 48000);
+    for (int n = RESAMPLER_TAPS * 2; n < TEST_LENGTH * 147 / 160 - RESAMPLER_TAPS * 2; ++n)
+    {
+        ASSERT_NEAR(0.0f, output[n], 1.0e-3f) << "sample " << n;
+    }
+}
+
+TEST(TestPolyphaseResampler, TestSameRate)
+{
+    PolyphaseResampler module_under_test(48000, 48000);
+    EXPECT_EQ(1, module_under_test._up);
+    EXPECT_EQ(1, module_under_test._down);
+    auto output = resample_sine(module_under_test, 1000, 48000);
+    for (int n = RESAMPLER_TAPS; n < TEST_LENGTH - RESAMPLER_TAPS; ++n)
+    {
+        float expected = std::sin(2.0 * M_PI * 1000 * n / 48000);
+        ASSERT_NEAR(expected, output[n], 1.0e-3f) << "sample " << n;
+    }
+}
+
+TEST(TestPolyphaseResampler, TestSupported)
+{
+    EXPECT_TRUE(PolyphaseResampler::supported(44100, 48000));
+    EXPECT_TRUE(PolyphaseResampler::supported(11025, 48000));
+    EXPECT_TRUE(PolyphaseResampler::supported(48000, 8000));
+    // Coprime rates would need one filter phase per output sample in a second
+    EXPECT_FALSE(PolyphaseResampler::supported(44101, 48000));
+    EXPECT_FALSE(PolyphaseResampler::supported(0, 48000));
+}
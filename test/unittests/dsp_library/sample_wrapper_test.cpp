@@ -26,3 +26,33 @@ TEST_F(TestSampleWrapper, TestSampleInterpolation)
     // Get interpolated values
     EXPECT_FLOAT_EQ(1.5f, _module_under_test.at(2.5f));
 }
+
+TEST_F(TestSampleWrapper, TestCubicInterpolation)
+{
+    // Cubic interpolation should pass through the sample points
+    EXPECT_FLOAT_EQ(1.0f, _module_under_test.cubic_at(0.0f));
+    EXPECT_FLOAT_EQ(2.0f, _module_under_test.cubic_at(2.0f));
+    EXPECT_FLOAT_EQ(2.125f, _module_under_test.cubic_at(1.5f));
+    // And return 0 outside of the sample data
+    EXPECT_FLOAT_EQ(0.0f, _module_under_test.cubic_at(6.0f));
+}
+
+TEST_F(TestSampleWrapper, TestBlockRendering)
+{
+    constexpr int SAMPLES = 20;
+    float gain[SAMPLES];
+    std::fill(gain, gain + SAMPLES, 0.5f);
+    for (auto mode : {InterpolationMode::LINEAR, InterpolationMode::CUBIC})
+    {
+        float output[SAMPLES] = {};
+        double speed = 0.3;
+        double position = _module_under_test.render(output, gain, 0.0, speed, SAMPLES, mode);
+        EXPECT_DOUBLE_EQ(SAMPLES * speed, position);
+        for (int i = 0; i < SAMPLES; ++i)
+        {
+            float expected = mode == InterpolationMode::CUBIC ? _module_under_test.cubic_at(i * speed) :
+                                                                _module_under_test.at(i * speed);
+            EXPECT_NEAR(0.5f * expected, output[i], 1.0e-6f);
+        }
+    }
+}
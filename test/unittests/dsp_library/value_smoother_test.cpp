@@ -62,4 +62,46 @@ TEST_F(ValueSmootherTest, TestExpFloat)
     }
     EXPECT_TRUE(_module_under_test_filter.stationary());
     EXPECT_NEAR(TEST_TARGET_VALUE, _module_under_test_filter.value(), 0.001);
-}
\ No newline at end of file
+}
+
+TEST_F(ValueSmootherTest, TestBlockProcessing)
+{
+    constexpr int BLOCK_SIZE = 4;
+    float block[BLOCK_SIZE];
+    ValueSmootherRamp<float> ramp_reference;
+    ValueSmootherFilter<float> filter_reference;
+    ramp_reference.set_lag_time(std::chrono::milliseconds(5), TEST_SAMPLE_RATE);
+    filter_reference.set_lag_time(std::chrono::milliseconds(5), TEST_SAMPLE_RATE);
+
+    /* Block processing should produce the same values as calling next_value() repeatedly,
+     * also when the ramp ends in the middle of a block */
+    _module_under_test_ramp.set(TEST_TARGET_VALUE);
+    ramp_reference.set(TEST_TARGET_VALUE);
+    for (int b = 0; b < 3; ++b)
+    {
+        _module_under_test_ramp.next_values(block, BLOCK_SIZE);
+        for (float value : block)
+        {
+            ASSERT_FLOAT_EQ(ramp_reference.next_value(), value);
+        }
+    }
+    EXPECT_TRUE(_module_under_test_ramp.stationary());
+    EXPECT_FLOAT_EQ(TEST_TARGET_VALUE, _module_under_test_ramp.value());
+
+    _module_under_test_filter.set(TEST_TARGET_VALUE);
+    filter_reference.set(TEST_TARGET_VALUE);
+    for (int b = 0; b < 3; ++b)
+    {
+        _module_under_test_filter.next_values(block, BLOCK_SIZE - 1);
+        for (int i = 0; i < BLOCK_SIZE - 1; ++i)
+        {
+            ASSERT_NEAR(filter_reference.next_value(), block[i], 1.0e-6);
+        }
+        _module_under_test_filter.next_values(block, BLOCK_SIZE);
+        for (float value : block)
+        {
+            ASSERT_NEAR(filter_reference.next_value(), value, 1.0e-6);
+        }
+    }
+    EXPECT_NEAR(filter_reference.value(), _module_under_test_filter.value(), 1.0e-6);
+}
@@ -238,4 +238,186 @@ TEST_F(ControllerTest, TestParameterControls)
     auto [str_value_status, str_value] = _module_under_test->get_parameter_value_as_string(proc_id, id);
     ASSERT_EQ(ext::ControlStatus::OK, str_value_status);
     EXPECT_EQ("1000.000000", str_value);
-}
\ No newline at end of file
+}
+class DummyControlListener : public ext::ControlListener
+{
+public:
+    void notification(const ext::ControlNotification* notification) override
+    {
+        _notifications++;
+        _last_type = notification->type();
+        if (notification->type() == ext::NotificationType::PARAMETER_CHANGE)
+        {
+            _last_value = static_cast<const ext::ParameterChangeNotification*>(notification)->value();
+        }
+    }
+
+    int _notifications{0};
+    ext::NotificationType _last_type{ext::NotificationType::CLIPPING};
+    float _last_value{0};
+};
+
+TEST_F(ControllerTest, TestNotifications)
+{
+    DummyControlListener listener;
+    /* The engine's Controller is a sushi::Controller, which also receives events from the dispatcher */
+    auto controller = static_cast<Controller*>(_module_under_test);
+    ASSERT_EQ(ext::ControlStatus::OK, controller->subscribe_to_notifications(ext::NotificationType::PARAMETER_CHANGE, &listener));
+    ASSERT_EQ(ext::ControlStatus::OK, controller->subscribe_to_notifications(ext::NotificationType::TRACK_UPDATE, &listener));
+
+    ParameterChangeNotificationEvent param_event(ParameterChangeNotificationEvent::Subtype::FLOAT_PARAMETER_CHANGE_NOT,
+                                                 1, 2, 0.75f, IMMEDIATE_PROCESS);
+    EXPECT_EQ(EventStatus::HANDLED_OK, controller->process(&param_event));
+    EXPECT_EQ(1, listener._notifications);
+    EXPECT_EQ(ext::NotificationType::PARAMETER_CHANGE, listener._last_type);
+    EXPECT_FLOAT_EQ(0.75f, listener._last_value);
+
+    AudioGraphNotificationEvent track_event(AudioGraphNotificationEvent::Action::TRACK_ADDED, 5, 5, IMMEDIATE_PROCESS);
+    EXPECT_EQ(EventStatus::HANDLED_OK, controller->process(&track_event));
+    EXPECT_EQ(2, listener._notifications);
+    EXPECT_EQ(ext::NotificationType::TRACK_UPDATE, listener._last_type);
+
+    /* Not subscribed to transport notifications */
+    TransportNotificationEvent tempo_event(130.0f, IMMEDIATE_PROCESS);
+    EXPECT_EQ(EventStatus::HANDLED_OK, controller->process(&tempo_event));
+    EXPECT_EQ(2, listener._notifications);
+
+    EXPECT_EQ(ext::ControlStatus::OK, controller->unsubscribe_from_notifications(ext::NotificationType::PARAMETER_CHANGE, &listener));
+    EXPECT_EQ(ext::ControlStatus::NOT_FOUND, controller->unsubscribe_from_notifications(ext::NotificationType::PARAMETER_CHANGE, &listener));
+    EXPECT_EQ(EventStatus::HANDLED_OK, controller->process(&param_event));
+    EXPECT_EQ(2, listener._notifications);
+    controller->unsubscribe_from_notifications(ext::NotificationType::TRACK_UPDATE, &listener);
+}
+
+TEST_F(ControllerTest, TestEngineSnapshot)
+{
+    auto snapshot = _module_under_test->get_engine_snapshot();
+    EXPECT_FLOAT_EQ(TEST_SAMPLE_RATE, snapshot.samplerate);
+    EXPECT_FLOAT_EQ(100.0f, snapshot.tempo);
+    EXPECT_EQ(ext::PlayingMode::PLAYING, snapshot.playing_mode);
+    ASSERT_EQ(3u, snapshot.tracks.size());
+    EXPECT_EQ("main", snapshot.tracks[0].info.name);
+    EXPECT_FALSE(snapshot.tracks[0].parameters.empty());
+
+    auto [status, proc_id] = _module_under_test->get_processor_id("equalizer_0_l");
+    ASSERT_EQ(ext::ControlStatus::OK, status);
+    auto [param_status, param_id] = _module_under_test->get_parameter_id(proc_id, "frequency");
+    ASSERT_EQ(ext::ControlStatus::OK, param_status);
+
+    bool found = false;
+    for (const auto& track : snapshot.tracks)
+    {
+        for (const auto& processor : track.processors)
+        {
+            if (processor.info.id != proc_id)
+            {
+                continue;
+            }
+            EXPECT_EQ("equalizer_0_l", processor.info.name);
+            ASSERT_EQ(static_cast<size_t>(processor.info.parameter_count), processor.parameters.size());
+            for (const auto& parameter : processor.parameters)
+            {
+                if (parameter.info.id == param_id)
+                {
+                    EXPECT_EQ("frequency", parameter.info.name);
+                    EXPECT_FLOAT_EQ(1000.0f, parameter.value);
+                    found = true;
+                }
+            }
+        }
+    }
+    EXPECT_TRUE(found);
+
+    /* All values of all processors, including the tracks */
+    auto values = _module_under_test->get_all_parameter_values();
+    auto value = std::find_if(values.begin(), values.end(), [&](const auto& v)
+    {
+        return v.processor_id == proc_id && v.parameter_id == param_id;
+    });
+    ASSERT_NE(values.end(), value);
+    EXPECT_FLOAT_EQ(1000.0f, value->value);
+
+    EXPECT_EQ(ext::ControlStatus::OK, _module_under_test->set_parameter_values({{proc_id, param_id, 0.5f}}));
+}
+
+TEST_F(ControllerTest, TestSetParameterValues)
+{
+    auto [eq_status, eq_id] = _module_under_test->get_processor_id("equalizer_0_l");
+    ASSERT_EQ(ext::ControlStatus::OK, eq_status);
+    auto [freq_status, freq_id] = _module_under_test->get_parameter_id(eq_id, "frequency");
+    ASSERT_EQ(ext::ControlStatus::OK, freq_status);
+    auto [first_status, first_id] = _module_under_test->get_processor_id("gain_0_l");
+    ASSERT_EQ(ext::ControlStatus::OK, first_status);
+    auto [last_status, last_id] = _module_under_test->get_processor_id("gain_0_r");
+    ASSERT_EQ(ext::ControlStatus::OK, last_status);
+    auto [gain_status, gain_id] = _module_under_test->get_parameter_id(first_id, "gain");
+    ASSERT_EQ(ext::ControlStatus::OK, gain_status);
+
+    /* Larger than the rt queue, so the last values are sent in a later dispatcher cycle */
+    constexpr int BATCH_SIZE = MAX_EVENTS_IN_QUEUE + 50;
+    std::vector<ext::ParameterValue> values;
+    values.push_back({first_id, gain_id, -6.0f});
+    for (int i = 1; i < BATCH_SIZE - 1; ++i)
+    {
+        values.push_back({eq_id, freq_id, 100.0f + i});
+    }
+    values.push_back({last_id, gain_id, 6.0f});
+    ASSERT_EQ(ext::ControlStatus::OK, _module_under_test->set_parameter_values(values));
+
+    SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(ENGINE_CHANNELS);
+    SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(ENGINE_CHANNELS);
+    ControlBuffer control_buffer;
+    auto last_gain = _engine.processor(last_id);
+    /* The engine's dispatcher is already running, so the values only need to be processed */
+    for (int i = 0; i < 100 && last_gain->parameter_value(gain_id).second != 6.0f; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        _engine.process_chunk(&in_buffer, &out_buffer, &control_buffer, &control_buffer);
+    }
+
+    EXPECT_FLOAT_EQ(-6.0f, _engine.processor(first_id)->parameter_value(gain_id).second);
+    EXPECT_FLOAT_EQ(100.0f + BATCH_SIZE - 2, _engine.processor(eq_id)->parameter_value(freq_id).second);
+    EXPECT_FLOAT_EQ(6.0f, last_gain->parameter_value(gain_id).second);
+}
+
+TEST_F(ControllerTest, TestMirrorFollowsAudioGraph)
+{
+    ASSERT_EQ(3u, _module_under_test->get_tracks().size());
+    ASSERT_EQ(EngineReturnStatus::OK, _engine.create_track("new_track", 2));
+
+    /* The dispatcher isn't running, the mirror is rebuilt from the graph generation alone */
+    auto tracks = _module_under_test->get_tracks();
+    ASSERT_EQ(4u, tracks.size());
+    EXPECT_EQ("new_track", tracks[3].name);
+    auto [status, id] = _module_under_test->get_track_id("new_track");
+    ASSERT_EQ(ext::ControlStatus::OK, status);
+    auto [proc_status, processors] = _module_under_test->get_track_processors(id);
+    ASSERT_EQ(ext::ControlStatus::OK, proc_status);
+    EXPECT_TRUE(processors.empty());
+
+    ASSERT_EQ(EngineReturnStatus::OK, _engine.add_plugin_to_track("new_track", "sushi.testing.gain", "new_gain", "",
+                                                                  PluginType::INTERNAL));
+    EXPECT_EQ(1, _module_under_test->get_track_info(id).second.processor_count);
+    std::tie(proc_status, processors) = _module_under_test->get_track_processors(id);
+    ASSERT_EQ(1u, processors.size());
+    EXPECT_EQ("new_gain", processors[0].name);
+    EXPECT_EQ(ext::ControlStatus::OK, _module_under_test->get_processor_id("new_gain").first);
+}
+
+TEST_F(ControllerTest, TestMirroredParameterValues)
+{
+    auto controller = static_cast<Controller*>(_module_under_test);
+    auto [status, proc_id] = _module_under_test->get_processor_id("equalizer_0_l");
+    ASSERT_EQ(ext::ControlStatus::OK, status);
+    auto [param_status, param_id] = _module_under_test->get_parameter_id(proc_id, "frequency");
+    ASSERT_EQ(ext::ControlStatus::OK, param_status);
+
+    ParameterChangeNotificationEvent event(ParameterChangeNotificationEvent::Subtype::FLOAT_PARAMETER_CHANGE_NOT,
+                                           proc_id, param_id, 2000.0f, IMMEDIATE_PROCESS);
+    EXPECT_EQ(EventStatus::HANDLED_OK, controller->process(&event));
+    EXPECT_FLOAT_EQ(2000.0f, _module_under_test->get_parameter_value(proc_id, param_id).second);
+
+    /* The processor itself still has the old value, which the next refresh reads back */
+    controller->notification_cycle_done();
+    EXPECT_FLOAT_EQ(1000.0f, _module_under_test->get_parameter_value(proc_id, param_id).second);
+}
@@ -160,6 +160,121 @@ TEST_F(TestEngine, TestOutputMixing)
 }
 
 
+TEST_F(TestEngine, TestProcessChunks)
+{
+    constexpr int CHUNKS = 4;
+    _module_under_test->create_track("1", 2);
+    _module_under_test->create_track("2", 2);
+    _module_under_test->connect_audio_input_bus(0, 0, "1");
+    _module_under_test->connect_audio_input_bus(1, 0, "2");
+    _module_under_test->connect_audio_output_bus(0, 0, "1");
+    _module_under_test->connect_audio_output_bus(0, 0, "2");
+    ASSERT_TRUE(_module_under_test->_track_major_rendering_possible());
+
+    std::vector<SampleBuffer<AUDIO_CHUNK_SIZE>> in_buffers(CHUNKS, SampleBuffer<AUDIO_CHUNK_SIZE>(TEST_CHANNEL_COUNT));
+    std::vector<SampleBuffer<AUDIO_CHUNK_SIZE>> out_buffers(CHUNKS, SampleBuffer<AUDIO_CHUNK_SIZE>(TEST_CHANNEL_COUNT));
+    ControlBuffer control_buffer;
+    for (int i = 0; i < CHUNKS; ++i)
+    {
+        test_utils::fill_sample_buffer(in_buffers[i], static_cast<float>(i));
+    }
+    Time start_time = std::chrono::microseconds(1000);
+    _module_under_test->process_chunks(in_buffers.data(), out_buffers.data(), CHUNKS, start_time, 10 * AUDIO_CHUNK_SIZE,
+                                       &control_buffer, &control_buffer);
+
+    /* Each track renders all chunks before the outputs are summed, which should
+     * give the same result as processing one chunk at a time */
+    for (int i = 0; i < CHUNKS; ++i)
+    {
+        auto main_bus = SampleBuffer<AUDIO_CHUNK_SIZE>::create_non_owning_buffer(out_buffers[i], 0, 2);
+        auto second_bus = SampleBuffer<AUDIO_CHUNK_SIZE>::create_non_owning_buffer(out_buffers[i], 2, 2);
+        test_utils::assert_buffer_value(2.0f * i, main_bus);
+        test_utils::assert_buffer_value(0.0f, second_bus);
+        EXPECT_EQ(10 * AUDIO_CHUNK_SIZE + i * AUDIO_CHUNK_SIZE, _module_under_test->_chunk_transports[i].current_samples());
+    }
+    EXPECT_EQ(_module_under_test->_chunk_transports.back().current_samples(), _module_under_test->_transport.current_samples());
+    EXPECT_GT(_module_under_test->_transport.current_process_time(), start_time);
+
+    /* Cv routing makes the engine fall back to processing one chunk at a time */
+    ASSERT_EQ(EngineReturnStatus::OK, _module_under_test->set_cv_input_channels(1));
+    ASSERT_FALSE(_module_under_test->_track_major_rendering_possible());
+    _module_under_test->process_chunks(in_buffers.data(), out_buffers.data(), CHUNKS, start_time, 0,
+                                       &control_buffer, &control_buffer);
+    for (int i = 0; i < CHUNKS; ++i)
+    {
+        auto main_bus = SampleBuffer<AUDIO_CHUNK_SIZE>::create_non_owning_buffer(out_buffers[i], 0, 2);
+        test_utils::assert_buffer_value(2.0f * i, main_bus);
+    }
+    EXPECT_EQ((CHUNKS - 1) * AUDIO_CHUNK_SIZE, _module_under_test->_transport.current_samples());
+}
+
+/* Sends one event for every chunk it processes */
+class EventSenderPlugin : public InternalPlugin
+{
+public:
+    EventSenderPlugin(HostControl host_control) : InternalPlugin(host_control)
+    {
+        _max_input_channels = 2;
+        _max_output_channels = 2;
+    }
+
+    void process_audio(const ChunkSampleBuffer& in_buffer, ChunkSampleBuffer& out_buffer) override
+    {
+        out_buffer = in_buffer;
+        output_event(RtEvent::make_parameter_change_event(this->id(), 0, 0, 1.0f));
+    }
+};
+
+TEST_F(TestEngine, TestProcessChunksEvents)
+{
+    /* More chunks than there is room for events in the queues */
+    constexpr int CHUNKS = MAX_EVENTS_IN_QUEUE + 20;
+    _module_under_test->create_track("1", 2);
+    _module_under_test->connect_audio_output_bus(0, 0, "1");
+    auto track = _module_under_test->_audio_graph[0];
+    EventSenderPlugin sender(HostControl(_module_under_test->event_dispatcher(), _module_under_test->transport()));
+    ASSERT_TRUE(track->add(&sender));
+
+    std::vector<SampleBuffer<AUDIO_CHUNK_SIZE>> in_buffers(CHUNKS, SampleBuffer<AUDIO_CHUNK_SIZE>(TEST_CHANNEL_COUNT));
+    std::vector<SampleBuffer<AUDIO_CHUNK_SIZE>> out_buffers(CHUNKS, SampleBuffer<AUDIO_CHUNK_SIZE>(TEST_CHANNEL_COUNT));
+    ControlBuffer control_buffer;
+    _module_under_test->process_chunks(in_buffers.data(), out_buffers.data(), CHUNKS, Time(0), 0,
+                                       &control_buffer, &control_buffer);
+
+    /* Events should be taken from the queue after every chunk, so none are lost */
+    const auto& events = _module_under_test->_track_block_events[track->id()];
+    ASSERT_EQ(static_cast<size_t>(CHUNKS), events.size());
+    for (const auto& event : events)
+    {
+        EXPECT_EQ(sender.id(), event.processor_id());
+    }
+    EXPECT_TRUE(_module_under_test->_processor_out_queue.empty());
+    track->remove(sender.id());
+}
+
+TEST_F(TestEngine, TestProcessChunksEventsOverflow)
+{
+    /* More events than the space reserved for each track */
+    constexpr int CHUNKS = MAX_TRACK_BLOCK_EVENTS + 20;
+    _module_under_test->create_track("1", 2);
+    auto track = _module_under_test->_audio_graph[0];
+    EventSenderPlugin sender(HostControl(_module_under_test->event_dispatcher(), _module_under_test->transport()));
+    ASSERT_TRUE(track->add(&sender));
+
+    std::vector<SampleBuffer<AUDIO_CHUNK_SIZE>> in_buffers(CHUNKS, SampleBuffer<AUDIO_CHUNK_SIZE>(TEST_CHANNEL_COUNT));
+    std::vector<SampleBuffer<AUDIO_CHUNK_SIZE>> out_buffers(CHUNKS, SampleBuffer<AUDIO_CHUNK_SIZE>(TEST_CHANNEL_COUNT));
+    ControlBuffer control_buffer;
+    _module_under_test->process_chunks(in_buffers.data(), out_buffers.data(), CHUNKS, Time(0), 0,
+                                       &control_buffer, &control_buffer);
+
+    /* Events beyond the reserved space are dropped, but the queue is still emptied */
+    const auto& events = _module_under_test->_track_block_events[track->id()];
+    EXPECT_EQ(static_cast<size_t>(MAX_TRACK_BLOCK_EVENTS), events.size());
+    EXPECT_EQ(static_cast<size_t>(MAX_TRACK_BLOCK_EVENTS), events.capacity());
+    EXPECT_TRUE(_module_under_test->_processor_out_queue.empty());
+    track->remove(sender.id());
+}
+
 TEST_F(TestEngine, TestUidNameMapping)
 {
     _module_under_test->create_track("left", 2);
@@ -306,7 +421,7 @@ TEST_F(TestEngine, TestSetSamplerate)
     ASSERT_FLOAT_EQ(48000.0f, _module_under_test->sample_rate());
     /* Pretty ugly way of checking that it was actually set, but wth */
     auto eq_plugin = static_cast<equalizer_plugin::EqualizerPlugin*>(_module_under_test->_processors["eq"].get());
-    ASSERT_FLOAT_EQ(48000.0f, eq_plugin->_sample_rate);
+    ASSERT_FLOAT_EQ(48000.0f, eq_plugin->_new_sample_rate.load());
 }
 
 TEST_F(TestEngine, TestRealtimeConfiguration)
@@ -38,8 +38,15 @@ public:
         return 100;
     };
 
+    void notification_cycle_done() override
+    {
+        _cycles_done++;
+    }
+
     int poster_id() override {return DUMMY_POSTER_ID;}
 
+    int cycles_done() const {return _cycles_done;}
+
     bool event_received()
     {
         if (_received)
@@ -52,6 +59,7 @@ public:
 
 private:
     bool _received{false};
+    int  _cycles_done{0};
 };
 
 class TestEventDispatcher : public ::testing::Test
@@ -161,6 +169,176 @@ TEST_F(TestEventDispatcher, TestFromRtEventParameterChangeNotification)
     ASSERT_TRUE(_poster.event_received());
 }
 
+TEST_F(TestEventDispatcher, TestFromRtEventTransportNotification)
+{
+    RtEvent rt_event = RtEvent::make_tempo_event(0, 125);
+    _in_rt_queue.push(rt_event);
+
+    _module_under_test->subscribe_to_engine_notifications(&_poster);
+    crank_event_loop_once();
+
+    ASSERT_TRUE(_poster.event_received());
+}
+
+TEST_F(TestEventDispatcher, TestEngineNotification)
+{
+    _module_under_test->subscribe_to_engine_notifications(&_poster);
+    _module_under_test->post_event(new AudioGraphNotificationEvent(AudioGraphNotificationEvent::Action::TRACK_ADDED,
+                                                                   5, 5, IMMEDIATE_PROCESS));
+    crank_event_loop_once();
+
+    ASSERT_TRUE(_poster.event_received());
+}
+
+TEST_F(TestEventDispatcher, TestNotificationCycleDone)
+{
+    /* Called once per cycle, even when subscribing to several kinds of notifications */
+    _module_under_test->subscribe_to_parameter_change_notifications(&_poster);
+    _module_under_test->subscribe_to_engine_notifications(&_poster);
+    crank_event_loop_once();
+    EXPECT_EQ(1, _poster.cycles_done());
+
+    _module_under_test->unsubscribe_from_parameter_change_notifications(&_poster);
+    crank_event_loop_once();
+    EXPECT_EQ(2, _poster.cycles_done());
+}
+
+TEST_F(TestEventDispatcher, TestParameterChangeBatch)
+{
+    /* Larger than the rt queue, so that the batch has to be sent in 2 parts */
+    constexpr int BATCH_SIZE = MAX_EVENTS_IN_QUEUE + 20;
+    std::vector<ParameterChangeBatchEvent::ParameterValue> values;
+    for (int i = 0; i < BATCH_SIZE; ++i)
+    {
+        values.push_back({1, static_cast<ObjectId>(i), 0.5f});
+    }
+    auto event = new ParameterChangeBatchEvent(std::move(values), IMMEDIATE_PROCESS);
+
+    EXPECT_EQ(EventStatus::QUEUED_HANDLING, _module_under_test->process(event));
+    EXPECT_GT(event->sent_count(), 0u);
+    EXPECT_LT(event->sent_count(), static_cast<size_t>(BATCH_SIZE));
+
+    RtEvent rt_event;
+    int received = 0;
+    while (_out_rt_queue.pop(rt_event))
+    {
+        ASSERT_EQ(RtEventType::FLOAT_PARAMETER_CHANGE, rt_event.type());
+        EXPECT_EQ(static_cast<ObjectId>(received), rt_event.parameter_change_event()->param_id());
+        received++;
+    }
+    EXPECT_EQ(event->sent_count(), static_cast<size_t>(received));
+
+    /* Retried the way the event loop does, after taking it off the waiting list */
+    ASSERT_EQ(1u, _module_under_test->_waiting_list.size());
+    _module_under_test->_waiting_list.clear();
+    EXPECT_EQ(EventStatus::HANDLED_OK, _module_under_test->process(event));
+    while (_out_rt_queue.pop(rt_event))
+    {
+        EXPECT_EQ(static_cast<ObjectId>(received), rt_event.parameter_change_event()->param_id());
+        received++;
+    }
+    EXPECT_EQ(BATCH_SIZE, received);
+
+    _module_under_test->_waiting_list.clear();
+    delete event;
+}
+
+TEST_F(TestEventDispatcher, TestParameterChangeBatchNextCycle)
+{
+    constexpr int BATCH_SIZE = MAX_EVENTS_IN_QUEUE + 20;
+    std::vector<ParameterChangeBatchEvent::ParameterValue> values;
+    for (int i = 0; i < BATCH_SIZE; ++i)
+    {
+        values.push_back({1, static_cast<ObjectId>(i), 0.5f});
+    }
+    _module_under_test->post_event(new ParameterChangeBatchEvent(std::move(values), IMMEDIATE_PROCESS));
+
+    /* The rest of the batch is not retried until the next cycle, even if the rt queue stays full */
+    crank_event_loop_once();
+    EXPECT_EQ(1u, _module_under_test->_waiting_list.size());
+    crank_event_loop_once();
+    EXPECT_EQ(1u, _module_under_test->_waiting_list.size());
+
+    RtEvent rt_event;
+    int received = 0;
+    while (_out_rt_queue.pop(rt_event))
+    {
+        received++;
+    }
+    crank_event_loop_once();
+    EXPECT_TRUE(_module_under_test->_waiting_list.empty());
+    while (_out_rt_queue.pop(rt_event))
+    {
+        EXPECT_EQ(static_cast<ObjectId>(received), rt_event.parameter_change_event()->param_id());
+        received++;
+    }
+    EXPECT_EQ(BATCH_SIZE, received);
+}
+
+TEST_F(TestEventDispatcher, TestParameterChangeAfterBatch)
+{
+    constexpr int BATCH_SIZE = MAX_EVENTS_IN_QUEUE + 20;
+    constexpr ObjectId LAST_PARAMETER = BATCH_SIZE - 1;
+    std::vector<ParameterChangeBatchEvent::ParameterValue> values;
+    for (int i = 0; i < BATCH_SIZE; ++i)
+    {
+        values.push_back({1, static_cast<ObjectId>(i), 0.5f});
+    }
+    _module_under_test->post_event(new ParameterChangeBatchEvent(std::move(values), IMMEDIATE_PROCESS));
+    crank_event_loop_once();
+    ASSERT_EQ(1u, _module_under_test->_waiting_list.size());
+
+    /* A newer change that arrives when the rt queue has room again must not be
+     * sent before the rest of the batch, or the batch would overwrite it */
+    RtEvent rt_event;
+    while (_out_rt_queue.pop(rt_event)) {}
+    auto event = new ParameterChangeEvent(ParameterChangeEvent::Subtype::FLOAT_PARAMETER_CHANGE,
+                                          1, LAST_PARAMETER, 1.0f, IMMEDIATE_PROCESS);
+    EXPECT_EQ(EventStatus::QUEUED_HANDLING, _module_under_test->process(event));
+    EXPECT_TRUE(_out_rt_queue.empty());
+
+    crank_event_loop_once();
+    EXPECT_TRUE(_module_under_test->_waiting_list.empty());
+    float last_value = 0.0f;
+    while (_out_rt_queue.pop(rt_event))
+    {
+        if (rt_event.parameter_change_event()->param_id() == LAST_PARAMETER)
+        {
+            last_value = rt_event.parameter_change_event()->value();
+        }
+    }
+    EXPECT_FLOAT_EQ(1.0f, last_value);
+}
+
+TEST_F(TestEventDispatcher, TestScheduledEvents)
+{
+    auto now = std::chrono::duration_cast<Time>(std::chrono::seconds(1));
+    _module_under_test->set_time(now);
+    _module_under_test->post_event(new ParameterChangeEvent(ParameterChangeEvent::Subtype::FLOAT_PARAMETER_CHANGE,
+                                                            1, 2, 0.5f, now + std::chrono::seconds(2)));
+    _module_under_test->post_event(new ParameterChangeEvent(ParameterChangeEvent::Subtype::FLOAT_PARAMETER_CHANGE,
+                                                            1, 1, 0.5f, now + std::chrono::seconds(1)));
+
+    /* Events in the future are kept in the schedule, and not retried every cycle */
+    crank_event_loop_once();
+    EXPECT_EQ(2u, _module_under_test->_scheduled_events.size());
+    EXPECT_TRUE(_module_under_test->_waiting_list.empty());
+    EXPECT_TRUE(_out_rt_queue.empty());
+
+    _module_under_test->set_time(now + std::chrono::seconds(1));
+    crank_event_loop_once();
+    EXPECT_EQ(1u, _module_under_test->_scheduled_events.size());
+    RtEvent rt_event;
+    ASSERT_TRUE(_out_rt_queue.pop(rt_event));
+    EXPECT_EQ(1u, rt_event.parameter_change_event()->param_id());
+    EXPECT_TRUE(_out_rt_queue.empty());
+
+    _module_under_test->set_time(now + std::chrono::seconds(3));
+    crank_event_loop_once();
+    EXPECT_TRUE(_module_under_test->_scheduled_events.empty());
+    ASSERT_TRUE(_out_rt_queue.pop(rt_event));
+    EXPECT_EQ(2u, rt_event.parameter_change_event()->param_id());
+}
 
 TEST_F(TestEventDispatcher, TestCompletionCallback)
 {
@@ -1,5 +1,7 @@
 #include <fstream>
 
+#include <unistd.h>
+
 #include "gtest/gtest.h"
 
 #define private public
@@ -341,4 +343,50 @@ TEST_F(TestJsonConfigurator, TestLoadEventList)
     auto [status, events] = _module_under_test->load_event_list();
     ASSERT_EQ(JsonConfigReturnStatus::OK, status);
     ASSERT_EQ(4u, events.size());
-}
\ No newline at end of file
+}
+
+TEST_F(TestJsonConfigurator, TestValidationCache)
+{
+    char dir_template[] = "/tmp/sushi_config_cache_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(dir_template));
+    std::string cache_dir(dir_template);
+    JsonConfigurator::set_validation_cache_directory(cache_dir);
+
+    uint32_t host_config_flag = 1u << static_cast<int>(JsonSection::HOST_CONFIG);
+    uint32_t tracks_flag = 1u << static_cast<int>(JsonSection::TRACKS);
+    std::string cache_file;
+    std::string config_path;
+    uint64_t content_size;
+    uint64_t content_hash;
+
+    /* Validated sections should be recorded in the cache file when the configurator is done */
+    {
+        JsonConfigurator configurator(_engine, _midi_dispatcher, _path);
+        ASSERT_EQ(JsonConfigReturnStatus::OK, configurator.load_host_config());
+        cache_file = configurator._validation_file;
+        config_path = configurator._validation_path;
+        content_size = configurator._content_size;
+        content_hash = configurator._content_hash;
+        ASSERT_FALSE(cache_file.empty());
+        EXPECT_EQ(0u, read_validated_sections(cache_file, config_path, content_size, content_hash));
+    }
+    EXPECT_EQ(host_config_flag, read_validated_sections(cache_file, config_path, content_size, content_hash));
+
+    /* A configurator reading the same file should pick them up */
+    {
+        JsonConfigurator configurator(_engine, _midi_dispatcher, _path);
+        ASSERT_EQ(JsonConfigReturnStatus::OK, configurator.load_tracks());
+        EXPECT_EQ(cache_file, configurator._validation_file);
+        EXPECT_EQ(host_config_flag | tracks_flag, configurator._validated_sections);
+    }
+    EXPECT_EQ(host_config_flag | tracks_flag, read_validated_sections(cache_file, config_path, content_size, content_hash));
+
+    /* A record of another file, or of other contents, must not be trusted */
+    EXPECT_EQ(0u, read_validated_sections(cache_file, config_path + "_other", content_size, content_hash));
+    EXPECT_EQ(0u, read_validated_sections(cache_file, config_path, content_size + 1, content_hash));
+    EXPECT_EQ(0u, read_validated_sections(cache_file, config_path, content_size, content_hash + 1));
+
+    JsonConfigurator::set_validation_cache_directory("");
+    remove(cache_file.c_str());
+    rmdir(cache_dir.c_str());
+}
@@ -0,0 +1,133 @@
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#define private public
+
+#include "test_utils/test_utils.h"
+#include "test_utils/host_control_mockup.h"
+#include "engine/meter_service.cpp"
+
+using namespace sushi;
+using namespace sushi::engine;
+
+constexpr float TEST_SAMPLE_RATE = 48000;
+constexpr int TEST_CHANNELS = 2;
+/* Enough to publish several times and let the rms level settle */
+constexpr int TEST_CHUNKS = static_cast<int>(TEST_SAMPLE_RATE * 2) / AUDIO_CHUNK_SIZE;
+
+class TestMeterService : public ::testing::Test
+{
+protected:
+    TestMeterService() {}
+
+    void SetUp()
+    {
+        _module_under_test.set_input_channels(TEST_CHANNELS);
+        _module_under_test.set_output_channels(TEST_CHANNELS);
+    }
+
+    HostControlMockup _host_control;
+    performance::PerformanceTimer _timer;
+    MeterService _module_under_test{TEST_SAMPLE_RATE};
+};
+
+TEST_F(TestMeterService, TestNoSnapshotPublished)
+{
+    MeterSnapshot snapshot;
+    _module_under_test.snapshot(snapshot);
+    EXPECT_EQ(0, snapshot.input_channels);
+    EXPECT_EQ(0, snapshot.output_channels);
+    EXPECT_EQ(0, snapshot.tracks);
+}
+
+TEST_F(TestMeterService, TestLevels)
+{
+    ChunkSampleBuffer buffer(TEST_CHANNELS);
+    MeterSnapshot snapshot;
+    for (int chunk = 0; chunk < TEST_CHUNKS; ++chunk)
+    {
+        /* Dc on the first channel, a sine at a quarter of the sample rate on the second.
+         * The sine is sampled at +-45 degrees from its peaks, so its true peak is
+         * higher than its sample peak */
+        for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+        {
+            buffer.channel(0)[i] = 0.5f;
+            buffer.channel(1)[i] = std::sin(static_cast<float>(M_PI) * (i / 2.0f + 0.25f));
+        }
+        _module_under_test.process_inputs(buffer);
+        buffer.clear();
+        _module_under_test.process_outputs(buffer, 0, std::chrono::microseconds(chunk));
+    }
+    _module_under_test.snapshot(snapshot);
+
+    ASSERT_EQ(TEST_CHANNELS, snapshot.input_channels);
+    ASSERT_EQ(TEST_CHANNELS, snapshot.output_channels);
+    EXPECT_GT(snapshot.timestamp.count(), 0);
+
+    EXPECT_NEAR(0.5f, snapshot.inputs[0].peak, 1.0e-5f);
+    EXPECT_NEAR(0.5f, snapshot.inputs[0].rms, 1.0e-3f);
+    EXPECT_NEAR(0.5f, snapshot.inputs[0].true_peak, 1.0e-2f);
+
+    EXPECT_NEAR(M_SQRT1_2, snapshot.inputs[1].peak, 1.0e-5f);
+    EXPECT_NEAR(M_SQRT1_2, snapshot.inputs[1].rms, 1.0e-3f);
+    EXPECT_GT(snapshot.inputs[1].true_peak, 0.95f);
+    EXPECT_LT(snapshot.inputs[1].true_peak, 1.05f);
+
+    EXPECT_FLOAT_EQ(0.0f, snapshot.outputs[0].peak);
+    EXPECT_FLOAT_EQ(0.0f, snapshot.outputs[1].rms);
+}
+
+TEST_F(TestMeterService, TestPeakDecay)
+{
+    ChunkSampleBuffer buffer(TEST_CHANNELS);
+    MeterSnapshot snapshot;
+    test_utils::fill_sample_buffer(buffer, 1.0f);
+    _module_under_test.process_inputs(buffer);
+    buffer.clear();
+    for (int chunk = 0; chunk < TEST_CHUNKS; ++chunk)
+    {
+        _module_under_test.process_inputs(buffer);
+        _module_under_test.process_outputs(buffer, 0, IMMEDIATE_PROCESS);
+    }
+    _module_under_test.snapshot(snapshot);
+    EXPECT_LT(snapshot.inputs[0].peak, 0.01f);
+    EXPECT_LT(snapshot.inputs[0].true_peak, 0.01f);
+    EXPECT_LT(snapshot.inputs[0].rms, 0.01f);
+}
+
+TEST_F(TestMeterService, TestTracks)
+{
+    Track track_1(_host_control.make_host_control_mockup(), 2, &_timer);
+    Track track_2(_host_control.make_host_control_mockup(), 1, &_timer);
+    test_utils::fill_sample_buffer(track_1._output_buffer, 0.25f);
+    test_utils::fill_sample_buffer(track_2._output_buffer, 0.75f);
+
+    ChunkSampleBuffer buffer(TEST_CHANNELS);
+    MeterSnapshot snapshot;
+    for (int chunk = 0; chunk < TEST_CHUNKS; ++chunk)
+    {
+        _module_under_test.process_track(0, track_1);
+        _module_under_test.process_track(1, track_2);
+        _module_under_test.process_outputs(buffer, 2, IMMEDIATE_PROCESS);
+    }
+    _module_under_test.snapshot(snapshot);
+    ASSERT_EQ(2, snapshot.tracks);
+    EXPECT_EQ(track_1.id(), snapshot.track_levels[0].track_id);
+    EXPECT_EQ(track_1.output_channels(), snapshot.track_levels[0].channels);
+    EXPECT_NEAR(0.25f, snapshot.track_levels[0].levels[1].peak, 1.0e-5f);
+    EXPECT_EQ(track_2.id(), snapshot.track_levels[1].track_id);
+    EXPECT_NEAR(0.75f, snapshot.track_levels[1].levels[0].peak, 1.0e-5f);
+
+    /* Remove the first track, the levels of the second should not carry over */
+    test_utils::fill_sample_buffer(track_2._output_buffer, 0.0f);
+    for (int chunk = 0; chunk < TEST_CHUNKS / 100; ++chunk)
+    {
+        _module_under_test.process_track(0, track_2);
+        _module_under_test.process_outputs(buffer, 1, IMMEDIATE_PROCESS);
+    }
+    _module_under_test.snapshot(snapshot);
+    ASSERT_EQ(1, snapshot.tracks);
+    EXPECT_EQ(track_2.id(), snapshot.track_levels[0].track_id);
+    EXPECT_FLOAT_EQ(0.0f, snapshot.track_levels[0].levels[0].peak);
+}
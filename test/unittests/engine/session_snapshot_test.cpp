@@ -0,0 +1,96 @@
+#include <cstdio>
+#include <string>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#define private public
+
+#include "test_utils/engine_mockup.h"
+#include "test_utils/host_control_mockup.h"
+#include "plugins/gain_plugin.h"
+#include "engine/session_snapshot.cpp"
+
+using namespace sushi;
+using namespace sushi::engine;
+
+constexpr float TEST_SAMPLE_RATE = 48000;
+
+class TestSessionSnapshot : public ::testing::Test
+{
+protected:
+    TestSessionSnapshot() {}
+
+    void SetUp()
+    {
+        _gain = new gain_plugin::GainPlugin(_host_control.make_host_control_mockup());
+        _gain->set_name("gain");
+        _engine.processors["gain"] = std::unique_ptr<Processor>(_gain);
+        _dispatcher = static_cast<EventDispatcherMockup*>(_engine.event_dispatcher());
+    }
+
+    void TearDown()
+    {
+        remove(_file_name.c_str());
+    }
+
+    HostControlMockup _host_control;
+    ProcessorEngineMockup _engine{TEST_SAMPLE_RATE};
+    Processor* _gain;
+    EventDispatcherMockup* _dispatcher;
+    std::string _file_name{"/tmp/sushi_snapshot_test_" + std::to_string(getpid())};
+};
+
+TEST_F(TestSessionSnapshot, TestSaveAndRestore)
+{
+    auto parameter_id = _gain->all_parameters()[0]->id();
+    float saved_value = _gain->parameter_value(parameter_id).second;
+    ASSERT_EQ(SnapshotStatus::OK, save_session_snapshot(&_engine, _file_name));
+
+    _gain->set_bypassed(true);
+    ASSERT_EQ(SnapshotStatus::OK, restore_session_snapshot(&_engine, _file_name));
+    EXPECT_FALSE(_gain->bypassed());
+
+    /* Tempo and time signature come first */
+    auto event = _dispatcher->retrieve_event();
+    ASSERT_NE(nullptr, event);
+    EXPECT_FALSE(event->is_parameter_change_batch());
+    event = _dispatcher->retrieve_event();
+    ASSERT_NE(nullptr, event);
+    EXPECT_FALSE(event->is_parameter_change_batch());
+
+    /* All parameter values are sent in one batch */
+    event = _dispatcher->retrieve_event();
+    ASSERT_NE(nullptr, event);
+    ASSERT_TRUE(event->is_parameter_change_batch());
+    const auto& values = static_cast<ParameterChangeBatchEvent*>(event.get())->values();
+    ASSERT_EQ(_gain->all_parameters().size(), values.size());
+    EXPECT_EQ(_gain->id(), values[0].processor_id);
+    EXPECT_EQ(parameter_id, values[0].parameter_id);
+    EXPECT_FLOAT_EQ(saved_value, values[0].value);
+    EXPECT_FALSE(_dispatcher->got_event());
+}
+
+TEST_F(TestSessionSnapshot, TestUnknownProcessor)
+{
+    ASSERT_EQ(SnapshotStatus::OK, save_session_snapshot(&_engine, _file_name));
+    _engine.processors.clear();
+    EXPECT_EQ(SnapshotStatus::OK, restore_session_snapshot(&_engine, _file_name));
+
+    EXPECT_TRUE(_dispatcher->got_event());
+    EXPECT_TRUE(_dispatcher->got_event());
+    EXPECT_FALSE(_dispatcher->got_event());
+}
+
+TEST_F(TestSessionSnapshot, TestInvalidFile)
+{
+    EXPECT_EQ(SnapshotStatus::FILE_ERROR, restore_session_snapshot(&_engine, _file_name));
+
+    FILE* file = fopen(_file_name.c_str(), "wb");
+    ASSERT_NE(nullptr, file);
+    fputs("This is not a snapshot, but long enough to hold a header", file);
+    fclose(file);
+    EXPECT_EQ(SnapshotStatus::INVALID_FILE, restore_session_snapshot(&_engine, _file_name));
+    EXPECT_FALSE(_dispatcher->got_event());
+}
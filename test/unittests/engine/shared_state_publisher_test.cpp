@@ -0,0 +1,108 @@
+#include <string>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#define private public
+
+#include "test_utils/engine_mockup.h"
+#include "test_utils/host_control_mockup.h"
+#include "plugins/gain_plugin.h"
+#include "engine/shared_state_publisher.cpp"
+
+using namespace sushi;
+using namespace sushi::engine;
+
+constexpr float TEST_SAMPLE_RATE = 48000;
+
+class TestSharedStatePublisher : public ::testing::Test
+{
+protected:
+    TestSharedStatePublisher() {}
+
+    void SetUp()
+    {
+        _gain = new gain_plugin::GainPlugin(_host_control.make_host_control_mockup());
+        _engine.processors["gain"] = std::unique_ptr<Processor>(_gain);
+        _module_under_test = std::make_unique<SharedStatePublisher>(&_engine, _name);
+        ASSERT_TRUE(_module_under_test->init());
+    }
+
+    HostControlMockup _host_control;
+    ProcessorEngineMockup _engine{TEST_SAMPLE_RATE};
+    Processor* _gain;
+    /* Unique per process so that tests running in parallel don't share a region */
+    std::string _name{"/sushi_state_test_" + std::to_string(getpid())};
+    std::unique_ptr<SharedStatePublisher> _module_under_test;
+};
+
+TEST_F(TestSharedStatePublisher, TestInitialState)
+{
+    auto state = _module_under_test->state();
+    ASSERT_NE(nullptr, state);
+    EXPECT_EQ(SUSHI_SHARED_STATE_MAGIC, state->magic);
+    EXPECT_EQ(SUSHI_SHARED_STATE_VERSION, state->version);
+    EXPECT_EQ(sizeof(sushi_shared_state), state->size);
+    EXPECT_EQ(0u, state->sequence % 2);
+    EXPECT_EQ(1u, state->parameter_generation);
+
+    auto parameter_count = _gain->all_parameters().size();
+    ASSERT_EQ(parameter_count, state->parameter_count);
+    EXPECT_EQ(_gain->id(), state->parameters[0].processor_id);
+    EXPECT_EQ(_gain->all_parameters()[0]->id(), state->parameters[0].parameter_id);
+}
+
+TEST_F(TestSharedStatePublisher, TestParameterChange)
+{
+    auto state = _module_under_test->state();
+    auto parameter_id = _gain->all_parameters()[0]->id();
+    float initial_value = state->parameters[0].value;
+    uint32_t sequence = sushi_shared_state_read_begin(state);
+
+    ParameterChangeNotificationEvent event(ParameterChangeNotificationEvent::Subtype::FLOAT_PARAMETER_CHANGE_NOT,
+                                           _gain->id(), parameter_id, 5.0f, IMMEDIATE_PROCESS);
+    EXPECT_EQ(EventStatus::HANDLED_OK, _module_under_test->process(&event));
+    /* Nothing is written until the end of the dispatcher cycle */
+    EXPECT_FLOAT_EQ(initial_value, state->parameters[0].value);
+    EXPECT_FALSE(sushi_shared_state_read_retry(state, sequence));
+
+    _module_under_test->notification_cycle_done();
+    EXPECT_TRUE(sushi_shared_state_read_retry(state, sequence));
+    sequence = sushi_shared_state_read_begin(state);
+    EXPECT_FLOAT_EQ(5.0f, state->parameters[0].value);
+    EXPECT_FALSE(sushi_shared_state_read_retry(state, sequence));
+}
+
+TEST_F(TestSharedStatePublisher, TestParameterChangeWithoutNotification)
+{
+    auto state = _module_under_test->state();
+    auto parameter_id = _gain->all_parameters()[0]->id();
+    _module_under_test->notification_cycle_done();
+    float initial_value = state->parameters[0].value;
+
+    /* Internal plugins set values from rt events without sending notifications */
+    auto rt_event = RtEvent::make_parameter_change_event(_gain->id(), 0, parameter_id, 0.75f);
+    _gain->process_event(rt_event);
+    float new_value = _gain->parameter_value(parameter_id).second;
+    ASSERT_NE(initial_value, new_value);
+
+    /* The values are only read back periodically */
+    _module_under_test->_last_value_refresh = IMMEDIATE_PROCESS;
+    uint32_t sequence = sushi_shared_state_read_begin(state);
+    _module_under_test->notification_cycle_done();
+    EXPECT_TRUE(sushi_shared_state_read_retry(state, sequence));
+    EXPECT_FLOAT_EQ(new_value, state->parameters[0].value);
+}
+
+TEST_F(TestSharedStatePublisher, TestAudioGraphChange)
+{
+    auto state = _module_under_test->state();
+    _engine.processors.erase("gain");
+    AudioGraphNotificationEvent event(AudioGraphNotificationEvent::Action::PROCESSOR_DELETED, 0, 0, IMMEDIATE_PROCESS);
+    _module_under_test->process(&event);
+    _module_under_test->notification_cycle_done();
+
+    EXPECT_EQ(2u, state->parameter_generation);
+    EXPECT_EQ(0u, state->parameter_count);
+}
@@ -0,0 +1,73 @@
+#include "gtest/gtest.h"
+#include "library/benchmark_report.cpp"
+#include "test_utils/control_mockup.h"
+
+using namespace sushi;
+
+/* Returns timings proportional to the node id, with records stored for all
+ * nodes except the engine */
+class TimerMockup : public performance::BasePerformanceTimer
+{
+public:
+    void set_timing_period(std::chrono::nanoseconds /*timing_period*/) override {}
+    void set_timing_period(float /*samplerate*/, int /*buffer_size*/) override {}
+    void enable(bool /*enabled*/) override {}
+    bool enabled() override {return true;}
+    std::optional<performance::ProcessTimings> timings_for_node(int id) override
+    {
+        return performance::ProcessTimings(0.1f * (id + 1), 0.05f * (id + 1), 0.2f * (id + 1));
+    }
+    bool clear_timings_for_node(int /*id*/) override {return true;}
+    void clear_all_timings() override {}
+    void store_records(bool /*enabled*/) override {}
+    std::optional<float> percentile_for_node(int id, float percentile) override
+    {
+        if (id == engine::ENGINE_TIMING_ID)
+        {
+            return std::nullopt;
+        }
+        return percentile / 100.0f;
+    }
+    int stored_records_for_node(int id) override
+    {
+        return id == engine::ENGINE_TIMING_ID ? 0 : 100;
+    }
+};
+
+TEST(TestBenchmarkReport, TestReportDocumentGeneration)
+{
+    sushi::ext::ControlMockup controller;
+    TimerMockup timer;
+    BenchmarkResult result{7500, 2.0, 48000.0f};
+
+    rapidjson::Document report = generate_benchmark_report_document(&controller, &timer, result);
+
+    ASSERT_TRUE(report.IsObject());
+    EXPECT_EQ(7500, report["chunks"].GetInt64());
+    EXPECT_EQ(AUDIO_CHUNK_SIZE, report["chunk_size"].GetInt());
+    EXPECT_DOUBLE_EQ(3750.0, report["chunks_per_second"].GetDouble());
+    EXPECT_DOUBLE_EQ(7500.0 * AUDIO_CHUNK_SIZE / 48000.0 / 2.0, report["realtime_factor"].GetDouble());
+
+    /* No percentiles without stored records */
+    const auto& engine_timings = report["engine"];
+    EXPECT_EQ(0, engine_timings["records"].GetInt());
+    EXPECT_FLOAT_EQ(0.0f, engine_timings["average"].GetFloat());
+    EXPECT_FALSE(engine_timings.HasMember("p50"));
+
+    const auto& tracks = report["tracks"];
+    ASSERT_EQ(2u, tracks.Size());
+    EXPECT_STREQ("track2", tracks[1]["name"].GetString());
+    EXPECT_EQ(1, tracks[1]["id"].GetInt());
+    EXPECT_FLOAT_EQ(0.2f, tracks[1]["timings"]["average"].GetFloat());
+    EXPECT_FLOAT_EQ(0.4f, tracks[1]["timings"]["max"].GetFloat());
+
+    const auto& processors = tracks[0]["processors"];
+    ASSERT_EQ(2u, processors.Size());
+    EXPECT_STREQ("proc 2", processors[1]["name"].GetString());
+    const auto& timings = processors[1]["timings"];
+    EXPECT_EQ(100, timings["records"].GetInt());
+    EXPECT_FLOAT_EQ(0.5f, timings["p50"].GetFloat());
+    EXPECT_FLOAT_EQ(0.9f, timings["p90"].GetFloat());
+    EXPECT_FLOAT_EQ(0.99f, timings["p99"].GetFloat());
+    EXPECT_FLOAT_EQ(0.999f, timings["p99.9"].GetFloat());
+}
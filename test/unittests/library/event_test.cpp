@@ -255,3 +255,42 @@ TEST(EventTest, TestFromRtEvent)
     EXPECT_TRUE(event->process_asynchronously());
     delete event;
 }
+
+TEST(EventTest, TestTransportNotificationFromRtEvent)
+{
+    auto tempo_event = RtEvent::make_tempo_event(0, 130);
+    Event* event = Event::from_rt_event(tempo_event, IMMEDIATE_PROCESS);
+    ASSERT_TRUE(event != nullptr);
+    ASSERT_TRUE(event->is_engine_notification());
+    auto engine_event = static_cast<EngineNotificationEvent*>(event);
+    ASSERT_TRUE(engine_event->is_transport_notification());
+    auto transport_event = static_cast<TransportNotificationEvent*>(event);
+    EXPECT_EQ(TransportNotificationEvent::Action::TEMPO_CHANGED, transport_event->action());
+    EXPECT_FLOAT_EQ(130, transport_event->tempo());
+    delete event;
+
+    auto signature_event = RtEvent::make_time_signature_event(0, {3, 4});
+    event = Event::from_rt_event(signature_event, IMMEDIATE_PROCESS);
+    ASSERT_TRUE(event != nullptr);
+    transport_event = static_cast<TransportNotificationEvent*>(event);
+    EXPECT_EQ(TransportNotificationEvent::Action::TIME_SIGNATURE_CHANGED, transport_event->action());
+    EXPECT_EQ(3, transport_event->time_signature().numerator);
+    EXPECT_EQ(4, transport_event->time_signature().denominator);
+    delete event;
+
+    auto mode_event = RtEvent::make_playing_mode_event(0, PlayingMode::PLAYING);
+    event = Event::from_rt_event(mode_event, IMMEDIATE_PROCESS);
+    ASSERT_TRUE(event != nullptr);
+    transport_event = static_cast<TransportNotificationEvent*>(event);
+    EXPECT_EQ(TransportNotificationEvent::Action::PLAYING_MODE_CHANGED, transport_event->action());
+    EXPECT_EQ(PlayingMode::PLAYING, transport_event->playing_mode());
+    delete event;
+
+    auto sync_event = RtEvent::make_sync_mode_event(0, SyncMode::MIDI_SLAVE);
+    event = Event::from_rt_event(sync_event, IMMEDIATE_PROCESS);
+    ASSERT_TRUE(event != nullptr);
+    transport_event = static_cast<TransportNotificationEvent*>(event);
+    EXPECT_EQ(TransportNotificationEvent::Action::SYNC_MODE_CHANGED, transport_event->action());
+    EXPECT_EQ(SyncMode::MIDI_SLAVE, transport_event->sync_mode());
+    delete event;
+}
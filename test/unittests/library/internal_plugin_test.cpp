@@ -3,8 +3,10 @@
 #include "gtest/gtest.h"
 
 #define private public
+#define protected public
 #include "library/internal_plugin.cpp"
 #undef private
+#undef protected
 
 #include "test_utils/host_control_mockup.h"
 #include "test_utils/test_utils.h"
@@ -149,3 +151,39 @@ TEST_F(InternalPluginTest, TestFloatParameterHandling)
 
     DECLARE_UNUSED(unused_value);
 }
+
+TEST_F(InternalPluginTest, TestParameterChangeTracking)
+{
+    FloatParameterValue* value = _module_under_test->register_float_parameter("param_1", "Param 1", "", 1.0f, 0.0f, 10.f,
+                                                                              new FloatParameterPreProcessor(0.0, 10.0));
+    _module_under_test->register_int_parameter("param_2", "Param 2", "", 0, 0, 10,
+                                               new IntParameterPreProcessor(0, 10));
+    ASSERT_TRUE(value);
+
+    // All parameters should be regarded as changed after registration
+    EXPECT_TRUE(_module_under_test->parameters_changed());
+    EXPECT_TRUE(_module_under_test->parameter_changed(0));
+    EXPECT_TRUE(_module_under_test->parameter_changed(1));
+
+    _module_under_test->clear_parameter_changes();
+    EXPECT_FALSE(_module_under_test->parameters_changed());
+    EXPECT_FALSE(_module_under_test->parameter_changed(0));
+    EXPECT_FALSE(_module_under_test->parameter_changed(1));
+
+    RtEvent event = RtEvent::make_parameter_change_event(0, 0, 1, 4.0f);
+    _module_under_test->process_event(event);
+    EXPECT_TRUE(_module_under_test->parameters_changed());
+    EXPECT_FALSE(_module_under_test->parameter_changed(0));
+    EXPECT_TRUE(_module_under_test->parameter_changed(1));
+
+    _module_under_test->clear_parameter_changes();
+    _module_under_test->set_parameter_and_notify(value, 3.0f);
+    EXPECT_TRUE(_module_under_test->parameter_changed(0));
+
+    // Events to non-existing parameters should not register as changes
+    _module_under_test->clear_parameter_changes();
+    event = RtEvent::make_parameter_change_event(0, 0, 45, 4.0f);
+    _module_under_test->process_event(event);
+    EXPECT_FALSE(_module_under_test->parameters_changed());
+    EXPECT_FALSE(_module_under_test->parameter_changed(45));
+}
@@ -14,4 +14,31 @@ TEST(TestParameterDump, TestParameterDocumentGeneration)
     rapidjson::Document result = sushi::generate_processor_parameter_document(&controller);
 
     ASSERT_EQ(expected_result, result);
-}
\ No newline at end of file
+}
+TEST(TestParameterDump, TestPluginMetadataDocumentGeneration)
+{
+    sushi::PluginMetadata metadata;
+    metadata.label = "Plugin";
+    metadata.max_input_channels = 2;
+    metadata.max_output_channels = 1;
+    metadata.latency = 64;
+    metadata.parameters.push_back({3, "gain", "Gain", "dB", sushi::ParameterType::FLOAT, -24.0f, 24.0f, true});
+    metadata.program_names = {"program 1", "program 2"};
+
+    rapidjson::Document result = sushi::generate_plugin_metadata_document(metadata);
+
+    EXPECT_STREQ("Plugin", result["label"].GetString());
+    EXPECT_EQ(2, result["input_channels"].GetInt());
+    EXPECT_EQ(1, result["output_channels"].GetInt());
+    EXPECT_EQ(64, result["latency"].GetInt());
+    ASSERT_EQ(1u, result["parameters"].Size());
+    const auto& parameter = result["parameters"][0];
+    EXPECT_STREQ("gain", parameter["name"].GetString());
+    EXPECT_STREQ("dB", parameter["unit"].GetString());
+    EXPECT_STREQ("float", parameter["type"].GetString());
+    EXPECT_EQ(3u, parameter["id"].GetUint());
+    EXPECT_FLOAT_EQ(-24.0f, parameter["min"].GetFloat());
+    EXPECT_TRUE(parameter["automatable"].GetBool());
+    ASSERT_EQ(2u, result["programs"].Size());
+    EXPECT_STREQ("program 2", result["programs"][1].GetString());
+}
@@ -103,3 +103,33 @@ TEST_F(TestPerformanceTimer, TestClearRecords)
     ASSERT_FLOAT_EQ(100.0f, t.min_case);
     ASSERT_FLOAT_EQ(0.0f, t.max_case);
 }
+
+TEST_F(TestPerformanceTimer, TestPercentiles)
+{
+    /* Records are not kept by default */
+    run_test_scenario(_module_under_test);
+    _module_under_test._update_timings();
+    ASSERT_FALSE(_module_under_test.percentile_for_node(1, 50).has_value());
+    ASSERT_EQ(0, _module_under_test.stored_records_for_node(1));
+
+    /* Store timings of 10% to 100% of the period in reverse order */
+    _module_under_test.store_records(true);
+    for (int i = 10; i > 0; --i)
+    {
+        auto start = _module_under_test.start_timer();
+        start = virtual_wait(start, i);
+        _module_under_test.stop_timer(start, 1);
+    }
+    _module_under_test._update_timings();
+    ASSERT_EQ(10, _module_under_test.stored_records_for_node(1));
+    ASSERT_EQ(0, _module_under_test.stored_records_for_node(467));
+
+    EXPECT_NEAR(0.1f, _module_under_test.percentile_for_node(1, 0).value(), 0.05f);
+    EXPECT_NEAR(0.6f, _module_under_test.percentile_for_node(1, 50).value(), 0.05f);
+    EXPECT_NEAR(1.0f, _module_under_test.percentile_for_node(1, 100).value(), 0.05f);
+    EXPECT_FALSE(_module_under_test.percentile_for_node(467, 50).has_value());
+
+    _module_under_test.clear_all_timings();
+    ASSERT_EQ(0, _module_under_test.stored_records_for_node(1));
+    ASSERT_FALSE(_module_under_test.percentile_for_node(1, 50).has_value());
+}
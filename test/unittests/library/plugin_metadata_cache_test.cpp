@@ -0,0 +1,155 @@
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "gtest/gtest.h"
+
+#define private public
+
+#include "test_utils/host_control_mockup.h"
+#include "plugins/gain_plugin.h"
+#include "library/plugin_metadata_cache.cpp"
+
+using namespace sushi;
+
+constexpr float TEST_SAMPLE_RATE = 48000;
+
+class TestPluginMetadataCache : public ::testing::Test
+{
+protected:
+    TestPluginMetadataCache() {}
+
+    void SetUp()
+    {
+        char dir_template[] = "/tmp/sushi_plugin_cache_XXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(dir_template));
+        _cache_dir = dir_template;
+        /* Stands in for the plugin library, only its size and time are used */
+        _plugin_path = _cache_dir + "/plugin.so";
+        _write_plugin_file("plugin");
+        _plugin.init(TEST_SAMPLE_RATE);
+    }
+
+    void TearDown()
+    {
+        remove(_module_under_test._cache_file_name({_plugin_path, ""}).c_str());
+        remove(_plugin_path.c_str());
+        rmdir(_cache_dir.c_str());
+    }
+
+    void _write_plugin_file(const char* contents)
+    {
+        FILE* file = fopen(_plugin_path.c_str(), "wb");
+        ASSERT_NE(nullptr, file);
+        fputs(contents, file);
+        fclose(file);
+    }
+
+    HostControlMockup _host_control;
+    gain_plugin::GainPlugin _plugin{_host_control.make_host_control_mockup()};
+    PluginMetadataCache _module_under_test;
+    std::string _cache_dir;
+    std::string _plugin_path;
+};
+
+TEST_F(TestPluginMetadataCache, TestReadMetadata)
+{
+    auto metadata = PluginMetadataCache::read_metadata(&_plugin);
+    EXPECT_EQ(_plugin.label(), metadata.label);
+    EXPECT_EQ(_plugin.max_input_channels(), metadata.max_input_channels);
+    EXPECT_EQ(_plugin.max_output_channels(), metadata.max_output_channels);
+    EXPECT_EQ(0, metadata.latency);
+    ASSERT_EQ(_plugin.all_parameters().size(), metadata.parameters.size());
+    auto descriptor = _plugin.all_parameters()[0];
+    EXPECT_EQ(descriptor->id(), metadata.parameters[0].id);
+    EXPECT_EQ(descriptor->name(), metadata.parameters[0].name);
+    EXPECT_EQ(descriptor->unit(), metadata.parameters[0].unit);
+    EXPECT_FLOAT_EQ(descriptor->max_range(), metadata.parameters[0].max_range);
+    EXPECT_TRUE(metadata.program_names.empty());
+}
+
+TEST_F(TestPluginMetadataCache, TestMemoryCache)
+{
+    EXPECT_FALSE(_module_under_test.lookup(_plugin_path, "").has_value());
+    _module_under_test.store(_plugin_path, "", &_plugin);
+    auto metadata = _module_under_test.lookup(_plugin_path, "");
+    ASSERT_TRUE(metadata.has_value());
+    EXPECT_EQ(_plugin.label(), metadata->label);
+    /* Entries are separate per uid */
+    EXPECT_FALSE(_module_under_test.lookup(_plugin_path, "other.uid").has_value());
+    EXPECT_FALSE(_module_under_test.lookup("/not/a/plugin.so", "").has_value());
+}
+
+TEST_F(TestPluginMetadataCache, TestCacheFiles)
+{
+    _module_under_test.set_cache_directory(_cache_dir);
+    auto stored = _module_under_test.store(_plugin_path, "", &_plugin);
+    EXPECT_EQ(0, access(_module_under_test._cache_file_name({_plugin_path, ""}).c_str(), R_OK));
+
+    /* A new instance should read the metadata back from the cache file */
+    PluginMetadataCache cache;
+    cache.set_cache_directory(_cache_dir);
+    auto metadata = cache.lookup(_plugin_path, "");
+    ASSERT_TRUE(metadata.has_value());
+    EXPECT_EQ(stored.label, metadata->label);
+    EXPECT_EQ(stored.max_output_channels, metadata->max_output_channels);
+    ASSERT_EQ(stored.parameters.size(), metadata->parameters.size());
+    for (size_t i = 0; i < stored.parameters.size(); ++i)
+    {
+        EXPECT_EQ(stored.parameters[i].id, metadata->parameters[i].id);
+        EXPECT_EQ(stored.parameters[i].name, metadata->parameters[i].name);
+        EXPECT_EQ(stored.parameters[i].label, metadata->parameters[i].label);
+        EXPECT_EQ(stored.parameters[i].type, metadata->parameters[i].type);
+        EXPECT_FLOAT_EQ(stored.parameters[i].min_range, metadata->parameters[i].min_range);
+        EXPECT_EQ(stored.parameters[i].automatable, metadata->parameters[i].automatable);
+    }
+
+    /* When the plugin changes, the cached metadata should be ignored */
+    _write_plugin_file("a rebuilt plugin");
+    EXPECT_FALSE(_module_under_test.lookup(_plugin_path, "").has_value());
+    PluginMetadataCache new_cache;
+    new_cache.set_cache_directory(_cache_dir);
+    EXPECT_FALSE(new_cache.lookup(_plugin_path, "").has_value());
+}
+
+TEST_F(TestPluginMetadataCache, TestCacheFileOfOtherPlugin)
+{
+    _module_under_test.set_cache_directory(_cache_dir);
+    _module_under_test.store(_plugin_path, "", &_plugin);
+
+    /* Stands in for a hash collision, where another plugin maps to the same file */
+    auto other_file = _module_under_test._cache_file_name({_plugin_path, "other.uid"});
+    ASSERT_EQ(0, rename(_module_under_test._cache_file_name({_plugin_path, ""}).c_str(), other_file.c_str()));
+    PluginMetadataCache cache;
+    cache.set_cache_directory(_cache_dir);
+    EXPECT_FALSE(cache.lookup(_plugin_path, "other.uid").has_value());
+    remove(other_file.c_str());
+}
+
+TEST_F(TestPluginMetadataCache, TestVst3Bundle)
+{
+    /* The library inside the bundle should be checked for changes, not the bundle directory */
+    std::string bundle = _cache_dir + "/plugin.vst3";
+    std::string arch_dir = bundle + "/Contents/" + VST3_BUNDLE_ARCH;
+    ASSERT_EQ(0, mkdir(bundle.c_str(), 0755));
+    ASSERT_EQ(0, mkdir((bundle + "/Contents").c_str(), 0755));
+    ASSERT_EQ(0, mkdir(arch_dir.c_str(), 0755));
+    std::string library = arch_dir + "/plugin.so";
+    ASSERT_EQ(0, rename(_plugin_path.c_str(), library.c_str()));
+
+    _module_under_test.store(bundle, "vst3.uid", &_plugin);
+    EXPECT_TRUE(_module_under_test.lookup(bundle, "vst3.uid").has_value());
+
+    FILE* file = fopen(library.c_str(), "wb");
+    ASSERT_NE(nullptr, file);
+    fputs("a rebuilt plugin library", file);
+    fclose(file);
+    EXPECT_FALSE(_module_under_test.lookup(bundle, "vst3.uid").has_value());
+
+    remove(library.c_str());
+    rmdir(arch_dir.c_str());
+    rmdir((bundle + "/Contents").c_str());
+    rmdir(bundle.c_str());
+}
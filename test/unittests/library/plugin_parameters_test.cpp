@@ -54,6 +54,50 @@ TEST_F(TestLinTodBPreProcessor, TestProcessing)
     EXPECT_NEAR(-12.04f, _module_under_test.process(0.25f), test_utils::DECIBEL_ERROR);
 }
 
+TEST(TestTableMappedPreProcessor, TestAccuracy)
+{
+    TableMappedPreProcessor<dBToLinMapping> db_to_lin(-120.0f, 24.0f);
+    TableMappedPreProcessor<LinTodBMapping> lin_to_db(1.0e-6f, 16.0f);
+    // Unity gain should be exact
+    EXPECT_EQ(1.0f, db_to_lin.process(0.0f));
+    EXPECT_EQ(0.0f, lin_to_db.process(1.0f));
+
+    for (float db = -120.0f; db < 24.0f; db += 0.37f)
+    {
+        float exact = dBToLinMapping::map(db);
+        ASSERT_NEAR(exact, db_to_lin.process(db), exact * 1.0e-5f);
+    }
+    for (float lin = 1.0e-6f; lin < 16.0f; lin *= 1.13f)
+    {
+        ASSERT_NEAR(LinTodBMapping::map(lin), lin_to_db.process(lin), 1.0e-4f);
+    }
+}
+
+TEST(TestTableMappedPreProcessor, TestParameterValue)
+{
+    /* Parameter values do the table lookup themselves and must match process() */
+    dBToLinPreProcessor pre_processor(-120.0f, 24.0f);
+    EXPECT_EQ(TableMapping::Function::EXP2, pre_processor.table_mapping().function);
+    FloatParameterValue value(&pre_processor, 0.0f, nullptr);
+    EXPECT_EQ(1.0f, value.value());
+    for (float db = -130.0f; db < 30.0f; db += 0.37f)
+    {
+        value.set(db);
+        ASSERT_EQ(pre_processor.process(db), value.value());
+    }
+    FloatParameterPreProcessor clip_only(-10.0f, 10.0f);
+    EXPECT_EQ(TableMapping::Function::NONE, clip_only.table_mapping().function);
+}
+
+TEST(TestMappedPreProcessor, TestProcessing)
+{
+    MappedPreProcessor<SemitonesToRatioMapping> module_under_test(-24.0f, 24.0f);
+    EXPECT_FLOAT_EQ(1.0f, module_under_test.process(0.0f));
+    EXPECT_FLOAT_EQ(2.0f, module_under_test.process(12.0f));
+    EXPECT_FLOAT_EQ(0.25f, module_under_test.process(-24.0f));
+    EXPECT_FLOAT_EQ(4.0f, module_under_test.process(36.0f));
+}
+
 /*
  * Templated testing is difficult since we want to test with different values for each type
  * Therefore we test each type separately.
@@ -114,4 +158,39 @@ TEST(TestParameterValue, TestSet)
     value.float_parameter_value()->set(6.0f);
     EXPECT_NEAR(2.0f, value.float_parameter_value()->value(), 0.01f);
     EXPECT_FLOAT_EQ(6.0f, value.float_parameter_value()->raw_value());
-}
\ No newline at end of file
+}
+
+TEST(TestParameterValue, TestSmoothing)
+{
+    FloatParameterPreProcessor pre_processor(0.0f, 10.0f);
+    auto value = ParameterStorage::make_float_parameter_storage(nullptr, 1.0f, &pre_processor);
+    auto float_value = value.float_parameter_value();
+    ChunkSampleBuffer buffer(1);
+
+    /* Without smoothing, all values in the chunk should be equal */
+    EXPECT_FALSE(float_value->smoothing());
+    float_value->set(2.0f);
+    EXPECT_FALSE(float_value->smoothing_active());
+    float_value->render_values(buffer);
+    test_utils::assert_buffer_value(2.0f, buffer);
+
+    /* Ramp over exactly 2 chunks */
+    float_value->set_smoothing(std::chrono::duration<float, std::ratio<1,1>>(2.0f), AUDIO_CHUNK_SIZE);
+    EXPECT_TRUE(float_value->smoothing());
+    EXPECT_FALSE(float_value->smoothing_active());
+    float_value->set(4.0f);
+    EXPECT_FLOAT_EQ(4.0f, float_value->value());
+    EXPECT_TRUE(float_value->smoothing_active());
+
+    float_value->render_values(buffer);
+    EXPECT_FLOAT_EQ(3.0f, buffer.channel(0)[AUDIO_CHUNK_SIZE - 1]);
+    for (int i = 1; i < AUDIO_CHUNK_SIZE; ++i)
+    {
+        ASSERT_GT(buffer.channel(0)[i], buffer.channel(0)[i - 1]);
+    }
+    float_value->render_values(buffer);
+    EXPECT_FLOAT_EQ(4.0f, buffer.channel(0)[AUDIO_CHUNK_SIZE - 1]);
+    EXPECT_FALSE(float_value->smoothing_active());
+    float_value->render_values(buffer);
+    test_utils::assert_buffer_value(4.0f, buffer);
+}
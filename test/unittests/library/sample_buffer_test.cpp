@@ -396,4 +396,33 @@ TEST (TestSampleBuffer, TestCountClippedSamples)
     ASSERT_EQ(3, buffer.count_clipped_samples(0,2));
     ASSERT_EQ(2, buffer.count_clipped_samples(1,1));
     ASSERT_EQ(1, buffer.count_clipped_samples(0,1));
-}
\ No newline at end of file
+}
+
+TEST(TestSampleBuffer, TestPerSampleGain)
+{
+    SampleBuffer<AUDIO_CHUNK_SIZE> buffer(2);
+    SampleBuffer<AUDIO_CHUNK_SIZE> source(2);
+    SampleBuffer<AUDIO_CHUNK_SIZE> mono_source(1);
+    SampleBuffer<AUDIO_CHUNK_SIZE> gain(1);
+    test_utils::fill_sample_buffer(source, 2.0f);
+    test_utils::fill_sample_buffer(mono_source, 1.0f);
+    for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+    {
+        gain.channel(0)[i] = static_cast<float>(i);
+    }
+
+    buffer.add_with_gain(source, gain);
+    buffer.add_with_gain(mono_source, gain);
+    for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+    {
+        ASSERT_FLOAT_EQ(3.0f * i, buffer.channel(0)[i]);
+        ASSERT_FLOAT_EQ(3.0f * i, buffer.channel(1)[i]);
+    }
+
+    buffer.apply_gain(gain);
+    for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+    {
+        ASSERT_FLOAT_EQ(3.0f * i * i, buffer.channel(0)[i]);
+        ASSERT_FLOAT_EQ(3.0f * i * i, buffer.channel(1)[i]);
+    }
+}
@@ -0,0 +1,111 @@
+#include <cstdlib>
+
+#include "gtest/gtest.h"
+
+#define private public
+
+#include "test_utils/test_utils.h"
+#include "library/sample_cache.cpp"
+
+using namespace sushi;
+
+static const std::string SAMPLE_FILE = "Kawai-K11-GrPiano-C4_mono.wav";
+static const std::string STEREO_FILE = "test_sndfile_05.wav";
+constexpr int SAMPLE_FILE_FRAMES = 78478;
+
+class TestSampleCache : public ::testing::Test
+{
+protected:
+    TestSampleCache() {}
+
+    std::string _path{test_utils::get_data_dir_path().append(SAMPLE_FILE)};
+    SampleCache _module_under_test;
+};
+
+TEST_F(TestSampleCache, TestSharing)
+{
+    auto sample = _module_under_test.acquire(_path);
+    ASSERT_NE(nullptr, sample.data);
+    EXPECT_EQ(SAMPLE_FILE_FRAMES, sample.frames);
+    EXPECT_EQ(SAMPLE_FILE_FRAMES, sample.total_frames);
+
+    /* A second user of the same file should get the same data */
+    auto shared_sample = _module_under_test.acquire(_path);
+    EXPECT_EQ(sample.data, shared_sample.data);
+    EXPECT_EQ(1, _module_under_test.size());
+
+    /* Loading only the beginning of the file is cached separately */
+    auto partial_sample = _module_under_test.acquire(_path, 1000);
+    ASSERT_NE(nullptr, partial_sample.data);
+    EXPECT_NE(sample.data, partial_sample.data);
+    EXPECT_EQ(1000, partial_sample.frames);
+    EXPECT_EQ(SAMPLE_FILE_FRAMES, partial_sample.total_frames);
+    EXPECT_EQ(2, _module_under_test.size());
+
+    /* Data should only be freed when the last user releases it */
+    EXPECT_TRUE(_module_under_test.release(sample.data));
+    EXPECT_EQ(2, _module_under_test.size());
+    EXPECT_TRUE(_module_under_test.release(shared_sample.data));
+    EXPECT_TRUE(_module_under_test.release(partial_sample.data));
+    EXPECT_EQ(0, _module_under_test.size());
+    EXPECT_TRUE(_module_under_test._keys.empty());
+
+    /* Data not from the cache should not be touched */
+    float data = 0;
+    EXPECT_FALSE(_module_under_test.release(&data));
+    EXPECT_FALSE(_module_under_test.release(nullptr));
+}
+
+TEST_F(TestSampleCache, TestErrors)
+{
+    EXPECT_EQ(nullptr, _module_under_test.acquire("/not/a/file.wav").data);
+    EXPECT_EQ(nullptr, _module_under_test.acquire(test_utils::get_data_dir_path().append(STEREO_FILE)).data);
+    EXPECT_EQ(0, _module_under_test.size());
+}
+
+TEST_F(TestSampleCache, TestCacheFiles)
+{
+    char dir_template[] = "/tmp/sushi_sample_cache_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(dir_template));
+    std::string cache_dir(dir_template);
+    _module_under_test.set_cache_directory(cache_dir);
+
+    /* The first load should decode the file and write a cache file */
+    auto sample = _module_under_test.acquire(_path);
+    ASSERT_NE(nullptr, sample.data);
+    std::vector<float> decoded(sample.data, sample.data + sample.frames);
+    auto cache_file = _module_under_test._cache_file_name({canonical_path(_path), 0});
+    EXPECT_EQ(0, access(cache_file.c_str(), R_OK));
+    EXPECT_EQ(nullptr, _module_under_test._entries.begin()->second.mapping);
+    _module_under_test.release(sample.data);
+
+    /* The next load should map the cache file */
+    sample = _module_under_test.acquire(_path);
+    ASSERT_NE(nullptr, sample.data);
+    EXPECT_NE(nullptr, _module_under_test._entries.begin()->second.mapping);
+    ASSERT_EQ(static_cast<int>(decoded.size()), sample.frames);
+    EXPECT_EQ(SAMPLE_FILE_FRAMES, sample.total_frames);
+    for (int i = 0; i < sample.frames; ++i)
+    {
+        ASSERT_FLOAT_EQ(decoded[i], sample.data[i]);
+    }
+    _module_under_test.release(sample.data);
+
+    /* Another path to the same file should share the entry and cache file */
+    std::string link = cache_dir + "/link.wav";
+    ASSERT_EQ(0, symlink(_path.c_str(), link.c_str()));
+    sample = _module_under_test.acquire(link);
+    ASSERT_NE(nullptr, sample.data);
+    EXPECT_NE(nullptr, _module_under_test._entries.begin()->second.mapping);
+    EXPECT_EQ(1, _module_under_test.size());
+    _module_under_test.release(sample.data);
+
+    /* The cache file must not be used for another sample file, as on a hash collision */
+    SampleCache::Entry entry;
+    EXPECT_FALSE(_module_under_test._map_cache_file(cache_file, link, entry));
+    EXPECT_EQ(nullptr, entry.mapping);
+
+    remove(link.c_str());
+    remove(cache_file.c_str());
+    rmdir(cache_dir.c_str());
+}
@@ -0,0 +1,166 @@
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#define private public
+
+#include "test_utils/test_utils.h"
+#include "test_utils/host_control_mockup.h"
+#include "plugins/partitioned_convolver.cpp"
+#include "plugins/convolution_plugin.cpp"
+
+using namespace sushi;
+using namespace sushi::convolution_plugin;
+
+constexpr float TEST_SAMPLERATE = 44100;
+/* Long enough to use both tail stages */
+constexpr int TEST_IR_LENGTH = 3 * TAIL_BLOCK_SIZES.back();
+constexpr int TEST_IMPULSE_DELAY = 1000;
+static const std::string IR_FILE = "mono.wav";
+
+/* Wait until the worker threads have processed all complete blocks, so that
+ * the tests do not depend on timing */
+void wait_for_tail(PartitionedConvolver& convolver)
+{
+    for (auto& stage : convolver._tail)
+    {
+        int64_t written = stage->_written_blocks.load();
+        if (written > 0)
+        {
+            auto& last_block = stage->_output_blocks[(written - 1) % TAIL_BUFFER_BLOCKS];
+            while (last_block.load() != written - 1)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+}
+
+TEST(TestPartitionedConvolver, TestImpulseResponse)
+{
+    std::vector<std::vector<float>> irs(2, std::vector<float>(TEST_IR_LENGTH));
+    for (int i = 0; i < TEST_IR_LENGTH; ++i)
+    {
+        irs[0][i] = std::sin(0.01f * i);
+        irs[1][i] = std::cos(0.003f * i);
+    }
+    PartitionedConvolver module_under_test(irs);
+    ASSERT_EQ(2, module_under_test.channels());
+    ASSERT_EQ(TAIL_BLOCK_SIZES.size(), module_under_test._tail.size());
+
+    /* Two impulses in a mono input, the output should be the impulse responses
+     * added to themselves with a delay */
+    ChunkSampleBuffer input(1);
+    ChunkSampleBuffer output(2);
+    int length = TEST_IR_LENGTH + TEST_IMPULSE_DELAY + AUDIO_CHUNK_SIZE;
+    for (int chunk = 0; chunk * AUDIO_CHUNK_SIZE < length; ++chunk)
+    {
+        input.clear();
+        int start = chunk * AUDIO_CHUNK_SIZE;
+        if (start == 0)
+        {
+            input.channel(0)[0] = 1.0f;
+        }
+        if (start <= TEST_IMPULSE_DELAY && TEST_IMPULSE_DELAY < start + AUDIO_CHUNK_SIZE)
+        {
+            input.channel(0)[TEST_IMPULSE_DELAY - start] = 0.5f;
+        }
+        module_under_test.process(input, output);
+        wait_for_tail(module_under_test);
+
+        for (int c = 0; c < 2; ++c)
+        {
+            for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+            {
+                int n = start + i;
+                float expected = n < TEST_IR_LENGTH ? irs[c][n] : 0.0f;
+                if (n >= TEST_IMPULSE_DELAY && n - TEST_IMPULSE_DELAY < TEST_IR_LENGTH)
+                {
+                    expected += 0.5f * irs[c][n - TEST_IMPULSE_DELAY];
+                }
+                ASSERT_NEAR(expected, output.channel(c)[i], 1.0e-4f) << "channel " << c << ", sample " << n;
+            }
+        }
+    }
+    EXPECT_EQ(0, module_under_test.underruns());
+}
+
+class TestConvolutionPlugin : public ::testing::Test
+{
+protected:
+    TestConvolutionPlugin() {}
+
+    void SetUp()
+    {
+        _module_under_test = new ConvolutionPlugin(_host_control.make_host_control_mockup(TEST_SAMPLERATE));
+        ProcessorReturnCode status = _module_under_test->init(TEST_SAMPLERATE);
+        ASSERT_EQ(ProcessorReturnCode::OK, status);
+        _module_under_test->set_input_channels(2);
+    }
+
+    void TearDown()
+    {
+        delete _module_under_test;
+    }
+
+    HostControlMockup _host_control;
+    ConvolutionPlugin* _module_under_test;
+};
+
+TEST_F(TestConvolutionPlugin, TestDryProcessing)
+{
+    ChunkSampleBuffer in_buffer(2);
+    ChunkSampleBuffer out_buffer(2);
+    test_utils::fill_sample_buffer(in_buffer, 1.0f);
+    /* Without an impulse response only the dry signal is output */
+    _module_under_test->process_audio(in_buffer, out_buffer);
+    test_utils::assert_buffer_value(1.0f, out_buffer);
+}
+
+TEST_F(TestConvolutionPlugin, TestImpulseResponseLoading)
+{
+    RtSafeRtEventFifo queue;
+    _module_under_test->set_event_output(&queue);
+    auto path = new std::string(test_utils::get_data_dir_path());
+    path->append(IR_FILE);
+    auto property_id = _module_under_test->parameter_from_name("impulse_response_file")->id();
+    _module_under_test->process_event(RtEvent::make_string_parameter_change_event(0, 0, property_id, path));
+
+    /* Simulate an event dispatcher receiving the event and calling the non-rt callback */
+    RtEvent async_event;
+    ASSERT_TRUE(queue.pop(async_event));
+    auto typed_event = async_event.async_work_event();
+    int status = typed_event->callback()(typed_event->callback_data(), typed_event->event_id());
+    ASSERT_EQ(ImpulseResponseChangeStatus::SUCCESS, status);
+    ASSERT_EQ(nullptr, _module_under_test->_convolver);
+    _module_under_test->process_event(RtEvent::make_async_work_completion_event(typed_event->processor_id(),
+                                                                                typed_event->event_id(), status));
+    ASSERT_NE(nullptr, _module_under_test->_convolver);
+    EXPECT_EQ(1, _module_under_test->_convolver->channels());
+
+    /* With the dry signal muted, an impulse should give the impulse response on both channels */
+    _module_under_test->process_event(RtEvent::make_parameter_change_event(0, 0, _module_under_test->_dry_parameter->descriptor()->id(), 0.0f));
+    ChunkSampleBuffer in_buffer(2);
+    ChunkSampleBuffer out_buffer(2);
+    in_buffer.channel(0)[0] = 1.0f;
+    in_buffer.channel(1)[0] = 1.0f;
+    _module_under_test->process_audio(in_buffer, out_buffer);
+    float energy = 0;
+    for (int i = 0; i < AUDIO_CHUNK_SIZE; ++i)
+    {
+        EXPECT_FLOAT_EQ(out_buffer.channel(0)[i], out_buffer.channel(1)[i]);
+        energy += out_buffer.channel(0)[i] * out_buffer.channel(0)[i];
+    }
+    EXPECT_GT(energy, 0.0f);
+
+    /* Loading a file that does not exist should keep the current impulse response */
+    auto current = _module_under_test->_convolver.get();
+    _module_under_test->process_event(RtEvent::make_string_parameter_change_event(0, 0, property_id, new std::string("no_such_file.wav")));
+    ASSERT_TRUE(queue.pop(async_event));
+    typed_event = async_event.async_work_event();
+    status = typed_event->callback()(typed_event->callback_data(), typed_event->event_id());
+    ASSERT_EQ(ImpulseResponseChangeStatus::FAILURE, status);
+    _module_under_test->process_event(RtEvent::make_async_work_completion_event(typed_event->processor_id(),
+                                                                                typed_event->event_id(), status));
+    EXPECT_EQ(current, _module_under_test->_convolver.get());
+}
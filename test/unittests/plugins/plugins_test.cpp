@@ -3,6 +3,7 @@
 #include "gtest/gtest.h"
 
 #define private public
+#define protected public
 
 #include "test_utils/test_utils.h"
 #include "test_utils/host_control_mockup.h"
@@ -117,10 +118,40 @@ TEST_F(TestGainPlugin, TestProcess)
     _module_under_test->set_input_channels(2);
     _module_under_test->set_output_channels(2);
     _module_under_test->_gain_parameter->set(6.0f);
+
+    // Gain changes are smoothed, the first chunk should ramp up from unity gain
     _module_under_test->process_audio(in_buffer, out_buffer);
+    EXPECT_GT(out_buffer.channel(0)[0], 1.0f);
+    EXPECT_LT(out_buffer.channel(0)[AUDIO_CHUNK_SIZE - 1], 2.0f);
+    for (int i = 1; i < AUDIO_CHUNK_SIZE; ++i)
+    {
+        ASSERT_GT(out_buffer.channel(0)[i], out_buffer.channel(0)[i - 1]);
+        ASSERT_FLOAT_EQ(out_buffer.channel(0)[i], out_buffer.channel(1)[i]);
+    }
+
+    int chunks = static_cast<int>(std::ceil(gain_plugin::GAIN_SMOOTHING_TIME.count() * TEST_SAMPLERATE / 1000 / AUDIO_CHUNK_SIZE));
+    for (int i = 0; i < chunks; ++i)
+    {
+        _module_under_test->process_audio(in_buffer, out_buffer);
+    }
+    EXPECT_FALSE(_module_under_test->_gain_parameter->smoothing_active());
     test_utils::assert_buffer_value(2.0f, out_buffer, test_utils::DECIBEL_ERROR);
 }
 
+TEST_F(TestGainPlugin, TestConfigure)
+{
+    SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(1);
+    SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(1);
+    _module_under_test->set_input_channels(1);
+
+    // The new sample rate should only be applied from the audio thread
+    _module_under_test->configure(TEST_SAMPLERATE * 2);
+    EXPECT_FLOAT_EQ(TEST_SAMPLERATE * 2, _module_under_test->_new_sample_rate.load());
+    _module_under_test->process_audio(in_buffer, out_buffer);
+    EXPECT_FLOAT_EQ(0.0f, _module_under_test->_new_sample_rate.load());
+    EXPECT_TRUE(_module_under_test->_gain_parameter->smoothing());
+}
+
 
 class TestEqualizerPlugin : public ::testing::Test
 {
@@ -187,6 +218,52 @@ TEST_F(TestEqualizerPlugin, TestProcess)
     test_utils::assert_buffer_value(0.0f, out_buffer);
 }
 
+TEST_F(TestEqualizerPlugin, TestCoefficientUpdates)
+{
+    SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(1);
+    SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(1);
+    test_utils::fill_sample_buffer(in_buffer, 0.0f);
+
+    // Coefficients should be calculated on the first call and not again until a parameter changes
+    _module_under_test->process_audio(in_buffer, out_buffer);
+    EXPECT_FALSE(_module_under_test->parameters_changed());
+    auto coefficients = _module_under_test->_filters[0]._coefficient_targets;
+
+    _module_under_test->process_audio(in_buffer, out_buffer);
+    EXPECT_FLOAT_EQ(coefficients.b0, _module_under_test->_filters[0]._coefficient_targets.b0);
+
+    auto gain_param = _module_under_test->parameter_from_name("gain");
+    auto event = RtEvent::make_parameter_change_event(0, 0, gain_param->id(), 12.0f);
+    _module_under_test->process_event(event);
+    EXPECT_TRUE(_module_under_test->parameters_changed());
+
+    _module_under_test->process_audio(in_buffer, out_buffer);
+    EXPECT_FALSE(_module_under_test->parameters_changed());
+    EXPECT_NE(coefficients.b0, _module_under_test->_filters[0]._coefficient_targets.b0);
+    EXPECT_FLOAT_EQ(_module_under_test->_filters[0]._coefficient_targets.b0,
+                    _module_under_test->_filters[1]._coefficient_targets.b0);
+}
+
+TEST_F(TestEqualizerPlugin, TestConfigure)
+{
+    SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(1);
+    SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(1);
+    test_utils::fill_sample_buffer(in_buffer, 0.0f);
+    _module_under_test->_gain->set(6.0f);
+    _module_under_test->process_audio(in_buffer, out_buffer);
+    auto coefficients = _module_under_test->_filters[0]._coefficient_targets;
+
+    // The coefficients should only be recalculated from the audio thread
+    _module_under_test->configure(TEST_SAMPLERATE * 2);
+    EXPECT_FALSE(_module_under_test->parameters_changed());
+    EXPECT_FLOAT_EQ(coefficients.a1, _module_under_test->_filters[0]._coefficient_targets.a1);
+
+    _module_under_test->process_audio(in_buffer, out_buffer);
+    EXPECT_FLOAT_EQ(TEST_SAMPLERATE * 2, _module_under_test->_sample_rate);
+    EXPECT_FLOAT_EQ(0.0f, _module_under_test->_new_sample_rate.load());
+    EXPECT_NE(coefficients.a1, _module_under_test->_filters[0]._coefficient_targets.a1);
+}
+
 
 class TestPeakMeterPlugin : public ::testing::Test
 {
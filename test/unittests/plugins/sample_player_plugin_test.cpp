@@ -5,6 +5,7 @@
 #include "test_utils/test_utils.h"
 #include "test_utils/host_control_mockup.h"
 #include "plugins/sample_player_voice.cpp"
+#include "plugins/sample_streamer.cpp"
 #include "plugins/sample_player_plugin.cpp"
 #include "library/rt_event_fifo.h"
 
@@ -85,6 +86,97 @@ TEST_F(TestSamplerVoice, TestNoteOff)
     EXPECT_FLOAT_EQ(0.0f, buf[4]);
 }
 
+TEST_F(TestSamplerVoice, TestStealFade)
+{
+    std::vector<float> data(AUDIO_CHUNK_SIZE * 4, 1.0f);
+    dsp::Sample sample{data.data(), static_cast<int>(data.size())};
+    _module_under_test.set_sample(&sample);
+    sushi::SampleBuffer<AUDIO_CHUNK_SIZE> buffer(1);
+    buffer.clear();
+    _module_under_test.note_on(60, 1.0f, 0);
+    _module_under_test.render(buffer);
+
+    /* Restarting a playing voice should fade out the old note and not cut it */
+    buffer.clear();
+    int offset = AUDIO_CHUNK_SIZE / 2;
+    _module_under_test.note_on(60, 1.0f, offset);
+    _module_under_test.render(buffer);
+    float* buf = buffer.channel(0);
+    EXPECT_NEAR(1.0f, buf[0], 1.0f / STEAL_FADE_SAMPLES);
+    for (int i = 1; i < offset; ++i)
+    {
+        EXPECT_LT(buf[i], buf[i - 1]);
+        EXPECT_GT(buf[i], 0.0f);
+    }
+    EXPECT_FLOAT_EQ(1.0f, buf[AUDIO_CHUNK_SIZE - 1]);
+    EXPECT_TRUE(_module_under_test.active());
+}
+
+TEST_F(TestSamplerVoice, TestFadeOut)
+{
+    std::vector<float> data(AUDIO_CHUNK_SIZE * 4, 1.0f);
+    dsp::Sample sample{data.data(), static_cast<int>(data.size())};
+    _module_under_test.set_sample(&sample);
+    sushi::SampleBuffer<AUDIO_CHUNK_SIZE> buffer(1);
+    buffer.clear();
+    _module_under_test.note_on(60, 1.0f, 0);
+    _module_under_test.render(buffer);
+
+    /* The note should ramp down to silence within one chunk and stop the voice */
+    buffer.clear();
+    _module_under_test.fade_out();
+    EXPECT_TRUE(_module_under_test.fading_out());
+    _module_under_test.render(buffer);
+    float* buf = buffer.channel(0);
+    EXPECT_NEAR(1.0f, buf[0], 1.0f / STEAL_FADE_SAMPLES);
+    for (int i = 1; i < AUDIO_CHUNK_SIZE; ++i)
+    {
+        EXPECT_LE(buf[i], buf[i - 1]);
+    }
+    EXPECT_FLOAT_EQ(0.0f, buf[AUDIO_CHUNK_SIZE - 1]);
+    EXPECT_FALSE(_module_under_test.active());
+    EXPECT_FALSE(_module_under_test.fading_out());
+
+    /* A note that has not sounded yet is stopped directly */
+    _module_under_test.note_on(60, 1.0f, 0);
+    _module_under_test.fade_out();
+    EXPECT_FALSE(_module_under_test.active());
+}
+
+TEST_F(TestSamplerVoice, TestStreaming)
+{
+    /* Preload the first 2 samples and stream the rest */
+    dsp::Sample preload{SAMPLE_DATA, 2};
+    StreamBuffer stream;
+    _module_under_test.set_sample(&preload);
+    _module_under_test.set_stream(&stream, SAMPLE_DATA_LENGTH);
+    sushi::SampleBuffer<AUDIO_CHUNK_SIZE> buffer(1);
+    buffer.clear();
+
+    /* The stream is not ready yet, so nothing should be played */
+    _module_under_test.note_on(60, 1.0f, 0);
+    _module_under_test.render(buffer);
+    EXPECT_TRUE(_module_under_test.underrun());
+    test_utils::assert_buffer_value(0.0f, buffer);
+
+    /* Simulate the streaming thread serving the request */
+    ASSERT_NE(0, stream.requested());
+    stream.reset(stream.requested());
+    stream.push(SAMPLE_DATA + 2, SAMPLE_DATA_LENGTH - 2);
+    _module_under_test.render(buffer);
+    EXPECT_FALSE(_module_under_test.underrun());
+
+    float* buf = buffer.channel(0);
+    EXPECT_FLOAT_EQ(1.0f, buf[0]);
+    EXPECT_FLOAT_EQ(2.0f, buf[1]);
+    EXPECT_FLOAT_EQ(2.0f, buf[2]);
+    EXPECT_FLOAT_EQ(1.0f, buf[3]);
+    EXPECT_FLOAT_EQ(1.0f, buf[4]);
+    EXPECT_FLOAT_EQ(0.0f, buf[5]);
+    /* The voice should stop by itself at the end of the sample */
+    EXPECT_FALSE(_module_under_test.active());
+    EXPECT_EQ(0, stream.requested());
+}
 
 /* Test the Plugin */
 class TestSamplePlayerPlugin : public ::testing::Test
@@ -103,6 +195,23 @@ protected:
     {
         delete _module_under_test;
     }
+    /* Load a sample file the same way as when set from the host */
+    void load_sample(SamplePlayerPlugin* plugin, const std::string& file)
+    {
+        RtSafeRtEventFifo queue;
+        plugin->set_event_output(&queue);
+        auto sample_ev = RtEvent::make_string_parameter_change_event(0, 0, 5, new std::string(file));
+        plugin->process_event(sample_ev);
+        RtEvent async_event;
+        ASSERT_TRUE(queue.pop(async_event));
+        auto typed_event = async_event.async_work_event();
+        int status = typed_event->callback()(typed_event->callback_data(), typed_event->event_id());
+        ASSERT_EQ(SampleChangeStatus::SUCCESS, status);
+        plugin->process_event(RtEvent::make_async_work_completion_event(typed_event->processor_id(),
+                                                                        typed_event->event_id(), status));
+        plugin->set_event_output(nullptr);
+    }
+
     HostControlMockup _host_control;
     SamplePlayerPlugin* _module_under_test;
 
@@ -132,9 +241,31 @@ TEST_F(TestSamplePlayerPlugin, TestSampleLoading)
 
     /* Sample should now be changed */
     ASSERT_NE(nullptr, _module_under_test->_sample_buffer);
+    EXPECT_EQ(nullptr, _module_under_test->_pending_sample.data);
 
-    /* Plugin should have put a delete event on the output queue, just check that it's there */
-    ASSERT_FALSE(queue.empty());
+    /* Loading the file again for streaming gives other sample data, and the old
+     * data should be given back to the cache from the non-rt thread */
+    const float* old_sample = _module_under_test->_sample_buffer;
+    int cache_size = SampleCache::instance().size();
+    _module_under_test->_disk_streaming_parameter->set_values(true, true);
+    sample_ev = RtEvent::make_string_parameter_change_event(0, 0, 5, new std::string(test_utils::get_data_dir_path() + SAMPLE_FILE));
+    _module_under_test->process_event(sample_ev);
+    ASSERT_TRUE(queue.pop(async_event));
+    typed_event = async_event.async_work_event();
+    status = typed_event->callback()(typed_event->callback_data(), typed_event->event_id());
+    ASSERT_EQ(SampleChangeStatus::SUCCESS, status);
+    _module_under_test->process_event(RtEvent::make_async_work_completion_event(typed_event->processor_id(),
+                                                                                typed_event->event_id(), status));
+    EXPECT_NE(old_sample, _module_under_test->_sample_buffer);
+    EXPECT_EQ(old_sample, _module_under_test->_retired_sample);
+    EXPECT_EQ(cache_size + 1, SampleCache::instance().size());
+
+    ASSERT_TRUE(queue.pop(async_event));
+    typed_event = async_event.async_work_event();
+    typed_event->callback()(typed_event->callback_data(), typed_event->event_id());
+    EXPECT_EQ(nullptr, _module_under_test->_retired_sample);
+    EXPECT_EQ(cache_size, SampleCache::instance().size());
+    EXPECT_TRUE(queue.empty());
 }
 
 TEST_F(TestSamplePlayerPlugin, TestProcessing)
@@ -147,13 +278,123 @@ TEST_F(TestSamplePlayerPlugin, TestProcessing)
     test_utils::assert_buffer_value(0.0f, out_buffer);
 }
 
+TEST_F(TestSamplePlayerPlugin, TestVoiceAllocation)
+{
+    SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(1);
+    SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(1);
+    std::vector<float> sample_data(AUDIO_CHUNK_SIZE * 10, 1.0f);
+    _module_under_test->_sample.set_sample(sample_data.data(), sample_data.size());
+    _module_under_test->_polyphony_parameter->set_values(2, 2);
+    _module_under_test->_release_parameter->set_values(1.0f, 1.0f);
+
+    _module_under_test->process_event(RtEvent::make_note_on_event(0, 0, 0, 60, 1.0f));
+    _module_under_test->process_event(RtEvent::make_note_on_event(0, 0, 0, 62, 1.0f));
+    ASSERT_EQ(2, _module_under_test->_active_voice_count);
+    int first_voice = _module_under_test->_active_voices[0];
+    int second_voice = _module_under_test->_active_voices[1];
+
+    /* All voices are busy, so the oldest one should be stolen */
+    _module_under_test->process_event(RtEvent::make_note_on_event(0, 0, 0, 64, 1.0f));
+    ASSERT_EQ(2, _module_under_test->_active_voice_count);
+    EXPECT_EQ(64, _module_under_test->_voices[first_voice].current_note());
+    EXPECT_EQ(first_voice, _module_under_test->_active_voices[1]);
+
+    /* A releasing voice should be stolen before an older, held voice */
+    _module_under_test->process_event(RtEvent::make_note_off_event(0, 0, 0, 64, 1.0f));
+    _module_under_test->process_audio(in_buffer, out_buffer);
+    _module_under_test->process_event(RtEvent::make_note_on_event(0, 0, 0, 65, 1.0f));
+    EXPECT_EQ(62, _module_under_test->_voices[second_voice].current_note());
+    EXPECT_EQ(65, _module_under_test->_voices[first_voice].current_note());
+
+    /* Voices should be returned to the free list once they have played the whole sample */
+    for (int i = 0; i < 11; ++i)
+    {
+        _module_under_test->process_audio(in_buffer, out_buffer);
+    }
+    EXPECT_EQ(0, _module_under_test->_active_voice_count);
+    EXPECT_EQ(MAX_POLYPHONY, _module_under_test->_free_voice_count);
+}
+
+TEST_F(TestSamplePlayerPlugin, TestLoweringPolyphony)
+{
+    SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(1);
+    SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(1);
+    std::vector<float> sample_data(AUDIO_CHUNK_SIZE * 10, 1.0f);
+    _module_under_test->_sample.set_sample(sample_data.data(), sample_data.size());
+    _module_under_test->_polyphony_parameter->set_values(4, 4);
+    for (int note = 60; note < 64; ++note)
+    {
+        _module_under_test->process_event(RtEvent::make_note_on_event(0, 0, 0, note, 1.0f));
+    }
+    _module_under_test->process_audio(in_buffer, out_buffer);
+    ASSERT_EQ(4, _module_under_test->_active_voice_count);
+
+    /* The oldest voices above the new polyphony should be faded out and freed */
+    _module_under_test->_polyphony_parameter->set_values(2, 2);
+    _module_under_test->process_audio(in_buffer, out_buffer);
+    ASSERT_EQ(2, _module_under_test->_active_voice_count);
+    EXPECT_EQ(62, _module_under_test->_voices[_module_under_test->_active_voices[0]].current_note());
+    EXPECT_EQ(63, _module_under_test->_voices[_module_under_test->_active_voices[1]].current_note());
+    _module_under_test->process_audio(in_buffer, out_buffer);
+    EXPECT_EQ(2, _module_under_test->_active_voice_count);
+}
+
+TEST_F(TestSamplePlayerPlugin, TestDiskStreaming)
+{
+    SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(1);
+    SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(1);
+    SampleBuffer<AUDIO_CHUNK_SIZE> streamed_buffer(1);
+    std::string path = test_utils::get_data_dir_path().append(SAMPLE_FILE);
+    load_sample(_module_under_test, path);
+
+    SamplePlayerPlugin streaming_plugin(_host_control.make_host_control_mockup(TEST_SAMPLERATE));
+    ASSERT_EQ(ProcessorReturnCode::OK, streaming_plugin.init(TEST_SAMPLERATE));
+    streaming_plugin._disk_streaming_parameter->set_values(true, true);
+    load_sample(&streaming_plugin, path);
+    ASSERT_TRUE(streaming_plugin._pending_streaming);
+    ASSERT_LT(streaming_plugin._sample.length(), streaming_plugin._pending_sample.total_frames);
+
+    /* The next sample is loaded into the other streamer, the first one may still be in use */
+    int first_streamer = streaming_plugin._active_streamer;
+    load_sample(&streaming_plugin, path);
+    EXPECT_NE(first_streamer, streaming_plugin._active_streamer);
+    int preload = static_cast<int>(std::chrono::duration<float>(STREAMING_PRELOAD_TIME).count() * 44100);
+    EXPECT_EQ(preload, streaming_plugin._sample.length());
+
+    /* The streamed sample should sound exactly like the one loaded into memory */
+    _module_under_test->process_event(RtEvent::make_note_on_event(0, 0, 0, 60, 1.0f));
+    streaming_plugin.process_event(RtEvent::make_note_on_event(0, 0, 0, 60, 1.0f));
+    int chunks = streaming_plugin._pending_sample.total_frames / AUDIO_CHUNK_SIZE + 1;
+    for (int i = 0; i < chunks; ++i)
+    {
+        /* Give the streaming thread time to keep up */
+        if (i % 16 == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        _module_under_test->process_audio(in_buffer, out_buffer);
+        streaming_plugin.process_audio(in_buffer, streamed_buffer);
+        for (int s = 0; s < AUDIO_CHUNK_SIZE; ++s)
+        {
+            ASSERT_FLOAT_EQ(out_buffer.channel(0)[s], streamed_buffer.channel(0)[s]);
+        }
+    }
+    EXPECT_EQ(0, streaming_plugin._stream_underruns_parameter->value());
+    EXPECT_EQ(0, streaming_plugin._active_voice_count);
+
+    /* The under-run count is output only */
+    auto id = streaming_plugin._stream_underruns_parameter->descriptor()->id();
+    streaming_plugin.process_event(RtEvent::make_parameter_change_event(0, 0, id, 10.0f));
+    EXPECT_EQ(0, streaming_plugin._stream_underruns_parameter->value());
+}
+
 TEST_F(TestSamplePlayerPlugin, TestEventProcessing)
 {
     SampleBuffer<AUDIO_CHUNK_SIZE> in_buffer(1);
     SampleBuffer<AUDIO_CHUNK_SIZE> out_buffer(1);
-    BlobData data = _module_under_test->load_sample_file(test_utils::get_data_dir_path().append(SAMPLE_FILE));
-    ASSERT_NE(0, data.size);
-    _module_under_test->_sample.set_sample(reinterpret_cast<float*>(data.data), data.size * sizeof(float));
+    auto data = SampleCache::instance().acquire(test_utils::get_data_dir_path().append(SAMPLE_FILE));
+    ASSERT_NE(nullptr, data.data);
+    _module_under_test->_sample.set_sample(data.data, data.frames);
     out_buffer.clear();
     RtEvent note_on = RtEvent::make_note_on_event(0, 5, 0, 60, 1.0f);
     RtEvent note_on2 = RtEvent::make_note_on_event(0, 50, 0, 65, 1.0f);
@@ -165,14 +406,19 @@ TEST_F(TestSamplePlayerPlugin, TestEventProcessing)
     ASSERT_NE(0.0f, out_buffer.channel(0)[10]);
     ASSERT_NE(0.0f, out_buffer.channel(0)[15]);
 
-    // Test that bypass works
+    // Test that bypass works, set_bypassed() should only post an event
     _module_under_test->set_bypassed(true);
+    EXPECT_FALSE(_module_under_test->bypassed());
+    auto event = _host_control._dummy_dispatcher.retrieve_event();
+    ASSERT_NE(nullptr, event);
+    _module_under_test->process_event(event->to_rt_event(0));
+    EXPECT_TRUE(_module_under_test->bypassed());
     _module_under_test->process_audio(in_buffer, out_buffer);
     test_utils::assert_buffer_value(0.0f, out_buffer);
 
     // And that we have no hanging notes
-    _module_under_test->set_bypassed(false);
+    _module_under_test->process_event(RtEvent::make_bypass_processor_event(_module_under_test->id(), false));
     _module_under_test->process_audio(in_buffer, out_buffer);
     test_utils::assert_buffer_value(0.0f, out_buffer);
-    delete data.data;
+    SampleCache::instance().release(data.data);
 }
@@ -159,6 +159,12 @@ public:
     virtual ControlStatus                              set_parameter_value(int /* processor_id */, int /* parameter_id */, float /* value */) override { return default_control_status; };
     virtual ControlStatus                              set_parameter_value_normalised(int /* processor_id */, int /* parameter_id */, float /* value */) override { return default_control_status; };
     virtual ControlStatus                              set_string_property_value(int /* processor_id */, int /* parameter_id */, const std::string& /* value */) override { return default_control_status; };
+    virtual std::vector<ParameterValue>                get_all_parameter_values() const override { return std::vector<ParameterValue>(); };
+    virtual ControlStatus                              set_parameter_values(const std::vector<ParameterValue>& /* values */) override { return default_control_status; };
+    virtual EngineSnapshot                             get_engine_snapshot() const override { return EngineSnapshot(); };
+
+    virtual ControlStatus                              subscribe_to_notifications(NotificationType /* type */, ControlListener* /* listener */) override { return default_control_status; };
+    virtual ControlStatus                              unsubscribe_from_notifications(NotificationType /* type */, ControlListener* /* listener */) override { return default_control_status; };
 };
 
 } // ext
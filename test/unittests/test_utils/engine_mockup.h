@@ -3,6 +3,7 @@
 
 #include "engine/base_engine.h"
 #include "engine/base_event_dispatcher.h"
+#include "engine/transport.h"
 
 using namespace sushi;
 using namespace sushi::engine;
@@ -121,4 +122,60 @@ private:
     EventDispatcherMockup _event_dispatcher;
 };
 
+// Engine with processors that tests can add directly to the public map
+class ProcessorEngineMockup : public EngineMockup
+{
+public:
+    ProcessorEngineMockup(float sample_rate) : EngineMockup(sample_rate), _transport(sample_rate) {}
+
+    const std::map<std::string, std::unique_ptr<Processor>>& all_processors() override
+    {
+        return processors;
+    }
+
+    std::pair<EngineReturnStatus, ObjectId> processor_id_from_name(const std::string& name) override
+    {
+        auto processor = processors.find(name);
+        if (processor == processors.end())
+        {
+            return {EngineReturnStatus::INVALID_PROCESSOR, 0};
+        }
+        return {EngineReturnStatus::OK, processor->second->id()};
+    }
+
+    const Processor* processor(ObjectId processor_id) const override
+    {
+        for (auto& processor : processors)
+        {
+            if (processor.second->id() == processor_id)
+            {
+                return processor.second.get();
+            }
+        }
+        return nullptr;
+    }
+
+    Processor* mutable_processor(ObjectId processor_id) override
+    {
+        for (auto& processor : processors)
+        {
+            if (processor.second->id() == processor_id)
+            {
+                return processor.second.get();
+            }
+        }
+        return nullptr;
+    }
+
+    Transport* transport() override
+    {
+        return &_transport;
+    }
+
+    std::map<std::string, std::unique_ptr<Processor>> processors;
+
+private:
+    Transport _transport;
+};
+
 #endif //SUSHI_ENGINE_MOCKUP_H